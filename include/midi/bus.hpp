@@ -27,7 +27,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2016-11-24
- * \updates       2024-06-12
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  The bus module is the new base class for the various implementations
@@ -61,6 +61,7 @@
  *      consistent.
  */
 
+#include <atomic>                       /* std::atomic<bool>                */
 #include <memory>                       /* std::shared_ptr<>, unique_ptr<>  */
 
 #include "c_macros.h"                   /* not_nullptr() macro              */
@@ -222,10 +223,12 @@ private:
      *  if the user enables the port in the Options / MIDI Input tab or the
      *  Options / MIDI Clocks tab.
      *
-     *  Setter/getter are port_enabled().
+     *  Setter/getter are port_enabled().  Atomic, because a bus can be
+     *  deactivated and re-bound (see rebind()) off the output thread, which
+     *  checks it before every send.
      */
 
-    bool m_io_active;
+    std::atomic<bool> m_io_active;
 
     /**
      *  Holds the full display name of the bus, index, ID numbers, and item
@@ -282,6 +285,15 @@ private:
 
     port::kind m_port_type;
 
+    /**
+     *  The time from sending an event on this port to the device sounding
+     *  it, in microseconds.  Set from the ports configuration, or queried
+     *  from the API (only JACK reports it).  Zero if not known.  Used by
+     *  busarray::compensate_latency() to line the ports up.
+     */
+
+    long m_latency_us;
+
     /**
      *  Locking mutex. This one is based on std:::recursive_mutex.
      */
@@ -389,6 +401,18 @@ public:
         return m_port_alias;
     }
 
+    long latency_us () const
+    {
+        return m_latency_us;
+    }
+
+    void latency_us (long us)
+    {
+        m_latency_us = us > 0 ? us : 0 ;
+    }
+
+    bool query_latency ();
+
     std::string connect_name () const;
 
     int bus_index () const
@@ -599,6 +623,7 @@ public:
      *----------------------------------------------------------------------*/
 
     virtual bool connect ();                        /* common to in/out tho */
+    virtual bool rebind (int busid, int portid);
 
     /*----------------------------------------------------------------------
      * Input functions
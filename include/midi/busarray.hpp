@@ -27,7 +27,7 @@
  * \library       rtl66 application
  * \author        Chris Ahlstrom
  * \date          2024-06-02
- * \updates       2024-06-09
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  The busarray module defines the busarray and busarray classes so that we can
@@ -36,9 +36,14 @@
  *  The busarray class holds a pointer to its midi::bus object.
  */
 
+#include <memory>                       /* std::unique_ptr<>                */
+#include <string>                       /* std::string                      */
+#include <unordered_map>                /* std::unordered_map<>             */
 #include <vector>                       /* for containing the bus objects   */
 
 #include "midi/bus.hpp"                 /* midi::bus, clientinfo, clocking  */
+#include "midi/outworker.hpp"           /* midi::outworker per-bus sender   */
+#include "midi/portwatch.hpp"           /* midi::portwatch::change          */
 
 namespace midi
 {
@@ -65,6 +70,52 @@ private:
 
     container m_container;
 
+    /**
+     *  Optional asynchronous output: one worker per bus, indexed as
+     *  m_container.  Empty unless async_output(true) has been called.  See
+     *  the outworker module.
+     */
+
+    std::vector<std::unique_ptr<outworker>> m_workers;
+
+    /**
+     *  The queue size given to each worker, kept so that a bus added while
+     *  asynchronous output is on gets a worker like the others.
+     */
+
+    std::size_t m_worker_capacity;
+
+    /**
+     *  If true, the workers of the lower-latency busses hold their output
+     *  back so that every bus reaches its device at the same time as the
+     *  slowest one.  See compensate_latency().
+     */
+
+    bool m_compensate_latency;
+
+    /**
+     *  Maps the identity of each bus's port (see portwatch::identity()) to
+     *  the bus, so that a name is resolved without a scan.  A bus is listed
+     *  under its "client:port" name and, if it has one, its alias.  Built by
+     *  reindex().
+     */
+
+    std::unordered_map<std::string, bussbyte> m_index;
+
+    /**
+     *  True if the index is out of date with the busses.
+     */
+
+    bool m_reindex;
+
+    /**
+     *  True for each bus whose port has vanished while the bus was active,
+     *  so that it is re-bound when the port comes back.  A bus that the user
+     *  had disabled stays disabled.
+     */
+
+    std::vector<bool> m_unplugged;
+
 public:
 
     busarray ();
@@ -116,6 +167,11 @@ public:
         return bus_valid(b) ? m_container[b].get() : nullptr ;
     }
 
+    const bus * bus_pointer (bussbyte b) const
+    {
+        return bus_valid(b) ? m_container[b].get() : nullptr ;
+    }
+
     int client_id (bussbyte b)
     {
         return bus_valid(b) ? m_container[b]->client_id() : 0 ;
@@ -144,6 +200,30 @@ public:
     clocking get_clock (bussbyte b) const;
     void send_event (bussbyte b, const event * e24, byte channel);
     void send_sysex (bussbyte b, const event * ev);
+    bool async_output (bool flag, std::size_t capacity = 1024);
+    outworker::statistics output_stats (bussbyte b) const;
+
+    bool async_output () const
+    {
+        return ! m_workers.empty();
+    }
+
+    bool compensate_latency (bool flag);
+
+    bool compensate_latency () const
+    {
+        return m_compensate_latency;
+    }
+
+    void latency (bussbyte b, long us);
+
+    long latency (bussbyte b) const
+    {
+        return bus_valid(b) ? m_container[b]->latency_us() : 0 ;
+    }
+
+    long compensation (bussbyte b) const;
+    int query_latencies ();
 
     std::string get_midi_bus_name (int b) const;  /* full display name!   */
     std::string get_midi_port_name (int b) const; /* without the client   */
@@ -151,6 +231,22 @@ public:
 
     void print () const;
     void port_exit (int client, int port);
+    void reindex ();
+    int bus_from_name
+    (
+        const std::string & name, const std::string & alias = ""
+    ) const;
+    bool port_change (const portwatch::change & pc);
+    bool port_vanished (const portwatch::change & pc);
+    int find_replug (const portwatch::change & pc);
+    bool rebind (bussbyte b, int client, int port);
+    void replugged (bussbyte b);
+
+    bool unplugged (bussbyte b) const
+    {
+        return bus_valid(b) && m_unplugged[b];
+    }
+
     bool set_input (bussbyte b, bool inputing);
     void set_all_inputs (bool inputing);
     bool get_input (bussbyte b) const;
@@ -161,6 +257,13 @@ public:
     bool get_midi_event (event * inev);
     int replacement_port (int b, int p);
 
+private:
+
+    long max_latency () const;
+    void apply_latency ();
+    void add_worker (bus & buss);
+    bool unplug (bussbyte b);
+
 };          // class busarray
 
 /*
@@ -0,0 +1,192 @@
+#if ! defined RTL66_MIDI_BUSCONFIG_HPP
+#define RTL66_MIDI_BUSCONFIG_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          busconfig.hpp
+ *
+ *  This module declares the bus settings that can be reloaded while playing.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  The [midi-clock] and [midi-input] sections of an "rc" file are parsed
+ *  into a busconfig, away from the I/O threads.  Each line is matched to a
+ *  live bus by the identity of its port name (see portwatch::identity()),
+ *  not by its number, and only the settings that differ from the live ones
+ *  become changes.  The changes are handed to a busconfig::stage, which the
+ *  output thread applies at the top of a frame without blocking.  A bus
+ *  whose settings did not change is never touched, and no port is opened or
+ *  closed.
+ *
+ *  The format of the lines is that written by Seq66:
+ *
+\verbatim
+        [midi-clock]
+        2                                   # optional count of lines
+         0  0   "[0] 14:0 Midi Through:Midi Through Port-0"
+         1  1   "[1] 24:0 Launchpad Mini:Launchpad Mini MIDI 1"
+\endverbatim
+ *
+ *  The second number is a clocking value for an output, and 0 or 1 for an
+ *  input.  The value -2 marks a port that was not present, and is skipped.
+ *  An output line can end with "latency=<us>", the port's latency in
+ *  microseconds for busarray::compensate_latency().  Other sections,
+ *  comments, and other text after the quoted name are ignored.
+ */
+
+#include <atomic>                       /* std::atomic<bool>                */
+#include <iosfwd>                       /* std::istream forward reference   */
+#include <mutex>                        /* std::mutex                       */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/clocking.hpp"            /* midi::clocking enumeration       */
+
+namespace midi
+{
+
+class busarray;
+
+/**
+ *  The clock and input settings read from a configuration file.
+ */
+
+class busconfig
+{
+
+public:
+
+    /**
+     *  One line of a section.
+     */
+
+    class item
+    {
+    public:
+
+        int bc_bus;
+        clocking bc_clock;
+        std::string bc_name;
+        long bc_latency_us;             /**< -1 if not given.               */
+    };
+
+    /**
+     *  One setting to apply.  For an input, bc_clock is clocking::input or
+     *  clocking::disabled.  For an output, bc_latency_us is the new latency,
+     *  or -1 to leave it.
+     */
+
+    class change
+    {
+    public:
+
+        bool bc_input;
+        int bc_bus;
+        clocking bc_clock;
+        long bc_latency_us;
+    };
+
+    /**
+     *  Hands the changes from the thread that made them to the output
+     *  thread.  post() may allocate and block; apply() does neither.
+     */
+
+    class stage
+    {
+
+    private:
+
+        /**
+         *  The posted changes, guarded by m_mutex.  Clearing it keeps its
+         *  capacity, so apply() frees nothing.
+         */
+
+        std::vector<change> m_staged;
+        std::mutex m_mutex;
+
+        /**
+         *  Lets apply() check for changes without the mutex.
+         */
+
+        std::atomic<bool> m_pending;
+
+    public:
+
+        stage ();
+        stage (const stage &) = delete;
+        stage & operator = (const stage &) = delete;
+
+        void post (const std::vector<change> & changes);
+        int apply (busarray & outs, busarray & ins);
+
+        bool pending () const
+        {
+            return m_pending;
+        }
+
+    };
+
+private:
+
+    /**
+     *  The [midi-clock] and [midi-input] lines, in file order.
+     */
+
+    std::vector<item> m_clocks;
+    std::vector<item> m_inputs;
+
+public:
+
+    busconfig ();
+
+    bool parse (std::istream & in, std::string & errmsg);
+    bool parse_file (const std::string & filename, std::string & errmsg);
+    int changes
+    (
+        const busarray & outs,
+        const busarray & ins,
+        std::vector<change> & result
+    ) const;
+
+    const std::vector<item> & clocks () const
+    {
+        return m_clocks;
+    }
+
+    const std::vector<item> & inputs () const
+    {
+        return m_inputs;
+    }
+
+};          // class busconfig
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_BUSCONFIG_HPP
+
+/*
+ * busconfig.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
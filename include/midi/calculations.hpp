@@ -37,6 +37,8 @@
  *  the functions are defined in this header file, as inline code.
  */
 
+#include <cstdint>                      /* std::uint64_t                    */
+
 #include "cpp_types.hpp"                /* std::string, tokenization alias  */
 #include "midi/midibytes.hpp"           /* pulse alias and much more        */
 #include "midi/measures.hpp"            /* midi::measures class             */
@@ -819,6 +821,13 @@ extern midi::ulong bytes_to_varinum
 );
 extern midi::bytes varinum_to_bytes (midi::ulong v);
 extern int varinum_size (long len);
+extern void leb128_append (midi::bytes & b, std::uint64_t v);
+extern bool leb128_extract
+(
+    const midi::bytes & b,
+    size_t & pos,
+    std::uint64_t & v
+);
 extern std::string get_meta_event_text (const midi::bytes & bdata);
 extern bool set_meta_event_text
 (
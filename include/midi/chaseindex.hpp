@@ -0,0 +1,230 @@
+#if ! defined RTL66_MIDI_CHASEINDEX_HPP
+#define RTL66_MIDI_CHASEINDEX_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          chaseindex.hpp
+ *
+ *  This module declares the controller-chase index of an event-list.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  When the transport jumps, the program changes, control changes, pitch
+ *  bend, and tempo in effect at the new position should be sent, or the
+ *  music plays with whatever state the last position left behind.  Finding
+ *  that state by scanning from tick 0 is slow in a long song, so the index
+ *  keeps a snapshot of the state at regular tick checkpoints.  A chase then
+ *  loads the checkpoint at or before the target and scans only the events
+ *  after it.
+ *
+ *  Checkpoints are built lazily, as far as the furthest chase so far.  An
+ *  edit at a given tick invalidates only the checkpoints at or after that
+ *  tick; they are rebuilt from the last good one on the next chase.  Any
+ *  other change to the event-list (see eventlist::edit_count()) drops them
+ *  all.
+ *
+ *  The channel mode messages (CC 120 to 127) are not chased, except that a
+ *  Reset All Controllers (CC 121) forgets the controllers it resets and is
+ *  itself replayed first.  The RPN and NRPN selects are kept with their
+ *  data entry, and sent before it.
+ */
+
+#include <array>                        /* std::array<>                     */
+#include <cstdint>                      /* std::int16_t, std::uint16_t      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/event.hpp"               /* midi::event                      */
+
+namespace midi
+{
+
+class eventlist;
+
+/**
+ *  The chased state of the 16 channels, plus the tempo.  Each channel has
+ *  a slot for each of the 128 controllers, one for the program, one for
+ *  the 14-bit pitch-bend value, and one that is set if a Reset All
+ *  Controllers was seen.  A value of -1 means "never set".
+ */
+
+class chasestate
+{
+
+public:
+
+    static const int c_program_slot = 128;
+    static const int c_pitch_slot = 129;
+    static const int c_reset_slot = 130;
+    static const int c_slot_count = 131;
+    static const int c_channel_count = 16;
+
+private:
+
+    std::array<std::int16_t, c_slot_count * c_channel_count> m_values;
+    midi::bpm m_tempo;
+
+public:
+
+    chasestate ();
+
+    void clear ();
+    bool apply (const event & ev);
+
+    std::int16_t value (int channel, int slot) const
+    {
+        return m_values[channel * c_slot_count + slot];
+    }
+
+    void value (int index, std::int16_t v)
+    {
+        m_values[index] = v;
+    }
+
+    midi::bpm tempo () const
+    {
+        return m_tempo;
+    }
+
+    void tempo (midi::bpm t)
+    {
+        m_tempo = t;
+    }
+
+    std::size_t size () const
+    {
+        return m_values.size();
+    }
+
+    std::int16_t operator [] (std::size_t index) const
+    {
+        return m_values[index];
+    }
+
+    int fill_events (std::vector<event> & out, midi::pulse tick) const;
+
+private:
+
+    void reset_controllers (int channel);
+    void select_parameter (int channel, int cc);
+
+};          // class chasestate
+
+/**
+ *  The per-track checkpoint index.
+ */
+
+class chaseindex
+{
+
+private:
+
+    /**
+     *  A checkpoint holds the state in effect just before m_tick, stored
+     *  sparsely as (slot index, value) pairs, and the index of the first
+     *  event at or after m_tick.
+     */
+
+    class checkpoint
+    {
+    public:
+
+        midi::pulse c_tick;
+        int c_index;
+        midi::bpm c_tempo;
+        std::vector<std::pair<std::uint16_t, std::int16_t>> c_values;
+
+        checkpoint (midi::pulse t, int index) :
+            c_tick      (t),
+            c_index     (index),
+            c_tempo     (0.0),
+            c_values    ()
+        {
+            // no code
+        }
+    };
+
+    /**
+     *  The spacing of the checkpoints, in pulses.
+     */
+
+    midi::pulse m_interval;
+
+    /**
+     *  The checkpoints, one every m_interval pulses starting at 0, so that
+     *  the one for a tick is found by division.
+     */
+
+    std::vector<checkpoint> m_checkpoints;
+
+    /**
+     *  The eventlist::edit_count() that the checkpoints describe, set when
+     *  they are extended, and by invalidate() after an edit.  If the list
+     *  has any other count, it was changed without an invalidate() call
+     *  giving the tick of the change, and everything is rebuilt, so that a
+     *  removal or an edit in place cannot chase stale state.
+     */
+
+    std::size_t m_edit_count;
+
+public:
+
+    chaseindex (midi::pulse interval = 192 * 4 * 8);
+
+    void interval (midi::pulse p);
+
+    midi::pulse interval () const
+    {
+        return m_interval;
+    }
+
+    int checkpoint_count () const
+    {
+        return int(m_checkpoints.size());
+    }
+
+    void invalidate (const eventlist & evl, midi::pulse from = 0);
+    bool chase
+    (
+        const eventlist & evl,
+        midi::pulse tick,
+        chasestate & state
+    );
+
+private:
+
+    void extend (const eventlist & evl, midi::pulse tick);
+    void load (const checkpoint & cp, chasestate & state) const;
+    void save (const chasestate & state, checkpoint & cp) const;
+
+};          // class chaseindex
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_CHASEINDEX_HPP
+
+/*
+ * chaseindex.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,126 @@
+#if ! defined RTL66_MIDI_COLDLIST_HPP
+#define RTL66_MIDI_COLDLIST_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          coldlist.hpp
+ *
+ *  This module declares an event-list that can be packed into cold storage
+ *  while it is idle.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  The event-list is reachable only through events(), which unpacks it
+ *  first if it is cold.  So no code can operate on the empty, released
+ *  list of a cold pattern by mistake.  The const events() unpacks, too:
+ *  only the storage form changes, not the events, so the members are
+ *  mutable, and a mutex guards the change.
+ */
+
+#include <atomic>                       /* std::atomic<bool>                */
+#include <mutex>                        /* std::mutex                       */
+
+#include "midi/eventlist.hpp"           /* midi::eventlist                  */
+
+namespace midi
+{
+
+class memusage;
+
+/**
+ *  An eventlist with cold storage.
+ */
+
+class coldlist
+{
+
+private:
+
+    /**
+     *  The events, empty while cold.
+     */
+
+    mutable eventlist m_events;
+
+    /**
+     *  The packed events (see eventlist::pack()), empty while warm.
+     */
+
+    mutable midi::bytes m_packed;
+
+    /**
+     *  Indicates that the events are in m_packed.
+     */
+
+    mutable std::atomic<bool> m_is_cold;
+
+    /**
+     *  Serializes make_cold() and make_warm().
+     */
+
+    mutable std::mutex m_mutex;
+
+public:
+
+    coldlist ();
+    coldlist (const coldlist & rhs);
+    coldlist & operator = (const coldlist & rhs);
+    ~coldlist () = default;
+
+    eventlist & events ()
+    {
+        if (is_cold())
+            (void) make_warm();
+
+        return m_events;
+    }
+
+    const eventlist & events () const
+    {
+        if (is_cold())
+            (void) make_warm();
+
+        return m_events;
+    }
+
+    bool is_cold () const
+    {
+        return m_is_cold;
+    }
+
+    bool make_cold ();
+    bool make_warm () const;
+    void memory_usage (memusage & mu) const;
+
+};          // class coldlist
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_COLDLIST_HPP
+
+/*
+ * coldlist.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
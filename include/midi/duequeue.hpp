@@ -0,0 +1,256 @@
+#if ! defined RTL66_MIDI_DUEQUEUE_HPP
+#define RTL66_MIDI_DUEQUEUE_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          duequeue.hpp
+ *
+ *  This module declares a queue of items, such as patterns, ordered by the
+ *  tick at which each is next due to be played.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Most patterns have nothing to play in most frames.  Rather than sweep
+ *  every pattern on every frame, the player keeps them in a min-heap by
+ *  next-due tick, and plays only those whose tick has been reached, in the
+ *  order they were added, which is the order of the full sweep.
+ *
+ *  The queue does not know what an item is.  The caller adds the items,
+ *  all due now, after any change that could move a due tick earlier, and
+ *  gives play() a function that plays an item and returns its next due
+ *  tick, or never().
+ */
+
+#include <algorithm>                    /* std::push_heap(), std::sort()    */
+#include <limits>                       /* std::numeric_limits<>            */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/midibytes.hpp"           /* midi::pulse typedef              */
+
+namespace midi
+{
+
+/**
+ *  Counters for comparing a duequeue with a full sweep of every item on
+ *  every frame.
+ *
+ *  -   frames.  The number of frames played.
+ *  -   visits.  The number of items actually played.
+ *  -   items.  The number a full sweep would have played.
+ *  -   rebuilds.  The number of times the queue was refilled.
+ */
+
+class duestats
+{
+public:
+
+    long ds_frames;
+    long ds_visits;
+    long ds_items;
+    long ds_rebuilds;
+
+    duestats () :
+        ds_frames   (0),
+        ds_visits   (0),
+        ds_items    (0),
+        ds_rebuilds (0)
+    {
+        // no code
+    }
+};
+
+/**
+ *  The queue of items by next-due tick.
+ */
+
+template <typename T>
+class duequeue
+{
+
+private:
+
+    /**
+     *  An item, the tick of the frame at which it is next due, and its
+     *  place in a full sweep.
+     */
+
+    class entry
+    {
+    public:
+
+        midi::pulse e_due;
+        int e_order;
+        T * e_item;
+    };
+
+    /**
+     *  The min-heap of the items with a next-due tick, and a scratch list
+     *  of the items due in the current frame.  An item that is never due
+     *  is dropped until the next refill.
+     */
+
+    std::vector<entry> m_heap;
+    std::vector<entry> m_due;
+
+    /**
+     *  The number of items added since the last clear().
+     */
+
+    int m_population;
+    duestats m_stats;
+
+public:
+
+    duequeue () :
+        m_heap          (),
+        m_due           (),
+        m_population    (0),
+        m_stats         ()
+    {
+        // no code
+    }
+
+    static midi::pulse never ()
+    {
+        return std::numeric_limits<midi::pulse>::max();
+    }
+
+    /**
+     *  Empties the queue for a refill, counted as a rebuild.
+     */
+
+    void clear ()
+    {
+        m_heap.clear();
+        m_population = 0;
+        ++m_stats.ds_rebuilds;
+    }
+
+    /**
+     *  Adds an item, due at the given tick, after those already added.
+     */
+
+    void add (T & item, midi::pulse due)
+    {
+        entry e;
+        e.e_due = due;
+        e.e_order = m_population++;
+        e.e_item = &item;
+        m_heap.push_back(e);
+        std::push_heap(m_heap.begin(), m_heap.end(), later);
+    }
+
+    /**
+     *  Plays the items due by the tick, in the order they were added.  The
+     *  function is called as player(item, tick) and returns the item's next
+     *  due tick, or never() to drop it.
+     *
+     * \return
+     *      Returns the number of items played.
+     */
+
+    template <typename F>
+    int play (midi::pulse tick, F player)
+    {
+        m_due.clear();
+        while (! m_heap.empty() && m_heap.front().e_due <= tick)
+        {
+            std::pop_heap(m_heap.begin(), m_heap.end(), later);
+            m_due.push_back(m_heap.back());
+            m_heap.pop_back();
+        }
+        std::sort
+        (
+            m_due.begin(), m_due.end(),
+            [] (const entry & a, const entry & b)
+            {
+                return a.e_order < b.e_order;
+            }
+        );
+        for (auto & e : m_due)
+        {
+            e.e_due = player(*e.e_item, tick);
+            if (e.e_due != never())
+            {
+                m_heap.push_back(e);
+                std::push_heap(m_heap.begin(), m_heap.end(), later);
+            }
+        }
+
+        int result = int(m_due.size());
+        ++m_stats.ds_frames;
+        m_stats.ds_visits += result;
+        m_stats.ds_items += m_population;
+        return result;
+    }
+
+    /**
+     *  Counts a frame in which the caller swept every item itself.
+     */
+
+    void swept (int count)
+    {
+        ++m_stats.ds_frames;
+        m_stats.ds_visits += count;
+        m_stats.ds_items += count;
+    }
+
+    int population () const
+    {
+        return m_population;
+    }
+
+    int pending () const
+    {
+        return int(m_heap.size());
+    }
+
+    const duestats & stats () const
+    {
+        return m_stats;
+    }
+
+    void reset_stats ()
+    {
+        m_stats = duestats();
+    }
+
+private:
+
+    static bool later (const entry & a, const entry & b)
+    {
+        return a.e_due > b.e_due;
+    }
+
+};          // class duequeue
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_DUEQUEUE_HPP
+
+/*
+ * duequeue.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
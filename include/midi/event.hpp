@@ -28,7 +28,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2025-01-16
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This module also declares/defines the various constants, status-byte
@@ -932,6 +932,11 @@ public:
         return midi::is_midi_song_pos_msg(status());
     }
 
+    bool is_quarter_frame () const
+    {
+        return midi::is_quarter_frame_msg(status());
+    }
+
     bool has_channel () const
     {
         return midi::is_channel_msg(status());
@@ -0,0 +1,295 @@
+#if ! defined RTL66_MIDI_EVENTFEED_HPP
+#define RTL66_MIDI_EVENTFEED_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          eventfeed.hpp
+ *
+ *  This module declares the shared-memory layout of the event feed, and
+ *  the writer that publishes emitted events and transport snapshots to it.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Local observers (lighting, visualizers, loggers) can follow what is
+ *  played without subscribing to extra MIDI ports.  The feed is a POSIX
+ *  shared-memory object (shm_open()) holding a header and a ring of
+ *  fixed-size records.  The writer never waits on a reader; readers never
+ *  write to the memory, so any number of them can attach.  A slow reader
+ *  that falls a whole ring behind just loses the oldest records, and can
+ *  tell how many it lost.  See midi::feedreader.
+ *
+ *  Layout (all values native-endian, offsets in bytes):
+ *
+\verbatim
+    Header, 64 bytes at offset 0:
+
+        0   u32  magic          0x46363652 ("R66F"), stored last at setup
+        4   u16  version        1
+        6   u16  record_size    64
+        8   u32  record_count   a power of 2
+       12   u32  writer_pid
+       16   u64  next           atomic: number of records claimed so far
+       24   u64  start_ns       steady (CLOCK_MONOTONIC) time at setup
+       32   ...  reserved
+
+    Record n lives at 64 + (n % record_count) * 64:
+
+        0   u64  sequence       atomic: 2n+1 while writing, 2n+2 when done
+        8   u64  time_ns        steady (CLOCK_MONOTONIC) time of emission
+       16   i64  tick           MIDI pulse of the event or the transport
+       24   u8   kind           1 = event, 2 = transport snapshot
+       25   u8   bus            output bus index (event only)
+       26   u8   channel        channel from the sequencer (event only)
+       27   u8   length         bytes stored in data, at most 32
+       28   u32  size           full message size (longer SysEx truncated)
+       32   u8[32] data         event: the MIDI message bytes
+                                transport: f64 bpm at 32, u32 ppqn at 40,
+                                u32 flags at 44 (bit 0 running, bit 1
+                                looping), u32 beats/bar at 48, u32 beat
+                                width at 52
+\endverbatim
+ *
+ *  Records are claimed with a fetch-add on "next", so several output
+ *  threads can publish at once.  A reader checks that "sequence" is 2n+2
+ *  before and after copying record n; if not, the record is being written
+ *  or was overwritten.
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <cstddef>                      /* std::size_t                      */
+#include <cstdint>                      /* std::uint64_t, etc.              */
+#include <string>                       /* std::string                      */
+
+#include "midi/midibytes.hpp"           /* midi::byte, midi::pulse, etc.    */
+
+namespace midi
+{
+
+class event;
+
+/**
+ *  The shared-memory structures.  Plain structs whose layout is part of the
+ *  interface; see the file banner.
+ */
+
+namespace feed
+{
+
+const std::uint32_t c_magic         = 0x46363652;   /* "R66F"           */
+const std::uint16_t c_version       = 1;
+const std::uint32_t c_data_max      = 32;
+const std::uint32_t c_default_count = 4096;
+
+const std::uint8_t c_kind_event     = 1;
+const std::uint8_t c_kind_transport = 2;
+
+const std::uint32_t c_flag_running  = 0x01;
+const std::uint32_t c_flag_looping  = 0x02;
+
+struct header
+{
+    std::atomic<std::uint32_t> fh_magic;
+    std::uint16_t fh_version;
+    std::uint16_t fh_record_size;
+    std::uint32_t fh_record_count;
+    std::uint32_t fh_writer_pid;
+    std::atomic<std::uint64_t> fh_next;
+    std::uint64_t fh_start_ns;
+    std::uint8_t fh_reserved[32];
+};
+
+struct record
+{
+    std::atomic<std::uint64_t> fr_sequence;
+    std::uint64_t fr_time_ns;
+    std::int64_t fr_tick;
+    std::uint8_t fr_kind;
+    std::uint8_t fr_bus;
+    std::uint8_t fr_channel;
+    std::uint8_t fr_length;
+    std::uint32_t fr_size;
+    std::uint8_t fr_data[c_data_max];
+};
+
+static_assert(sizeof(header) == 64, "feed::header layout");
+static_assert(sizeof(record) == 64, "feed::record layout");
+static_assert
+(
+    ATOMIC_LLONG_LOCK_FREE == 2,
+    "feed needs address-free 64-bit atomics"
+);
+
+extern std::uint64_t steady_ns ();
+extern std::size_t region_size (std::uint32_t recordcount);
+
+}           // namespace feed
+
+/**
+ *  The writer side.  One per process, normally, made active by open() and
+ *  reached by the output path through an eventfeed::pin.  All publish
+ *  functions are lock-free and never block.
+ */
+
+class eventfeed
+{
+
+public:
+
+    /**
+     *  Holds the active feed, if any, for the life of the pin, so that
+     *  close() cannot unmap it while an output thread is publishing.
+     *  Costs two atomic adds.
+     *
+\verbatim
+        eventfeed::pin pinned;
+        eventfeed * ef = pinned.feed();
+        if (not_nullptr(ef))
+            ef->publish_event(bus, channel, ev);
+\endverbatim
+     */
+
+    class pin
+    {
+
+    private:
+
+        eventfeed * m_feed;
+
+    public:
+
+        pin () : m_feed (nullptr)
+        {
+            ++sm_pins;                              /* before the load      */
+            m_feed = sm_active.load();
+        }
+
+        ~pin ()
+        {
+            --sm_pins;
+        }
+
+        pin (const pin &) = delete;
+        pin & operator = (const pin &) = delete;
+
+        eventfeed * feed () const
+        {
+            return m_feed;
+        }
+
+    };
+
+private:
+
+    /**
+     *  The feed made active by open(), or null.  Output busses check this
+     *  once per event.
+     */
+
+    static std::atomic<eventfeed *> sm_active;
+
+    /**
+     *  The number of live pins.  close() clears sm_active, then waits for
+     *  this to reach zero before unmapping.
+     */
+
+    static std::atomic<int> sm_pins;
+
+    std::string m_name;
+    int m_fd;
+    void * m_region;
+    std::size_t m_region_size;
+    feed::header * m_header;
+    feed::record * m_records;
+    std::uint32_t m_mask;
+
+    /**
+     *  Minimum spacing of transport snapshots, and the time of the last.
+     */
+
+    std::uint64_t m_transport_interval_ns;
+    std::atomic<std::uint64_t> m_last_transport_ns;
+
+public:
+
+    eventfeed ();
+    eventfeed (const eventfeed &) = delete;
+    eventfeed & operator = (const eventfeed &) = delete;
+    ~eventfeed ();
+
+    /**
+     *  For checking only.  The output path must use a pin, since the feed
+     *  can be closed right after this returns.
+     */
+
+    static eventfeed * active ()
+    {
+        return sm_active.load(std::memory_order_acquire);
+    }
+
+    bool open
+    (
+        const std::string & name,
+        std::uint32_t recordcount = feed::c_default_count
+    );
+    void close ();
+
+    bool is_open () const
+    {
+        return m_header != nullptr;
+    }
+
+    const std::string & name () const
+    {
+        return m_name;
+    }
+
+    void transport_interval_ms (int ms)
+    {
+        m_transport_interval_ns = std::uint64_t(ms > 0 ? ms : 0) * 1000000;
+    }
+
+    void publish_event (int bus, midi::byte channel, const event & ev);
+    void publish_transport
+    (
+        midi::pulse tick, double bpm, int ppqn,
+        bool running, bool looping,
+        int beatsperbar = 4, int beatwidth = 4
+    );
+
+private:
+
+    feed::record & claim (std::uint64_t & number);
+    void commit (feed::record & r, std::uint64_t number);
+
+};          // class eventfeed
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_EVENTFEED_HPP
+
+/*
+ * eventfeed.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
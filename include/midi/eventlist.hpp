@@ -28,7 +28,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2015-09-19
- * \updates       2025-01-16
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This module extracts the event-list functionality from the sequencer
@@ -69,8 +69,11 @@
 #undef   RTL66_USE_FILL_TIME_SIG_AND_TEMPO
 
 #include <atomic>                       /* std::atomic<bool> usage          */
+#include <unordered_map>                /* std::unordered_map<>             */
+#include <vector>                       /* std::vector<>                    */
 
 #include "midi/event.hpp"               /* midi::event, midi::event::buffer */
+#include "midi/memusage.hpp"            /* midi::memusage accounting        */
 #include "midi/trackinfo.hpp"           /* data holders for MIDI parameters */
 
 namespace midi
@@ -82,6 +85,7 @@ namespace midi
 
 class eventlist
 {
+    friend class coldlist;              // access to verify_and_link()
     friend class editable_events;       // access to verify_and_link()
     friend class midifile;              // access to print()
     friend class track;                 // any_selected_notes()
@@ -150,6 +154,66 @@ private:
     bool m_match_iterating;
     event::iterator m_match_iterator;
 
+    /**
+     *  The fields compared by event::match(): the timestamp, the status, the
+     *  channel, and (except for Meta events) the first data byte.
+     */
+
+    class match_key
+    {
+    public:
+
+        midi::pulse k_timestamp;
+        midi::byte k_status;
+        midi::byte k_channel;
+        midi::byte k_d0;
+
+        match_key (const event & e);
+
+        bool operator == (const match_key & rhs) const
+        {
+            return k_timestamp == rhs.k_timestamp &&
+                k_status == rhs.k_status && k_channel == rhs.k_channel &&
+                k_d0 == rhs.k_d0;
+        }
+    };
+
+    class match_hash
+    {
+    public:
+
+        std::size_t operator () (const match_key & k) const;
+    };
+
+    /**
+     *  An optional index of the events by match_key, giving the positions
+     *  (in ascending order) of the events with each key.  It makes the
+     *  find/remove-match functions O(1) instead of a scan of the list.  It
+     *  is kept up to date by append() and remove(), and is rebuilt on the
+     *  next lookup after anything that reorders or edits the events in
+     *  place (sort() in particular).  Code that changes events through the
+     *  iterators must call invalidate_match_index().
+     */
+
+    using match_positions = std::unordered_map
+    <
+        match_key, std::vector<std::size_t>, match_hash
+    >;
+
+    bool m_match_indexing;
+    bool m_match_index_valid;
+    match_positions m_match_index;
+
+    /**
+     *  The positions in the index are those the events had when the index
+     *  was built.  A remove() does not renumber them; it records the old
+     *  position here (in ascending order), and a position is mapped to the
+     *  list by subtracting the tombstones below it.  When there are too
+     *  many, the index is dropped and rebuilt on the next lookup.
+     */
+
+    std::vector<std::size_t> m_match_tombstones;
+
     /**
      *  Provides an atomic flag to raise while sorting(), which can invalidate
      *  iterators while a user-interface is accessing the event list, or while
@@ -192,6 +256,17 @@ private:
 
     bool m_is_modified;
 
+    /**
+     *  Counts the changes made to the events: additions, removals, sorts,
+     *  and edits in place.  Unlike m_is_modified, it is never reset, so a
+     *  cache built from the events (such as the chaseindex) can tell that
+     *  it is stale by comparing the count it was built at.  Code that
+     *  edits events through the iterators bumps it by calling
+     *  invalidate_match_index().
+     */
+
+    std::size_t m_edit_count;
+
     /**
      *  A new flag to indicate that a tempo event has been added.  Legacy
      *  behavior forces the tempo to be written to the track-0 sequence,
@@ -300,6 +375,11 @@ public:
         return m_is_modified;
     }
 
+    std::size_t edit_count () const
+    {
+        return m_edit_count;
+    }
+
     bool has_tempo () const
     {
         return m_has_tempo;
@@ -341,20 +421,68 @@ public:
 
     event::iterator remove (event::iterator ie)
     {
+        if (m_match_index_valid)
+            unindex_match(std::size_t(ie - m_events.begin()));
+
         event::iterator result = m_events.erase(ie);
         m_is_modified = true;
+        ++m_edit_count;
         return result;
     }
 
     void clear ();
+    void release ();
     void sort ();
     bool merge (const eventlist & el, bool presort = true);
+    void memory_usage (memusage & mu) const;
+    void pack (midi::bytes & destination) const;
+    bool unpack (const midi::bytes & source);
 
     bool action_in_progress () const
     {
         return m_action_in_progress;
     }
 
+    /**
+     *  Turns the match index on or off.  It costs a hash entry per event, so
+     *  it is off by default; turn it on for lists that see many lookups,
+     *  such as while recording or in an editor.
+     */
+
+    void match_indexing (bool flag)
+    {
+        m_match_indexing = flag;
+        invalidate_match_index();
+    }
+
+    bool match_indexing () const
+    {
+        return m_match_indexing;
+    }
+
+    void invalidate_match_index ()
+    {
+        m_match_index_valid = false;
+        m_match_index.clear();
+        m_match_tombstones.clear();
+        ++m_edit_count;
+    }
+
+    event::iterator find_first_match
+    (
+        const event & e,
+        midi::pulse starttick = 0
+    );
+    event::iterator find_next_match (const event & e);
+    bool remove_first_match
+    (
+        const event & e,
+        midi::pulse starttick = 0
+    );
+    bool remove_event (event & e);
+    bool remove_marked ();
+    bool remove_selected ();
+
     /**
      *  Dereference access for list or map.
      *
@@ -383,6 +511,11 @@ private:                                /* internal quantization functions  */
 
     bool add (event::buffer & evlist, const event & e);
     void merge (const event::buffer & evlist);
+    void index_matches ();
+    void unindex_match (std::size_t pos);
+    std::size_t match_position (std::size_t indexpos) const;
+    event::iterator indexed_match (const event & e, std::size_t from);
+    bool remove_flagged (bool selected);
 
 private:                                /* functions for friend sequence    */
 
@@ -439,21 +572,7 @@ private:                                /* functions for friend sequence    */
     void mark_all ();
     void unmark_all ();
 #endif
-    bool remove_event (event & e);
-    event::iterator find_first_match
-    (
-        const event & e,
-        midi::pulse starttick = 0
-    );
-    event::iterator find_next_match (const event & e);
-    bool remove_first_match
-    (
-        const event & e,
-        midi::pulse starttick = 0
-    );
-    bool remove_marked ();                  /* deprecated   */
     bool remove_trailing_events (midi::pulse limit);
-    bool remove_selected ();
 #if defined RTL66_SUPPORT_PAINTED_EVENTS
     void unpaint_all ();
 #endif
@@ -0,0 +1,151 @@
+#if ! defined RTL66_MIDI_FEEDREADER_HPP
+#define RTL66_MIDI_FEEDREADER_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          feedreader.hpp
+ *
+ *  This module declares the reader side of the shared-memory event feed.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  The reader maps the feed read-only and copies records out one at a
+ *  time.  It does not depend on the rest of the library beyond the layout
+ *  in eventfeed.hpp, so an observer can be built against just these two
+ *  modules.  See tests/midi/feedtest.cpp for an example.
+ */
+
+#include <cstdint>                      /* std::uint64_t, etc.              */
+#include <string>                       /* std::string                      */
+
+#include "midi/eventfeed.hpp"           /* midi::feed layout structures     */
+
+namespace midi
+{
+
+/**
+ *  A copy of one feed record, decoded.
+ */
+
+struct feedrecord
+{
+    std::uint64_t number;               /**< Record number in the feed.     */
+    std::uint64_t time_ns;              /**< Steady time of emission.       */
+    std::int64_t tick;                  /**< MIDI pulse.                    */
+    std::uint8_t kind;                  /**< feed::c_kind_event, etc.       */
+    std::uint8_t bus;                   /**< Output bus (events).           */
+    std::uint8_t channel;               /**< Channel (events).              */
+    std::uint8_t length;                /**< Bytes in data.                 */
+    std::uint32_t size;                 /**< Full message size.             */
+    std::uint8_t data[feed::c_data_max];
+    double bpm;                         /**< Transport: tempo.              */
+    std::uint32_t ppqn;                 /**< Transport: resolution.         */
+    std::uint32_t flags;                /**< Transport: running, looping.   */
+    std::uint32_t beats_per_bar;        /**< Transport: time signature.     */
+    std::uint32_t beat_width;           /**< Transport: time signature.     */
+
+    bool is_event () const
+    {
+        return kind == feed::c_kind_event;
+    }
+
+    bool is_transport () const
+    {
+        return kind == feed::c_kind_transport;
+    }
+};
+
+/**
+ *  Follows a feed.  Not thread-safe; use one reader per thread.
+ */
+
+class feedreader
+{
+
+public:
+
+    /**
+     *  The results of next().
+     */
+
+    enum class status
+    {
+        ok,                             /**< A record was copied.           */
+        empty,                          /**< Nothing new yet.               */
+        closed                          /**< The feed is not open.          */
+    };
+
+private:
+
+    int m_fd;
+    const void * m_region;
+    std::size_t m_region_size;
+    const feed::header * m_header;
+    const feed::record * m_records;
+    std::uint32_t m_count;
+    std::uint64_t m_next;
+    std::uint64_t m_dropped;
+
+public:
+
+    feedreader ();
+    feedreader (const feedreader &) = delete;
+    feedreader & operator = (const feedreader &) = delete;
+    ~feedreader ();
+
+    bool open (const std::string & name, bool fromstart = false);
+    void close ();
+
+    bool is_open () const
+    {
+        return m_header != nullptr;
+    }
+
+    /**
+     *  The number of records skipped because the writer lapped this reader.
+     */
+
+    std::uint64_t dropped () const
+    {
+        return m_dropped;
+    }
+
+    std::uint32_t writer_pid () const
+    {
+        return is_open() ? m_header->fh_writer_pid : 0 ;
+    }
+
+    status next (feedrecord & rec);
+
+};          // class feedreader
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_FEEDREADER_HPP
+
+/*
+ * feedreader.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
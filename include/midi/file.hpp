@@ -27,12 +27,14 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2025-01-16
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This version is very basic, and does not include any Seq66 features.
  */
 
+#include <vector>                       /* std::vector<track *> for write() */
+
 #include "midi/splitter.hpp"            /* midi::splitter SMF 0 converter   */
 #include "midi/track.hpp"               /* midi::track raw midi container   */
 #include "midi/tracklist.hpp"           /* midi::tracklist vector of tracks */
@@ -131,6 +133,34 @@ private:
 
     bool m_smf0_split;
 
+    /**
+     *  The number of worker threads used by write() to convert the tracks
+     *  to raw MIDI bytes. Each track is filled into its own buffer, so
+     *  the fills are independent; the MTrk chunks are then streamed to the
+     *  file data in track order, so the output does not depend on this
+     *  value.  A value of 0 means to use the number of CPUs, and 1 means
+     *  to fill the tracks serially, in the calling thread.
+     */
+
+    int m_fill_jobs;
+
+    /**
+     *  If true, parse() defers the decoding of each track's events until the
+     *  track is first used, and starts the player's background prefetch.
+     *  Only the track settings are read up front.  Not done for an SMF 0
+     *  file that is to be split, since the split needs the events.  The
+     *  default comes from player::lazy_decode().
+     */
+
+    bool m_lazy_decode;
+
+    /**
+     *  The size optimizations used by write().  All are off by default, so
+     *  that a file is written byte for byte as before.  See smfpacking.
+     */
+
+    smfpacking m_packing;
+
 public:
 
     file () = delete;
@@ -192,6 +222,37 @@ public:
         return m_smf0_split;
     }
 
+    int fill_jobs () const
+    {
+        return m_fill_jobs;
+    }
+
+    void fill_jobs (int jobs)
+    {
+        if (jobs >= 0)
+            m_fill_jobs = jobs;
+    }
+
+    bool lazy_decode () const
+    {
+        return m_lazy_decode;
+    }
+
+    void lazy_decode (bool flag)
+    {
+        m_lazy_decode = flag;
+    }
+
+    const smfpacking & packing () const
+    {
+        return m_packing;
+    }
+
+    void packing (const smfpacking & sp)
+    {
+        m_packing = sp;
+    }
+
 protected:
 
     virtual track * create_track ();
@@ -283,6 +344,9 @@ protected:
 
     bool put_track (/*const*/ midi::track & lst);
     bool put_track_events (/*const*/ midi::track & lst);
+    bool fill_track (midi::track & trk, bool eventsonly);
+    bool fill_tracks (std::vector<track *> & tracks, bool eventsonly);
+    void put_track_data (midi::track & trk);
     bool put_header (int numtracks, int smfformat = 1);
 
     bool set_error (const std::string & msg) const
@@ -0,0 +1,162 @@
+#if ! defined RTL66_MIDI_INPUTLOG_HPP
+#define RTL66_MIDI_INPUTLOG_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          inputlog.hpp
+ *
+ *  This module declares the capture and replay of MIDI input sessions.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Problems in the handling of input (controllers, recording) usually need
+ *  the controller in hand to reproduce.  An inputlog records each input
+ *  event, with the time it arrived and its input bus, to a small file.  The
+ *  file can then be fed back through the normal input path, at the original
+ *  timing or as fast as possible, and a replaystats object measures how
+ *  late and how long each event took.
+ *
+ *  File format: the four bytes "R66I", a version byte (1), then one record
+ *  per event:
+ *
+\verbatim
+        varint  microseconds since the previous record (since start for
+                the first)
+        u8      input bus
+        varint  message length
+        u8[]    message bytes
+\endverbatim
+ *
+ *  The varints are little-endian base-128, as in eventlist::pack().
+ */
+
+#include <atomic>                       /* std::atomic<bool>                */
+#include <cstdint>                      /* std::uint64_t                    */
+#include <cstdio>                       /* std::FILE                        */
+#include <mutex>                        /* std::mutex                       */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/midibytes.hpp"           /* midi::bytes, midi::bussbyte      */
+
+namespace midi
+{
+
+class event;
+
+/**
+ *  Writes or reads an input-session file.
+ */
+
+class inputlog
+{
+
+private:
+
+    std::FILE * m_file;
+    std::atomic<bool> m_capturing;
+    bool m_replaying;
+    std::uint64_t m_start_us;
+    std::uint64_t m_last_us;
+    std::uint64_t m_count;
+    midi::bytes m_buffer;
+    std::mutex m_mutex;
+
+public:
+
+    inputlog ();
+    inputlog (const inputlog &) = delete;
+    inputlog & operator = (const inputlog &) = delete;
+    ~inputlog ();
+
+    static std::uint64_t now_us ();
+
+    bool open_for_capture (const std::string & filename);
+    bool open_for_replay (const std::string & filename);
+    void close ();
+
+    bool capturing () const
+    {
+        return m_capturing.load(std::memory_order_acquire);
+    }
+
+    bool replaying () const
+    {
+        return m_replaying;
+    }
+
+    std::uint64_t count () const
+    {
+        return m_count;
+    }
+
+    bool capture (const event & ev);
+    bool next (event & ev, std::uint64_t & time_us);
+
+};          // class inputlog
+
+/**
+ *  Collects the timing of a replay.  Lateness is how far after its
+ *  scheduled time an event was dispatched (always 0 when replaying as
+ *  fast as possible).  Service time is how long the input path took to
+ *  handle it.
+ */
+
+class replaystats
+{
+
+private:
+
+    std::vector<std::uint64_t> m_lateness_us;
+    std::vector<std::uint64_t> m_service_us;
+    std::uint64_t m_start_us;
+    std::uint64_t m_end_us;
+
+public:
+
+    replaystats ();
+
+    void start ();
+    void finish ();
+    void add (std::uint64_t lateness_us, std::uint64_t service_us);
+
+    std::size_t count () const
+    {
+        return m_service_us.size();
+    }
+
+    double events_per_second () const;
+    std::string report () const;
+
+};          // class replaystats
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_INPUTLOG_HPP
+
+/*
+ * inputlog.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -27,7 +27,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2016-11-23
- * \updates       2024-06-09
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  The masterbus module is the base-class version of the mastermidi::bus
@@ -87,8 +87,10 @@
 #include "rtl/rtl_build_macros.h"       /* RTL_DEFAULT_PPQN, _DEFAULT_BPM   */
 #include "rtl/rt_types.hpp"             /* rtl::rtmidi::api enum class      */
 #include "midi/busarray.hpp"            /* midi::busarray a la Seq66        */
+#include "midi/busconfig.hpp"           /* midi::busconfig reloadable setup */
 #include "midi/clientinfo.hpp"          /* midi::clientinfo a la Seq66      */
 #include "midi/clocking.hpp"            /* midi::clock::action enumertion   */
+#include "midi/portwatch.hpp"           /* midi::portwatch change queue     */
 #include "rtl/midi/rtmidi_engine.hpp"   /* rtl::rtmidi_engine class         */
 #include "xpc/recmutex.hpp"             /* xpc::recmutex                    */
 
@@ -156,6 +158,20 @@ private:
 
     mutable xpc::recmutex m_mutex;
 
+    /**
+     *  The ports that have come and gone, as posted by the API callbacks,
+     *  waiting for process_port_changes().
+     */
+
+    portwatch m_port_watch;
+
+    /**
+     *  The clock and input changes from a reloaded configuration, waiting
+     *  for the output thread to call apply_configuration().
+     */
+
+    busconfig::stage m_config_stage;
+
     /**
      *  The "global" client handle, stored here so we do not recreate it every
      *  time.
@@ -216,6 +232,16 @@ public:
         // No other code needed
     }
 
+    /**
+     *  The client name of the engine.  Also given to rtl::find_midi_api(),
+     *  so that the engine can adopt the client opened by the API probe.
+     */
+
+    static std::string engine_client_name ()
+    {
+        return std::string("mbus");
+    }
+
     rtl::rtmidi::api selected_api () const
     {
         return m_selected_api;
@@ -263,6 +289,53 @@ public:
         return m_inbus_array.count();
     }
 
+    /**
+     *  Optional per-bus output workers; see busarray::async_output().
+     */
+
+    bool async_output (bool flag, std::size_t capacity = 1024);
+
+    bool async_output () const
+    {
+        return m_outbus_array.async_output();
+    }
+
+    outworker::statistics output_stats (midi::bussbyte bus) const
+    {
+        return m_outbus_array.output_stats(bus);
+    }
+
+    /**
+     *  Output latency compensation; see busarray::compensate_latency().
+     */
+
+    bool compensate_latency (bool flag);
+
+    bool compensate_latency () const
+    {
+        return m_outbus_array.compensate_latency();
+    }
+
+    void output_latency (midi::bussbyte bus, long us)
+    {
+        m_outbus_array.latency(bus, us);
+    }
+
+    long output_latency (midi::bussbyte bus) const
+    {
+        return m_outbus_array.latency(bus);
+    }
+
+    long output_compensation (midi::bussbyte bus) const
+    {
+        return m_outbus_array.compensation(bus);
+    }
+
+    int query_output_latencies ()
+    {
+        return m_outbus_array.query_latencies();
+    }
+
     void client_handle (void * clienthandle)
     {
         m_client_handle = clienthandle;
@@ -333,6 +406,53 @@ public:     // used in a test application
     );
     virtual bool engine_query ();
 
+public:     // port hot-plugging, called from the API callbacks
+
+    virtual bool port_start
+    (
+        int client, int port,
+        const std::string & name = "",
+        const std::string & alias = ""
+    );
+    virtual bool port_exit
+    (
+        int client, int port,
+        const std::string & name = "",
+        const std::string & alias = ""
+    );
+    int process_port_changes ();
+
+    portwatch & port_watch ()
+    {
+        return m_port_watch;
+    }
+
+public:     // configuration reload, see busconfig
+
+    int stage_configuration (const busconfig & cfg);
+    bool reload_configuration
+    (
+        const std::string & filename, std::string & errmsg
+    );
+    int apply_configuration ();
+
+    bool configuration_pending () const
+    {
+        return m_config_stage.pending();
+    }
+
+protected:  // for derived masters, e.g. in tests
+
+    busarray & output_busses ()
+    {
+        return m_outbus_array;
+    }
+
+    busarray & input_busses ()
+    {
+        return m_inbus_array;
+    }
+
 protected:  // API pass-alongs
 
     virtual bool engine_activate ();
@@ -370,8 +490,6 @@ protected:  // API implementations
         midi::bussbyte bus, midi::port::io iotype
     ) const;
     virtual int poll_for_midi () const;
-    virtual bool port_start (int client, int port);     // TODO
-    virtual bool port_exit (int client, int port);      // TODO
     virtual bool set_track_input (bool state, track * trk);
     virtual void dump_midi_input (event ev);
 
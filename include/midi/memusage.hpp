@@ -0,0 +1,188 @@
+#if ! defined RTL66_MIDI_MEMUSAGE_HPP
+#define RTL66_MIDI_MEMUSAGE_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          memusage.hpp
+ *
+ *  This module declares a small class for accumulating the memory held by
+ *  tracks, patterns, sets, and the player.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  The numbers are estimates based on container capacities and the sizes
+ *  of the stored objects.  Allocator overhead is not included.  No copies
+ *  of any containers are made while counting, so the accounting is cheap
+ *  enough to be polled periodically by a user-interface or a status dump.
+ */
+
+#include <cstddef>                      /* std::size_t                      */
+#include <string>                       /* std::string                      */
+
+namespace midi
+{
+
+/**
+ *  Holds byte and item counts for the major memory consumers.
+ *
+ *  -   Events.  The event vectors themselves, sizeof(event) * capacity.
+ *  -   Payload.  The heap buffers of the midi::message in each event.
+ *  -   Undo.  The undo/redo copies of event-lists and trigger lists.
+ *  -   Triggers.  The live trigger lists of the patterns.
+ *  -   Cold.  The packed event-lists of patterns in cold storage.
+ *  -   Other.  Clipboards, playlists, and other ancillary storage.
+ */
+
+class memusage
+{
+
+private:
+
+    std::size_t m_event_count;
+    std::size_t m_event_bytes;
+    std::size_t m_payload_bytes;
+    std::size_t m_undo_count;
+    std::size_t m_undo_bytes;
+    std::size_t m_trigger_count;
+    std::size_t m_trigger_bytes;
+    std::size_t m_cold_count;
+    std::size_t m_cold_bytes;
+    std::size_t m_other_bytes;
+
+public:
+
+    memusage ();
+    memusage (const memusage &) = default;
+    memusage (memusage &&) = default;
+    memusage & operator = (const memusage &) = default;
+    memusage & operator = (memusage &&) = default;
+    ~memusage () = default;
+
+    memusage & operator += (const memusage & rhs);
+
+    void clear ()
+    {
+        *this = memusage();
+    }
+
+    std::size_t event_count () const
+    {
+        return m_event_count;
+    }
+
+    std::size_t event_bytes () const
+    {
+        return m_event_bytes;
+    }
+
+    std::size_t payload_bytes () const
+    {
+        return m_payload_bytes;
+    }
+
+    std::size_t undo_count () const
+    {
+        return m_undo_count;
+    }
+
+    std::size_t undo_bytes () const
+    {
+        return m_undo_bytes;
+    }
+
+    std::size_t trigger_count () const
+    {
+        return m_trigger_count;
+    }
+
+    std::size_t trigger_bytes () const
+    {
+        return m_trigger_bytes;
+    }
+
+    std::size_t cold_count () const
+    {
+        return m_cold_count;
+    }
+
+    std::size_t cold_bytes () const
+    {
+        return m_cold_bytes;
+    }
+
+    std::size_t other_bytes () const
+    {
+        return m_other_bytes;
+    }
+
+    std::size_t total_bytes () const
+    {
+        return m_event_bytes + m_payload_bytes + m_undo_bytes +
+            m_trigger_bytes + m_cold_bytes + m_other_bytes;
+    }
+
+    void add_events (std::size_t count, std::size_t bytes, std::size_t payload)
+    {
+        m_event_count += count;
+        m_event_bytes += bytes;
+        m_payload_bytes += payload;
+    }
+
+    void add_undo (std::size_t count, std::size_t bytes)
+    {
+        m_undo_count += count;
+        m_undo_bytes += bytes;
+    }
+
+    void add_triggers (std::size_t count, std::size_t bytes)
+    {
+        m_trigger_count += count;
+        m_trigger_bytes += bytes;
+    }
+
+    void add_cold (std::size_t bytes)
+    {
+        ++m_cold_count;
+        m_cold_bytes += bytes;
+    }
+
+    void add_other (std::size_t bytes)
+    {
+        m_other_bytes += bytes;
+    }
+
+    void add_as_undo (const memusage & mu);
+    std::string to_string (const std::string & tag = "") const;
+
+};          // class memusage
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_MEMUSAGE_HPP
+
+/*
+ * memusage.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,141 @@
+#if ! defined RTL66_MIDI_NOTETRACKER_HPP
+#define RTL66_MIDI_NOTETRACKER_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          notetracker.hpp
+ *
+ *  This module declares a per-channel record of the notes that are sounding.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  A pattern used to count sounding notes by note number only.  With
+ *  free-channel patterns (or a channel remap) the same note can sound on
+ *  several channels at once, and a Note Off on one channel would "cancel"
+ *  the Note On of another, while the all-notes-off sent every note on the
+ *  pattern channel, leaving the others hanging.
+ *
+ *  Here each (channel, note) pair has its own count, plus a bit in a
+ *  128-bit set per channel and a 16-bit mask of the channels in use, so that
+ *  releasing the notes visits only those that are sounding.
+ */
+
+#include <array>                        /* std::array<>                     */
+#include <cstdint>                      /* std::uint8_t, std::uint64_t      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/midibytes.hpp"           /* midi::byte, c_notes_count, etc.  */
+
+namespace midi
+{
+
+class event;
+
+/**
+ *  The 16 x 128 table of sounding notes.
+ */
+
+class notetracker
+{
+
+private:
+
+    /**
+     *  Two 64-bit words per channel.  Bit n is set while note n has any
+     *  unmatched Note Ons on that channel.
+     */
+
+    std::array<std::uint64_t, c_channel_max * 2> m_bits;
+
+    /**
+     *  The unmatched Note On count of each pair.  Saturates at 255, which
+     *  no sane pattern reaches.
+     */
+
+    std::array<std::uint8_t, c_channel_max * c_notes_count> m_counts;
+
+    /**
+     *  Bit c is set while channel c has sounding notes.
+     */
+
+    unsigned m_channel_mask;
+
+    /**
+     *  The total of all counts.
+     */
+
+    int m_sounding;
+
+public:
+
+    notetracker ();
+
+    void clear ();
+    void note_on (midi::byte channel, midi::byte note);
+    bool note_off (midi::byte channel, midi::byte note);
+    int release
+    (
+        std::vector<event> & offs,
+        midi::pulse tick = 0,
+        midi::byte velocity = 0
+    );
+
+    int count (midi::byte channel, midi::byte note) const
+    {
+        return int(m_counts[slot(channel, note)]);
+    }
+
+    bool sounding (midi::byte channel, midi::byte note) const
+    {
+        return count(channel, note) > 0;
+    }
+
+    int sounding () const
+    {
+        return m_sounding;
+    }
+
+    bool any () const
+    {
+        return m_channel_mask != 0;
+    }
+
+private:
+
+    static int slot (midi::byte channel, midi::byte note)
+    {
+        return int(channel & 0x0F) * c_notes_count + int(note & 0x7F);
+    }
+
+};          // class notetracker
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_NOTETRACKER_HPP
+
+/*
+ * notetracker.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
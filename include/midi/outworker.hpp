@@ -0,0 +1,269 @@
+#if ! defined RTL66_MIDI_OUTWORKER_HPP
+#define RTL66_MIDI_OUTWORKER_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          outworker.hpp
+ *
+ *  This module declares a per-bus output worker: a bounded queue and a
+ *  thread that drains it into one output bus.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Normally the output thread calls each bus's send_event() directly, so a
+ *  driver call that blocks (e.g. an ALSA drain on a congested USB device)
+ *  delays every other bus.  With asynchronous output enabled in the
+ *  busarray, the output thread only posts to a queue per bus, and each
+ *  queue has its own sender thread.  A misbehaving port then only delays
+ *  itself.
+ *
+ *  The queue is single-producer (the output thread) and single-consumer
+ *  (the worker).  Its slots, including their event buffers, are allocated
+ *  up front, so posting does not allocate once the slots have held an event
+ *  of the same size.  A full queue drops the new item and counts it.
+ *
+ *  A worker can also hold each item back by a fixed delay, measured from
+ *  the time it was posted.  The busarray uses this for latency
+ *  compensation: the ports that reach their devices soonest are delayed so
+ *  that all ports sound together.
+ *
+ *  The worker can be paused, so that another thread can re-open the bus's
+ *  port (see bus::rebind()) knowing that the worker is not inside the bus.
+ *  Items posted meanwhile wait in the queue.
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <condition_variable>           /* std::condition_variable          */
+#include <cstdint>                      /* std::uint64_t, std::int64_t      */
+#include <mutex>                        /* std::mutex                       */
+#include <thread>                       /* std::thread                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/event.hpp"               /* midi::event                      */
+
+namespace midi
+{
+
+class bus;
+
+/**
+ *  One output queue and its sender thread.
+ */
+
+class outworker
+{
+
+public:
+
+    /**
+     *  The operations that can be queued.  Clock messages go through the
+     *  queue too, so that they stay in order with the events and so that
+     *  the bus is only ever driven by one thread.
+     */
+
+    enum class action
+    {
+        event,
+        sysex,
+        clock_start,
+        clock_stop,
+        clock_continue,
+        init_clock
+    };
+
+    /**
+     *  A snapshot of the queue statistics.
+     */
+
+    class statistics
+    {
+    public:
+
+        std::uint64_t posted;           /**< Items accepted into queue.     */
+        std::uint64_t sent;             /**< Items handed to the bus.       */
+        std::uint64_t failed;           /**< Sends the bus reported failed. */
+        std::uint64_t dropped;          /**< Items refused, queue full.     */
+        std::size_t backlog;            /**< Items waiting right now.       */
+        std::size_t max_backlog;        /**< Highest backlog seen.          */
+
+        statistics () :
+            posted      (0),
+            sent        (0),
+            failed      (0),
+            dropped     (0),
+            backlog     (0),
+            max_backlog (0)
+        {
+            // no code
+        }
+    };
+
+private:
+
+    /**
+     *  A queue slot.  The event is copied in; its message buffer keeps its
+     *  capacity from one use of the slot to the next.
+     */
+
+    class item
+    {
+    public:
+
+        action i_action;
+        pulse i_tick;
+        byte i_channel;
+        std::int64_t i_due;             /**< Steady-clock us, 0 = now.      */
+        event i_event;
+
+        item () :
+            i_action    (action::event),
+            i_tick      (0),
+            i_channel   (0),
+            i_due       (0),
+            i_event     ()
+        {
+            // no code
+        }
+    };
+
+    /**
+     *  The bus that the worker drives.  Not owned.
+     */
+
+    bus & m_bus;
+
+    /**
+     *  The ring of slots.  The size is a power of 2.
+     */
+
+    std::vector<item> m_ring;
+
+    /**
+     *  The ring size less one, for masking the indices.
+     */
+
+    std::size_t m_mask;
+
+    /**
+     *  The time each item is held back before it is sent, in microseconds.
+     *  Zero (the usual case) sends as soon as possible.
+     */
+
+    std::atomic<long> m_delay_us;
+
+    /**
+     *  The number of items posted and taken.  The producer writes m_head,
+     *  the worker writes m_tail; each only reads the other.
+     */
+
+    std::atomic<std::size_t> m_head;
+    std::atomic<std::size_t> m_tail;
+
+    /**
+     *  Statistics counters, written by one thread each.
+     */
+
+    std::atomic<std::uint64_t> m_sent;
+    std::atomic<std::uint64_t> m_failed;
+    std::atomic<std::uint64_t> m_dropped;
+    std::atomic<std::size_t> m_max_backlog;
+
+    /**
+     *  Sleep/wake handling for the worker.  The producer only takes the
+     *  mutex when the worker has said that it is going to sleep.
+     */
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::atomic<bool> m_sleeping;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+
+    /**
+     *  Pause handling.  m_paused is set by pause(); the worker, between
+     *  items, sets m_parked and waits on m_wakeup until resume().  Both are
+     *  changed with m_mutex held; m_parked_cond tells pause() the worker
+     *  has parked.
+     */
+
+    std::atomic<bool> m_paused;
+    bool m_parked;
+    std::condition_variable m_parked_cond;
+
+public:
+
+    outworker (bus & b, std::size_t capacity = 1024);
+    outworker (const outworker &) = delete;
+    outworker & operator = (const outworker &) = delete;
+    ~outworker ();
+
+    bool start ();
+    void stop ();
+    void pause ();
+    void resume ();
+
+    bool running () const
+    {
+        return m_running;
+    }
+
+    void delay_us (long us)
+    {
+        m_delay_us = us > 0 ? us : 0 ;
+    }
+
+    long delay_us () const
+    {
+        return m_delay_us;
+    }
+
+    bool post (action a, const event * ev = nullptr, byte channel = 0);
+    bool post_clock (action a, pulse tick);
+    statistics stats () const;
+
+    std::size_t backlog () const
+    {
+        return m_head.load(std::memory_order_acquire) -
+            m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+
+    item * claim ();
+    static std::int64_t now_us ();
+    void publish ();
+    void worker ();
+    void dispatch (const item & it);
+
+};          // class outworker
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_OUTWORKER_HPP
+
+/*
+ * outworker.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -28,7 +28,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2022-07-10
- * \updates       2024-06-01
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  The player class is a severely cut-down version of seq66::performer, with
@@ -65,18 +65,24 @@
  *  It will be a base class for the new version of performer.
  */
 
+#include <atomic>                           /* std::atomic<bool>            */
 #include <functional>                       /* std::function<void(int)>     */
 #include <memory>                           /* std::unique_ptr<>            */
+#include <mutex>                            /* std::mutex                   */
 #include <thread>                           /* std::thread                  */
 
 #include "xpc/condition.hpp"                /* xpc::condition/synchronizer  */
+#include "midi/eventfeed.hpp"               /* midi::eventfeed class        */
+#include "midi/inputlog.hpp"                /* midi::inputlog capture file  */
 #include "midi/masterbus.hpp"               /* access to all MIDI busses    */
 #include "midi/ports.hpp"                   /* access to MIDI ports         */
 #include "midi/tracklist.hpp"               /* provides a set of tracks     */
 #include "rtl/iothread.hpp"                 /* rtl::iothread class          */
 #include "transport/jack/scratchpad.hpp"    /* transport::jack::scratchpad  */
 #include "transport/jack/transport.hpp"     /* transport::jack::transport   */
+#include "transport/clock/frameclock.hpp"   /* transport::clock::frameclock */
 #include "transport/clock/info.hpp"         /* transport::clock::info       */
+#include "transport/clock/mtc.hpp"          /* transport::clock::mtc_xxx    */
 
 namespace midi
 {
@@ -227,6 +233,33 @@ private:
 
     bool m_sort_on_install;
 
+    /**
+     *  If true (the default is false), MIDI files are loaded with deferred
+     *  decoding: each track keeps its raw bytes, and its events are decoded
+     *  when first needed.  See track::decode_deferred() and
+     *  prefetch_tracks().
+     */
+
+    bool m_lazy_decode;
+
+    /**
+     *  The thread that decodes deferred tracks in the background after a
+     *  lazy load, and the flag that stops it early.
+     */
+
+    std::thread m_prefetch_thread;
+    std::atomic<bool> m_prefetch_stop;
+
+    /**
+     *  The thread that reads a configuration file for
+     *  reload_configuration(), and its outcome, which is read only after
+     *  the thread is joined.
+     */
+
+    std::thread m_reload_thread;
+    std::string m_reload_error;
+    bool m_reload_ok;
+
     /**
      *  Indicates the format of this file, either SMF 0 or SMF 1.
      *  Note that Seq66 always converts files from SMF 0 to SMF 1,
@@ -298,6 +331,29 @@ private:                            /* key, midi, and op container section  */
 
     bool m_dont_reset_ticks;
 
+    /**
+     *  Set when the JACK transport has been moved to the left marker for
+     *  the current loop wrap, so that it is moved only once per wrap.
+     */
+
+    bool m_loop_jack_positioned;
+
+    /**
+     *  What to do with the notes still sounding when looping wraps from R
+     *  back to L.  See track::wrapnotes.
+     */
+
+    track::wrapnotes m_loop_notes;
+
+    /**
+     *  The play-time transform published for all tracks, applied after
+     *  each track's own, and the one in use for the current frame, taken
+     *  from it at the start of play().  See track::play_transform().
+     */
+
+    transform::pointer m_play_transform;
+    transform::pointer m_frame_transform;
+
     /**
      *  A condition variable to protect playback.  It is signalled if playback
      *  has been started.  The output thread function waits on this variable
@@ -317,6 +373,52 @@ private:                            /* key, midi, and op container section  */
 
     transport::clock::info m_clock_info;
 
+    /**
+     *  Optionally records every event read by poll_cycle(), with its bus and
+     *  arrival time, so that a session can be replayed deterministically
+     *  via replay_input().  Idle unless start_input_capture() is called.
+     */
+
+    inputlog m_input_capture;
+
+    /**
+     *  The shared-memory feed that observers read the emitted events and
+     *  transport from.  Closed unless open_event_feed() is called, as
+     *  session::rtlmanager::create_player() does if the configuration names
+     *  a feed.
+     */
+
+    eventfeed m_event_feed;
+
+    /**
+     *  An audio stream's frame clock, if the application wants MIDI output
+     *  timed by it; not owned.  While it is active, the output thread takes
+     *  its tick advance from the frames counted rather than from the system
+     *  clock, so MIDI and audio share one timeline.
+     */
+
+    transport::clock::frameclock * m_frame_clock;
+
+    /**
+     *  MIDI Time Code output.  If the bus is not the null buss, the output
+     *  thread sends a full frame when playback starts and quarter frames
+     *  as the position moves.  The position in seconds is the tick position
+     *  at the current tempo.
+     */
+
+    transport::clock::mtc_generator m_mtc_generator;
+    midi::bussbyte m_mtc_bus;
+
+    /**
+     *  MIDI Time Code input.  The input thread feeds the follower; if
+     *  m_mtc_follow is set, the position follows it.  The mutex is for the
+     *  follower, which both threads use.
+     */
+
+    transport::clock::mtc_follower m_mtc_follower;
+    std::atomic<bool> m_mtc_follow;
+    mutable std::mutex m_mtc_mutex;
+
     /**
      *  Consolidates a number of ALSA/JACK/etc. transport parameters. It
      *  includes settings and live values.  The accessor is transportinfo().
@@ -383,6 +485,25 @@ public:
 
     virtual bool create_master_bus ();
     virtual bool clear_all (bool clearplaylist = false);
+    virtual memusage memory_usage () const;
+
+    bool lazy_decode () const
+    {
+        return m_lazy_decode;
+    }
+
+    void lazy_decode (bool flag)
+    {
+        m_lazy_decode = flag;
+    }
+
+    int prefetch_tracks (bool background = true);
+    void stop_prefetch ();
+    bool reload_configuration
+    (
+        const std::string & filename, bool background = true
+    );
+    bool finish_reload ();
     virtual bool track_playing_toggle (track::number trkno);
     virtual bool track_playing_change (track::number trkno, bool on);
 
@@ -458,6 +579,99 @@ public:
         return m_clock_info;
     }
 
+    bool start_input_capture (const std::string & filename);
+    void stop_input_capture ();
+    bool replay_input
+    (
+        const std::string & filename,
+        bool realtime,
+        std::string & report
+    );
+
+    bool input_capturing () const
+    {
+        return m_input_capture.capturing();
+    }
+
+    bool open_event_feed (const std::string & name);
+
+    void close_event_feed ()
+    {
+        m_event_feed.close();
+    }
+
+    bool event_feed_open () const
+    {
+        return m_event_feed.is_open();
+    }
+
+    void frame_clock (transport::clock::frameclock * fc)
+    {
+        m_frame_clock = fc;
+    }
+
+    const transport::clock::frameclock * frame_clock () const
+    {
+        return m_frame_clock;
+    }
+
+    bool frame_clock_active () const
+    {
+        return not_nullptr(m_frame_clock) && m_frame_clock->active();
+    }
+
+    void mtc_output
+    (
+        midi::bussbyte bus,
+        transport::clock::mtc_rate r = transport::clock::mtc_rate::fps_25
+    )
+    {
+        m_mtc_bus = bus;
+        m_mtc_generator.rate(r);
+    }
+
+    bool mtc_output () const
+    {
+        return ! midi::is_null_buss(m_mtc_bus);
+    }
+
+    void mtc_follow (bool flag)
+    {
+        m_mtc_follow = flag;
+    }
+
+    bool mtc_follow () const
+    {
+        return m_mtc_follow;
+    }
+
+    void loop_notes (track::wrapnotes policy)
+    {
+        m_loop_notes = policy;
+    }
+
+    track::wrapnotes loop_notes () const
+    {
+        return m_loop_notes;
+    }
+
+    void play_transform (transform::pointer t)
+    {
+        std::atomic_store(&m_play_transform, t);
+    }
+
+    transform::pointer play_transform () const
+    {
+        return std::atomic_load(&m_play_transform);
+    }
+
+    const transform * frame_transform () const
+    {
+        return m_frame_transform.get();
+    }
+
+    bool mtc_position (double now, double & seconds) const;
+
     midi::ppqn get_ppqn () const
     {
         return transportinfo().get_ppqn();
@@ -669,6 +883,7 @@ public:
     void right_tick (midi::pulse t);
     void left_tick_snap (midi::pulse tick, midi::pulse snap);
     void right_tick_snap (midi::pulse tick, midi::pulse snap);
+    int chase (midi::pulse tick);
 
     /*
      * ---------------------------------------------------------------------
@@ -975,6 +1190,9 @@ private:
 
     void append_error_message (const std::string & msg) const;
     void reset_tracks (bool pause = false);
+    void loop_wrap (midi::pulse rtick, midi::pulse ltick);
+    void prefetch (std::vector<track::pointer> pending);
+    void reload (std::string filename);
 
 public:                             /* access functions for the containers  */
 
@@ -993,6 +1211,7 @@ private:
     bool output_func ();
     bool input_func ();
     bool poll_cycle ();
+    bool handle_input_event (event & ev);
     bool launch_input_thread ();
     bool launch_output_thread ();
     void midi_start ();
@@ -1000,7 +1219,11 @@ private:
     void midi_stop ();
     void midi_clock ();
     void midi_song_pos (const event & ev);
+    void midi_quarter_frame (const event & ev);
     void midi_sysex (const event & ev);
+    void mtc_locate (double seconds);
+    void mtc_emit (double seconds);
+    midi::pulse mtc_pulse (double seconds) const;
 
     synch & cv ()
     {
@@ -0,0 +1,137 @@
+#if ! defined RTL66_MIDI_PORTWATCH_HPP
+#define RTL66_MIDI_PORTWATCH_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          portwatch.hpp
+ *
+ *  This module declares the queue of system port changes.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  When a USB device is unplugged and plugged back in, ALSA gives it new
+ *  client and port numbers, and JACK may give it a new system port name.
+ *  The API callbacks (the ALSA announce port, the JACK port-registration
+ *  callback) post each change here, from their own threads.  The queue is
+ *  taken and applied later, off the output thread, by
+ *  masterbus::process_port_changes(), which re-binds each unplugged bus to
+ *  its returning port by identity rather than by number.
+ *
+ *  The identity of a port is its nickname, normalized so that the numbers
+ *  that change from one plug-in to the next ("[20]", "24:0", a process ID)
+ *  drop out.  See identity().
+ */
+
+#include <atomic>                       /* std::atomic<bool>                */
+#include <mutex>                        /* std::mutex, std::lock_guard      */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+namespace midi
+{
+
+/**
+ *  A thread-safe queue of port appearances and disappearances.
+ */
+
+class portwatch
+{
+
+public:
+
+    /**
+     *  What happened to the port.
+     */
+
+    enum class action
+    {
+        appeared,
+        vanished
+    };
+
+    /**
+     *  One change.  The name and alias are empty if the API cannot supply
+     *  them, as for an ALSA port that has already gone; then only the
+     *  numbers can be matched.
+     */
+
+    class change
+    {
+    public:
+
+        action pw_action;
+        int pw_client;
+        int pw_port;
+        std::string pw_name;
+        std::string pw_alias;
+    };
+
+private:
+
+    /**
+     *  The pending changes, in order of arrival.  Guarded by m_mutex, which
+     *  is held only to append or to swap the vector out.
+     */
+
+    std::vector<change> m_changes;
+    std::mutex m_mutex;
+
+    /**
+     *  Lets the poller check for changes without taking the mutex.
+     */
+
+    std::atomic<bool> m_pending;
+
+public:
+
+    portwatch ();
+    portwatch (const portwatch &) = delete;
+    portwatch & operator = (const portwatch &) = delete;
+
+    void post
+    (
+        action a, int client, int port,
+        const std::string & name = "",
+        const std::string & alias = ""
+    );
+    bool take (std::vector<change> & changes);
+
+    bool pending () const
+    {
+        return m_pending;
+    }
+
+    static std::string identity (const std::string & name);
+
+};          // class portwatch
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_PORTWATCH_HPP
+
+/*
+ * portwatch.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -27,7 +27,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2015-10-10
- * \updates       2024-05-26
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This class is meant to hold the bytes that represent MIDI events and other
@@ -38,12 +38,18 @@
  */
 
 #include <atomic>                       /* std::atomic<bool> for dirtying   */
+#include <cstdint>                      /* std::uint16_t                    */
 #include <memory>                       /* std::shared_ptr<>, unique_ptr<>  */
 #include <string>                       /* std::string class                */
+#include <utility>                      /* std::pair<>                      */
+#include <vector>                       /* std::vector<> for carried offs   */
 
 #include "cpp_types.hpp"                /* lib66::notification              */
+#include "midi/chaseindex.hpp"          /* midi::chaseindex for seeking     */
+#include "midi/notetracker.hpp"         /* midi::notetracker, sounding notes*/
 #include "midi/trackdata.hpp"           /* midi::trackdata event-data class */
 #include "midi/trackinfo.hpp"           /* midi::trackinfo parameters class */
+#include "midi/transform.hpp"           /* midi::transform of output        */
 #include "xpc/automutex.hpp"            /* xpc::recmutex, automutex         */
 #include "util/bytevector.hpp"          /* util::bytevector big-endian data */
 
@@ -121,6 +127,24 @@ public:
         max
     };
 
+    /**
+     *  What to do with notes still sounding when playback wraps from the
+     *  right (R) marker back to the left (L) marker.
+     *
+     * \var close
+     *      Send their Note Offs at the seam.
+     *
+     * \var carry
+     *      Hold them across the seam, and send each Note Off after the
+     *      same number of ticks it would have come after R.
+     */
+
+    enum class wrapnotes
+    {
+        close,
+        carry
+    };
+
 private:
 
     /**
@@ -201,12 +225,61 @@ private:
     midi::masterbus * m_master_bus;
 
     /**
-     *  Provides a "map" for Note On events.  It is used when muting, to shut
-     *  off the notes that are playing. The c_notes_count is simply the
-     *  maximum number of MIDI notes, 128.  See the midibytes.hpp module.
+     *  Provides a "map" for Note On events, per channel.  It is used when
+     *  muting, to shut off the notes that are playing.  See the
+     *  notetracker.hpp module.
+     */
+
+    notetracker m_playing_notes;
+
+    /**
+     *  Note Offs held across a loop wrap by wrapnotes::carry, stamped with
+     *  the global tick at which each is due.  Usually empty.
+     */
+
+    std::vector<event> m_carried_offs;
+
+    /**
+     *  The play-time transform published for this track, and the one in use
+     *  for the current frame, taken from it when the frame starts.  Either
+     *  can be null, meaning no transform.  The published pointer is only
+     *  accessed with std::atomic_load() and std::atomic_store().
+     */
+
+    transform::pointer m_play_transform;
+    transform::pointer m_emit_transform;
+
+    /**
+     *  For each sounding note that a transform moved, the (channel, note)
+     *  slot in the track and the slot it went out on, so that its Note Off
+     *  goes to the same place even if the transform has changed.  The slot
+     *  is channel * 128 + note.  Empty when no transform is used.  Its
+     *  capacity is reserved by the constructor, and clear() and erase()
+     *  keep it, so playing does not allocate.
+     */
+
+    std::vector<std::pair<std::uint16_t, std::uint16_t>> m_note_pairs;
+
+    /**
+     *  Checkpoints of the controller, program, pitch-bend, and tempo state
+     *  of the events, so that a transport jump can restore that state
+     *  without scanning from the start.  See chase().
+     */
+
+    chaseindex m_chase;
+
+    /**
+     *  Indicates that the track was loaded with deferred decoding, and its
+     *  events are still raw MTrk bytes in m_data.  They are decoded on
+     *  demand by decode_deferred(), which the events() accessors and
+     *  set_armed() call, and ahead of time by player::prefetch_tracks().
+     *  The sort and verify that installing the track would have done are
+     *  noted in the next two flags and done after decoding.
      */
 
-    unsigned short m_playing_notes[c_notes_count];
+    std::atomic<bool> m_deferred;
+    bool m_deferred_sort;
+    bool m_deferred_verify;
 
     /**
      *  True if sequence playback currently is possible for this sequence.  In
@@ -463,14 +536,35 @@ public:
 
     eventlist & events ()
     {
+        if (is_deferred())
+            (void) decode_deferred();
+
         return data().events();
     }
 
     const eventlist & events () const
     {
+        if (is_deferred())
+            (void) const_cast<track *>(this)->decode_deferred();
+
         return data().m_events;
     }
 
+    bool decode_deferred ();
+
+    bool is_deferred () const
+    {
+        return m_deferred;
+    }
+
+    void memory_usage (memusage & mu) const;
+    int chase (midi::pulse tick, midi::bpm & tempo);
+
+    void chase_invalidate (midi::pulse from = 0)
+    {
+        m_chase.invalidate(events(), from);
+    }
+
     /*-----------------------------------------------------------------------
      * track
      *-----------------------------------------------------------------------*/
@@ -638,6 +732,27 @@ public:
 
 public:
 
+    void loop_wrap
+    (
+        midi::pulse righttick, midi::pulse lefttick,
+        wrapnotes policy = wrapnotes::close
+    );
+
+    void play_transform (transform::pointer t)
+    {
+        std::atomic_store(&m_play_transform, t);
+    }
+
+    transform::pointer play_transform () const
+    {
+        return std::atomic_load(&m_play_transform);
+    }
+
+    const notetracker & playing_notes () const
+    {
+        return m_playing_notes;
+    }
+
     void resume_note_ons (midi::pulse tick)
     {
         (void) tick;
@@ -816,10 +931,16 @@ protected:
     size_t parse_track
     (
         const util::bytevector & datavec,
-        size_t offset, size_t len
+        size_t offset, size_t len,
+        bool deferred = false
     )
     {
-        return data().parse_track(*this, datavec, offset, len);
+        size_t result = data().parse_track
+        (
+            *this, datavec, offset, len, deferred
+        );
+        m_deferred = deferred && result > 0;
+        return result;
     }
 
     bool modified () const
@@ -847,7 +968,14 @@ protected:
     bool append_event (const event & er);
     void sort_events ();
     void verify_and_link (bool wrap = false);
-    void put_event_on_bus (const event & ev);
+    bool put_event_on_bus (const event & ev, bool flush = true);
+    virtual void send_on_bus
+    (
+        const event & evout, midi::byte channel, bool flush
+    );
+    void follow_note (midi::byte & channel, midi::byte & note, bool off);
+    virtual void flush_bus ();
+    int play_carried_offs (midi::pulse tick);
 
 #if defined MOVE_THIS_TO_DERIVED_CLASS
     midi::pulse song_put_seq_event...
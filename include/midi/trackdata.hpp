@@ -27,7 +27,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2015-10-10
- * \updates       2024-05-26
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This class is meant to hold the bytes that represent MIDI events and other
@@ -77,6 +77,55 @@ enum class rsaction
     abort       /* Stop processing the rest of the tracks.                  */
 };
 
+/**
+ *  Options for writing a smaller track.  All are off by default, which
+ *  writes every byte as before.  None of them changes what is heard.
+ *
+ * \var sp_running_status
+ *      Leave out a status byte that equals the one before it.  A Meta or
+ *      SysEx event cancels running status, so the next status is written.
+ *
+ * \var sp_zero_note_offs
+ *      Write each Note Off as a Note On of velocity 0, so that the notes of
+ *      a channel form one running-status run.  The release velocity is
+ *      lost; it is read back as a Note Off of velocity 0.
+ *
+ * \var sp_drop_repeats
+ *      Leave out a Control Change or Pitch Wheel event that repeats the
+ *      last value written for its channel.  Data entry, increment and
+ *      decrement, and the channel mode messages always act, so they are
+ *      kept.  Reset All Controllers and SysEx forget the values.
+ *
+ * \var sp_dedupe_metas
+ *      Leave out a Tempo or Time Signature event identical to one already
+ *      written at the same tick.
+ */
+
+class smfpacking
+{
+public:
+
+    bool sp_running_status;
+    bool sp_zero_note_offs;
+    bool sp_drop_repeats;
+    bool sp_dedupe_metas;
+
+    smfpacking (bool all = false) :
+        sp_running_status   (all),
+        sp_zero_note_offs   (all),
+        sp_drop_repeats     (all),
+        sp_dedupe_metas     (all)
+    {
+        // no code
+    }
+
+    bool any () const
+    {
+        return sp_running_status || sp_zero_note_offs ||
+            sp_drop_repeats || sp_dedupe_metas;
+    }
+};
+
 /**
  *    This class is the base class for a container of MIDI track
  *    information.  It is one of the base classes for the track class.
@@ -124,6 +173,21 @@ private:
 
     bool m_end_of_track_found;
 
+    /**
+     *  When the track was loaded with deferred decoding, holds the raw bytes
+     *  of the MTrk chunk until decode_deferred() turns them into events.
+     *  Empty otherwise.
+     */
+
+    midi::bytes m_deferred_bytes;
+
+    /**
+     *  The status last written while running status is in use, or 0 if
+     *  the next status must be written.  See smfpacking.
+     */
+
+    midi::byte m_put_status;
+
 public:
 
     trackdata ();
@@ -141,6 +205,7 @@ public:
     void clear_buffer ()
     {
         m_data.clear();
+        m_put_status = 0;
     }
 
     void clear_all ()
@@ -184,6 +249,11 @@ public:
         return m_end_of_track_found;
     }
 
+    size_t deferred_size () const
+    {
+        return m_deferred_bytes.size();
+    }
+
     /*---------------------------------------------------------------------
      * "get" functions
      *---------------------------------------------------------------------*/
@@ -366,7 +436,12 @@ public:
         m_data.put_long(x);
     }
 
-    void put_channel_event (const event & e, midi::pulse deltatime);
+    void put_channel_event
+    (
+        const event & e,
+        midi::pulse deltatime,
+        const smfpacking & packing = smfpacking()
+    );
     void put_ex_event (const event & e, midi::pulse deltatime);
     void put_meta_header
     (
@@ -391,12 +466,17 @@ public:
     void put_meta_track_end (midi::pulse deltatime);
 #endif
 
-    bool put_track_events (/*const*/ track & trk);
+    bool put_track_events
+    (
+        /*const*/ track & trk,
+        const smfpacking & packing = smfpacking()
+    );
     bool put_track
     (
         /*const*/ track & trk,
         int tempotrack = 0,
-        bool doseqspec = true
+        bool doseqspec = true,
+        const smfpacking & packing = smfpacking()
     );
     void put_seqspec (midi::ulong spec, int datalen);
     void put_seqspec_code (midi::ulong spec, int datalen);
@@ -470,8 +550,11 @@ protected:
     (
         track & trk,
         const util::bytevector & data,
-        size_t offset, size_t len
+        size_t offset, size_t len,
+        bool deferred = false
     );
+    bool parse_events (track & trk, bool deferred);
+    bool decode_deferred (track & trk);
 
     eventlist & events ()
     {
@@ -0,0 +1,180 @@
+#if ! defined RTL66_MIDI_TRANSFORM_HPP
+#define RTL66_MIDI_TRANSFORM_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          transform.hpp
+ *
+ *  This module declares a play-time transform of outgoing events.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Transposing a pattern by rewriting its events dirties the file and walks
+ *  every event.  A transform is instead applied to the copy of each event
+ *  that goes to the bus, leaving the stored events alone.  It holds a
+ *  transpose, a velocity scale, offset, and curve, a channel remap, and a
+ *  note range, all folded into lookup tables when the transform is built,
+ *  so that applying it is a few table lookups.
+ *
+ *  A transform is not changed once published.  A track (and the player,
+ *  for all tracks) holds a shared pointer to a constant transform, and a
+ *  change is made by publishing a new one, which takes effect at the next
+ *  frame.  See track::play_transform().
+ */
+
+#include <array>                        /* std::array<>                     */
+#include <memory>                       /* std::shared_ptr<>                */
+
+#include "midi/midibytes.hpp"           /* midi::byte, c_notes_count, etc.  */
+
+namespace midi
+{
+
+class event;
+
+/**
+ *  The emit-time transform and its tables.
+ */
+
+class transform
+{
+
+public:
+
+    using pointer = std::shared_ptr<const transform>;
+
+    /**
+     *  The shape of the velocity mapping, applied before the scale and
+     *  offset.
+     *
+     * \var linear
+     *      The velocity is unchanged.
+     *
+     * \var soft
+     *      Quiet notes are raised (a square-root curve).
+     *
+     * \var hard
+     *      Quiet notes are lowered (a square curve).
+     */
+
+    enum class curve
+    {
+        linear,
+        soft,
+        hard
+    };
+
+private:
+
+    int m_transpose;
+    double m_velocity_scale;
+    int m_velocity_offset;
+    curve m_velocity_curve;
+    midi::byte m_note_low;
+    midi::byte m_note_high;
+
+    /**
+     *  The outgoing channel for each channel.  Starts as the identity.
+     */
+
+    std::array<midi::byte, c_channel_max> m_channel_map;
+
+    /**
+     *  The outgoing note for each note, after the transpose and range.
+     */
+
+    std::array<midi::byte, c_notes_count> m_note_table;
+
+    /**
+     *  The outgoing Note On velocity for each velocity.  A velocity of 0
+     *  stays 0, and no other velocity becomes 0.
+     */
+
+    std::array<midi::byte, c_notes_count> m_velocity_table;
+
+    /**
+     *  True if all the tables are the identity, so that apply() can be
+     *  skipped.
+     */
+
+    bool m_identity;
+
+public:
+
+    transform ();
+    transform
+    (
+        int transpose,
+        double velscale = 1.0,
+        int veloffset = 0,
+        curve velcurve = curve::linear
+    );
+
+    void transpose (int semitones);
+    void velocity_map (double scale, int offset = 0, curve c = curve::linear);
+    void channel_map (midi::byte from, midi::byte to);
+    void note_range (midi::byte low, midi::byte high);
+
+    int transpose () const
+    {
+        return m_transpose;
+    }
+
+    bool identity () const
+    {
+        return m_identity;
+    }
+
+    midi::byte note (midi::byte n) const
+    {
+        return m_note_table[n & 0x7F];
+    }
+
+    midi::byte velocity (midi::byte v) const
+    {
+        return m_velocity_table[v & 0x7F];
+    }
+
+    midi::byte channel (midi::byte ch) const
+    {
+        return m_channel_map[ch & 0x0F];
+    }
+
+    void apply (event & ev, midi::byte & ch) const;
+
+private:
+
+    void rebuild ();
+
+};          // class transform
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_TRANSFORM_HPP
+
+/*
+ * transform.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
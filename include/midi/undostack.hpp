@@ -0,0 +1,318 @@
+#if ! defined RTL66_MIDI_UNDOSTACK_HPP
+#define RTL66_MIDI_UNDOSTACK_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          undostack.hpp
+ *
+ *  This module declares a bounded stack of event-list snapshots for the
+ *  undo and redo of pattern edits.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  A plain std::stack<eventlist> holds a full live copy of the pattern for
+ *  every edit, and never gives any of it back.  Long editing sessions on
+ *  large patterns can then hold hundreds of megabytes.  The undostack
+ *  keeps only the newest few snapshots as live event-lists.  Older ones are
+ *  packed into a compact byte form (see eventlist::pack()), and, when the
+ *  process-wide budget is exceeded, the oldest packed snapshots are written
+ *  to a temporary file.  The depth can also be capped, in which case the
+ *  oldest snapshot is simply dropped.
+ *
+ *  The packing and spilling are not done in push().  By default a single
+ *  background thread, shared by all undo stacks, trims a stack after each
+ *  push, so an edit costs only the existing copy of the event-list.  The
+ *  stack mutex is held for one snapshot at a time, so an edit never waits
+ *  for more than one pack or one write.  With background_trim(false), the
+ *  trimming is done synchronously at the end of push(), as a test aid.
+ *
+ *  The budget and default depth are process-wide, and are set from the
+ *  rtlconfiguration by rtlmanager::create_player().
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <cstddef>                      /* std::size_t                      */
+#include <cstdio>                       /* std::FILE                        */
+#include <deque>                        /* std::deque<>                     */
+#include <memory>                       /* std::unique_ptr<>                */
+#include <mutex>                        /* std::mutex                       */
+
+#include "midi/eventlist.hpp"           /* midi::eventlist                  */
+
+namespace midi
+{
+
+class memusage;
+
+/**
+ *  Provides a stack of eventlist snapshots with bounded memory.
+ */
+
+class undostack
+{
+
+    friend class undotrimmer;
+
+public:
+
+    /**
+     *  Default number of snapshots kept as live event-lists.
+     */
+
+    static const int c_live_default = 4;
+
+    /**
+     *  Default memory budget for the packed snapshots of all undo stacks,
+     *  64 MiB.
+     */
+
+    static const std::size_t c_budget_default = 64 * 1024 * 1024;
+
+    /**
+     *  Default maximum number of snapshots.  Zero means no limit.
+     */
+
+    static const int c_depth_default = 0;
+
+    /**
+     *  A depth-limit parameter value that means "use default_depth()".
+     */
+
+    static const int c_depth_configured = (-1);
+
+private:
+
+    /**
+     *  One snapshot.  Exactly one of the three forms is in use: a live
+     *  event-list, a packed byte buffer, or a range in the spill file.
+     */
+
+    struct slot
+    {
+        std::unique_ptr<eventlist> s_live;
+        midi::bytes s_packed;
+        long s_offset;
+        std::size_t s_size;
+    };
+
+    /**
+     *  The memory budget for the packed snapshots of all undo stacks in
+     *  the process.  Zero means no spilling is done.
+     */
+
+    static std::atomic<std::size_t> sm_budget;
+
+    /**
+     *  The depth limit given to new stacks that do not specify one.
+     */
+
+    static std::atomic<int> sm_default_depth;
+
+    /**
+     *  If true (the default), trimming is done by the background thread.
+     */
+
+    static std::atomic<bool> sm_background;
+
+    /**
+     *  The packed bytes held in memory by all undo stacks.
+     */
+
+    static std::atomic<std::size_t> sm_total_bytes;
+
+    /**
+     *  The snapshots, oldest at the front.
+     */
+
+    std::deque<slot> m_slots;
+
+    /**
+     *  Serializes the owner's push() and pop() with the background trim.
+     */
+
+    mutable std::mutex m_mutex;
+
+    /**
+     *  Held by the background thread while it trims this stack.  The
+     *  destructor takes it, after unregistering, to wait for such a trim
+     *  to end.
+     */
+
+    std::mutex m_trim_mutex;
+
+    /**
+     *  Set by push() when the stack may need trimming.
+     */
+
+    std::atomic<bool> m_trim_pending;
+
+    /**
+     *  The number of newest snapshots to keep as live event-lists.
+     */
+
+    int m_live_limit;
+
+    /**
+     *  The maximum number of snapshots.  Zero means no limit.
+     */
+
+    int m_depth_limit;
+
+    /**
+     *  The number of packed bytes held in memory by this stack.
+     */
+
+    std::size_t m_packed_bytes;
+
+    /**
+     *  The number of snapshots, at the front, that are in the spill file.
+     */
+
+    std::size_t m_spilled;
+
+    /**
+     *  The temporary file for spilled snapshots, opened when first needed.
+     *  It is deleted automatically when closed.
+     */
+
+    std::FILE * m_spill_file;
+
+    /**
+     *  The end of the used part of the spill file.  Since the oldest
+     *  snapshots are spilled first and popped last, the file is used as a
+     *  stack, too, and popping reclaims the space.  A snapshot dropped by
+     *  the depth limit leaves a hole at the start instead; once the holes
+     *  outgrow the snapshots, trim() moves the snapshots down.
+     */
+
+    long m_spill_end;
+
+    /**
+     *  The bytes of the snapshots in the spill file, not counting holes.
+     */
+
+    std::size_t m_spill_bytes;
+
+public:
+
+    undostack
+    (
+        int livelimit = c_live_default,
+        int depthlimit = c_depth_configured
+    );
+    undostack (const undostack &) = delete;
+    undostack & operator = (const undostack &) = delete;
+    ~undostack ();
+
+    static std::size_t budget ()
+    {
+        return sm_budget;
+    }
+
+    static void budget (std::size_t b)
+    {
+        sm_budget = b;
+    }
+
+    static int default_depth ()
+    {
+        return sm_default_depth;
+    }
+
+    static void default_depth (int d)
+    {
+        sm_default_depth = d > 0 ? d : 0 ;
+    }
+
+    static bool background_trim ()
+    {
+        return sm_background;
+    }
+
+    static void background_trim (bool flag)
+    {
+        sm_background = flag;
+    }
+
+    static std::size_t total_bytes ()
+    {
+        return sm_total_bytes;
+    }
+
+    bool empty () const
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        return m_slots.empty();
+    }
+
+    std::size_t size () const
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        return m_slots.size();
+    }
+
+    int live_limit () const
+    {
+        return m_live_limit;
+    }
+
+    int depth_limit () const
+    {
+        return m_depth_limit;
+    }
+
+    bool trim_pending () const
+    {
+        return m_trim_pending;
+    }
+
+    void depth_limit (int d);
+    void push (const eventlist & evl);
+    bool pop (eventlist & destination);
+    void clear ();
+    int trim ();
+    std::size_t spilled () const;
+    std::size_t spill_file_size () const;
+    std::size_t packed_bytes () const;
+    void memory_usage (memusage & mu) const;
+
+private:
+
+    bool trim_step ();
+    void pack_slot (slot & s);
+    bool spill_slot (slot & s);
+    bool compact_step ();
+    void release_slot (slot & s);
+
+};          // class undostack
+
+}           // namespace midi
+
+#endif      // RTL66_MIDI_UNDOSTACK_HPP
+
+/*
+ * undostack.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -28,7 +28,7 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2023-03-07
- * \updates       2024-01-16
+ * \updates       2026-10-18
  * \license       See above.
  *
  *      This class is mostly similar to the original RtAudio MidiApi class,
@@ -43,20 +43,35 @@
  *      instantiated.  The class audio_api will create an instance of an
  *      audio_api subclass (RtApiOss, RtApiAlsa, RtApiJack, RtApiCore,
  *      RtApiDs, or RtApiAsio).
+ *
+ *      Besides the callback-driven stream, a stream can be opened in push
+ *      mode (open_push_stream()), for an application that makes or uses
+ *      audio on its own thread.  The application calls write() and read();
+ *      an internal callback moves the frames through a lock-free ring to
+ *      and from the device.
+ *
+ *      The stream time is kept by a frame clock, a 64-bit count of the
+ *      frames processed, so it does not drift as a sum of buffer durations
+ *      would.  The MIDI player can follow the same clock; see
+ *      transport::clock::frameclock.
  */
 
 #include "rtl/rtl_build_macros.h"       /* RTL66_EXPORT, etc.               */
 
+#include <atomic>                       /* std::atomic<>                    */
 #include <string>                       /* std::string class                */
 #include <thread>                       /* std::thread class                */
+#include <vector>                       /* std::vector<>                    */
 
 #if defined HAVE_GETTIMEOFDAY
 #include <sys/time.h>
 #endif
 
 #include "rtl/api_base.hpp"             /* rtl::api_base class etc.         */
+#include "rtl/audio/audio_ring.hpp"     /* rtl::audio_ring class            */
 #include "rtl/audio/audio_support.hpp"  /* rtl::rtaudio::xxx_info classes   */
 #include "rtl/audio/rtaudio.hpp"        /* rtl::rtaudio::api, etc.          */
+#include "transport/clock/frameclock.hpp" /* transport::clock::frameclock   */
 
 namespace rtl
 {
@@ -91,12 +106,38 @@ private:
 
     api_stream m_stream;
 
+    /**
+     *  Counts the frames of the open stream.  It is active while a stream
+     *  is open.
+     */
+
+    transport::clock::frameclock m_frame_clock;
+
     /*
      * Move into rterror???
      */
 
     bool m_show_warnings;
 
+    /**
+     *  Push mode.  The output ring is filled by write() and drained by the
+     *  callback; the input ring is filled by the callback and drained by
+     *  read().  The rings hold frames in the stream's format, converted
+     *  from or to float by write() and read(), each in its own scratch
+     *  buffer (they may be called from different threads), so the callback
+     *  only copies.  An underrun is a callback that found too
+     *  few frames to play (the rest is silence); an overrun is a callback
+     *  that found too little room for its input (the rest is dropped).
+     */
+
+    bool m_push_mode;
+    audio_ring m_push_output;
+    audio_ring m_push_input;
+    std::vector<char> m_push_write_scratch;
+    std::vector<char> m_push_read_scratch;
+    std::atomic<unsigned long> m_underruns;
+    std::atomic<unsigned long> m_overruns;
+
 public:
 
     /*
@@ -105,13 +146,23 @@ public:
      */
 
     audio_api ();
-    audio_api (const audio_api &) = default;                // delete;
+    audio_api (const audio_api &) = delete;
     audio_api & operator = (audio_api &&) = delete;
-    audio_api & operator = (const audio_api &) = default;   // delete;
+    audio_api & operator = (const audio_api &) = delete;
     virtual ~audio_api () = default;
 
 protected:
 
+    api_stream & stream ()
+    {
+        return m_stream;
+    }
+
+    const api_stream & stream () const
+    {
+        return m_stream;
+    }
+
     devicelist & device_list ()
     {
         return m_device_list;
@@ -154,11 +205,59 @@ protected:
         rterror::callback_t errorcb
     );
 
+    bool open_push_stream
+    (
+        stream_parameters * outparameters,
+        stream_parameters * inparameters,
+        stream_format format,
+        unsigned samplerate,
+        unsigned bufferframes,
+        unsigned ringframes,
+        stream_options * options,
+        rterror::callback_t errorcb
+    );
+    std::size_t write
+    (
+        const float * samples, std::size_t frames, int timeoutms = 0
+    );
+    std::size_t read (float * samples, std::size_t frames, int timeoutms = 0);
+
+    bool push_mode () const
+    {
+        return m_push_mode;
+    }
+
+    std::size_t push_writable () const
+    {
+        return m_push_output.writable();
+    }
+
+    std::size_t push_readable () const
+    {
+        return m_push_input.readable();
+    }
+
+    unsigned long underruns () const
+    {
+        return m_underruns;
+    }
+
+    unsigned long overruns () const
+    {
+        return m_overruns;
+    }
+
     void tick_stream_time ();           /* increments the stream time       */
 
     void clear_stream_info ()           /* clears api_stream structure      */
     {
         m_stream.clear();
+        m_frame_clock.active(false);
+    }
+
+    transport::clock::frameclock & frame_clock ()
+    {
+        return m_frame_clock;
     }
 
     /**
@@ -224,11 +323,7 @@ protected:
         return m_stream.streamtime();
     }
 
-    virtual void set_stream_time (double t)
-    {
-        if (t >= 0.0)
-            m_stream.streamtime(t);
-    }
+    virtual void set_stream_time (double t);
 
     /*
      * These functions don't need to be virtual as they call virtual
@@ -257,6 +352,17 @@ protected:
 
 private:
 
+    static int push_callback
+    (
+        void * outputbuffer, void * inputbuffer,
+        int nframes, double streamtime,
+        stream_status status, void * userdata
+    );
+    int push_service
+    (
+        char * outputbuffer, const char * inputbuffer, int nframes
+    );
+
     bool stream_mode_is_input ()
     {
         return m_stream.mode() == stream_mode::input ||
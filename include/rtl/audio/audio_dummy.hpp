@@ -0,0 +1,118 @@
+#if ! defined RTL66_AUDIO_DUMMY_HPP
+#define RTL66_AUDIO_DUMMY_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          audio_dummy.hpp
+ *
+ *      Provides a headless audio device driven by a timer thread.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  The dummy device has no hardware behind it.  It calls the stream callback
+ *  once per buffer period, with user-format buffers.  In duplex mode with
+ *  the same channel count each way, what it plays in one period is what it
+ *  records in the next (a loopback); otherwise it records silence.  It is
+ *  useful for exercising the stream code (for example, push mode) without a
+ *  sound server.
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <thread>                       /* std::thread                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "rtl/audio/audio_api.hpp"      /* rtl::audio_api base class        */
+
+namespace rtl
+{
+
+/*------------------------------------------------------------------------
+ * audio_dummy
+ *------------------------------------------------------------------------*/
+
+class RTL66_DLL_PUBLIC audio_dummy : public audio_api
+{
+
+private:
+
+    /**
+     *  The thread that stands in for the device, and the flag that stops
+     *  it.
+     */
+
+    std::thread m_thread;
+    std::atomic<bool> m_thread_running;
+
+    /**
+     *  The buffers handed to the callback, playback and record.
+     */
+
+    std::vector<char> m_output_buffer;
+    std::vector<char> m_input_buffer;
+
+public:
+
+    audio_dummy ();
+    audio_dummy (const audio_dummy &) = delete;
+    audio_dummy & operator = (const audio_dummy &) = delete;
+    virtual ~audio_dummy ();
+
+    virtual rtaudio::api get_current_api () override
+    {
+        return rtaudio::api::dummy;
+    }
+
+protected:
+
+    virtual bool probe_devices () override;
+    virtual bool probe_device_open
+    (
+        unsigned device,
+        stream_mode mode,
+        unsigned channels,
+        unsigned firstchannel, unsigned samplerate,
+        stream_format format, unsigned * buffersize,
+        stream_options * options
+    ) override;
+    virtual bool close_stream () override;
+    virtual bool start_stream () override;
+    virtual bool stop_stream () override;
+    virtual bool abort_stream () override;
+
+private:
+
+    void run ();
+    void join ();
+
+};          // class audio_dummy
+
+}           // namespace rtl
+
+#endif      // RTL66_AUDIO_DUMMY_HPP
+
+/*
+ * audio_dummy.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
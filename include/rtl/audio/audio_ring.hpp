@@ -0,0 +1,160 @@
+#if ! defined RTL66_AUDIO_RING_HPP
+#define RTL66_AUDIO_RING_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          audio_ring.hpp
+ *
+ *      A lock-free frame ring between an application thread and an audio
+ *      callback.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  The ring holds whole frames (one sample per channel) in the format of
+ *  the stream, so that the audio callback only copies bytes.  It has one
+ *  producer and one consumer; each side owns one index and only reads the
+ *  other, so neither side takes a lock.  The side that must not block (the
+ *  callback) never waits; the application side can wait for room or data,
+ *  with a timeout, and is woken by the callback only if it is waiting.
+ *
+ *  Also declared here are the sample conversions to and from float, done
+ *  on the application side of the ring.
+ */
+
+#include "rtl/rtl_build_macros.h"       /* RTL66_EXPORT, etc.               */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <condition_variable>           /* std::condition_variable          */
+#include <cstddef>                      /* std::size_t                      */
+#include <mutex>                        /* std::mutex                       */
+#include <vector>                       /* std::vector<>                    */
+
+#include "rtl/audio/rt_audio_types.hpp" /* rtl::stream_format              */
+
+namespace rtl
+{
+
+/**
+ *  A single-producer, single-consumer ring of audio frames.
+ */
+
+class RTL66_DLL_PUBLIC audio_ring
+{
+
+private:
+
+    std::vector<char> m_buffer;
+    std::size_t m_frame_bytes;
+
+    /**
+     *  The capacity in frames, a power of two, and the mask for it.
+     */
+
+    std::size_t m_capacity;
+    std::size_t m_mask;
+
+    /**
+     *  Running counts of the frames written and read.  Only the producer
+     *  stores m_write_count and only the consumer stores m_read_count.
+     */
+
+    std::atomic<std::size_t> m_write_count;
+    std::atomic<std::size_t> m_read_count;
+
+    /**
+     *  For the optional wait on the application side.
+     */
+
+    std::mutex m_wait_mutex;
+    std::condition_variable m_wait_cond;
+    std::atomic<bool> m_waiting;
+
+public:
+
+    audio_ring ();
+    audio_ring (const audio_ring &) = delete;
+    audio_ring & operator = (const audio_ring &) = delete;
+
+    bool resize (std::size_t frames, std::size_t framebytes);
+    void clear ();
+
+    std::size_t capacity () const
+    {
+        return m_capacity;
+    }
+
+    std::size_t frame_bytes () const
+    {
+        return m_frame_bytes;
+    }
+
+    std::size_t readable () const
+    {
+        return m_write_count.load(std::memory_order_acquire) -
+            m_read_count.load(std::memory_order_acquire);
+    }
+
+    std::size_t writable () const
+    {
+        return m_capacity - readable();
+    }
+
+    std::size_t write (const void * frames, std::size_t count);
+    std::size_t read (void * frames, std::size_t count);
+    bool wait_writable (std::size_t count, int timeoutms);
+    bool wait_readable (std::size_t count, int timeoutms);
+
+private:
+
+    bool wait_for (bool writing, std::size_t count, int timeoutms);
+    void wake ();
+
+};          // class audio_ring
+
+/*
+ * Sample conversion.  The float side is interleaved, normalized to plus or
+ * minus 1.0.  The other side is the given format, interleaved, in host byte
+ * order, with 24-bit samples packed in three bytes.
+ */
+
+extern void convert_from_float
+(
+    const float * source, char * destination,
+    std::size_t samples, stream_format format
+);
+extern void convert_to_float
+(
+    const char * source, float * destination,
+    std::size_t samples, stream_format format
+);
+
+}           // namespace rtl
+
+#endif      // RTL66_AUDIO_RING_HPP
+
+/*
+ * audio_ring.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
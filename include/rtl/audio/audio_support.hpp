@@ -168,6 +168,17 @@ public:
 
     stream_parameters () = default;
 
+    stream_parameters
+    (
+        unsigned deviceid, unsigned nchannels, unsigned firstchannel = 0
+    ) :
+        m_deviceid      (deviceid),
+        m_nchannels     (nchannels),
+        m_firstchannel  (firstchannel)
+    {
+        // no code
+    }
+
     unsigned deviceid () const
     {
         return m_deviceid;
@@ -532,6 +543,11 @@ public:
         return m_ID;
     }
 
+    void ID (unsigned id)
+    {
+        m_ID = id;
+    }
+
     bool invalid () const
     {
         return m_ID == 0;
@@ -542,6 +558,11 @@ public:
         return m_name;
     }
 
+    void name (const std::string & n)
+    {
+        m_name = n;
+    }
+
     unsigned output_channels () const
     {
         return m_output_channels;
@@ -713,6 +734,11 @@ public:
         return m_samplerate;
     }
 
+    void samplerate (unsigned sr)
+    {
+        m_samplerate = sr;
+    }
+
     char * devicebuffer ()
     {
         return m_devicebuffer;
@@ -723,6 +749,11 @@ public:
         return m_buffersize;
     }
 
+    void buffersize (unsigned frames)
+    {
+        m_buffersize = frames;
+    }
+
     /**
      * UGH!
      */
@@ -801,6 +832,13 @@ public:
         return mode <= 1 ?  m_nuserchannels[mode] : 0 ;
     }
 
+    void nuserchannels (stream_mode strmode, unsigned channels)
+    {
+        int mode = static_cast<int>(strmode);
+        if (mode >= 0 && mode <= 1)
+            m_nuserchannels[mode] = channels;
+    }
+
     unsigned ndevicechannels (stream_mode strmode)
     {
         int mode = static_cast<int>(strmode);
@@ -830,6 +868,11 @@ public:
         return m_userformat;
     }
 
+    void userformat (stream_format f)
+    {
+        m_userformat = f;
+    }
+
 };          // class api_stream
 
 }           // namespace rtl
@@ -41,12 +41,13 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2023-03-07
- * \updates       2025-01-20
+ * \updates       2026-10-18
  * \license       See above.
  *
  *      Also contains some additional capabilities.
  */
 
+#include <cstddef>                      /* std::size_t                      */
 #include <string>                       /* omnipresent std::string class    */
 #include <vector>
 
@@ -54,6 +55,7 @@
 #include "rtl/rtl_build_macros.h"       /* RTL66_DLL_PUBLIC, etc.           */
 #include "rtl/rterror.hpp"              /* rtl::rterror::callback_t         */
 #include "rtl/audio/audio_support.hpp"  /* rtl::device_info                 */
+#include "transport/clock/frameclock.hpp" /* transport::clock::frameclock   */
 
 namespace rtl
 {
@@ -211,6 +213,39 @@ public:
         rterror::callback_t errorcb
     );
 
+    /*
+     * Push mode, where the application calls write() and read() instead of
+     * providing a callback.  See audio_api::open_push_stream().
+     */
+
+    bool open_push_stream
+    (
+        stream_parameters * outparameters,
+        stream_parameters * inparameters,
+        stream_format format,
+        unsigned samplerate,
+        unsigned bufferframes,
+        unsigned ringframes,
+        stream_options * options,
+        rterror::callback_t errorcb
+    );
+    std::size_t write
+    (
+        const float * samples, std::size_t frames, int timeoutms = 0
+    );
+    std::size_t read (float * samples, std::size_t frames, int timeoutms = 0);
+    std::size_t push_writable () const;
+    std::size_t push_readable () const;
+    unsigned long underruns () const;
+    unsigned long overruns () const;
+
+    /*
+     * The stream's frame clock, for the MIDI player to follow; see
+     * midi::player::frame_clock().  Null if there is no API.
+     */
+
+    transport::clock::frameclock * frame_clock ();
+
 public:
 
     static void silence_messages (bool silent);     /* already in rtmidi... */
@@ -27,7 +27,7 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2022-06-07
- * \updates       2024-05-14
+ * \updates       2026-10-18
  * \license       See above.
  *
  */
@@ -73,7 +73,6 @@ extern void set_alsa_version ();
 
 class RTL66_DLL_PUBLIC midi_alsa : public midi_api
 {
-    friend void * midi_alsa_handler (void *);
 
 private:
 
@@ -183,6 +182,10 @@ private:
     (
         midi::ports & inputports, bool preclear = true
     ) override;
+    virtual int get_all_io_port_info
+    (
+        midi::ports & inports, midi::ports & outports
+    ) override;
 
     /*
      * virtual std::string get_port_alias (const std::string & name) override;
@@ -254,6 +257,7 @@ protected:
     bool remove_subscription ();
     bool start_input_thread (rtmidi_in_data & indata);
     bool join_input_thread ();
+    int enumerate_ports (midi::ports * inports, midi::ports * outports);
 
 };          // class midi_alsa
 
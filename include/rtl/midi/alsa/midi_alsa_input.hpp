@@ -0,0 +1,226 @@
+#if ! defined RTL66_RTL_MIDI_ALSA_INPUT_HPP
+#define RTL66_RTL_MIDI_ALSA_INPUT_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          midi_alsa_input.hpp
+ *
+ *    A single input thread serving all ALSA input ports.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Each ALSA input port used to start its own thread (midi_alsa_handler()),
+ *  with its own poll loop, trigger pipe, and snd_midi_event decoder.  With
+ *  many inputs that is many threads waking on their own.  Worse, ports that
+ *  share an ALSA client share its input queue, so one port's thread could
+ *  read (and misdeliver) another port's events.
+ *
+ *  This service runs one thread.  It polls the descriptors of every ALSA
+ *  client that has a registered port, drains all pending events on each
+ *  wakeup with snd_seq_event_input(), and hands each event to the port it
+ *  was sent to (its dest.port).  Events for one port are delivered in the
+ *  order ALSA gives them.  Channel and system events are turned into MIDI
+ *  bytes directly from the snd_seq_event_t; only the rare compound kinds
+ *  (14-bit controllers, (N)RPN) use snd_midi_event_decode().
+ *
+ *  A port registered with a port watch is also subscribed to the ALSA
+ *  announce port; the port-start and port-exit events that arrive on it are
+ *  posted to the watch instead of being delivered.  See announce().
+ */
+
+#include "rtl/rtl_build_macros.h"       /* RTL66_EXPORT, etc.               */
+
+#if defined RTL66_BUILD_ALSA
+
+#include <alsa/asoundlib.h>             /* ALSA header file                 */
+#include <atomic>                       /* std::atomic<>                    */
+#include <condition_variable>           /* std::condition_variable          */
+#include <mutex>                        /* std::mutex                       */
+#include <poll.h>                       /* struct pollfd                    */
+#include <pthread.h>                    /* pthread_t, etc.                  */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/message.hpp"             /* midi::message                    */
+#include "midi/portwatch.hpp"           /* midi::portwatch change queue     */
+
+namespace rtl
+{
+
+class midi_alsa_data;
+class rtmidi_in_data;
+
+/**
+ *  The process-wide ALSA input service.
+ */
+
+class RTL66_DLL_PUBLIC midi_alsa_input
+{
+
+private:
+
+    /**
+     *  One registered input port, and its SysEx reassembly state.
+     */
+
+    class listener
+    {
+    public:
+
+        snd_seq_t * l_client;
+        int l_port;
+        rtmidi_in_data * l_in_data;
+        midi_alsa_data * l_api_data;
+        midi::portwatch * l_port_watch;
+        midi::message l_message;
+        bool l_more_sysex;
+        unsigned long l_received;
+    };
+
+    /**
+     *  The registered ports.  Guarded by m_mutex, which the thread holds
+     *  while reading and decoding events, but not while calling a port's
+     *  callback, so that the callback can add or remove ports.
+     */
+
+    std::vector<listener> m_listeners;
+    std::mutex m_mutex;
+
+    /**
+     *  The port whose callback is running, if any, and the message handed
+     *  to it.  remove() waits on m_idle until the port it removed is no
+     *  longer the busy one, so that no delivery is in progress when it
+     *  returns.
+     */
+
+    snd_seq_t * m_busy_client;
+    int m_busy_port;
+    midi::message m_delivery;
+    std::condition_variable m_idle;
+
+    /**
+     *  Poll set: entry 0 is the trigger pipe, then the descriptors of each
+     *  distinct client, with m_poll_clients giving the client of each.
+     */
+
+    std::vector<struct pollfd> m_poll_fds;
+    std::vector<snd_seq_t *> m_poll_clients;
+    bool m_rebuild;
+
+    /**
+     *  Wakes the thread for a change in the port set, or to stop.
+     */
+
+    int m_trigger_fds[2];
+
+    /**
+     *  Decoder for the event kinds not decoded directly, and its buffer.
+     */
+
+    snd_midi_event_t * m_parser;
+    std::vector<midi::byte> m_buffer;
+
+    /**
+     *  The thread, and whether it still has to be joined.  If the last port
+     *  is removed by a callback, the thread cannot join itself; it is
+     *  joined by the next start() or by the destructor.
+     */
+
+    pthread_t m_thread;
+    std::atomic<bool> m_joinable;
+    std::atomic<bool> m_running;
+    std::atomic<unsigned long> m_overruns;
+
+    /**
+     *  If above 0, the SCHED_FIFO priority of the thread.
+     */
+
+    static int sm_rt_priority;
+
+public:
+
+    static midi_alsa_input & instance ();
+
+    static void rt_priority (int p)
+    {
+        sm_rt_priority = p;
+    }
+
+    static int rt_priority ()
+    {
+        return sm_rt_priority;
+    }
+
+    bool add
+    (
+        snd_seq_t * client, int port,
+        rtmidi_in_data * indata, midi_alsa_data * apidata,
+        midi::portwatch * watch = nullptr
+    );
+    bool remove (snd_seq_t * client, int port);
+    int port_count ();
+    unsigned long received (snd_seq_t * client, int port);
+
+    bool running () const
+    {
+        return m_running;
+    }
+
+    unsigned long overruns () const
+    {
+        return m_overruns;
+    }
+
+private:
+
+    midi_alsa_input ();
+    ~midi_alsa_input ();
+
+    bool start ();
+    void stop ();
+    void wake ();
+    bool in_service_thread () const;
+    void rebuild ();
+    void drain (std::unique_lock<std::mutex> & lock, snd_seq_t * client);
+    bool prepare (listener & lr, const snd_seq_event_t * ev);
+    void deliver (rtmidi_in_data * rtidata);
+    void announce (listener & lr, const snd_seq_event_t * ev);
+    bool decode (const snd_seq_event_t * ev, midi::message & msg);
+    listener * find (snd_seq_t * client, int port);
+    void service ();
+
+    static void * service_thread (void * self);
+
+};          // class midi_alsa_input
+
+}           // namespace rtl
+
+#endif      // RTL66_BUILD_ALSA
+
+#endif      // RTL66_RTL_MIDI_ALSA_INPUT_HPP
+
+/*
+ * midi_alsa_input.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
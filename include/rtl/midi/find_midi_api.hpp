@@ -28,9 +28,13 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2022-07-23
- * \updates       2024-05-26
+ * \updates       2026-10-18
  * \license       See above.
  *
+ *  Finding an API is done by a cheap probe of each API, whose result is
+ *  cached.  A probe that has to open a client (JACK, ALSA) does not close
+ *  it, but parks it here, so that the first port or engine opened with the
+ *  same API adopts the handle instead of opening a second client.
  */
 
 #include "rtl/midi/midi_api.hpp"
@@ -51,6 +55,33 @@ extern midi_api * try_open_midi_api
     std::string clientname  = "",
     unsigned qsize          = 0
 );
+extern bool probe_midi_api
+(
+    rtmidi::api rapi,
+    const std::string & clientname = ""
+);
+extern void reset_midi_api_probes ();
+
+/*
+ * Parking of the client handle opened by a probe.  The closer is called on
+ * a handle that is never adopted.
+ */
+
+using client_closer = void (*) (void *);
+
+extern void park_client_handle
+(
+    rtmidi::api rapi,
+    void * handle,
+    const std::string & clientname,
+    client_closer closer
+);
+extern void * adopt_client_handle
+(
+    rtmidi::api rapi,
+    const std::string & clientname = ""
+);
+extern void release_client_handles ();
 
 }           // namespace rtl
 
@@ -27,7 +27,7 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2022-06-07
- * \updates       2025-01-20
+ * \updates       2026-10-18
  * \license       See above.
  *
  */
@@ -219,6 +219,7 @@ protected:
 
     void delete_port ();
     bool create_ringbuffer (size_t rbsize);
+    int enumerate_ports (midi::ports * inports, midi::ports * outports);
 
     /*--------------------------------------------------------------------
      * Extensions
@@ -228,7 +229,12 @@ protected:
     (
         midi::ports & inputports, bool preclear = true
     ) override;
+    virtual int get_all_io_port_info
+    (
+        midi::ports & inports, midi::ports & outports
+    ) override;
     virtual std::string get_port_alias (const std::string & name) override;
+    virtual long get_port_latency () override;
 
 #if defined RTL66_MIDI_EXTENSIONS       // defined in Linux, FIXME
 
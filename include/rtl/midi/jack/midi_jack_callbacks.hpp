@@ -27,7 +27,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2022-12-11
- * \updates       2023-03-15
+ * \updates       2026-10-18
  * \license       See above.
  *
  */
@@ -95,6 +95,11 @@ extern void jack_port_register_callback
 );
 #endif
 
+extern void jack_port_watch_callback
+(
+    jack_port_id_t portid, int regv, void * arg
+);
+
 #if defined RTL66_JACK_PORT_CONNECT_CALLBACK
 extern void jack_port_connect_callback
 (
@@ -28,7 +28,7 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2022-06-07
- * \updates       2024-06-09
+ * \updates       2026-10-18
  * \license       See above.
  *
  *      This class is mostly similar to the original RtMidi MidiApi class, but
@@ -347,6 +347,20 @@ protected:
         midi::ports & portsout, bool preclear = true
     ) = 0;
 
+    /*
+     * Fills both port lists with one enumeration.  Returns -1 if the API
+     * does not support it, in which case get_io_port_info() is used once
+     * for each direction.
+     */
+
+    virtual int get_all_io_port_info
+    (
+        midi::ports & /*inports*/, midi::ports & /*outports*/
+    )
+    {
+        return (-1);
+    }
+
     /*
      * Gets an alternate name for the port. Currently supported only in some
      * versions of JACK.
@@ -357,6 +371,16 @@ protected:
         return std::string("");
     }
 
+    /*
+     * Gets the output latency of the open port, in microseconds, or -1 if
+     * the API cannot tell.  Currently supported only by JACK.
+     */
+
+    virtual long get_port_latency ()
+    {
+        return -1;
+    }
+
 #if defined RTL66_MIDI_EXTENSIONS       // defined in Linux, FIXME
 
     /*
@@ -28,7 +28,7 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2022-06-07
- * \updates       2025-01-30
+ * \updates       2026-10-18
  * \license       See above.
  *
  *      Also contains some additional capabilities.
@@ -264,6 +264,7 @@ public:
     (
         midi::ports & inputports, bool preclear = true
     );
+    int get_all_io_port_info (midi::ports & inports, midi::ports & outports);
 
 #if defined RTL66_MIDI_EXTENSIONS       // defined in Linux, FIXME
 
@@ -394,6 +395,10 @@ extern bool detect_pipewire ();
  */
 
 extern bool detect_jack (bool forcecheck);          /* = false */
+extern bool probe_jack
+(
+    const std::string & clientname, int timeoutms, bool & timedout
+);
 extern void silence_jack_errors (bool silent);
 extern void silence_jack_info (bool silent);
 extern void silence_jack_messages (bool silent);
@@ -401,6 +406,7 @@ extern void silence_jack_messages (bool silent);
 
 #if defined RTL66_BUILD_ALSA
 extern bool detect_alsa (bool checkports);
+extern bool probe_alsa (const std::string & clientname);
 #endif
 
 #if defined RTL66_BUILD_MACOSX_CORE
@@ -27,7 +27,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2022-06-30
- * \updates       2024-05-26
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  Note that these functions are not in a namespace so that most of them
@@ -61,6 +61,7 @@ extern bool rt_test_port_valid (int port);
 extern void set_test_data_length (int len);
 extern int rt_test_data_length ();
 extern bool rt_show_help ();
+extern bool rt_test_check (bool condition, const std::string & what);
 
 #endif      // defined __cplusplus
 
@@ -0,0 +1,177 @@
+#if ! defined RTL66_CHANGES_HPP
+#define RTL66_CHANGES_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          changes.hpp
+ *
+ *  This module declares a board of change epochs for the slots of a
+ *  screen-set.
+ *
+ * \library       rtl66 library
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  The dirty flags of a sequence (is_dirty_main() and friends) are cleared
+ *  when read, so when the GUI, the control-output, and NSM all poll them,
+ *  only one of them sees a given change.  Epochs are counters that only
+ *  ever go up.  A writer bumps the epoch of a slot, then the epoch of the
+ *  whole set.  Each consumer keeps its own changes::cursor, a copy of the
+ *  epochs it last saw, so reading does not disturb any other consumer, and
+ *  an unchanged set costs one comparison.
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <cstdint>                      /* std::uint64_t                    */
+#include <memory>                       /* std::unique_ptr<>                */
+#include <vector>                       /* std::vector<>                    */
+
+namespace seq66
+{
+
+/**
+ *  Holds the change epochs of the slots of one screen-set.
+ */
+
+class changes
+{
+
+public:
+
+    /**
+     *  An epoch value.  Zero means "never changed".
+     */
+
+    using epoch = std::uint64_t;
+
+    /**
+     *  The categories of change tracked by each sequence.  They match
+     *  the dirty flags of the sequence.
+     */
+
+    enum class kind
+    {
+        main,
+        edit,
+        perf,
+        names,
+        max
+    };
+
+    /**
+     *  The per-consumer view of a board.  A default cursor has seen
+     *  nothing, so the first poll reports every slot that has ever changed.
+     */
+
+    class cursor
+    {
+        friend class changes;
+
+    private:
+
+        epoch m_set_epoch;
+        std::vector<epoch> m_slot_epochs;
+
+    public:
+
+        cursor () : m_set_epoch (0), m_slot_epochs ()
+        {
+            // no code
+        }
+
+    };
+
+    /**
+     *  A board and a slot on it.  A pattern holds these as one unit, so
+     *  that a bump can never pair the board of one set with the slot
+     *  number from another while the pattern is being moved.
+     */
+
+    struct link
+    {
+        std::shared_ptr<changes> l_board;
+        int l_slot;
+
+        link (const std::shared_ptr<changes> & board, int slot) :
+            l_board (board),
+            l_slot  (slot)
+        {
+            // no code
+        }
+    };
+
+private:
+
+    /**
+     *  The number of slots in the set.
+     */
+
+    int m_slot_count;
+
+    /**
+     *  The sum of all slot bumps.  Bumped after the slot epoch, so a
+     *  consumer that sees the new set epoch also sees the slot change.
+     */
+
+    std::atomic<epoch> m_set_epoch;
+
+    /**
+     *  One epoch per slot.  An array, since std::atomic cannot live in a
+     *  std::vector that is resized or copied.
+     */
+
+    std::unique_ptr<std::atomic<epoch> []> m_slot_epochs;
+
+public:
+
+    changes (int slotcount = 0);
+    changes (const changes &) = delete;
+    changes & operator = (const changes &) = delete;
+    ~changes () = default;
+
+    int slot_count () const
+    {
+        return m_slot_count;
+    }
+
+    epoch set_epoch () const
+    {
+        return m_set_epoch.load(std::memory_order_acquire);
+    }
+
+    epoch slot_epoch (int slot) const;
+    void bump (int slot);
+    void bump_all ();
+    bool changed (const cursor & c) const;
+    bool changed_since (cursor & c, std::vector<bool> & bitmap) const;
+
+};          // class changes
+
+}           // namespace seq66
+
+#endif      // RTL66_CHANGES_HPP
+
+/*
+ * changes.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
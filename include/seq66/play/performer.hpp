@@ -50,6 +50,7 @@
 
 #include "cfg/rcsettings.hpp"           /* lots of other files, see banner  */
 #include "ctrl/opcontainer.hpp"         /* class seq66::opcontainer         */
+#include "midi/inputlog.hpp"            /* midi::inputlog capture/replay    */
 #include "midi/jack_assistant.hpp"      /* optional seq66::jack_assistant   */
 #include "midi/mastermidibus.hpp"       /* seq66::mastermidibus ALSA/JACK   */
 #include "play/metro.hpp"               /* seq66::metro metronome pattern   */
@@ -812,6 +813,14 @@ private:                            /* key, midi, and op container section  */
 
     std::unique_ptr<mastermidibus> m_master_bus;
 
+    /**
+     *  Optionally records every event read by poll_cycle(), with its bus and
+     *  arrival time, so that a session can be replayed deterministically
+     *  via replay_input().  Idle unless start_input_capture() is called.
+     */
+
+    midi::inputlog m_input_capture;
+
     /**
      *  Provides storage for this "rc" configuration option so that the
      *  performer can set it in the master buss once that has been created.
@@ -2612,7 +2621,11 @@ public:
     void stop_playing (bool rewind = false);
     void group_learn (bool flag);
     void group_learn_complete (const keystroke & k, bool good = true);
-    bool needs_update (seq::number seqno = seq::all()) const;
+    bool needs_update
+    (
+        setmapper::update_cursor & c,
+        seq::number seqno = seq::all()
+    ) const;
 
     midi::pulse get_tick () const
     {
@@ -2900,6 +2913,7 @@ public:
     midi::pulse get_max_extent () const;
     std::string duration (bool dur = true) const;
     int count_exportable () const;
+    midi::memusage memory_usage () const;
     bool convert_to_smf_0 (bool remove_old = true);
 
     /**
@@ -3549,6 +3563,20 @@ public:                                 /* access functions for the containers *
         return mutes().reset_defaults();
     }
 
+    bool start_input_capture (const std::string & filename);
+    void stop_input_capture ();
+    bool replay_input
+    (
+        const std::string & filename,
+        bool realtime,
+        std::string & report
+    );
+
+    bool input_capturing () const
+    {
+        return m_input_capture.capturing();
+    }
+
 private:
 
     void clear_snapshot ()
@@ -3576,8 +3604,10 @@ private:
     void output_func ();
     void input_func ();
     bool poll_cycle ();
+    bool handle_input_event (midi::event & ev);
     void launch_input_thread ();
     void launch_output_thread ();
+    void apply_output_latencies ();
     void midi_start ();
     void midi_continue ();
     void midi_stop ();
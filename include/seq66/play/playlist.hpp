@@ -38,6 +38,7 @@
 #include <map>                          /* std::map<>                       */
 
 #include "cfg/basesettings.hpp"         /* seq66::basesettings class        */
+#include "midi/memusage.hpp"            /* midi::memusage accounting        */
 
 namespace seq66
 {
@@ -475,6 +476,7 @@ public:
 public:
 
     void clear ();
+    void memory_usage (midi::memusage & mu) const;
     bool reset_list (int listindex = 0, bool clearit = false);
     bool copy_songs (const std::string & destination);
     bool add_list
@@ -103,6 +103,7 @@ public:
         std::string io_alias;       /**< FYI only, and only for JACK.       */
         int io_client_number;       /**< The system client number.          */
         int io_port_number;         /**< The system port number.            */
+        long io_latency_us;         /**< Output latency, 0 if not set.      */
     };
 
 protected:
@@ -150,6 +151,7 @@ public:
         int & portstatus,
         std::string & portname
     );
+    static long parse_port_latency (const std::string & line);
     static bool valid (const io & item);
 
     void match_system_to_map (portslist & destination) const;
@@ -193,6 +195,8 @@ public:
     void set_nick_name (midi::bussbyte bus, const std::string & name);
 #endif
     void set_alias (midi::bussbyte bus, const std::string & name);
+    void set_latency (midi::bussbyte bus, long us);
+    long get_latency (midi::bussbyte bus) const;
     std::string get_name (midi::bussbyte bus) const;
     std::string get_pair_name (midi::bussbyte bus) const;
     std::string get_nick_name
@@ -247,7 +251,8 @@ protected:
         int portnumber,
         int mstatus,
         const std::string & portname,
-        const std::string & portalias = ""
+        const std::string & portalias = "",
+        long latency = 0
     ) const;
     bool add
     (
@@ -42,8 +42,10 @@
  */
 
 #include <functional>                   /* std::function, function objects  */
+#include <memory>                       /* std::shared_ptr<>                */
 #include <vector>                       /* std::vector<>                    */
 
+#include "play/changes.hpp"             /* seq66::changes epoch board       */
 #include "play/seq.hpp"                 /* seq66::seq extension class       */
 
 namespace seq66
@@ -253,6 +255,15 @@ private:
 
     mutable seq::number m_sequence_high;
 
+    /**
+     *  The change epochs of the slots in this set.  The patterns in the set
+     *  bump it via sequence::set_dirty() and friends.  A shared pointer,
+     *  since screensets are copied and moved around by the setmapper, and
+     *  the patterns hold a reference, too.
+     */
+
+    std::shared_ptr<changes> m_changes;
+
 public:
 
     screenset () = delete;
@@ -471,7 +482,22 @@ public:
         bool global = false
     ) const;
     bool index_to_grid (seq::number seqno, int & row, int & column) const;
-    bool needs_update () const;
+    bool needs_update (changes::epoch & seen) const;
+
+    const std::shared_ptr<changes> & change_board () const
+    {
+        return m_changes;
+    }
+
+    bool changed (const changes::cursor & c) const
+    {
+        return m_changes->changed(c);
+    }
+
+    bool changed_slots (changes::cursor & c, std::vector<bool> & bitmap) const
+    {
+        return m_changes->changed_since(c, bitmap);
+    }
 
     /*
      * exec_set_function(s, index) runs a set-handler with the two arguments.
@@ -563,6 +589,9 @@ private:
     void save_queued (seq::number repseq); // save_current_screenset ()
     void unqueue (seq::number hotseq);
     void clear ();
+    void memory_usage (midi::memusage & mu) const;
+    int make_cold ();
+    int make_warm ();
     void initialize (int rows, int columns);
     std::string to_string (bool showseqs = true, int limit = 0) const;
     void show (bool showseqs = true) const;
@@ -39,13 +39,18 @@
  */
 
 #include <atomic>                       /* std::atomic<bool> for dirt       */
-#include <stack>                        /* std::stack<midi::eventlist>      */
+#include <cstdint>                      /* std::uint64_t                    */
+#include <limits>                       /* std::numeric_limits<>            */
 #include <string>                       /* std::string                      */
 
 #include "rtl66_features.hpp"           /* various feature #defines         */
 #include "cfg/usrsettings.hpp"          /* enum class record                */
 #include "midi/calculations.hpp"        /* seq66::lengthfix, alteration     */
+#include "midi/coldlist.hpp"            /* midi::coldlist, eventlist        */
 #include "midi/eventlist.hpp"           /* midi::eventlist                  */
+#include "midi/notetracker.hpp"         /* midi::notetracker                */
+#include "midi/undostack.hpp"           /* midi::undostack                  */
+#include "play/changes.hpp"             /* seq66::changes epochs            */
 #include "play/triggers.hpp"            /* seq66::triggers, etc.            */
 #include "util/automutex.hpp"           /* xpc::recmutex, automutex         */
 
@@ -271,10 +276,11 @@ private:
 
     /**
      *  Provides a stack of event-lists for use with the undo and redo
-     *  facility.
+     *  facility.  Only the newest few are kept as live event-lists; older
+     *  ones are packed, and can be spilled to disk.  See midi::undostack.
      */
 
-    using eventstack = std::stack<midi::eventlist>;
+    using eventstack = midi::undostack;
 
 public:
 
@@ -332,6 +338,22 @@ private:
 
     static int sm_fingerprint_size;
 
+    /**
+     *  Bumped by any change that can alter when a pattern next needs to be
+     *  played (an edit, arming, queuing, a trigger change, a reposition).
+     *  The horizon scheduler in setmapper rebuilds its heap when it changes.
+     */
+
+    static std::atomic<std::uint64_t> sm_schedule_epoch;
+
+    /**
+     *  One past the tick of the last frame played by the horizon scheduler.
+     *  It is the m_last_tick value that a dormant pattern would have if it
+     *  had been played on every frame.
+     */
+
+    static std::atomic<midi::pulse> sm_frame_tick;
+
 private:
 
     /**
@@ -350,9 +372,22 @@ private:
      *  This list holds the current pattern/sequence events.  It used to be
      *  called m_list_events, but a map implementation is now available, and
      *  is the default.
+     *
+     *  It can be packed into cold storage (see midi::coldlist) when the
+     *  pattern is idle.  The event-list is then reachable only via
+     *  events(), which unpacks it first, so all code here uses events().
+     */
+
+    midi::coldlist m_events;
+
+    /**
+     *  Set by the horizon scheduler after playing the pattern.  While set,
+     *  the scheduler may skip the pattern on frames where it has nothing to
+     *  play, and last_tick() yields sm_frame_tick instead of m_last_tick.
+     *  Cleared by wake(), which brings m_last_tick up to date.
      */
 
-    midi::eventlist m_events;
+    std::atomic<bool> m_dormant;
 
     /**
      *  Holds the list of triggers associated with the sequence, used in the
@@ -482,11 +517,40 @@ private:
     mastermidibus * m_master_bus;
 
     /**
-     *  Provides a "map" for Note On events.  It is used when muting, to shut
-     *  off the notes that are playing.
+     *  Provides a "map" for Note On events, per output channel.  It is used
+     *  when muting, to shut off the notes that are playing.
      */
 
-    unsigned short m_playing_notes[c_notes_count];
+    midi::notetracker m_playing_notes;
+
+    /**
+     *  Holds the output settings of the pattern resolved ahead of time, so
+     *  that put_event_on_bus() can apply them to each event without
+     *  checking the bus, free-channel, and transposition settings.
+     *
+     *  -   om_bus.  A copy of m_true_bus.
+     *  -   om_transpose.  The transposition for which om_notes was built.
+     *  -   om_channels.  Maps the event's channel byte (including the
+     *      null channel) to the output channel.  For a free-channel pattern
+     *      this is the identity, otherwise every entry is m_midi_channel.
+     *  -   om_notes.  Maps each note to the transposed note.  Notes that
+     *      would go out of range are left alone, as in
+     *      event::transpose_note().
+     *
+     *  Rebuilt by update_output_map() when the bus or channel changes, and
+     *  by update_output_transpose() when the transposition of a frame
+     *  differs from the last one.
+     */
+
+    struct outputmap
+    {
+        midi::bussbyte om_bus;
+        int om_transpose;
+        midi::byte om_channels[256];
+        midi::byte om_notes[c_notes_count];
+    };
+
+    outputmap m_output_map;
 
     /**
      *  Indicates if the sequence was playing.  This value is set at the end
@@ -682,6 +746,24 @@ private:
 
     mutable std::atomic<bool> m_dirty_names;
 
+    /**
+     *  Change epochs, one per dirty flag, indexed by changes::kind.  Unlike
+     *  the dirty flags, these are never cleared by a reader; each consumer
+     *  compares them to the values it saw last.
+     */
+
+    std::atomic<changes::epoch> m_change_epochs[int(changes::kind::max)];
+
+    /**
+     *  The change board of the screen-set holding this pattern, and the
+     *  slot of the pattern in that set, published together.  Set by
+     *  screenset::add() and cleared by screenset::remove().  Accessed with
+     *  std::atomic_load() and std::atomic_store(), since the performer
+     *  thread bumps it.
+     */
+
+    std::shared_ptr<const changes::link> m_change_link;
+
     /**
      *  Indicates the pattern was modified.  Unlike the is_dirty_xxx flags,
      *  this one is not reset when checked.  Useful when closing a file or the
@@ -960,27 +1042,35 @@ public:
 
     midi::eventlist & events ()
     {
-        return m_events;
+        return m_events.events();
     }
 
     const midi::eventlist & events () const
     {
-        return m_events;
+        return m_events.events();
+    }
+
+    bool make_cold ();
+    bool make_warm ();
+
+    bool is_cold () const
+    {
+        return m_events.is_cold();
     }
 
     bool any_selected_notes () const
     {
-        return m_events.any_selected_notes();
+        return events().any_selected_notes();
     }
 
     bool any_selected_events () const
     {
-        return m_events.any_selected_events();
+        return events().any_selected_events();
     }
 
     bool any_selected_events (midi::byte status, midi::byte cc) const
     {
-        return m_events.any_selected_events(status, cc);
+        return events().any_selected_events(status, cc);
     }
 
     bool is_exportable () const
@@ -988,6 +1078,9 @@ public:
         return ! get_song_mute() && trigger_count() > 0;
     }
 
+    void memory_usage (midi::memusage & mu) const;
+    static void clipboard_usage (midi::memusage & mu);
+
     const triggers::container & triggerlist () const
     {
         return m_triggers.triggerlist();
@@ -1288,6 +1381,9 @@ public:
 
     void seq_in_edit (bool edit)
     {
+        if (edit && is_cold())
+            (void) make_warm();
+
         m_seq_in_edit = edit;
     }
 
@@ -1328,7 +1424,7 @@ public:
 
     midi::pulse last_tick () const
     {
-        return m_last_tick;
+        return m_dormant ? sm_frame_tick.load() : m_last_tick ;
     }
 
     /**
@@ -1340,9 +1436,42 @@ public:
 
     midi::pulse mod_last_tick ()
     {
-        return (m_length > 1) ? (m_last_tick % m_length) : m_last_tick ;
+        midi::pulse lt = last_tick();
+        return (m_length > 1) ? (lt % m_length) : lt ;
+    }
+
+    /*
+     * Support for the horizon scheduler of setmapper.
+     */
+
+    static std::uint64_t schedule_epoch ()
+    {
+        return sm_schedule_epoch.load();
+    }
+
+    static void reschedule ()
+    {
+        (void) sm_schedule_epoch.fetch_add(1);
     }
 
+    static void frame_done (midi::pulse tick)
+    {
+        sm_frame_tick.store(tick + 1);
+    }
+
+    static midi::pulse never_due ()
+    {
+        return std::numeric_limits<midi::pulse>::max();
+    }
+
+    void doze ()
+    {
+        m_dormant = true;
+    }
+
+    void wake ();
+    midi::pulse next_due (midi::pulse tick, bool songmode);
+
     /*
      * Documented at the definition point in the cpp module.
      */
@@ -1557,6 +1686,12 @@ public:
     bool is_dirty_names () const;
     void set_dirty_mp ();
     void set_dirty ();
+    void change_board (const std::shared_ptr<changes> & board, int slot);
+
+    changes::epoch change_epoch (changes::kind k) const
+    {
+        return m_change_epochs[int(k)].load(std::memory_order_acquire);
+    }
     std::string channel_string () const;            /* "F" or "<channel+1>" */
     bool set_channels (int channel);                /* modifies event list  */
 
@@ -1862,12 +1997,12 @@ public:
 
     event::buffer::const_iterator cbegin () const
     {
-        return m_events.cbegin();
+        return events().cbegin();
     }
 
     bool cend (event::buffer::const_iterator & evi) const
     {
-        return evi == m_events.cend();
+        return evi == events().cend();
     }
 
     bool reset_interval
@@ -1998,6 +2133,7 @@ protected:
     void free_channel (bool flag)
     {
         m_free_channel = flag;
+        update_output_map();
     }
 
 private:
@@ -2020,7 +2156,12 @@ private:
     bool quantize_events (midi::byte status, midi::byte cc, int divide);
     bool quantize_notes (int divide);
     bool change_ppqn (int p);
-    void put_event_on_bus (const event & ev);
+    bool put_event_on_bus
+    (
+        const event & ev, bool transpose = true, bool flush = true
+    );
+    void update_output_map ();
+    void update_output_transpose (int transpose);
     void reset_loop ();
     void set_trigger_offset (midi::pulse trigger_offset);
     void adjust_trigger_offsets_to_length (midi::pulse newlen);
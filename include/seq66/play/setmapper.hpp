@@ -42,6 +42,11 @@
  *  allowed in a given run of the application.
  */
 
+#include <cstdint>                      /* std::uint64_t                    */
+#include <map>                          /* std::map<>                       */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/duequeue.hpp"            /* midi::duequeue<> template        */
 #include "play/mutegroups.hpp"          /* seq66::mutegroups & mutegroup    */
 #include "play/setmaster.hpp"           /* seq66::seqmanager and seqstatus  */
 
@@ -57,6 +62,42 @@ class setmapper
 {
     friend class performer;             /* a very good friend to have   */
 
+public:
+
+    /**
+     *  A consumer's record of the set epochs it saw last.  See
+     *  needs_update().
+     */
+
+    using update_cursor = std::map<screenset::number, changes::epoch>;
+
+    /**
+     *  Selects how patterns outside the playing set use cold storage (see
+     *  sequence::make_cold()).
+     *
+     *  -   off.  All patterns stay unpacked.
+     *  -   lazy.  Idle patterns in other sets are packed when the play-screen
+     *      changes.  A set is unpacked when it is selected, or earlier if
+     *      prepare_screenset() is called when it is queued.
+     *  -   eager.  Like lazy, but the sets on either side of the play-screen
+     *      are also kept unpacked, so that a next/previous set change never
+     *      waits on an unpack.
+     */
+
+    enum class coldstorage
+    {
+        off,
+        lazy,
+        eager
+    };
+
+    /**
+     *  Counters for comparing the horizon scheduler of play_all_sets() with
+     *  a full sweep of every pattern on every frame.  See midi::duestats.
+     */
+
+    using horizonstats = midi::duestats;
+
 private:
 
     /**
@@ -164,6 +205,39 @@ private:
 
     midi::booleans m_tracks_mute_state;
 
+    /**
+     *  The cold-storage policy.  Off by default.
+     */
+
+    coldstorage m_cold_storage;
+
+    /**
+     *  If true, play_all_sets() plays only the patterns whose next-due tick
+     *  falls in the current frame.  See sequence::next_due().  Off by
+     *  default, until the next-due ticks have had more field use; a full
+     *  sweep is always correct.
+     */
+
+    bool m_horizon_enabled;
+
+    /**
+     *  The patterns with a next-due tick.  Patterns that are never due are
+     *  not in it until the next rebuild.
+     */
+
+    midi::duequeue<sequence> m_horizon;
+
+    /**
+     *  The sequence::schedule_epoch() when the queue was built.  Any change
+     *  to it, a move back in time, or a change of playback mode, rebuilds
+     *  the queue and plays every pattern once.
+     */
+
+    std::uint64_t m_horizon_epoch;
+    midi::pulse m_horizon_tick;
+    bool m_horizon_songmode;
+    bool m_horizon_valid;
+
 public:
 
     setmapper () = delete;
@@ -287,6 +361,7 @@ private:
         master().clear();
         m_sequence_count = 0;
         m_sequence_high = m_edit_sequence = seq::unassigned();
+        m_horizon_valid = false;
     }
 
     int sequence_count () const
@@ -344,6 +419,7 @@ private:
 
     bool is_seq_in_edit (seq::number seqno) const;
     bool reset ();
+    midi::memusage memory_usage () const;
 
 #if defined RTL66_USE_SCREENSET_RESET_SEQUENCES     /* currently unused */
     void reset_sequences (bool pause, sequence::playback mode)
@@ -358,6 +434,27 @@ private:
         midi::pulse tick, sequence::playback mode, bool resumenoteons
     );
 
+    void horizon_scheduling (bool flag)
+    {
+        m_horizon_enabled = flag;
+        m_horizon_valid = false;
+    }
+
+    bool horizon_scheduling () const
+    {
+        return m_horizon_enabled;
+    }
+
+    const horizonstats & horizon_stats () const
+    {
+        return m_horizon.stats();
+    }
+
+    void reset_horizon_stats ()
+    {
+        m_horizon.reset_stats();
+    }
+
     seq::number sequence_high () const
     {
         return m_sequence_high;
@@ -539,17 +636,29 @@ private:
     }
 
     /**
-     *  Perhaps we need to check ONLY the play_screen()!!!
+     *  Checks all sets against the epochs the caller saw last, and updates
+     *  them all, so no change is reported twice.  A set the caller has
+     *  not seen yet counts as changed.  Perhaps we need to check ONLY the
+     *  play_screen()!!!
      */
 
-    bool needs_update () const
+    bool needs_update (update_cursor & c) const
     {
+        bool result = false;
         for (const auto & sset : sets())
         {
-            if (sset.second.needs_update())
-                return true;
+            auto ci = c.find(sset.first);
+            if (ci == c.end())
+            {
+                changes::epoch seen = 0;
+                (void) sset.second.needs_update(seen);
+                c[sset.first] = seen;
+                result = true;
+            }
+            else if (sset.second.needs_update(ci->second))
+                result = true;
         }
-        return false;
+        return result;
     }
 
     /*
@@ -820,6 +929,13 @@ public:
 
     bool set_playscreen (screenset::number setno);
     bool set_playing_screenset (screenset::number setno);
+    int prepare_screenset (screenset::number setno);
+    void cold_storage (coldstorage cs);
+
+    coldstorage cold_storage () const
+    {
+        return m_cold_storage;
+    }
     bool copy_screenset (screenset::number srcset, screenset::number destset);
     bool save_screenset (screenset::number srcset);
     bool paste_screenset (screenset::number destset);
@@ -935,6 +1051,8 @@ private:
     bool add_to_play_set (playset & p, screenset & s);
     bool add_all_sets_to_play_set (playset & p);
     void recount_sequences ();
+    void update_cold_storage ();
+    void rebuild_horizon (midi::pulse tick);
 
     setmaster::container::iterator add_set (screenset::number setno)
     {
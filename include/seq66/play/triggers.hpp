@@ -35,10 +35,11 @@
  *  a bit easier to understand.
  */
 
+#include <deque>
 #include <string>
-#include <stack>
 #include <vector>
 
+#include "midi/memusage.hpp"            /* midi::memusage accounting        */
 #include "midi/midibytes.hpp"           /* midi::pulse alias, etc.          */
 
 namespace seq66
@@ -349,10 +350,18 @@ private:
 
     /**
      *  Provides a stack for use with the undo/redo features of the
-     *  trigger support.
+     *  trigger support.  A deque is used, rather than std::stack, so that
+     *  the oldest entries can be dropped when the depth limit is reached.
      */
 
-    using stack = std::stack<container>;
+    using stack = std::deque<container>;
+
+    /**
+     *  The maximum number of trigger lists kept in each of the undo and
+     *  redo stacks.
+     */
+
+    static const int c_undo_depth = 256;
 
 private:
 
@@ -481,6 +490,7 @@ public:
 
     int datasize (midi::ulong seqspec) const;
     bool any_transposed () const;
+    void memory_usage (midi::memusage & mu) const;
 
     int number_selected () const
     {
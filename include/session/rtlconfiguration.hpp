@@ -28,7 +28,7 @@
  * \library       rtl66 application
  * \author        Chris Ahlstrom
  * \date          2020-05-30
- * \updates       2024-01-15
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This class provides a process for starting, running, restarting, and
@@ -37,6 +37,7 @@
  *  devices in the system changes.
  */
 
+#include <cstddef>                      /* std::size_t                      */
 #include <memory>                       /* std::shared_ptr<>, unique_ptr<>  */
 #include <string>                       /* std::string                      */
 
@@ -93,6 +94,28 @@ private:
 
     bool m_load_midi_file;
 
+    /**
+     *  The memory budget, in bytes, for the packed pattern-undo snapshots
+     *  of all patterns.  Beyond it, the oldest are spilled to a temporary
+     *  file.  Zero disables spilling.  See midi::undostack.
+     */
+
+    std::size_t m_undo_budget;
+
+    /**
+     *  The maximum number of undo snapshots per pattern.  Zero means no
+     *  limit.
+     */
+
+    int m_undo_depth;
+
+    /**
+     *  The shared-memory name of the observer feed (see midi::eventfeed),
+     *  such as "/rtl66-feed".  Empty, the default, leaves the feed off.
+     */
+
+    std::string m_event_feed;
+
 public:
 
     rtlconfiguration (const std::string & caps = "");
@@ -138,6 +161,21 @@ public:
         return m_midi_filename;
     }
 
+    std::size_t undo_budget () const
+    {
+        return m_undo_budget;
+    }
+
+    int undo_depth () const
+    {
+        return m_undo_depth;
+    }
+
+    const std::string & event_feed () const
+    {
+        return m_event_feed;
+    }
+
 protected:
 
     void load_midi_file (bool flag)
@@ -155,6 +193,21 @@ protected:
         m_midi_filename = f;
     }
 
+    void undo_budget (std::size_t b)
+    {
+        m_undo_budget = b;
+    }
+
+    void undo_depth (int d)
+    {
+        m_undo_depth = d > 0 ? d : 0 ;
+    }
+
+    void event_feed (const std::string & name)
+    {
+        m_event_feed = name;
+    }
+
 };          // class rtlconfiguration
 
 }           // namespace session
@@ -28,7 +28,7 @@
  * \library       rtl66 application
  * \author        Chris Ahlstrom
  * \date          2020-05-30
- * \updates       2023-01-01
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This class provides a process for starting, running, restarting, and
@@ -177,6 +177,7 @@ public:
     virtual bool settings (int argc, char * argv []) override;
     virtual bool create_player ();
     virtual std::string open_midi_file (const std::string & fname);
+    virtual bool reload_configuration (const std::string & filename);
     virtual bool run () override
     {
         return false;               // TODO???
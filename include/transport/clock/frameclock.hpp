@@ -0,0 +1,168 @@
+#if ! defined RTL66_TRANSPORT_CLOCK_FRAMECLOCK_HPP
+#define RTL66_TRANSPORT_CLOCK_FRAMECLOCK_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          transport/clock/frameclock.hpp
+ *
+ *    A clock that counts audio frames, shared by audio and MIDI.
+ *
+ * \library       rtl66 application
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  The audio stream advances the clock by one buffer of frames per
+ *  callback.  The count is a 64-bit integer, so it never drifts; seconds
+ *  and MIDI ticks are computed from it when asked for, not accumulated.
+ *  Ticks use the tempo in force, which is anchored at the frame where it
+ *  was set, so a tempo change does not move the ticks already passed.
+ *
+ *  The audio thread only calls advance(), which touches nothing but an
+ *  atomic count.  The tempo and the conversions are for the MIDI side, and
+ *  take a mutex.
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <cstdint>                      /* std::uint64_t                    */
+#include <mutex>                        /* std::mutex                       */
+
+#include "midi/midibytes.hpp"           /* midi::bpm, ppqn, and pulse       */
+
+namespace transport
+{
+
+namespace clock
+{
+
+/**
+ *  Counts audio frames and converts them to time and ticks.
+ */
+
+class frameclock
+{
+
+public:
+
+    using frame = std::uint64_t;
+
+private:
+
+    /**
+     *  The frames counted since the last reset().  Only the audio side
+     *  stores it.
+     */
+
+    std::atomic<frame> m_frames;
+
+    /**
+     *  The sample rate, and whether an audio stream is driving the clock.
+     */
+
+    std::atomic<unsigned> m_sample_rate;
+    std::atomic<bool> m_active;
+
+    /**
+     *  The tempo in force and where it took effect: the frame and the tick
+     *  (fractional) at that frame.  Guarded by m_tempo_mutex.
+     */
+
+    mutable std::mutex m_tempo_mutex;
+    midi::bpm m_bpm;
+    midi::ppqn m_ppqn;
+    frame m_anchor_frame;
+    double m_anchor_tick;
+
+public:
+
+    frameclock (unsigned samplerate = 0);
+    frameclock (const frameclock &) = delete;
+    frameclock & operator = (const frameclock &) = delete;
+
+    void reset (frame f = 0);
+    void tempo (midi::bpm bp, midi::ppqn ppq);
+
+    /**
+     *  Called by the audio side once per buffer.
+     */
+
+    void advance (unsigned nframes)
+    {
+        m_frames.fetch_add(nframes, std::memory_order_release);
+    }
+
+    frame frames () const
+    {
+        return m_frames.load(std::memory_order_acquire);
+    }
+
+    unsigned sample_rate () const
+    {
+        return m_sample_rate;
+    }
+
+    void sample_rate (unsigned sr)
+    {
+        m_sample_rate = sr;
+    }
+
+    bool active () const
+    {
+        return m_active && m_sample_rate > 0;
+    }
+
+    void active (bool flag)
+    {
+        m_active = flag;
+    }
+
+    double seconds () const
+    {
+        return seconds_at(frames());
+    }
+
+    double ticks () const
+    {
+        return ticks_at(frames());
+    }
+
+    midi::pulse pulse () const
+    {
+        return midi::pulse(ticks());
+    }
+
+    double seconds_at (frame f) const;
+    double ticks_at (frame f) const;
+    frame frame_of (midi::pulse tick) const;
+
+};          // class frameclock
+
+}           // namespace clock
+
+}           // namespace transport
+
+#endif      // RTL66_TRANSPORT_CLOCK_FRAMECLOCK_HPP
+
+/*
+ * transport/clock/frameclock.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,213 @@
+#if ! defined RTL66_TRANSPORT_CLOCK_MTC_HPP
+#define RTL66_TRANSPORT_CLOCK_MTC_HPP
+
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          transport/clock/mtc.hpp
+ *
+ *    MIDI Time Code: a quarter-frame generator and a follower.
+ *
+ * \library       rtl66 application
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Positions are in seconds from 00:00:00:00.  A frame count is the number
+ *  of real frames from there, so at 29.97 drop-frame it differs from the
+ *  number shown in the timecode, which skips frames 0 and 1 at the start of
+ *  each minute except every tenth.
+ *
+ *  Eight quarter-frame messages (F1 0nnn dddd) carry one timecode, a
+ *  nibble each, over two frames; piece n is sent n/4 frame after the frame
+ *  encoded.  A full-frame SysEx (F0 7F 7F 01 01 hh mm ss ff F7) gives the
+ *  position at once, on a locate.
+ *
+ *  Neither class does any I/O, so both can be driven (and tested) offline.
+ *  The player sends the generator's messages and feeds the follower.
+ */
+
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/midibytes.hpp"           /* midi::byte, midi::bytes          */
+
+namespace transport
+{
+
+namespace clock
+{
+
+/**
+ *  The MTC frame rates, with the values of the rate bits.
+ */
+
+enum class mtc_rate
+{
+    fps_24          = 0,
+    fps_25          = 1,
+    fps_29_97_df    = 2,
+    fps_30          = 3
+};
+
+/**
+ *  A timecode as displayed.
+ */
+
+struct timecode
+{
+    int tc_hours;
+    int tc_minutes;
+    int tc_seconds;
+    int tc_frames;
+};
+
+extern double mtc_fps (mtc_rate r);
+extern long timecode_to_frames (const timecode & tc, mtc_rate r);
+extern timecode frames_to_timecode (long count, mtc_rate r);
+extern midi::bytes mtc_full_frame (const timecode & tc, mtc_rate r);
+
+/**
+ *  A quarter-frame message's data byte and when it is due.
+ */
+
+struct quarter_frame
+{
+    double qf_seconds;
+    midi::byte qf_data;
+};
+
+/**
+ *  Produces the quarter-frame messages for a position moving forward in
+ *  real time.
+ */
+
+class mtc_generator
+{
+
+private:
+
+    mtc_rate m_rate;
+
+    /**
+     *  The quarter frame to send next, counted from 00:00:00:00.  After a
+     *  locate it is a multiple of eight, so that piece 0 comes first.
+     */
+
+    long m_next_qf;
+
+public:
+
+    mtc_generator (mtc_rate r = mtc_rate::fps_25);
+
+    mtc_rate rate () const
+    {
+        return m_rate;
+    }
+
+    void rate (mtc_rate r)
+    {
+        m_rate = r;
+    }
+
+    midi::bytes locate (double seconds);
+    double next_seconds () const;
+    midi::byte next_data () const;
+    std::size_t quarter_frames (double until, std::vector<quarter_frame> & qf);
+
+};          // class mtc_generator
+
+/**
+ *  Rebuilds the position from incoming MTC.  Each quarter frame moves the
+ *  position a quarter frame in the direction the pieces are counting; a
+ *  completed set of eight gives the exact position.  The arrival times
+ *  jitter, so the position at a given time is estimated from a smoothed
+ *  line through the arrivals, and snaps only on a jump (a locate).
+ */
+
+class mtc_follower
+{
+
+private:
+
+    /**
+     *  The weight of each new arrival in the smoothed position.
+     */
+
+    double m_smoothing;
+
+    midi::byte m_nibbles [8];
+    int m_last_piece;
+    int m_run;                          /* pieces in order so far           */
+    int m_direction;                    /* +1, -1, or 0 if not moving       */
+    mtc_rate m_rate;
+    bool m_locked;
+
+    /**
+     *  The position (frames) of the last piece, from counting.
+     */
+
+    double m_frame_position;
+
+    /**
+     *  The smoothed position (seconds) at the time of the last arrival.
+     */
+
+    double m_estimate;
+    double m_estimate_time;
+
+public:
+
+    mtc_follower (double smoothing = 0.1);
+
+    void reset ();
+    bool receive_quarter_frame (midi::byte data, double seconds);
+    bool receive_full_frame (const midi::bytes & msg);
+
+    bool locked () const
+    {
+        return m_locked;
+    }
+
+    int direction () const
+    {
+        return m_direction;
+    }
+
+    mtc_rate rate () const
+    {
+        return m_rate;
+    }
+
+    double position (double seconds) const;
+    bool running (double seconds) const;
+
+};          // class mtc_follower
+
+}           // namespace clock
+
+}           // namespace transport
+
+#endif      // RTL66_TRANSPORT_CLOCK_MTC_HPP
+
+/*
+ * transport/clock/mtc.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
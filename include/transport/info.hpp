@@ -27,7 +27,7 @@
  * \library       rtl66 application
  * \author        Chris Ahlstrom
  * \date          2017-11-10
- * \updates       2024-05-30
+ * \updates       2026-10-18
  * \license       See above.
  */
 
@@ -310,6 +310,7 @@ public:
     }
 
     unsigned delta_time_ms (midi::pulse p) const;
+    int loop_wrap (double & tick) const;
 
     int clocks_per_metronome () const
     {
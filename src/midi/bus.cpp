@@ -25,7 +25,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2016-11-25
- * \updates       2024-06-12
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This file provides a cross-platform implementation of MIDI support.
@@ -55,6 +55,7 @@
 #include "rtl/midi/midi_api.hpp"        /* rtl::midi_api base class         */
 #include "midi/masterbus.hpp"           /* midi::masterbus class            */
 #include "midi/bus.hpp"                 /* midi::bus class                  */
+#include "midi/portwatch.hpp"           /* midi::portwatch::identity()      */
 #include "rtl/rterror.hpp"              /* rtl::rterror for null pointer    */
 
 namespace midi
@@ -142,7 +143,8 @@ bus::bus
     m_port_name         (), // (portname),
     m_port_alias        (), // (portalias),
     m_io_type           (io_type),
-    m_port_type         ()  // (porttype),
+    m_port_type         (), // (porttype),
+    m_latency_us        (0)
 {
     // no code (yet)
 }
@@ -382,6 +384,27 @@ bus::is_port_connectable () const
     return result;
 }
 
+/**
+ *  Asks the API for the port's output latency, and stores it if the API
+ *  knows it.  A configured latency is not overwritten by an unknown one.
+ *
+ * \return
+ *      Returns true if the API reported a latency.
+ */
+
+bool
+bus::query_latency ()
+{
+    bool result = not_nullptr(m_midi_api_ptr);
+    if (result)
+    {
+        long us = m_midi_api_ptr->get_port_latency();
+        result = us >= 0;
+        if (result)
+            latency_us(us);
+    }
+    return result;
+}
 
 /**
  *  Prints m_name.
@@ -450,6 +473,62 @@ bus::connect ()
     return result;
 }
 
+/**
+ *  Points the bus at a port that has come back, possibly with new numbers.
+ *  The bus is left inactive, so that the output thread skips it; the caller
+ *  activates it (see busarray::replugged()).  Not to be called on the
+ *  output thread, and the caller must see that nothing else is in the bus;
+ *  busarray::rebind() pauses the bus's output worker around this call.
+ *
+ *  If the API has the port open, the system port with the same identity
+ *  (see portwatch::identity()) is looked up and the port is re-opened to
+ *  it.  Otherwise only the numbers are changed.
+ *
+ * \param busid
+ *      The new buss (ALSA client) number, or -1 to leave it.
+ *
+ * \param portid
+ *      The new port number, or -1 to leave it.
+ *
+ * \return
+ *      Returns true if the port is open again.
+ */
+
+bool
+bus::rebind (int busid, int portid)
+{
+    bool result = true;
+    deactivate();
+    if (busid >= 0)
+        set_bus_id(busid);
+
+    if (portid >= 0)
+        set_port_id(portid);
+
+    rtl::midi_api * api = midi_api_ptr();
+    if (not_nullptr(api) && api->is_port_open())
+    {
+        std::string key = portwatch::identity(connect_name());
+        int index = -1;
+        int count = api->get_port_count();
+        for (int i = 0; i < count; ++i)
+        {
+            if (portwatch::identity(api->get_port_name(i)) == key)
+            {
+                index = i;
+                break;
+            }
+        }
+        result = index >= 0;
+        if (result)
+        {
+            (void) api->close_port();
+            result = api->open_port(index, port_name());
+        }
+    }
+    return result;
+}
+
 #if defined RTL66_SHOW_BUS_VALUES
 
 /**
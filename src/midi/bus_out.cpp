@@ -25,13 +25,14 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2022-07-23
- * \updates       2024-06-09
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  */
 
 #include "midi/bus_out.hpp"             /* midi::bus and midi::bus_out      */
 #include "midi/clientinfo.hpp"          /* midi::clientinfo class           */
+#include "midi/eventfeed.hpp"           /* midi::eventfeed observer feed    */
 #include "midi/masterbus.hpp"           /* midi::masterbus class            */
 #include "rtl/midi/midi_api.hpp"        /* rtl::rtmidi::midi_api            */
 
@@ -139,7 +140,8 @@ bus_out::init_clock (pulse tick)
 }
 
 /**
- *  For speed here, we do not check if the port is enabled.
+ *  For speed here, we do not check if the port is enabled.  If an event
+ *  feed is active, the event is also published to it; see eventfeed.
  */
 
 bool
@@ -147,8 +149,14 @@ bus_out::send_event (const event * e24, midi::byte channel)
 {
     bool result = not_nullptr(midi_api_ptr());
     if (result)
+    {
         midi_api_ptr()->send_event(e24, channel);
 
+        eventfeed::pin pinned;
+        eventfeed * ef = pinned.feed();
+        if (not_nullptr(ef))
+            ef->publish_event(bus_index(), channel, *e24);
+    }
     return result;
 }
 
@@ -157,8 +165,14 @@ bus_out::send_sysex (const event * e24)
 {
     bool result = not_nullptr(midi_api_ptr());
     if (result)
+    {
         midi_api_ptr()->send_sysex(e24);
 
+        eventfeed::pin pinned;
+        eventfeed * ef = pinned.feed();
+        if (not_nullptr(ef))
+            ef->publish_event(bus_index(), e24->channel(), *e24);
+    }
     return result;
 }
 
@@ -25,7 +25,7 @@
  * \library       rtl66 application
  * \author        Chris Ahlstrom
  * \date          2024-06-02
- * \updates       2024-06-12
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This file provides a base-class implementation for various master MIDI
@@ -50,7 +50,14 @@ namespace midi
  *  access than using arrays of booleans and pointers.
  */
 
-busarray::busarray () : m_container{}
+busarray::busarray () :
+    m_container             (),
+    m_workers               (),
+    m_worker_capacity       (1024),
+    m_compensate_latency    (false),
+    m_index                 (),
+    m_reindex               (false),
+    m_unplugged             ()
 {
     // Empty body
 }
@@ -66,7 +73,7 @@ busarray::busarray () : m_container{}
 
 busarray::~busarray ()
 {
-    // no need to explicity remove the unique_ptrs for busses.
+    m_workers.clear();                  /* workers stop before the busses   */
 }
 
 /**
@@ -77,6 +84,11 @@ busarray::~busarray ()
  *  configured clock settings for the output ports.  So initialization has
  *  been removed from the constructor and moved to the initialize() function.
  *
+ *  If asynchronous output is on, the new bus gets its worker right away,
+ *  so that m_workers stays indexed like m_container.  As the vectors may
+ *  grow, the same rule holds as for async_output(): no other thread may be
+ *  sending meanwhile.
+ *
  * \param b
  *      The midi::bus to be hooked into the array of busses.
  *
@@ -96,6 +108,13 @@ busarray::add (bus * b, clocking /*c*/ )        // FIXME
     {
         bus::pointer bp{b};
         m_container.push_back(std::move(bp));
+        m_unplugged.push_back(false);
+        m_reindex = true;
+        if (async_output())
+        {
+            add_worker(*m_container.back());
+            apply_latency();
+        }
     }
     return result;
 }
@@ -117,6 +136,7 @@ busarray::initialize ()
         if (! buss->initialize())
             result = false;
     }
+    reindex();
     return result;
 }
 
@@ -130,8 +150,16 @@ busarray::initialize ()
 void
 busarray::clock_start ()
 {
-    for (auto & buss : m_container)
-        buss->clock_start();
+    if (async_output())
+    {
+        for (auto & w : m_workers)
+            (void) w->post(outworker::action::clock_start);
+    }
+    else
+    {
+        for (auto & buss : m_container)
+            buss->clock_start();
+    }
 }
 
 /**
@@ -142,8 +170,16 @@ busarray::clock_start ()
 void
 busarray::clock_stop ()
 {
-    for (auto & buss : m_container)
-        buss->clock_stop();
+    if (async_output())
+    {
+        for (auto & w : m_workers)
+            (void) w->post(outworker::action::clock_stop);
+    }
+    else
+    {
+        for (auto & buss : m_container)
+            buss->clock_stop();
+    }
 }
 
 /**
@@ -157,8 +193,16 @@ busarray::clock_stop ()
 void
 busarray::clock_continue (pulse tick)
 {
-    for (auto & buss : m_container)
-        buss->clock_continue(tick);
+    if (async_output())
+    {
+        for (auto & w : m_workers)
+            (void) w->post_clock(outworker::action::clock_continue, tick);
+    }
+    else
+    {
+        for (auto & buss : m_container)
+            buss->clock_continue(tick);
+    }
 }
 
 /**
@@ -172,8 +216,16 @@ busarray::clock_continue (pulse tick)
 void
 busarray::init_clock (pulse tick)
 {
-    for (auto & buss : m_container)
-        buss->init_clock(tick);
+    if (async_output())
+    {
+        for (auto & w : m_workers)
+            (void) w->post_clock(outworker::action::init_clock, tick);
+    }
+    else
+    {
+        for (auto & buss : m_container)
+            buss->init_clock(tick);
+    }
 }
 
 /**
@@ -197,7 +249,12 @@ void
 busarray::send_event (bussbyte b, const event * e24, midi::byte channel)
 {
     if (port_active(b))
-        m_container[b]->send_event(e24, channel);
+    {
+        if (async_output())
+            (void) m_workers[b]->post(outworker::action::event, e24, channel);
+        else
+            m_container[b]->send_event(e24, channel);
+    }
 }
 
 /**
@@ -211,7 +268,185 @@ void
 busarray::send_sysex (bussbyte b, const event * e24)
 {
     if (port_active(b))
-        m_container[b]->send_sysex(e24);
+    {
+        if (async_output())
+            (void) m_workers[b]->post(outworker::action::sysex, e24);
+        else
+            m_container[b]->send_sysex(e24);
+    }
+}
+
+/**
+ *  Turns asynchronous output on or off.  When on, each bus gets its own
+ *  queue and sender thread, and the send/clock functions above only post
+ *  to the queue, so a bus whose driver blocks cannot hold up the others.
+ *  Turning it off sends whatever is still queued before returning.
+ *
+ *  Must be called from the thread that does the sending (or while it is
+ *  idle), or with the masterbus lock held, as masterbus::async_output()
+ *  does, since the sending functions walk the workers.
+ *
+ * \param flag
+ *      True to start the workers, false to stop them.
+ *
+ * \param capacity
+ *      The queue size for each bus.  A full queue drops new items; see
+ *      output_stats().
+ *
+ * \return
+ *      Returns true if the mode changed.
+ */
+
+bool
+busarray::async_output (bool flag, std::size_t capacity)
+{
+    bool result = flag != async_output();
+    if (result)
+    {
+        if (flag)
+        {
+            m_worker_capacity = capacity;
+            m_workers.reserve(m_container.size());
+            for (auto & buss : m_container)
+                add_worker(*buss);
+
+            apply_latency();
+        }
+        else
+        {
+            m_workers.clear();
+            m_compensate_latency = false;   /* it needs the workers     */
+        }
+    }
+    return result;
+}
+
+/**
+ *  Creates and starts the worker for the bus most recently added to the
+ *  container, or for each bus in turn when asynchronous output starts.
+ */
+
+void
+busarray::add_worker (bus & buss)
+{
+    std::unique_ptr<outworker> w{new outworker(buss, m_worker_capacity)};
+    (void) w->start();
+    m_workers.push_back(std::move(w));
+}
+
+/**
+ *  Gets the queue statistics for one bus.  All zero if asynchronous output
+ *  is off or the bus number is bad.
+ */
+
+outworker::statistics
+busarray::output_stats (bussbyte b) const
+{
+    return async_output() && bus_valid(b) ?
+        m_workers[b]->stats() : outworker::statistics() ;
+}
+
+/**
+ *  Turns latency compensation on or off.  Each bus is given a delay equal
+ *  to the largest bus latency less its own, so an event sent to all busses
+ *  at once reaches every device together.  The delay is applied by the
+ *  bus's output worker, so asynchronous output is turned on if needed
+ *  (and turning that off turns compensation off).
+ *
+ *  The latencies are in microseconds, not ticks, because they are a
+ *  property of the device and the driver, and do not change with tempo.
+ *
+ * \return
+ *      Returns true if compensation is on afterward.
+ */
+
+bool
+busarray::compensate_latency (bool flag)
+{
+    m_compensate_latency = flag;
+    if (flag && ! async_output())
+        (void) async_output(true);      /* calls apply_latency()        */
+    else
+        apply_latency();
+
+    return m_compensate_latency;
+}
+
+/**
+ *  Sets the latency of one bus, usually from the ports configuration, and
+ *  recalculates the delays.
+ */
+
+void
+busarray::latency (bussbyte b, long us)
+{
+    if (bus_valid(b))
+    {
+        m_container[b]->latency_us(us);
+        apply_latency();
+    }
+}
+
+/**
+ *  Asks each bus's API for its latency.  Only JACK reports one; the other
+ *  busses keep what was configured.
+ *
+ * \return
+ *      Returns the number of busses whose latency was reported.
+ */
+
+int
+busarray::query_latencies ()
+{
+    int result = 0;
+    for (auto & buss : m_container)
+    {
+        if (buss->query_latency())
+            ++result;
+    }
+    if (result > 0)
+        apply_latency();
+
+    return result;
+}
+
+long
+busarray::max_latency () const
+{
+    long result = 0;
+    for (const auto & buss : m_container)
+    {
+        if (buss->latency_us() > result)
+            result = buss->latency_us();
+    }
+    return result;
+}
+
+/**
+ *  Gets the delay being applied to the bus, in microseconds.  Zero if
+ *  compensation is off.
+ */
+
+long
+busarray::compensation (bussbyte b) const
+{
+    long result = 0;
+    if (m_compensate_latency && bus_valid(b))
+        result = max_latency() - m_container[b]->latency_us();
+
+    return result;
+}
+
+/**
+ *  Hands each worker its delay.  Busses with no latency set are treated as
+ *  having none, so they are delayed the most.
+ */
+
+void
+busarray::apply_latency ()
+{
+    for (std::size_t b = 0; b < m_workers.size(); ++b)
+        m_workers[b]->delay_us(compensation(bussbyte(b)));
 }
 
 /**
@@ -420,10 +655,238 @@ busarray::print () const
 void
 busarray::port_exit (int client, int p)
 {
-    for (auto & buss : m_container)
+    for (bussbyte b = 0; b < bussbyte(m_container.size()); ++b)
+    {
+        if (m_container[b]->match(client, p))
+            (void) unplug(b);
+    }
+}
+
+/**
+ *  Deactivates a bus whose port has gone, remembering if it had been
+ *  active, so that port_change() re-binds it when the port comes back.
+ *
+ * \return
+ *      Returns true if the bus had been active.
+ */
+
+bool
+busarray::unplug (bussbyte b)
+{
+    bool result = m_container[b]->active();
+    if (result)
+    {
+        m_container[b]->deactivate();
+        m_unplugged[b] = true;
+    }
+    return result;
+}
+
+/**
+ *  Rebuilds the name index.  Called by initialize(), and by port_change()
+ *  if busses have been added since.  The bus names are set when the busses
+ *  are made, before they are initialized.
+ */
+
+void
+busarray::reindex ()
+{
+    m_index.clear();
+    for (bussbyte b = 0; b < bussbyte(m_container.size()); ++b)
+    {
+        const bus & buss = *m_container[b];
+        std::string key = portwatch::identity(buss.connect_name());
+        if (! key.empty())
+            (void) m_index.emplace(key, b);         /* the first one wins   */
+
+        key = portwatch::identity(buss.port_alias());
+        if (! key.empty())
+            (void) m_index.emplace(key, b);
+    }
+    m_reindex = false;
+}
+
+/**
+ *  Looks up a bus by the name of its port, using the index.  The alias is
+ *  tried first, since it survives a replug under JACK.
+ *
+ * \param name
+ *      The full "client:port" name of the port.
+ *
+ * \param alias
+ *      The alias of the port, or empty.
+ *
+ * \return
+ *      Returns the bus number, or -1 if no bus has the port.
+ */
+
+int
+busarray::bus_from_name
+(
+    const std::string & name,
+    const std::string & alias
+) const
+{
+    int result = -1;
+    std::string key = portwatch::identity(alias);
+    auto it = key.empty() ? m_index.end() : m_index.find(key) ;
+    if (it == m_index.end())
+    {
+        key = portwatch::identity(name);
+        if (! key.empty())
+            it = m_index.find(key);
+    }
+    if (it != m_index.end())
+        result = int(it->second);
+
+    return result;
+}
+
+/**
+ *  Applies one port change, all in one go: port_vanished(), or for an
+ *  appeared port find_replug(), rebind(), and replugged().  A vanished
+ *  port deactivates its bus, found by name if the API gave one, else by
+ *  number.  An appeared port re-binds the bus that has its name, if that
+ *  bus was unplugged while active.  Failing a name, only a port with the
+ *  old numbers is taken back.
+ *
+ *  Not to be called on the output thread.  masterbus::process_port_changes()
+ *  makes the same calls, but holds its lock only around the quick ones.
+ *
+ * \param pc
+ *      The change, as queued by the API.
+ *
+ * \return
+ *      Returns true if a bus was deactivated or re-bound.
+ */
+
+bool
+busarray::port_change (const portwatch::change & pc)
+{
+    bool result = false;
+    if (pc.pw_action == portwatch::action::vanished)
+    {
+        result = port_vanished(pc);
+    }
+    else
+    {
+        int b = find_replug(pc);
+        if (b >= 0)
+        {
+            result = rebind(bussbyte(b), pc.pw_client, pc.pw_port);
+            if (result)
+                replugged(bussbyte(b));
+        }
+    }
+    return result;
+}
+
+/**
+ *  Deactivates the bus of a port that has vanished.  Quick.
+ *
+ * \return
+ *      Returns true if a bus was deactivated.
+ */
+
+bool
+busarray::port_vanished (const portwatch::change & pc)
+{
+    bool result = false;
+    if (m_reindex)
+        reindex();
+
+    int b = bus_from_name(pc.pw_name, pc.pw_alias);
+    if (b >= 0)
+    {
+        result = unplug(bussbyte(b));
+    }
+    else if (pc.pw_client >= 0)
+    {
+        for (bussbyte bb = 0; bb < bussbyte(m_container.size()); ++bb)
+        {
+            if (m_container[bb]->match(pc.pw_client, pc.pw_port))
+            {
+                if (unplug(bb))
+                    result = true;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ *  Finds the unplugged bus that an appeared port belongs to.  Quick.
+ *
+ * \return
+ *      Returns the bus number, or -1 if no unplugged bus wants the port.
+ */
+
+int
+busarray::find_replug (const portwatch::change & pc)
+{
+    if (m_reindex)
+        reindex();
+
+    int result = bus_from_name(pc.pw_name, pc.pw_alias);
+    bool unnamed = pc.pw_name.empty() && pc.pw_alias.empty();
+    if (result < 0 && unnamed && pc.pw_client >= 0)
+    {
+        for (bussbyte bb = 0; bb < bussbyte(m_container.size()); ++bb)
+        {
+            if (m_container[bb]->match(pc.pw_client, pc.pw_port))
+            {
+                result = int(bb);
+                break;
+            }
+        }
+    }
+    if (result >= 0 && ! m_unplugged[result])
+        result = -1;
+
+    return result;
+}
+
+/**
+ *  Re-opens the port of an unplugged bus, which stays inactive.  This is
+ *  the slow part, and is not done under the masterbus lock.  The worker
+ *  may still be sending what was queued before the unplug; it must be out
+ *  of the bus while the port is re-opened, so it is paused.
+ *
+ * \return
+ *      Returns true if the port is open again; then replugged() is to be
+ *      called.
+ */
+
+bool
+busarray::rebind (bussbyte b, int client, int port)
+{
+    bool result = false;
+    if (unplugged(b))
+    {
+        outworker * w = std::size_t(b) < m_workers.size() ?
+            m_workers[b].get() : nullptr ;
+
+        if (not_nullptr(w))
+            w->pause();
+
+        result = m_container[b]->rebind(client, port);
+        if (not_nullptr(w))
+            w->resume();
+    }
+    return result;
+}
+
+/**
+ *  Activates a bus that rebind() has re-opened.  Quick.
+ */
+
+void
+busarray::replugged (bussbyte b)
+{
+    if (unplugged(b))
     {
-        if (buss->match(client, p))
-           buss->deactivate();
+        m_container[b]->activate();
+        m_unplugged[b] = false;
     }
 }
 
@@ -0,0 +1,498 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          busconfig.cpp
+ *
+ *  This module defines the bus settings that can be reloaded while playing.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ */
+
+#include <cstdlib>                      /* std::strtol()                    */
+#include <fstream>                      /* std::ifstream                    */
+#include <sstream>                      /* std::istringstream               */
+
+#include "c_macros.h"                   /* not_nullptr() macro              */
+#include "midi/busarray.hpp"            /* midi::busarray class             */
+#include "midi/busconfig.hpp"           /* midi::busconfig class            */
+
+namespace midi
+{
+
+/**
+ *  Builds the "line N: " prefix of an error message.
+ */
+
+static std::string
+at_line (int lineno)
+{
+    return "line " + std::to_string(lineno) + ": ";
+}
+
+/**
+ *  Gets the text between the first pair of double quotes.
+ *
+ * \return
+ *      Returns false if there is no such pair.
+ */
+
+static bool
+quoted_name (const std::string & line, std::string & name)
+{
+    auto left = line.find_first_of('"');
+    auto right = left == std::string::npos ?
+        left : line.find_first_of('"', left + 1) ;
+
+    bool result = right != std::string::npos;
+    if (result)
+        name = line.substr(left + 1, right - left - 1);
+
+    return result;
+}
+
+/**
+ *  Gets the optional "latency=<us>" word after the quoted name, as written
+ *  by the Seq66 ports list.  A comment ends the search.
+ *
+ * \param [out] us
+ *      Gets the latency in microseconds, or -1 if not given.
+ *
+ * \return
+ *      Returns false if the value is not a number of microseconds.
+ */
+
+static bool
+port_latency (const std::string & line, long & us)
+{
+    static const std::string s_tag = "latency=";
+    auto left = line.find_first_of('"');
+    auto right = line.find_first_of('"', left + 1);
+    std::istringstream words(line.substr(right + 1));
+    std::string word;
+    bool result = true;
+    us = (-1);
+    while (words >> word && word[0] != '#')
+    {
+        if (word.compare(0, s_tag.size(), s_tag) == 0)
+        {
+            std::string value = word.substr(s_tag.size());
+            char * end = nullptr;
+            us = std::strtol(value.c_str(), &end, 10);
+            result = ! value.empty() && *end == 0 && us >= 0;
+            break;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Checks that a section's optional count matches its lines.
+ */
+
+static bool
+count_matches
+(
+    const std::string & section, int count, std::size_t lines,
+    std::string & errmsg
+)
+{
+    bool result = count < 0 || std::size_t(count) == lines;
+    if (! result)
+    {
+        errmsg = section + ": count " + std::to_string(count) +
+            " does not match " + std::to_string(lines) + " ports";
+    }
+    return result;
+}
+
+/*-------------------------------------------------------------------------
+ * busconfig::stage
+ *-------------------------------------------------------------------------*/
+
+busconfig::stage::stage () :
+    m_staged    (),
+    m_mutex     (),
+    m_pending   (false)
+{
+    // no code
+}
+
+/**
+ *  Queues changes behind any not yet applied, which are applied first.
+ *  Called from the thread that parsed the file.
+ */
+
+void
+busconfig::stage::post (const std::vector<change> & changes)
+{
+    if (! changes.empty())
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_staged.insert(m_staged.end(), changes.begin(), changes.end());
+        m_pending = true;
+    }
+}
+
+/**
+ *  Applies the posted changes.  Meant to be called by the output thread
+ *  at the top of a frame, so that a bus does not change in the middle of
+ *  one.  If another thread holds the mutex, nothing is done until the next
+ *  call.  Nothing is allocated or freed here, and only the clock, the
+ *  latency, and the active flag of a bus are set; no port is opened or
+ *  closed.
+ *
+ *  The changes were made before this call, so a bus may have been
+ *  unplugged since, or be in the middle of a re-bind; it is skipped.  A
+ *  bus that is inactive for any reason other than being disabled by the
+ *  configuration gets only its clock type, so that it is not activated
+ *  with no port behind it.
+ *
+ * \param outs
+ *      The output busses, changed by clock and latency.
+ *
+ * \param ins
+ *      The input busses, enabled or disabled.
+ *
+ * \return
+ *      Returns the number of changes applied.
+ */
+
+int
+busconfig::stage::apply (busarray & outs, busarray & ins)
+{
+    int result = 0;
+    if (m_pending)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if (lock.owns_lock())
+        {
+            for (const auto & c : m_staged)
+            {
+                bussbyte b = bussbyte(c.bc_bus);
+                busarray & busses = c.bc_input ? ins : outs ;
+                bus * buss = busses.bus_pointer(b);
+                if (not_nullptr(buss) && ! busses.unplugged(b))
+                {
+                    bool enabling = buss->active() ||
+                        buss->clock_type() == clocking::disabled;
+
+                    if (c.bc_input)
+                    {
+                        bool inputing = ! port_disabled(c.bc_clock);
+                        if (enabling)
+                            (void) buss->init_input(inputing);
+                        else
+                            buss->clock_type
+                            (
+                                inputing ? clocking::none : clocking::disabled
+                            );
+                    }
+                    else
+                    {
+                        if (buss->clock_type() != c.bc_clock)
+                        {
+                            if (enabling)
+                                (void) buss->set_clock(c.bc_clock);
+                            else
+                                buss->clock_type(c.bc_clock);
+                        }
+
+                        if (c.bc_latency_us >= 0)
+                            outs.latency(b, c.bc_latency_us);
+                    }
+                    ++result;
+                }
+            }
+            m_staged.clear();                       /* keeps its capacity   */
+            m_pending = false;
+        }
+    }
+    return result;
+}
+
+/*-------------------------------------------------------------------------
+ * busconfig
+ *-------------------------------------------------------------------------*/
+
+busconfig::busconfig () :
+    m_clocks    (),
+    m_inputs    ()
+{
+    // no code
+}
+
+/**
+ *  Reads the [midi-clock] and [midi-input] sections.  Any error rejects
+ *  the whole file, so that a half-read file is never applied.
+ *
+ * \param in
+ *      The stream to read.
+ *
+ * \param [out] errmsg
+ *      Gets a message naming the line and the problem, if any.
+ *
+ * \return
+ *      Returns true if the sections were read without error.  Otherwise,
+ *      this object is left as it was.
+ */
+
+bool
+busconfig::parse (std::istream & in, std::string & errmsg)
+{
+    std::vector<item> clocks;
+    std::vector<item> inputs;
+    std::vector<item> * section = nullptr;
+    std::string sectionname;
+    int count = (-1);
+    bool found = false;
+    bool result = true;
+    int lineno = 0;
+    std::string line;
+    while (result && std::getline(in, line))
+    {
+        ++lineno;
+        auto pos = line.find_first_not_of(" \t\r");
+        if (pos == std::string::npos || line[pos] == '#')
+            continue;
+
+        if (line[pos] == '[')
+        {
+            if (not_nullptr(section))
+            {
+                std::size_t lines = section->size();
+                result = count_matches(sectionname, count, lines, errmsg);
+            }
+
+            auto end = line.find_first_of(']', pos);
+            sectionname = line.substr(pos, end == std::string::npos ?
+                std::string::npos : end - pos + 1);
+
+            if (sectionname == "[midi-clock]")
+                section = &clocks;
+            else if (sectionname == "[midi-input]")
+                section = &inputs;
+            else
+                section = nullptr;                  /* not ours, skip it    */
+
+            if (result && not_nullptr(section))
+            {
+                if (section->empty())
+                    found = true;
+                else
+                {
+                    errmsg = at_line(lineno) + sectionname + " given twice";
+                    result = false;
+                }
+            }
+            count = (-1);
+            continue;
+        }
+        if (is_nullptr(section))
+            continue;
+
+        bool input = section == &inputs;
+        std::istringstream words(line);
+        std::string rest;
+        item it;
+        int status;
+        if (! (words >> it.bc_bus))
+        {
+            errmsg = at_line(lineno) + "expected a bus number";
+            result = false;
+        }
+        else if (! (words >> status))               /* a count, or junk     */
+        {
+            words.clear();
+            if (words >> rest && rest[0] != '#')
+            {
+                errmsg = at_line(lineno) + "expected 'bus status \"name\"'";
+                result = false;
+            }
+            else if (count >= 0 || ! section->empty())
+            {
+                errmsg = at_line(lineno) + "unexpected count";
+                result = false;
+            }
+            else
+                count = it.bc_bus;
+        }
+        else if (! quoted_name(line, it.bc_name) || it.bc_name.empty())
+        {
+            errmsg = at_line(lineno) + "expected a quoted port name";
+            result = false;
+        }
+        else if (! port_latency(line, it.bc_latency_us))
+        {
+            errmsg = at_line(lineno) + "bad latency";
+            result = false;
+        }
+        else if (it.bc_bus < 0 || it.bc_bus >= c_busscount_max)
+        {
+            errmsg = at_line(lineno) + "bad bus " + std::to_string(it.bc_bus);
+            result = false;
+        }
+        else if
+        (
+            status < clocking_to_int(clocking::unavailable) ||
+            status > (input ? 1 : clocking_to_int(clocking::mod))
+        )
+        {
+            errmsg = at_line(lineno) + "bad " +
+                (input ? "input" : "clock") + " value " +
+                std::to_string(status);
+
+            result = false;
+        }
+        else
+        {
+            for (const auto & other : *section)
+            {
+                if (other.bc_bus == it.bc_bus)
+                {
+                    errmsg = at_line(lineno) + "bus " +
+                        std::to_string(it.bc_bus) + " given twice";
+
+                    result = false;
+                    break;
+                }
+            }
+            if (result)
+            {
+                if (input && status >= 0)
+                    it.bc_clock = bool_to_clocking(status != 0);
+                else
+                    it.bc_clock = int_to_clocking(status);
+
+                section->push_back(it);
+            }
+        }
+    }
+    if (result && not_nullptr(section))
+        result = count_matches(sectionname, count, section->size(), errmsg);
+
+    if (result && ! found)
+    {
+        errmsg = "no [midi-clock] or [midi-input] section";
+        result = false;
+    }
+    if (result)
+    {
+        m_clocks.swap(clocks);
+        m_inputs.swap(inputs);
+    }
+    return result;
+}
+
+/**
+ *  Opens and parses a file.  See parse().
+ */
+
+bool
+busconfig::parse_file (const std::string & filename, std::string & errmsg)
+{
+    std::ifstream file(filename);
+    bool result = file.is_open();
+    if (result)
+    {
+        result = parse(file, errmsg);
+        if (! result)
+            errmsg = filename + ": " + errmsg;
+    }
+    else
+        errmsg = "cannot open " + filename;
+
+    return result;
+}
+
+/**
+ *  Finds the settings that differ from the live busses.  A line whose port
+ *  is not on the system, or was marked as not present, is skipped, as is a
+ *  bus whose port has been unplugged (see busarray::unplugged()) and an
+ *  input system port, which is always on.  The bus itself is asked about
+ *  the latter, since busarray::is_system_port() also says true for any bus
+ *  that is not active.
+ *
+ * \param outs
+ *      The output busses, compared by clock and latency.
+ *
+ * \param ins
+ *      The input busses, compared by enabled status.
+ *
+ * \param [out] result
+ *      Gets the changes, outputs first.  Its old contents are dropped.
+ *
+ * \return
+ *      Returns the number of changes.
+ */
+
+int
+busconfig::changes
+(
+    const busarray & outs,
+    const busarray & ins,
+    std::vector<change> & result
+) const
+{
+    result.clear();
+    for (const auto & it : m_clocks)
+    {
+        int b = outs.bus_from_name(it.bc_name);
+        if (b >= 0 && ! port_unavailable(it.bc_clock) && ! outs.unplugged(b))
+        {
+            clocking live = outs.get_clock(bussbyte(b));
+            long us = it.bc_latency_us;
+            bool clockchange = live != it.bc_clock && ! port_unavailable(live);
+            bool latencychange = us >= 0 && us != outs.latency(bussbyte(b));
+            if (clockchange || latencychange)
+            {
+                clocking c = clockchange ? it.bc_clock : live ;
+                result.push_back(change{false, b, c, latencychange ? us : -1});
+            }
+        }
+    }
+    for (const auto & it : m_inputs)
+    {
+        int b = ins.bus_from_name(it.bc_name);
+        if (b >= 0 && ! port_unavailable(it.bc_clock) && ! ins.unplugged(b))
+        {
+            const bus * buss = ins.bus_pointer(bussbyte(b));
+            if (! buss->is_system_port())           /* always on, see bus_in */
+            {
+                bool live = ins.get_clock(bussbyte(b)) != clocking::disabled;
+                bool wanted = it.bc_clock != clocking::disabled;
+                if (live != wanted)
+                    result.push_back(change{true, b, it.bc_clock, -1});
+            }
+        }
+    }
+    return int(result.size());
+}
+
+}           // namespace midi
+
+/*
+ * busconfig.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -1838,6 +1838,60 @@ varinum_size (long len)
     return result;
 }
 
+/**
+ *  Appends a little-endian base-128 (LEB128) value.  Unlike a MIDI
+ *  varinum, this is not limited to 28 bits, and the low-order group comes
+ *  first, so a value can be decoded at any position in a buffer without
+ *  rescanning.  Used by the packed event-lists and the input-session logs.
+ *
+ * \param [out] b
+ *      The buffer to append to.
+ *
+ * \param v
+ *      The value to encode.
+ */
+
+void
+leb128_append (midi::bytes & b, std::uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        b.push_back(midi::byte((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    b.push_back(midi::byte(v));
+}
+
+/**
+ *  Decodes a value written by leb128_append().
+ *
+ * \param b
+ *      The buffer.
+ *
+ * \param [inout] pos
+ *      The position of the value, advanced past it.
+ *
+ * \param [out] v
+ *      The decoded value.
+ *
+ * \return
+ *      Returns false if the buffer ended before the value did.
+ */
+
+bool
+leb128_extract (const midi::bytes & b, size_t & pos, std::uint64_t & v)
+{
+    v = 0;
+    for (int shift = 0; pos < b.size() && shift < 64; shift += 7)
+    {
+        midi::byte c = b[pos++];
+        v |= std::uint64_t(c & 0x7F) << shift;
+        if ((c & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
 /**
  *  An internal helper function to test if the data provided is
  *  a meta text message.
@@ -0,0 +1,395 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          chaseindex.cpp
+ *
+ *  This module defines the controller-chase index.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ */
+
+#include "midi/chaseindex.hpp"          /* midi::chaseindex, chasestate     */
+#include "midi/eventlist.hpp"           /* midi::eventlist                  */
+
+namespace midi
+{
+
+/*
+ * class chasestate
+ */
+
+chasestate::chasestate () :
+    m_values    (),
+    m_tempo     (0.0)
+{
+    clear();
+}
+
+void
+chasestate::clear ()
+{
+    m_values.fill(-1);
+    m_tempo = 0.0;
+}
+
+/**
+ *  Forgets the controllers that a Reset All Controllers resets (see the MIDI
+ *  RP-015), and pitch bend.  Bank select, volume, pan, and the program are
+ *  kept, and the reset is noted so that fill_events() sends it first.
+ */
+
+void
+chasestate::reset_controllers (int channel)
+{
+    int base = channel * c_slot_count;
+    for (int c = 1; c < 120; ++c)
+    {
+        if (c != 7 && c != 10 && c != 32)
+            m_values[base + c] = -1;
+    }
+    m_values[base + c_pitch_slot] = -1;
+    m_values[base + c_reset_slot] = 1;
+}
+
+/**
+ *  An RPN select (CC 101 and 100) and an NRPN select (CC 99 and 98) replace
+ *  each other, so setting one forgets the other.  Otherwise the chase would
+ *  send both, and the data entry would go to whichever was sent last.
+ */
+
+void
+chasestate::select_parameter (int channel, int cc)
+{
+    int base = channel * c_slot_count;
+    bool rpn = cc == 101 || cc == 100;
+    m_values[base + (rpn ? 99 : 101)] = -1;
+    m_values[base + (rpn ? 98 : 100)] = -1;
+}
+
+/**
+ *  Folds one event into the state.  Channel mode messages are not chased,
+ *  except for Reset All Controllers.  The data increment and decrement
+ *  controllers (CC 96 and 97) are relative, and cannot be replayed.
+ *
+ * \return
+ *      Returns true if the event is one that is chased.
+ */
+
+bool
+chasestate::apply (const event & ev)
+{
+    bool result = true;
+    midi::byte st = ev.status();
+    int channel = int(st & 0x0F);
+    int base = channel * c_slot_count;
+    if (ev.is_tempo())
+        m_tempo = ev.tempo();
+    else if (is_controller_msg(st))
+    {
+        int cc = int(ev.d0());
+        if (cc == 121)
+            reset_controllers(channel);
+        else if (cc >= 120 || cc == 96 || cc == 97)
+            result = false;
+        else
+        {
+            if (cc >= 98 && cc <= 101)
+                select_parameter(channel, cc);
+
+            m_values[base + cc] = std::int16_t(ev.d1());
+        }
+    }
+    else if (is_program_change_msg(st))
+        m_values[base + c_program_slot] = std::int16_t(ev.d0());
+    else if (is_pitchbend_msg(st))
+        m_values[base + c_pitch_slot] = std::int16_t((ev.d1() << 7) | ev.d0());
+    else
+        result = false;
+
+    return result;
+}
+
+/**
+ *  Makes the events that put a device into this state.  For each channel,
+ *  a Reset All Controllers comes first, if one was seen, then bank select
+ *  (CC 0 and 32), then the program change (which uses the bank), then the
+ *  other controllers, then the parameter select (CC 101 and 100, or 99 and
+ *  98) followed by its data entry (CC 6 and 38), then pitch bend.  The
+ *  tempo is not included; the caller applies tempo() to the transport.
+ *
+ * \param [out] out
+ *      The events are appended to this vector.
+ *
+ * \param tick
+ *      The timestamp to give the events.
+ *
+ * \return
+ *      Returns the number of events appended.
+ */
+
+int
+chasestate::fill_events (std::vector<event> & out, midi::pulse tick) const
+{
+    int result = 0;
+    midi::bytes msg;
+    auto add = [&] (midi::byte status, int d0, int d1, bool twobytes)
+    {
+        msg.clear();
+        msg.push_back(status);
+        msg.push_back(midi::byte(d0));
+        if (twobytes)
+            msg.push_back(midi::byte(d1));
+
+        event ev;
+        if (ev.set_midi_event(tick, msg, msg.size()))
+        {
+            out.push_back(ev);
+            ++result;
+        }
+    };
+    for (int ch = 0; ch < c_channel_count; ++ch)
+    {
+        midi::byte cc = midi::byte(to_byte(status::control_change) | ch);
+        midi::byte pc = midi::byte(to_byte(status::program_change) | ch);
+        midi::byte pw = midi::byte(to_byte(status::pitch_wheel) | ch);
+        if (value(ch, c_reset_slot) >= 0)
+            add(cc, 121, 0, true);
+
+        int bank[] = { 0, 32 };
+        for (int b : bank)
+        {
+            if (value(ch, b) >= 0)
+                add(cc, b, value(ch, b), true);
+        }
+        if (value(ch, c_program_slot) >= 0)
+            add(pc, value(ch, c_program_slot), 0, false);
+
+        for (int c = 1; c < 120; ++c)
+        {
+            bool later = c == 6 || c == 38 || (c >= 98 && c <= 101);
+            if (c != 32 && ! later && value(ch, c) >= 0)
+                add(cc, c, value(ch, c), true);
+        }
+
+        int parameter[] = { 101, 100, 99, 98, 6, 38 };
+        for (int p : parameter)
+        {
+            if (value(ch, p) >= 0)
+                add(cc, p, value(ch, p), true);
+        }
+
+        int bend = value(ch, c_pitch_slot);
+        if (bend >= 0)
+            add(pw, bend & 0x7F, (bend >> 7) & 0x7F, true);
+    }
+    return result;
+}
+
+/*
+ * class chaseindex
+ */
+
+/**
+ *  Creates an empty index.
+ *
+ * \param interval
+ *      The checkpoint spacing, in pulses.  The default is eight 4/4 measures
+ *      at 192 PPQN.  Smaller spacing makes the scan after the checkpoint
+ *      shorter but uses more memory; a checkpoint only holds the values that
+ *      are set.
+ */
+
+chaseindex::chaseindex (midi::pulse interval) :
+    m_interval      (interval > 0 ? interval : 192 * 4 * 8),
+    m_checkpoints   (),
+    m_edit_count    (0)
+{
+    // no code
+}
+
+/**
+ *  Changes the spacing, which drops all checkpoints.  A good value is a
+ *  few measures at the song's PPQN.
+ */
+
+void
+chaseindex::interval (midi::pulse p)
+{
+    if (p > 0 && p != m_interval)
+    {
+        m_interval = p;
+        m_checkpoints.clear();
+    }
+}
+
+/**
+ *  Called after an edit of the event-list, including any sort it needs.
+ *  Checkpoints after the given tick are dropped.  A checkpoint at the tick
+ *  itself holds the state before the tick, and the index of the first
+ *  event at that tick, neither of which an edit at that tick changes, so it
+ *  is kept.  The edit count is taken from the list now; any later change
+ *  not followed by a call to this function drops all the checkpoints.
+ *
+ * \param evl
+ *      The event-list, already edited.
+ *
+ * \param from
+ *      The earliest tick affected by the edit.  The default, 0, drops
+ *      everything.
+ */
+
+void
+chaseindex::invalidate (const eventlist & evl, midi::pulse from)
+{
+    while (! m_checkpoints.empty() && m_checkpoints.back().c_tick > from)
+        m_checkpoints.pop_back();
+
+    m_edit_count = evl.edit_count();
+}
+
+void
+chaseindex::load (const checkpoint & cp, chasestate & state) const
+{
+    state.clear();
+    state.tempo(cp.c_tempo);
+    for (const auto & v : cp.c_values)
+        state.value(int(v.first), v.second);
+}
+
+void
+chaseindex::save (const chasestate & state, checkpoint & cp) const
+{
+    cp.c_tempo = state.tempo();
+    cp.c_values.clear();
+    for (std::size_t i = 0; i < state.size(); ++i)
+    {
+        if (state[i] >= 0)
+            cp.c_values.emplace_back(std::uint16_t(i), state[i]);
+    }
+}
+
+/**
+ *  Builds checkpoints from the last good one up to the one that covers the
+ *  given tick.  The event-list must be sorted.  The checkpoints are dropped
+ *  if the list has changed since they were made, or if one of them indexes
+ *  past the end of the list; as the indexes only grow, checking the last
+ *  one covers them all.
+ */
+
+void
+chaseindex::extend (const eventlist & evl, midi::pulse tick)
+{
+    if (m_edit_count != evl.edit_count())
+        m_checkpoints.clear();
+    else if
+    (
+        ! m_checkpoints.empty() && m_checkpoints.back().c_index > evl.count()
+    )
+    {
+        m_checkpoints.clear();                  /* never step past cend()   */
+    }
+    m_edit_count = evl.edit_count();
+    if (m_checkpoints.empty())
+        m_checkpoints.emplace_back(0, 0);
+
+    const checkpoint & last = m_checkpoints.back();
+    midi::pulse next = last.c_tick + m_interval;
+    if (next <= tick)
+    {
+        chasestate state;
+        load(last, state);
+
+        int index = last.c_index;
+        auto ei = evl.cbegin() + index;
+        for ( ; next <= tick; next += m_interval)
+        {
+            for ( ; ei != evl.cend() && ei->timestamp() < next; ++ei, ++index)
+                (void) state.apply(*ei);
+
+            checkpoint cp(next, index);
+            save(state, cp);
+            m_checkpoints.push_back(cp);
+        }
+    }
+}
+
+/**
+ *  Finds the state in effect just before the given tick.  The checkpoint
+ *  is found directly (they are evenly spaced), so the cost is loading it
+ *  plus scanning at most one interval of events.
+ *
+ * \param evl
+ *      The (sorted) event-list that this index describes.
+ *
+ * \param tick
+ *      The position being jumped to.  Events at this tick are not included;
+ *      they will be played when playback resumes.
+ *
+ * \param [out] state
+ *      Receives the state.
+ *
+ * \return
+ *      Returns true if anything is set in the state.
+ */
+
+bool
+chaseindex::chase
+(
+    const eventlist & evl,
+    midi::pulse tick,
+    chasestate & state
+)
+{
+    if (tick < 0)
+        tick = 0;
+
+    extend(evl, tick);
+
+    std::size_t k = std::size_t(tick / m_interval);
+    if (k >= m_checkpoints.size())
+        k = m_checkpoints.size() - 1;
+
+    const checkpoint & cp = m_checkpoints[k];
+    load(cp, state);
+
+    bool result = ! cp.c_values.empty() || cp.c_tempo > 0.0;
+    for
+    (
+        auto ei = evl.cbegin() + cp.c_index;
+        ei != evl.cend() && ei->timestamp() < tick; ++ei
+    )
+    {
+        if (state.apply(*ei))
+            result = true;
+    }
+    return result;
+}
+
+}           // namespace midi
+
+/*
+ * chaseindex.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,145 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          coldlist.cpp
+ *
+ *  This module defines the event-list with cold storage.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Whether the list may go cold (not armed, not in an editor, and so on) is
+ *  up to the owner; see seq66::sequence::make_cold().
+ */
+
+#include "midi/coldlist.hpp"            /* midi::coldlist class             */
+#include "midi/memusage.hpp"            /* midi::memusage class             */
+
+namespace midi
+{
+
+coldlist::coldlist () :
+    m_events    (),
+    m_packed    (),
+    m_is_cold   (false),
+    m_mutex     ()
+{
+    // no code
+}
+
+/**
+ *  Copies the events of the source, unpacking them if needed.  The copy
+ *  starts out warm.
+ */
+
+coldlist::coldlist (const coldlist & rhs) :
+    m_events    (rhs.events()),
+    m_packed    (),
+    m_is_cold   (false),
+    m_mutex     ()
+{
+    // no code
+}
+
+coldlist &
+coldlist::operator = (const coldlist & rhs)
+{
+    if (this != &rhs)
+    {
+        const eventlist & source = rhs.events();
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_events = source;
+        midi::bytes().swap(m_packed);
+        m_is_cold = false;
+    }
+    return *this;
+}
+
+/**
+ *  Packs the events and releases the event storage.  An empty list is left
+ *  alone.
+ *
+ * \return
+ *      Returns true if the list was made cold.
+ */
+
+bool
+coldlist::make_cold ()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    bool result = ! is_cold() && ! m_events.empty();
+    if (result)
+    {
+        m_events.pack(m_packed);
+        m_packed.shrink_to_fit();
+        m_events.release();
+        m_is_cold = true;
+    }
+    return result;
+}
+
+/**
+ *  Unpacks the events.  The links between Note On and Note Off events are
+ *  not packed, so they are rebuilt here.  If the data cannot be unpacked,
+ *  which would be a bug, the list is left empty.
+ *
+ * \return
+ *      Returns true if the list was cold and was unpacked.
+ */
+
+bool
+coldlist::make_warm () const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    bool result = is_cold();
+    if (result)
+    {
+        result = m_events.unpack(m_packed);
+        if (result)
+            (void) m_events.verify_and_link();
+
+        midi::bytes().swap(m_packed);
+        m_is_cold = false;
+    }
+    return result;
+}
+
+/**
+ *  Counts the live events, or, if cold, the packed bytes.
+ */
+
+void
+coldlist::memory_usage (memusage & mu) const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_events.memory_usage(mu);
+    if (is_cold())
+        mu.add_cold(m_packed.capacity());
+}
+
+}           // namespace midi
+
+/*
+ * coldlist.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
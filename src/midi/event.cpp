@@ -24,7 +24,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2025-01-15
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  A MIDI event (i.e. "track event") is encapsulated by the midi::event
@@ -776,9 +776,8 @@ event::set_midi_event
     {
         if (midi::is_sysex_msg(buffer[0]))
         {
-            reset_sysex();            /* set up for sysex if needed   */
-            set_sysex_size(buffer.size());
-            if (! append_sysex(buffer, count))
+            reset_sysex();            /* pushes the 0xF0 status byte  */
+            if (! append_sysex(buffer.data() + 1, count - 1))
             {
                 errprint("event::append_sysex() failed");
             }
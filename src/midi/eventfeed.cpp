@@ -0,0 +1,359 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          eventfeed.cpp
+ *
+ *  This module defines the writer of the shared-memory event feed.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Only POSIX shared memory is supported for now.  On other platforms
+ *  open() fails and the output path sees no active feed.
+ */
+
+#include <cerrno>                       /* errno, EEXIST, ESRCH             */
+#include <chrono>                       /* std::chrono::steady_clock        */
+#include <cstring>                      /* std::memcpy(), std::memset()     */
+#include <thread>                       /* std::this_thread::yield()        */
+
+#include "c_macros.h"                   /* not_nullptr() macro              */
+#include "midi/event.hpp"               /* midi::event class                */
+#include "midi/eventfeed.hpp"           /* midi::eventfeed class            */
+
+#if defined PLATFORM_LINUX
+#include <fcntl.h>                      /* O_CREAT, O_EXCL, O_RDWR          */
+#include <signal.h>                     /* kill()                           */
+#include <sys/mman.h>                   /* shm_open(), mmap()               */
+#include <sys/stat.h>                   /* fstat()                          */
+#include <unistd.h>                     /* ftruncate(), getpid(), close()   */
+#endif
+
+namespace midi
+{
+
+namespace feed
+{
+
+/**
+ *  The time base of the feed.  On Linux the steady clock is
+ *  CLOCK_MONOTONIC, so readers can compare it to clock_gettime().
+ */
+
+std::uint64_t
+steady_ns ()
+{
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return std::uint64_t
+    (
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t).count()
+    );
+}
+
+std::size_t
+region_size (std::uint32_t recordcount)
+{
+    return sizeof(header) + std::size_t(recordcount) * sizeof(record);
+}
+
+}           // namespace feed
+
+#if defined PLATFORM_LINUX
+
+/**
+ *  True if the named feed was left behind by a writer that has exited
+ *  without closing it.  A feed whose writer is alive, or cannot be told,
+ *  is not stale.
+ */
+
+static bool
+stale_feed (const std::string & name)
+{
+    bool result = false;
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd >= 0)
+    {
+        struct stat st;
+        std::size_t sz = sizeof(feed::header);
+        if (::fstat(fd, &st) == 0 && std::size_t(st.st_size) >= sz)
+        {
+            void * p = ::mmap(nullptr, sz, PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                const feed::header * h = static_cast<feed::header *>(p);
+                pid_t pid = pid_t(h->fh_writer_pid);
+                if (h->fh_magic.load() == feed::c_magic && pid > 0)
+                    result = ::kill(pid, 0) != 0 && errno == ESRCH;
+
+                (void) ::munmap(p, sz);
+            }
+        }
+        (void) ::close(fd);
+    }
+    return result;
+}
+
+#endif
+
+std::atomic<eventfeed *> eventfeed::sm_active{nullptr};
+std::atomic<int> eventfeed::sm_pins{0};
+
+eventfeed::eventfeed () :
+    m_name                  (),
+    m_fd                    (-1),
+    m_region                (nullptr),
+    m_region_size           (0),
+    m_header                (nullptr),
+    m_records               (nullptr),
+    m_mask                  (0),
+    m_transport_interval_ns (10000000),         /* 10 ms                    */
+    m_last_transport_ns     (0)
+{
+    // no code
+}
+
+eventfeed::~eventfeed ()
+{
+    close();
+}
+
+/**
+ *  Creates the shared-memory object, lays out the header, and makes this
+ *  feed the active one.  A feed of the same name that another live process
+ *  is writing is never taken over; one left by a process that died is
+ *  removed and re-created.
+ *
+ * \param name
+ *      The POSIX shared-memory name, such as "/rtl66-feed".  A leading
+ *      slash is added if missing.
+ *
+ * \param recordcount
+ *      The number of records in the ring, rounded up to a power of 2.
+ *
+ * \return
+ *      Returns true if the feed is open.  False if the platform has no
+ *      shared memory, or the name is in use.
+ */
+
+bool
+eventfeed::open (const std::string & name, std::uint32_t recordcount)
+{
+    close();
+
+    std::uint32_t count = 16;
+    while (count < recordcount && count < 0x01000000)
+        count <<= 1;
+
+    m_name = name;
+    if (m_name.empty() || m_name[0] != '/')
+        m_name = "/" + m_name;
+
+    bool result = false;
+#if defined PLATFORM_LINUX
+    std::size_t sz = feed::region_size(count);
+    const int flags = O_CREAT | O_EXCL | O_RDWR;
+    m_fd = ::shm_open(m_name.c_str(), flags, 0644);
+    if (m_fd < 0 && errno == EEXIST && stale_feed(m_name))
+    {
+        (void) ::shm_unlink(m_name.c_str());
+        m_fd = ::shm_open(m_name.c_str(), flags, 0644);
+    }
+    if (m_fd >= 0 && ::ftruncate(m_fd, off_t(sz)) == 0)
+    {
+        void * p = ::mmap
+        (
+            nullptr, sz, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0
+        );
+        if (p != MAP_FAILED)
+        {
+            std::memset(p, 0, sz);
+            m_region = p;
+            m_region_size = sz;
+            m_header = static_cast<feed::header *>(p);
+            m_records = reinterpret_cast<feed::record *>
+            (
+                static_cast<char *>(p) + sizeof(feed::header)
+            );
+            m_mask = count - 1;
+            m_header->fh_version = feed::c_version;
+            m_header->fh_record_size = std::uint16_t(sizeof(feed::record));
+            m_header->fh_record_count = count;
+            m_header->fh_writer_pid = std::uint32_t(::getpid());
+            m_header->fh_next.store(0);
+            m_header->fh_start_ns = feed::steady_ns();
+            m_header->fh_magic.store(feed::c_magic, std::memory_order_release);
+            result = true;
+        }
+    }
+#endif
+    if (result)
+        sm_active.store(this, std::memory_order_release);
+    else
+        close();
+
+    return result;
+}
+
+/**
+ *  Deactivates the feed, waits for the output threads that pinned it to
+ *  finish publishing, unmaps it, and removes the shared-memory name.
+ *  Readers that are still attached keep their mapping, but see no new
+ *  records.  Not to be called while holding a pin.
+ */
+
+void
+eventfeed::close ()
+{
+    eventfeed * self = this;
+    (void) sm_active.compare_exchange_strong(self, nullptr);
+    if (not_nullptr(m_region))
+    {
+        while (sm_pins.load() > 0)                  /* quiesce publishers   */
+            std::this_thread::yield();
+    }
+#if defined PLATFORM_LINUX
+    if (not_nullptr(m_region))
+        (void) ::munmap(m_region, m_region_size);
+
+    if (m_fd >= 0)
+    {
+        (void) ::close(m_fd);
+        (void) ::shm_unlink(m_name.c_str());
+    }
+#endif
+    m_fd = (-1);
+    m_region = nullptr;
+    m_region_size = 0;
+    m_header = nullptr;
+    m_records = nullptr;
+    m_mask = 0;
+}
+
+feed::record &
+eventfeed::claim (std::uint64_t & number)
+{
+    number = m_header->fh_next.fetch_add(1, std::memory_order_acq_rel);
+
+    feed::record & r = m_records[number & m_mask];
+    r.fr_sequence.store(2 * number + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    r.fr_time_ns = feed::steady_ns();
+    return r;
+}
+
+void
+eventfeed::commit (feed::record & r, std::uint64_t number)
+{
+    r.fr_sequence.store(2 * number + 2, std::memory_order_release);
+}
+
+/**
+ *  Publishes an event that is being sent to an output bus.
+ *
+ * \param bus
+ *      The output bus index.
+ *
+ * \param channel
+ *      The channel given to the bus by the sequencer.
+ *
+ * \param ev
+ *      The event.  Its timestamp is the tick at which it is sent.
+ */
+
+void
+eventfeed::publish_event (int bus, midi::byte channel, const event & ev)
+{
+    if (is_nullptr(m_header))
+        return;
+
+    const midi::bytes & msg = ev.get_message().event_bytes();
+    std::uint64_t n;
+    feed::record & r = claim(n);
+    std::size_t len = msg.size() < feed::c_data_max ?
+        msg.size() : feed::c_data_max ;
+
+    r.fr_tick = std::int64_t(ev.timestamp());
+    r.fr_kind = feed::c_kind_event;
+    r.fr_bus = std::uint8_t(bus);
+    r.fr_channel = channel;
+    r.fr_length = std::uint8_t(len);
+    r.fr_size = std::uint32_t(msg.size());
+    if (len > 0)
+        std::memcpy(r.fr_data, msg.data(), len);
+
+    commit(r, n);
+}
+
+/**
+ *  Publishes a transport snapshot, at most once per transport interval
+ *  (10 ms by default).  Meant to be called from each pass of the output
+ *  loop.
+ */
+
+void
+eventfeed::publish_transport
+(
+    midi::pulse tick, double bpm, int ppqn,
+    bool running, bool looping,
+    int beatsperbar, int beatwidth
+)
+{
+    if (is_nullptr(m_header))
+        return;
+
+    std::uint64_t now = feed::steady_ns();
+    std::uint64_t last = m_last_transport_ns.load(std::memory_order_relaxed);
+    if (now - last < m_transport_interval_ns && last != 0)
+        return;
+
+    if (! m_last_transport_ns.compare_exchange_strong(last, now))
+        return;                                 /* another thread did it    */
+
+    std::uint32_t flags = (running ? feed::c_flag_running : 0) |
+        (looping ? feed::c_flag_looping : 0);
+
+    std::uint32_t p = std::uint32_t(ppqn);
+    std::uint32_t bpb = std::uint32_t(beatsperbar);
+    std::uint32_t bw = std::uint32_t(beatwidth);
+    std::uint64_t n;
+    feed::record & r = claim(n);
+    r.fr_tick = std::int64_t(tick);
+    r.fr_kind = feed::c_kind_transport;
+    r.fr_bus = 0;
+    r.fr_channel = 0;
+    r.fr_length = 24;
+    r.fr_size = 24;
+    std::memcpy(&r.fr_data[0], &bpm, sizeof bpm);
+    std::memcpy(&r.fr_data[8], &p, sizeof p);
+    std::memcpy(&r.fr_data[12], &flags, sizeof flags);
+    std::memcpy(&r.fr_data[16], &bpb, sizeof bpb);
+    std::memcpy(&r.fr_data[20], &bw, sizeof bw);
+    commit(r, n);
+}
+
+}           // namespace midi
+
+/*
+ * eventfeed.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -25,7 +25,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2015-09-19
- * \updates       2025-01-16
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This container now can indicate if certain Meta events (time-signaure or
@@ -33,8 +33,10 @@
  */
 
 #include <algorithm>                    /* std::sort(), std::merge()        */
+#include <cstdint>                      /* std::uint64_t                    */
+#include <functional>                   /* std::less<>                      */
 
-#include "midi/calculations.hpp"        /* midi::randomize()                */
+#include "midi/calculations.hpp"        /* midi::randomize(), leb128_...()  */
 #include "midi/eventlist.hpp"           /* midi::eventlist                  */
 
 namespace midi
@@ -53,11 +55,16 @@ eventlist::eventlist () :
     m_events                (),
     m_match_iterating       (false),
     m_match_iterator        (m_events.end()),
+    m_match_indexing        (false),
+    m_match_index_valid     (false),
+    m_match_index           (),
+    m_match_tombstones      (),
     m_action_in_progress    (false),                    /* atomic boolean   */
     m_length                (0),
     m_note_off_margin       (3),
     m_zero_len_correction   (16),
     m_is_modified           (false),
+    m_edit_count            (0),
     m_has_tempo             (false),
     m_has_time_signature    (false),
     m_has_key_signature     (false),
@@ -77,11 +84,16 @@ eventlist::eventlist (const eventlist & rhs) :
     m_events                (rhs.m_events),
     m_match_iterating       (false),
     m_match_iterator        (m_events.end()),
+    m_match_indexing        (rhs.m_match_indexing),
+    m_match_index_valid     (false),
+    m_match_index           (),
+    m_match_tombstones      (),
     m_action_in_progress    (false),                    /* atomic boolean   */
     m_length                (rhs.m_length),
     m_note_off_margin       (rhs.m_note_off_margin),
     m_zero_len_correction   (rhs.m_zero_len_correction),
     m_is_modified           (rhs.m_is_modified),
+    m_edit_count            (0),
     m_has_tempo             (rhs.m_has_tempo),
     m_has_time_signature    (rhs.m_has_time_signature),
     m_has_key_signature     (rhs.m_has_key_signature),
@@ -99,6 +111,8 @@ eventlist::operator = (const eventlist & rhs)
         m_events                = rhs.m_events;
         m_match_iterating       = rhs.m_match_iterating;    /* ok? */
         m_match_iterator        = rhs.m_match_iterator;     /* ok? */
+        m_match_indexing        = rhs.m_match_indexing;
+        invalidate_match_index();
         m_action_in_progress    = false;                /* atomic boolean   */
         m_length                = rhs.m_length;
         m_note_off_margin       = rhs.m_note_off_margin;
@@ -112,6 +126,218 @@ eventlist::operator = (const eventlist & rhs)
     return *this;
 }
 
+/**
+ *  Adds the memory held by this event-list to the given accounting object.
+ *  The event vector is counted by capacity, and the message buffer of each
+ *  event (its status and data bytes, or the SysEx/Meta payload) is counted
+ *  by the capacity of that buffer.  No copies are made.
+ *
+ * \param [out] mu
+ *      The accounting object to be incremented.
+ */
+
+void
+eventlist::memory_usage (memusage & mu) const
+{
+    std::size_t payload = 0;
+    for (const auto & e : m_events)
+        payload += e.get_message().event_bytes().capacity();
+
+    mu.add_events
+    (
+        m_events.size(), m_events.capacity() * sizeof(event), payload
+    );
+    if (! m_match_index.empty())
+    {
+        std::size_t bytes = m_match_index.bucket_count() * sizeof(void *);
+        for (const auto & kv : m_match_index)
+        {
+            bytes += sizeof(kv) + sizeof(void *) +
+                kv.second.capacity() * sizeof(std::size_t);
+        }
+        bytes += m_match_tombstones.capacity() * sizeof(std::size_t);
+        mu.add_other(bytes);
+    }
+}
+
+/*
+ *  Helpers for the packed form of an event-list, built on the LEB128
+ *  functions in the calculations module.  The signed version uses
+ *  "zig-zag" encoding so that a small negative time delta (an unsorted
+ *  list) stays small.
+ */
+
+static void
+pack_value (midi::bytes & b, std::uint64_t v)
+{
+    leb128_append(b, v);
+}
+
+static void
+pack_signed (midi::bytes & b, long v)
+{
+    std::uint64_t z = v < 0 ?
+        (std::uint64_t(-(v + 1)) << 1) | 1 : std::uint64_t(v) << 1 ;
+
+    pack_value(b, z);
+}
+
+static bool
+unpack_value (const midi::bytes & b, size_t & pos, std::uint64_t & v)
+{
+    return leb128_extract(b, pos, v);
+}
+
+static bool
+unpack_signed (const midi::bytes & b, size_t & pos, long & v)
+{
+    std::uint64_t z;
+    bool result = unpack_value(b, pos, z);
+    if (result)
+        v = (z & 1) ? -long(z >> 1) - 1 : long(z >> 1) ;
+
+    return result;
+}
+
+/**
+ *  Bits of the per-event flag byte in the packed form.
+ */
+
+static const midi::byte c_pack_selected = 0x01;
+static const midi::byte c_pack_marked   = 0x02;
+static const midi::byte c_pack_painted  = 0x04;
+
+/**
+ *  Serializes the events and the list settings into a compact byte form,
+ *  for use by midi::undostack in holding older undo states.  Each event
+ *  costs roughly the size of its MIDI bytes plus three or four bytes,
+ *  versus sizeof(event) plus a heap buffer for a live event.
+ *
+ *  Note links and iterators are not saved; the caller must call
+ *  verify_and_link() after unpack(), as is already done after any undo.
+ *
+ * \param [out] destination
+ *      The buffer to receive the packed data.  It is cleared first.
+ */
+
+void
+eventlist::pack (midi::bytes & destination) const
+{
+    destination.clear();
+    destination.reserve(m_events.size() * 6 + 16);
+    pack_value(destination, std::uint64_t(m_events.size()));
+    pack_signed(destination, m_length);
+    pack_signed(destination, m_note_off_margin);
+    pack_signed(destination, m_zero_len_correction);
+    destination.push_back
+    (
+        midi::byte((m_is_modified ? 1 : 0) | (m_link_wraparound ? 2 : 0))
+    );
+
+    midi::pulse prevtime = 0;
+    for (const auto & e : m_events)
+    {
+        midi::byte flags = 0;
+        if (e.m_selected)
+            flags |= c_pack_selected;
+
+        if (e.m_marked)
+            flags |= c_pack_marked;
+
+#if defined RTL66_SUPPORT_PAINTED_EVENTS
+        if (e.m_painted)
+            flags |= c_pack_painted;
+#endif
+
+        const midi::bytes & msg = e.m_message.event_bytes();
+        pack_signed(destination, e.m_timestamp - prevtime);
+        prevtime = e.m_timestamp;
+        destination.push_back(flags);
+        destination.push_back(e.m_input_buss);
+        destination.push_back(e.m_channel);
+        pack_value(destination, std::uint64_t(msg.size()));
+        destination.insert(destination.end(), msg.begin(), msg.end());
+    }
+}
+
+/**
+ *  Restores the events and list settings from the form created by pack().
+ *  The meta-event flags (tempo, time-signature, key-signature) are rebuilt
+ *  by append().
+ *
+ * \param source
+ *      The packed data.
+ *
+ * \return
+ *      Returns true if the data was consistent.  Otherwise the list is
+ *      left empty.
+ */
+
+bool
+eventlist::unpack (const midi::bytes & source)
+{
+    size_t pos = 0;
+    std::uint64_t count;
+    long length, margin, zlc;
+    clear();
+    bool result =
+        unpack_value(source, pos, count) &&
+        unpack_signed(source, pos, length) &&
+        unpack_signed(source, pos, margin) &&
+        unpack_signed(source, pos, zlc) &&
+        pos < source.size();
+
+    if (result)
+    {
+        midi::byte listflags = source[pos++];
+        m_length = midi::pulse(length);
+        m_note_off_margin = midi::pulse(margin);
+        m_zero_len_correction = midi::pulse(zlc);
+        m_link_wraparound = (listflags & 2) != 0;
+        m_events.reserve(size_t(count));
+
+        midi::pulse timestamp = 0;
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            long delta;
+            std::uint64_t msgsize;
+            result = unpack_signed(source, pos, delta) &&
+                (pos + 3) <= source.size();
+
+            if (! result)
+                break;
+
+            midi::byte flags = source[pos++];
+            event e;
+            timestamp += midi::pulse(delta);
+            e.m_timestamp = timestamp;
+            e.m_input_buss = source[pos++];
+            e.m_channel = source[pos++];
+            result = unpack_value(source, pos, msgsize) &&
+                (pos + msgsize) <= source.size();
+
+            if (! result)
+                break;
+
+            auto first = source.begin() + pos;
+            e.m_message.event_bytes().assign(first, first + msgsize);
+            pos += size_t(msgsize);
+            e.m_selected = (flags & c_pack_selected) != 0;
+            e.m_marked = (flags & c_pack_marked) != 0;
+#if defined RTL66_SUPPORT_PAINTED_EVENTS
+            e.m_painted = (flags & c_pack_painted) != 0;
+#endif
+            (void) append(e);
+        }
+        if (result)
+            m_is_modified = (listflags & 1) != 0;
+    }
+    if (! result)
+        clear();
+
+    return result;
+}
+
 /**
  *  Provides the minimum and maximux timestamps  of the events, in MIDI pulses.
  *  These functions get the iterator for the first or last element and returns
@@ -185,6 +411,13 @@ eventlist::append (const event & e)
 {
     m_events.push_back(e);                      /* std::vector operation    */
     m_is_modified = true;
+    ++m_edit_count;
+    if (m_match_index_valid)
+    {
+        std::size_t indexpos = m_events.size() - 1 + m_match_tombstones.size();
+        m_match_index[match_key(e)].push_back(indexpos);
+    }
+
     if (e.is_tempo())
         m_has_tempo = true;
 
@@ -247,6 +480,7 @@ void
 eventlist::sort ()
 {
     std::sort(m_events.begin(), m_events.end());
+    invalidate_match_index();
 }
 
 /**
@@ -487,6 +721,23 @@ eventlist::clear ()
         m_events.clear();
         m_is_modified = true;
     }
+    invalidate_match_index();
+}
+
+/**
+ *  Empties the list and gives its storage back to the heap, without marking
+ *  the list as modified.  Used after pack() when the packed form is to
+ *  replace the list for a while, as in cold storage.
+ */
+
+void
+eventlist::release ()
+{
+    event::buffer().swap(m_events);
+    match_positions().swap(m_match_index);
+    std::vector<std::size_t>().swap(m_match_tombstones);
+    m_match_index_valid = false;
+    ++m_edit_count;
 }
 
 /**
@@ -835,6 +1086,8 @@ eventlist::quantize_events (int snap, int divide, bool all)
     }
     if (result && found_note)
         verify_and_link();                          /* sorts them again!!!  */
+    else if (result)
+        invalidate_match_index();                   /* edited in place      */
 
     return result;
 }
@@ -1031,6 +1284,9 @@ eventlist::move_selected_events (midi::pulse delta_tick)
             result = true;
         }
     }
+    if (result)
+        invalidate_match_index();
+
     return result;
 }
 
@@ -1075,6 +1331,8 @@ eventlist::align_left (bool relink)
                 sort();
                 result = verify_and_link();
             }
+            else if (result)
+                invalidate_match_index();           /* edited in place      */
         }
     }
     return result;
@@ -1121,6 +1379,8 @@ eventlist::align_right (bool relink)
                 sort();
                 result = verify_and_link();
             }
+            else if (result)
+                invalidate_match_index();           /* edited in place      */
         }
     }
     return result;
@@ -1138,6 +1398,7 @@ eventlist::scale_note_off (event & noteoff, double factor)
     stamp *= factor;                                /* scale the note off   */
     stamp -= note_off_margin();                     /* put back the margin  */
     noteoff.set_timestamp(stamp);
+    invalidate_match_index();
 }
 
 /**
@@ -1214,6 +1475,9 @@ eventlist::apply_time_factor (double factor, bool savenotelength, bool relink)
             sort();
             verify_and_link();
         }
+        else
+            invalidate_match_index();               /* edited in place      */
+
         result = get_max_timestamp();
     }
     return result;
@@ -1269,6 +1533,8 @@ eventlist::reverse_events (bool inplace, bool relink)
             sort();
             verify_and_link();
         }
+        else
+            invalidate_match_index();           /* edited in place      */
     }
     return result;
 }
@@ -1309,6 +1575,8 @@ eventlist::randomize (midi::byte astatus, int range, bool all)
                     result = true;
             }
         }
+        if (result)
+            invalidate_match_index();
     }
     return result;
 }
@@ -1422,6 +1690,8 @@ eventlist::jitter_events (int snap, int jitr)
         }
         if (note_changed)
             verify_and_link();                  /* sort and relink notes    */
+        else if (result)
+            invalidate_match_index();           /* edited in place          */
     }
     return result;
 }
@@ -1660,35 +1930,174 @@ eventlist::mark_out_of_range (midi::pulse slength)
     return result;
 }
 
+/*
+ * Match index
+ */
+
+eventlist::match_key::match_key (const event & e) :
+    k_timestamp (e.timestamp()),
+    k_status    (e.status()),
+    k_channel   (e.channel()),
+    k_d0        (e.is_meta() ? 0 : e.d0())
+{
+    // no code
+}
+
+std::size_t
+eventlist::match_hash::operator () (const match_key & k) const
+{
+    std::uint64_t h = std::uint64_t(k.k_timestamp) * 0x9E3779B97F4A7C15ULL;
+    h ^= (std::uint64_t(k.k_status) << 16) |
+        (std::uint64_t(k.k_channel) << 8) | std::uint64_t(k.k_d0);
+
+    return std::size_t(h ^ (h >> 29));
+}
+
+/**
+ *  Builds the match index from scratch.  The positions for each key come
+ *  out in ascending order.
+ */
+
+void
+eventlist::index_matches ()
+{
+    m_match_index.clear();
+    m_match_tombstones.clear();
+    m_match_index.reserve(m_events.size());
+    for (std::size_t i = 0; i < m_events.size(); ++i)
+        m_match_index[match_key(m_events[i])].push_back(i);
+
+    m_match_index_valid = true;
+}
+
+/**
+ *  Keeps the index valid across the erasure of the event at the given
+ *  position.  The event's entry is dropped and its index position becomes
+ *  a tombstone, so the other entries need no renumbering.  The cost is the
+ *  entries of one key plus the tombstones, which are bounded: past 32 plus
+ *  an eighth of the list, the index is dropped, to be rebuilt by the next
+ *  lookup, which keeps a run of removals amortized O(1) each.
+ */
+
+void
+eventlist::unindex_match (std::size_t pos)
+{
+    std::size_t indexpos = pos;                 /* the inverse of below     */
+    auto t = m_match_tombstones.begin();
+    for ( ; t != m_match_tombstones.end() && *t <= indexpos; ++t)
+        ++indexpos;
+
+    (void) m_match_tombstones.insert(t, indexpos);
+
+    auto k = m_match_index.find(match_key(m_events[pos]));
+    if (k != m_match_index.end())
+    {
+        auto & positions = k->second;
+        auto p = std::lower_bound
+        (
+            positions.begin(), positions.end(), indexpos
+        );
+        if (p != positions.end() && *p == indexpos)
+        {
+            (void) positions.erase(p);
+            if (positions.empty())
+                (void) m_match_index.erase(k);
+        }
+    }
+    if (m_match_tombstones.size() > 32 + m_events.size() / 8)
+    {
+        m_match_index_valid = false;
+        m_match_index.clear();
+        m_match_tombstones.clear();
+    }
+}
+
 /**
- *  A helper function for sequence.  Finds the given event, and removes the
- *  first iterator matching that.  If there are events that would match after
- *  that, they remain in the container.  This matches seq24 behavior.
+ *  Maps a position in the index to the position of the event in the list,
+ *  by subtracting the tombstones below it.
+ */
+
+std::size_t
+eventlist::match_position (std::size_t indexpos) const
+{
+    auto t = std::lower_bound
+    (
+        m_match_tombstones.begin(), m_match_tombstones.end(), indexpos
+    );
+    return indexpos - std::size_t(t - m_match_tombstones.begin());
+}
+
+/**
+ *  Looks up the first event at or after the given position that matches
+ *  the given event.  The candidates from the index are checked with
+ *  event::match(), so an index entry that has gone stale is never
+ *  returned.
+ *
+ * \param e
+ *      The event to match.  It must not have a null timestamp.
+ *
+ * \param from
+ *      The position at which to start.
  *
- * \todo
- *      Use the find() function to find the matching event more
- *      conventionally.
+ * \return
+ *      Returns the iterator to the match, or end() if there is none.
+ */
+
+event::iterator
+eventlist::indexed_match (const event & e, std::size_t from)
+{
+    event::iterator result = m_events.end();
+    if (! m_match_index_valid)
+        index_matches();
+
+    auto k = m_match_index.find(match_key(e));
+    if (k != m_match_index.end())
+    {
+        /*
+         * An index position is never less than the list position, so the
+         * search can start at "from".
+         */
+
+        const auto & positions = k->second;
+        auto p = std::lower_bound(positions.begin(), positions.end(), from);
+        for ( ; p != positions.end(); ++p)
+        {
+            std::size_t pos = match_position(*p);
+            if (pos >= from && pos < m_events.size() && m_events[pos].match(e))
+            {
+                result = m_events.begin() + pos;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ *  A helper function for sequence.  Removes the given event, which must be
+ *  an element of this list.  The position of the event is found from its
+ *  address, rather than by searching for it.
  *
  * \param e
  *      Provides a reference to the event to be removed.
  *
  * \return
- *      Returns true if the event was found and removed.  This function
- *      returns immediately after the event is removed.
+ *      Returns true if the event was found and removed.
  */
 
 bool
 eventlist::remove_event (event & e)
 {
     bool result = false;
-    for (auto i = m_events.begin(); i != m_events.end(); ++i)
+    if (! m_events.empty())
     {
-        event & er = dref(i);
-        if (&e == &er)                  /* comparing pointers, not values   */
+        std::less<const event *> before;
+        const event * first = m_events.data();
+        const event * last = first + m_events.size();
+        if (! before(&e, first) && before(&e, last))
         {
-            (void) remove(i);           /* an iterator is required here     */
+            (void) remove(m_events.begin() + (&e - first));
             result = true;
-            break;
         }
     }
     return result;
@@ -1707,6 +2116,9 @@ eventlist::remove_event (event & e)
  *              -   Get the text and timestamp. As en event?
  *              -   Set the event to a new value.
  *
+ *  If match_indexing() is on, and the event has a timestamp, the match is
+ *  found in the index.  Otherwise the list is scanned.
+ *
  * \param e
  *      The event to match.
  *
@@ -1722,20 +2134,28 @@ event::iterator
 eventlist::find_first_match (const event & e, midi::pulse starttick)
 {
     event::iterator result = m_events.end();
-    for (auto i = m_events.begin(); i != m_events.end(); ++i)
+    if (m_match_indexing && ! is_null_pulse(e.timestamp()))
+    {
+        if (e.timestamp() >= starttick)
+            result = indexed_match(e, 0);
+    }
+    else
     {
-        event & er = dref(i);
-        midi::pulse t = er.timestamp();
-        if (t >= starttick)
+        for (auto i = m_events.begin(); i != m_events.end(); ++i)
         {
-            if (er.match(e))                /* compares values, not ptrs    */
+            event & er = dref(i);
+            midi::pulse t = er.timestamp();
+            if (t >= starttick)
             {
-                result = i;
-                m_match_iterator = result;  /* keeps track of position      */
-                break;
+                if (er.match(e))            /* compares values, not ptrs    */
+                {
+                    result = i;
+                    break;
+                }
             }
         }
     }
+    m_match_iterator = result;              /* keeps track of position      */
     m_match_iterating = result != m_events.end();
     return result;
 }
@@ -1746,13 +2166,21 @@ eventlist::find_next_match (const event & e)
     event::iterator result = m_events.end();
     if (m_match_iterating)
     {
-        for (auto i = m_match_iterator; i != m_events.end(); ++i)
+        if (m_match_indexing && ! is_null_pulse(e.timestamp()))
         {
-            event & er = dref(i);
-            if (er.match(e))            /* comparing values, not pointers   */
+            auto from = m_match_iterator - m_events.begin();
+            result = indexed_match(e, std::size_t(from));
+        }
+        else
+        {
+            for (auto i = m_match_iterator; i != m_events.end(); ++i)
             {
-                result = i;
-                break;
+                event & er = dref(i);
+                if (er.match(e))        /* comparing values, not pointers   */
+                {
+                    result = i;
+                    break;
+                }
             }
         }
         m_match_iterating = result != m_events.end();
@@ -1782,26 +2210,97 @@ bool
 eventlist::remove_first_match (const event & e, midi::pulse starttick)
 {
     bool result = false;
-    for (auto i = m_events.begin(); i != m_events.end(); ++i)
+    auto i = find_first_match(e, starttick);
+    if (i != m_events.end())
+    {
+        (void) remove(i);                   /* iterator required here       */
+        m_match_iterating = false;
+        result = true;
+    }
+    return result;
+}
+
+/**
+ *  Removes the marked or selected events in one pass, moving each kept
+ *  event down once, instead of erasing them one at a time.  The order of
+ *  the kept events is unchanged, so no sort is needed.  The note links of
+ *  the kept events are moved to the new positions of their partners; only
+ *  a note whose partner was removed (or whose link was not mutual) is
+ *  unlinked and then relinked by link_new(), which looks only at unlinked
+ *  Note Ons.
+ *
+ * \param selected
+ *      If true, selected events are removed, otherwise marked events.
+ *
+ * \return
+ *      Returns true if at least one event was removed.
+ */
+
+bool
+eventlist::remove_flagged (bool selected)
+{
+    static const std::size_t s_gone = std::size_t(-1);
+    std::size_t count = m_events.size();
+    std::vector<std::size_t> newpos;
+    newpos.reserve(count);
+
+    std::size_t kept = 0;
+    for (const auto & e : m_events)
+    {
+        bool flagged = selected ? e.is_selected() : e.is_marked() ;
+        newpos.push_back(flagged ? s_gone : kept++);
+    }
+
+    bool result = kept < count;
+    if (result)
     {
-        event & er = dref(i);
-        midi::pulse t = er.timestamp();
-        if (t >= starttick)
+        auto first = m_events.begin();
+        std::vector<std::size_t> partner(count, s_gone);
+        for (std::size_t i = 0; i < count; ++i)
         {
-            if (er.match(e))                /* comparing values, not ptrs   */
+            const event & e = m_events[i];
+            if (newpos[i] != s_gone && e.is_linked())
             {
-                (void) remove(i);           /* iterator required here       */
-                result = true;
-                break;
+                std::size_t p = std::size_t(e.link() - first);
+                if (p < count && newpos[p] != s_gone)
+                {
+                    const event & ep = m_events[p];
+                    if (ep.is_linked() && std::size_t(ep.link() - first) == i)
+                        partner[i] = p;
+                }
             }
         }
+
+        bool orphans = false;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::size_t n = newpos[i];
+            if (n == s_gone)
+                continue;
+
+            event & e = m_events[i];
+            if (partner[i] != s_gone)
+                e.link(first + newpos[partner[i]]);
+            else if (e.is_linked())
+            {
+                e.unlink();
+                orphans = true;
+            }
+            if (n != i)
+                m_events[n] = std::move(e);
+        }
+        m_events.erase(first + kept, m_events.end());
+        m_is_modified = true;
+        m_match_iterating = false;
+        invalidate_match_index();
+        if (orphans)
+            (void) link_new(m_link_wraparound);
     }
     return result;
 }
 
 /**
- *  Removes marked events.  Note how this function handles removing a
- *  value to avoid incrementing a now-invalid iterator.
+ *  Removes marked events.
  *
  * \threadsafe
  *
@@ -1812,22 +2311,7 @@ eventlist::remove_first_match (const event & e, midi::pulse starttick)
 bool
 eventlist::remove_marked ()
 {
-    bool result = false;
-    for (auto i = m_events.begin(); i != m_events.end(); /*++i*/)
-    {
-        if (i->is_marked())
-        {
-            auto t = remove(i);
-            i = t;
-            result = true;
-        }
-        else
-            ++i;
-    }
-    if (result)
-        verify_and_link();
-
-    return result;
+    return remove_flagged(false);
 }
 
 /**
@@ -1878,8 +2362,7 @@ eventlist::remove_trailing_events (midi::pulse limit)
 }
 
 /**
- *  Removes selected events.  Note how this function handles removing a
- *  value to avoid incrementing a now-invalid iterator.
+ *  Removes selected events.
  *
  *  We want to get rid of the concept of marking events.  Selected events can
  *  be handled directly in the event container.
@@ -1891,22 +2374,7 @@ eventlist::remove_trailing_events (midi::pulse limit)
 bool
 eventlist::remove_selected ()
 {
-    bool result = false;
-    for (auto i = m_events.begin(); i != m_events.end(); /*++i*/)
-    {
-        if (i->is_selected())
-        {
-            auto t = remove(i);
-            i = t;
-            result = true;
-        }
-        else
-            ++i;
-    }
-    if (result)
-        verify_and_link();
-
-    return result;
+    return remove_flagged(true);
 }
 
 #if 0
@@ -2102,6 +2570,9 @@ eventlist::set_channels (int channel)
             result = true;
         }
     }
+    if (result)
+        invalidate_match_index();
+
     return result;
 }
 
@@ -2628,6 +3099,7 @@ eventlist::rescale (midi::ppqn newppqn, midi::ppqn oldppqn)
             er.rescale(newppqn, oldppqn);
 
         length(rescale_tick(length(), newppqn, oldppqn));
+        invalidate_match_index();
     }
     return result;
 }
@@ -0,0 +1,233 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          feedreader.cpp
+ *
+ *  This module defines the reader side of the shared-memory event feed.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ */
+
+#include <cstring>                      /* std::memcpy()                    */
+
+#include "c_macros.h"                   /* not_nullptr() macro              */
+#include "midi/feedreader.hpp"          /* midi::feedreader class           */
+
+#if defined PLATFORM_LINUX
+#include <fcntl.h>                      /* O_RDONLY                         */
+#include <sys/mman.h>                   /* shm_open(), mmap()               */
+#include <sys/stat.h>                   /* fstat()                          */
+#include <unistd.h>                     /* close()                          */
+#endif
+
+namespace midi
+{
+
+feedreader::feedreader () :
+    m_fd            (-1),
+    m_region        (nullptr),
+    m_region_size   (0),
+    m_header        (nullptr),
+    m_records       (nullptr),
+    m_count         (0),
+    m_next          (0),
+    m_dropped       (0)
+{
+    // no code
+}
+
+feedreader::~feedreader ()
+{
+    close();
+}
+
+/**
+ *  Attaches to a feed.
+ *
+ * \param name
+ *      The shared-memory name given to eventfeed::open().
+ *
+ * \param fromstart
+ *      If true, start with the oldest record still in the ring.
+ *      Otherwise (the default), start with the next record published.
+ *
+ * \return
+ *      Returns true if the feed exists and has a valid header.
+ */
+
+bool
+feedreader::open (const std::string & name, bool fromstart)
+{
+    close();
+
+    std::string shmname = name;
+    if (shmname.empty() || shmname[0] != '/')
+        shmname = "/" + shmname;
+
+    bool result = false;
+#if defined PLATFORM_LINUX
+    m_fd = ::shm_open(shmname.c_str(), O_RDONLY, 0);
+    struct stat st;
+    if (m_fd >= 0 && ::fstat(m_fd, &st) == 0 &&
+        std::size_t(st.st_size) >= sizeof(feed::header))
+    {
+        std::size_t sz = std::size_t(st.st_size);
+        void * p = ::mmap(nullptr, sz, PROT_READ, MAP_SHARED, m_fd, 0);
+        if (p != MAP_FAILED)
+        {
+            const feed::header * h = static_cast<const feed::header *>(p);
+            m_region = p;
+            m_region_size = sz;
+            result =
+                h->fh_magic.load(std::memory_order_acquire) == feed::c_magic &&
+                h->fh_version == feed::c_version &&
+                h->fh_record_size == sizeof(feed::record) &&
+                feed::region_size(h->fh_record_count) <= sz;
+
+            if (result)
+            {
+                m_header = h;
+                m_records = reinterpret_cast<const feed::record *>
+                (
+                    static_cast<const char *>(p) + sizeof(feed::header)
+                );
+                m_count = h->fh_record_count;
+                m_next = h->fh_next.load(std::memory_order_acquire);
+                if (fromstart)
+                    m_next = m_next > m_count ? m_next - m_count : 0 ;
+            }
+        }
+    }
+#endif
+    if (! result)
+        close();
+
+    return result;
+}
+
+void
+feedreader::close ()
+{
+#if defined PLATFORM_LINUX
+    if (not_nullptr(m_region))
+        (void) ::munmap(const_cast<void *>(m_region), m_region_size);
+
+    if (m_fd >= 0)
+        (void) ::close(m_fd);
+#endif
+    m_fd = (-1);
+    m_region = nullptr;
+    m_region_size = 0;
+    m_header = nullptr;
+    m_records = nullptr;
+    m_count = 0;
+    m_next = 0;
+}
+
+/**
+ *  Copies the next record.  Records that were overwritten before they
+ *  could be read are skipped and counted in dropped().
+ *
+ * \param [out] rec
+ *      Receives the record if the status is status::ok.
+ *
+ * \return
+ *      Returns status::ok, status::empty if the writer has published
+ *      nothing new (or is still writing the next record), or
+ *      status::closed.
+ */
+
+feedreader::status
+feedreader::next (feedrecord & rec)
+{
+    if (is_nullptr(m_header))
+        return status::closed;
+
+    for (;;)
+    {
+        std::uint64_t head = m_header->fh_next.load(std::memory_order_acquire);
+        if (m_next >= head)
+            return status::empty;
+
+        if (head - m_next > m_count)                    /* lapped           */
+        {
+            m_dropped += head - m_count - m_next;
+            m_next = head - m_count;
+        }
+
+        std::uint64_t n = m_next;
+        const feed::record & r = m_records[n & (m_count - 1)];
+        std::uint64_t done = 2 * n + 2;
+        std::uint64_t s1 = r.fr_sequence.load(std::memory_order_acquire);
+        if (s1 < done)
+            return status::empty;                       /* being written    */
+
+        if (s1 == done)
+        {
+            rec.number = n;
+            rec.time_ns = r.fr_time_ns;
+            rec.tick = r.fr_tick;
+            rec.kind = r.fr_kind;
+            rec.bus = r.fr_bus;
+            rec.channel = r.fr_channel;
+            rec.length = r.fr_length <= feed::c_data_max ?
+                r.fr_length : std::uint8_t(feed::c_data_max) ;
+            rec.size = r.fr_size;
+            std::memcpy(rec.data, r.fr_data, feed::c_data_max);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (r.fr_sequence.load(std::memory_order_relaxed) == s1)
+            {
+                ++m_next;
+                rec.bpm = 0.0;
+                rec.ppqn = rec.flags = rec.beats_per_bar = rec.beat_width = 0;
+                if (rec.is_transport())
+                {
+                    std::memcpy(&rec.bpm, &rec.data[0], sizeof rec.bpm);
+                    std::memcpy(&rec.ppqn, &rec.data[8], sizeof rec.ppqn);
+                    std::memcpy(&rec.flags, &rec.data[12], sizeof rec.flags);
+                    std::memcpy
+                    (
+                        &rec.beats_per_bar, &rec.data[16],
+                        sizeof rec.beats_per_bar
+                    );
+                    std::memcpy
+                    (
+                        &rec.beat_width, &rec.data[20], sizeof rec.beat_width
+                    );
+                }
+                return status::ok;
+            }
+        }
+        ++m_next;                                       /* overwritten      */
+        ++m_dropped;
+    }
+}
+
+}           // namespace midi
+
+/*
+ * feedreader.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
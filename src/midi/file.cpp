@@ -24,7 +24,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2025-01-16
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  A midi::file is file-header data plus the data in each of the tracks of
@@ -108,8 +108,10 @@
  *              put/poke/peek/get functions.
  */
 
+#include <atomic>                       /* std::atomic<int> work counter    */
 #include <fstream>                      /* std::ifstream & std::ofstream    */
 #include <memory>                       /* std::unique_ptr<>                */
+#include <thread>                       /* std::thread fill workers         */
 
 #include "midi/file.hpp"                /* midi::file base read/write class */
 #include "midi/player.hpp"              /* midi::player coordinator class   */
@@ -242,7 +244,10 @@ file::file
     m_file_spec         (filespec),
     m_file_ppqn         (0),                /* will change                  */
     m_smf0_splitter     (),
-    m_smf0_split        (smf0split)
+    m_smf0_split        (smf0split),
+    m_fill_jobs         (0),                /* one fill worker per CPU      */
+    m_lazy_decode       (p.lazy_decode()),
+    m_packing           ()                  /* byte-exact by default        */
 {
     // no other code needed
 }
@@ -287,6 +292,8 @@ file::parse (const std::string & tag)
         m_file_size = m_data.size();                /* just logged for now  */
         util::file_message(tag, m_file_spec);
         result = parse_smf_1();
+        if (result && lazy_decode() && ! smf0_split())
+            (void) coordinator().prefetch_tracks();
     }
     return result;
 }
@@ -477,8 +484,9 @@ file::parse_smf_1 ()
                 printf("Parsing track %d\n", trk);
 #endif
 
+                bool deferred = lazy_decode() && ! smf0_split();
                 sp->track_number(trk);
-                offset = sp->parse_track(m_data, offset, tracklen);
+                offset = sp->parse_track(m_data, offset, tracklen, deferred);
                 ok = offset > 0;
                 if (ok)
                 {
@@ -653,21 +661,10 @@ file::put_header (int numtracks, int smfformat)
 bool
 file::put_track (/*const*/ midi::track & trk)
 {
-    trackdata & trkdata = trk.data();
-    bool result = trkdata.put_track(trk, 0, false); // tempotrack, doseqspec
+    bool result = fill_track(trk, false);
     if (result)
-    {
-        midi::ulong tracksize = midi::ulong(trkdata.size());
-        if (tracksize > 0)
-        {
-            put_long(c_mtrk_tag);               /* magic number 'MTrk'      */
-            put_long(tracksize);
-            while (! trkdata.done())            /* get track data to buffer */
-                put(trkdata.get());
+        put_track_data(trk);
 
-            // midi::bytes ender = lst.end_of_track();  // already in track
-        }
-    }
     return result;
 }
 
@@ -683,25 +680,133 @@ file::put_track (/*const*/ midi::track & trk)
 bool
 file::put_track_events (/*const*/ midi::track & trk)
 {
-    trackdata & trkdata = trk.data();
-    bool result = trkdata.put_track_events(trk);
+    bool result = fill_track(trk, true);
     if (result)
+        put_track_data(trk);
+
+    return result;
+}
+
+/**
+ *  Converts the events of a track to raw MIDI bytes in the track's own
+ *  trackdata buffer.  Nothing is added to the file data here, so this
+ *  function can be called for different tracks at the same time.
+ *
+ * \param trk
+ *      The MIDI track containing the events.
+ *
+ * \param eventsonly
+ *      If true, use trackdata::put_track_events(), otherwise use
+ *      trackdata::put_track().
+ *
+ * \return
+ *      Returns true if the track data could be filled.
+ */
+
+bool
+file::fill_track (midi::track & trk, bool eventsonly)
+{
+    trackdata & trkdata = trk.data();
+    return eventsonly ?
+        trkdata.put_track_events(trk, m_packing) :
+        trkdata.put_track(trk, 0, false, m_packing) ;   /* no SeqSpec   */
+}
+
+/**
+ *  Fills all of the given tracks, spreading the work over m_fill_jobs
+ *  worker threads.  Each worker grabs the next unfilled track index from
+ *  an atomic counter, so long and short tracks balance out.  The tracks
+ *  do not share any data while filling, and the file data is not touched,
+ *  so no locking is needed.  The caller then streams the buffers to the
+ *  file data in track order, which makes the output byte-identical to a
+ *  serial fill.
+ *
+ * \param tracks
+ *      The tracks to fill, in the order they will be written.
+ *
+ * \param eventsonly
+ *      Passed along to fill_track().
+ *
+ * \return
+ *      Returns true if every track could be filled.
+ */
+
+bool
+file::fill_tracks (std::vector<track *> & tracks, bool eventsonly)
+{
+    int count = int(tracks.size());
+    int jobs = m_fill_jobs;
+    if (jobs == 0)
+        jobs = int(std::thread::hardware_concurrency());
+
+    if (jobs > count)
+        jobs = count;
+
+    bool result = true;
+    if (jobs <= 1)
     {
-        midi::ulong tracksize = midi::ulong(trkdata.size());
-        if (tracksize > 0)
+        for (auto trkptr : tracks)
         {
-            put_long(c_mtrk_tag);               /* magic number 'MTrk'      */
-            put_long(tracksize);
-            trkdata.reset_position();           /* get back to first byte   */
-            while (! trkdata.done())            /* get track data to buffer */
-                put(trkdata.get());
-
-            // midi::bytes ender = lst.end_of_track();  // already in track
+            result = fill_track(*trkptr, eventsonly);
+            if (! result)
+                break;
         }
     }
+    else
+    {
+        std::atomic<int> next(0);
+        std::atomic<bool> ok(true);
+        auto worker = [&] ()
+        {
+            for (;;)
+            {
+                int t = next++;
+                if (t >= count || ! ok)
+                    break;
+
+                if (! fill_track(*tracks[t], eventsonly))
+                    ok = false;
+            }
+        };
+        std::vector<std::thread> workers;
+        workers.reserve(size_t(jobs - 1));
+        for (int j = 1; j < jobs; ++j)
+            workers.emplace_back(worker);
+
+        worker();                               /* this thread helps, too   */
+        for (auto & w : workers)
+            w.join();
+
+        result = ok;
+    }
     return result;
 }
 
+/**
+ *  Streams the already-filled raw bytes of a track to the file data as an
+ *  MTrk chunk.  An empty track is skipped.
+ *
+ * \param trk
+ *      The MIDI track whose trackdata has been filled by fill_track().
+ */
+
+void
+file::put_track_data (midi::track & trk)
+{
+    trackdata & trkdata = trk.data();
+    midi::ulong tracksize = midi::ulong(trkdata.size());
+    if (tracksize > 0)
+    {
+        put_long(c_mtrk_tag);                   /* magic number 'MTrk'      */
+        put_long(tracksize);
+        trkdata.reset_position();               /* get back to first byte   */
+        while (! trkdata.done())                /* get track data to buffer */
+            put(trkdata.get());
+
+        // midi::bytes ender = lst.end_of_track();  // already in track
+    }
+}
+
 /**
  *  Write the whole MIDI data and Seq24 information out to the file.
  *  Also see the put_song() function, for exporting to standard MIDI.
@@ -748,6 +853,8 @@ file::write (bool eventsonly)
         caption += std::to_string(m_file_ppqn);
         caption += " PPQN";
         util::file_message(caption, m_file_spec);
+
+        std::vector<track *> tracks;
         for (int t = 0; t < trackhigh; ++t)
         {
             track::pointer trkptr = coordinator().get_track(t);
@@ -760,15 +867,15 @@ file::write (bool eventsonly)
                     trkptr->track_number(), trkptr->event_count()
                 );
 #endif
-                if (eventsonly)
-                    result = put_track_events(*trkptr);
-                else
-                    result = put_track(*trkptr);
-
-                if (! result)
-                    break;
+                tracks.push_back(trkptr.get());
             }
         }
+        result = fill_tracks(tracks, eventsonly);
+        if (result)
+        {
+            for (auto trkptr : tracks)              /* stream in slot order */
+                put_track_data(*trkptr);
+        }
         if (result)
             result = m_data.write(m_file_spec);
     }
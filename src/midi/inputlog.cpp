@@ -0,0 +1,368 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          inputlog.cpp
+ *
+ *  This module defines the capture and replay of MIDI input sessions.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ */
+
+#include <algorithm>                    /* std::sort()                      */
+#include <chrono>                       /* std::chrono::steady_clock        */
+#include <cstring>                      /* std::memcmp()                    */
+#include <sstream>                      /* std::ostringstream               */
+
+#include "c_macros.h"                   /* not_nullptr() macro              */
+#include "midi/calculations.hpp"        /* midi::leb128_append()            */
+#include "midi/event.hpp"               /* midi::event class                */
+#include "midi/inputlog.hpp"            /* midi::inputlog class             */
+
+namespace midi
+{
+
+static const char c_inputlog_magic [] = "R66I";
+static const int c_inputlog_version = 1;
+
+/**
+ *  Reads one LEB128 value from the file.
+ */
+
+static bool
+read_varint (std::FILE * f, std::uint64_t & v)
+{
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int c = std::fgetc(f);
+        if (c == EOF)
+            return false;
+
+        v |= std::uint64_t(c & 0x7F) << shift;
+        if ((c & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+/*
+ * class inputlog
+ */
+
+inputlog::inputlog () :
+    m_file      (nullptr),
+    m_capturing (false),
+    m_replaying (false),
+    m_start_us  (0),
+    m_last_us   (0),
+    m_count     (0),
+    m_buffer    (),
+    m_mutex     ()
+{
+    // no code
+}
+
+inputlog::~inputlog ()
+{
+    close();
+}
+
+std::uint64_t
+inputlog::now_us ()
+{
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return std::uint64_t
+    (
+        std::chrono::duration_cast<std::chrono::microseconds>(t).count()
+    );
+}
+
+/**
+ *  Creates the capture file and starts the capture clock.
+ */
+
+bool
+inputlog::open_for_capture (const std::string & filename)
+{
+    close();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_file = std::fopen(filename.c_str(), "wb");
+    bool result = not_nullptr(m_file);
+    if (result)
+    {
+        result = std::fwrite(c_inputlog_magic, 1, 4, m_file) == 4 &&
+            std::fputc(c_inputlog_version, m_file) != EOF;
+
+        if (result)
+        {
+            m_start_us = m_last_us = now_us();
+            m_count = 0;
+            m_buffer.reserve(64);
+            m_capturing.store(true, std::memory_order_release);
+        }
+        else
+        {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Opens a capture file for replay, checking its header.
+ */
+
+bool
+inputlog::open_for_replay (const std::string & filename)
+{
+    close();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_file = std::fopen(filename.c_str(), "rb");
+    bool result = not_nullptr(m_file);
+    if (result)
+    {
+        char magic[4];
+        result = std::fread(magic, 1, 4, m_file) == 4 &&
+            std::memcmp(magic, c_inputlog_magic, 4) == 0 &&
+            std::fgetc(m_file) == c_inputlog_version;
+
+        if (result)
+        {
+            m_replaying = true;
+            m_last_us = 0;
+            m_count = 0;
+        }
+        else
+        {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+    return result;
+}
+
+void
+inputlog::close ()
+{
+    m_capturing.store(false, std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (not_nullptr(m_file))
+    {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+    m_replaying = false;
+}
+
+/**
+ *  Appends an input event.  Meant to be called from the input thread right
+ *  after the event is received, before it is handled.  If capture is off,
+ *  this costs one atomic load.
+ *
+ * \param ev
+ *      The incoming event, with its input bus set.
+ *
+ * \return
+ *      Returns true if the event was written.
+ */
+
+bool
+inputlog::capture (const event & ev)
+{
+    if (! capturing())
+        return false;
+
+    std::uint64_t now = now_us();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool result = not_nullptr(m_file);
+    if (result)
+    {
+        const midi::bytes & msg = ev.get_message().event_bytes();
+        m_buffer.clear();
+        leb128_append(m_buffer, now - m_last_us);
+        m_buffer.push_back(ev.input_bus());
+        leb128_append(m_buffer, msg.size());
+        m_buffer.insert(m_buffer.end(), msg.begin(), msg.end());
+        result = std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) ==
+            m_buffer.size();
+
+        if (result)
+        {
+            m_last_us = now;
+            ++m_count;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Reads the next event of a replay.
+ *
+ * \param [out] ev
+ *      Receives the event, with its input bus set and a zero timestamp.
+ *
+ * \param [out] time_us
+ *      Receives the capture time of the event, in microseconds after the
+ *      start of the capture.
+ *
+ * \return
+ *      Returns false at the end of the file or on a damaged record.
+ */
+
+bool
+inputlog::next (event & ev, std::uint64_t & time_us)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (is_nullptr(m_file) || ! m_replaying)
+        return false;
+
+    std::uint64_t delta, size;
+    int bus;
+    bool result = read_varint(m_file, delta) &&
+        (bus = std::fgetc(m_file)) != EOF &&
+        read_varint(m_file, size) && size > 0 && size < 0x100000;
+
+    if (result)
+    {
+        m_buffer.resize(size_t(size));
+        result = std::fread(m_buffer.data(), 1, m_buffer.size(), m_file) ==
+            m_buffer.size();
+    }
+    if (result)
+    {
+        ev = event();
+        result = ev.set_midi_event(0, m_buffer, m_buffer.size());
+        ev.set_input_bus(midi::bussbyte(bus));
+        m_last_us += delta;
+        time_us = m_last_us;
+        ++m_count;
+    }
+    return result;
+}
+
+/*
+ * class replaystats
+ */
+
+replaystats::replaystats () :
+    m_lateness_us   (),
+    m_service_us    (),
+    m_start_us      (0),
+    m_end_us        (0)
+{
+    // no code
+}
+
+void
+replaystats::start ()
+{
+    m_lateness_us.clear();
+    m_service_us.clear();
+    m_start_us = m_end_us = inputlog::now_us();
+}
+
+void
+replaystats::finish ()
+{
+    m_end_us = inputlog::now_us();
+}
+
+void
+replaystats::add (std::uint64_t lateness_us, std::uint64_t service_us)
+{
+    m_lateness_us.push_back(lateness_us);
+    m_service_us.push_back(service_us);
+}
+
+double
+replaystats::events_per_second () const
+{
+    std::uint64_t elapsed = m_end_us - m_start_us;
+    return elapsed > 0 ?
+        double(count()) * 1000000.0 / double(elapsed) : 0.0 ;
+}
+
+/**
+ *  Summarizes one set of samples: minimum, mean, median, 99th percentile,
+ *  and maximum, in microseconds.
+ */
+
+static std::string
+summarize (const std::string & tag, std::vector<std::uint64_t> samples)
+{
+    std::ostringstream os;
+    os << tag << " (us):";
+    if (samples.empty())
+    {
+        os << " none";
+    }
+    else
+    {
+        std::sort(samples.begin(), samples.end());
+
+        std::uint64_t total = 0;
+        for (auto s : samples)
+            total += s;
+
+        std::size_t n = samples.size();
+        os
+            << " min " << samples.front()
+            << " mean " << (total / n)
+            << " p50 " << samples[n / 2]
+            << " p99 " << samples[(n * 99) / 100]
+            << " max " << samples.back()
+            ;
+    }
+    return os.str();
+}
+
+/**
+ *  Provides a short report, one item per line, suitable for a CI log.
+ */
+
+std::string
+replaystats::report () const
+{
+    std::ostringstream os;
+    os
+        << "Events: " << count() << "\n"
+        << "Elapsed (us): " << (m_end_us - m_start_us) << "\n"
+        << "Throughput (events/s): " << events_per_second() << "\n"
+        << summarize("Lateness", m_lateness_us) << "\n"
+        << summarize("Service", m_service_us) << "\n"
+        ;
+    return os.str();
+}
+
+}           // namespace midi
+
+/*
+ * inputlog.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -25,7 +25,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2016-11-23
- * \updates       2023-07-20
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This file provides a base-class implementation for various master MIDI
@@ -133,8 +133,10 @@ masterbus::masterbus
 ) :
     m_selected_api      (rtl::rtmidi::api::unspecified),
     m_rt_api_ptr        (nullptr),
-    m_engine            (this, rapi, "mbus"),
+    m_engine            (this, rapi, engine_client_name()),
     m_mutex             (),
+    m_port_watch        (),
+    m_config_stage      (),
     m_client_handle     (nullptr),
     m_client_id         (0),
     m_max_busses        (c_busscount_max),
@@ -154,9 +156,9 @@ masterbus::masterbus
  *  But this function is called in the constructor, so that means that
  *  no masterbus was created.
  *
- *  This function works by creating temporary midi::bus_in (or midi::bus_out)
- *  objects in order to create the desired rtl::midi_api object for
- *  the engine, allowing us to get the MIDI client/engine handle for re-use.
+ *  The engine lists the input and output ports in one pass, if its API
+ *  can.  Otherwise, this function works by creating temporary rtmidi_in
+ *  and rtmidi_out objects, each with its own client, to list the ports.
  *
  * Other things we can do:
  *
@@ -178,7 +180,14 @@ masterbus::engine_query ()
     bool result = bool(client_info());
     if (result)
     {
-        result = get_all_port_info(*client_info(), selected_api());
+        ports & in = client_info()->io_ports(port::io::input);
+        ports & out = client_info()->io_ports(port::io::output);
+        int count = m_engine.get_all_io_port_info(in, out);
+        if (count >= 0)
+            result = count > 0;
+        else
+            result = get_all_port_info(*client_info(), selected_api());
+
         if (result)
         {
 #if defined PLATFORM_DEBUG
@@ -286,22 +295,31 @@ masterbus::panic (int displaybuss)
 
 /**
  *  Handle the sending of SYSEX events.  There's currently no
- *  implementation-specific API function for this call.
+ *  implementation-specific API function for this call; the output bus
+ *  array sends it, through the bus's output worker if output is
+ *  asynchronous.
  *
  * \threadsafe
  *
+ * \param bus
+ *      The output buss to send the event to.
+ *
  * \param ev
  *      Provides the event pointer to be set.
+ *
+ * \return
+ *      Returns true if the buss is active, so that the event was sent.
  */
 
 bool
 masterbus::sysex (midi::bussbyte bus, const event * ev)
 {
     xpc::automutex locker(m_mutex);
-    (void) bus;
-    (void) ev;
-    //  return m_outbus_array.sysex(bus, ev);
-    return false;
+    bool result = m_outbus_array.port_active(bus);
+    if (result)
+        m_outbus_array.send_sysex(bus, ev);
+
+    return result;
 }
 
 /**
@@ -327,10 +345,7 @@ void
 masterbus::play (midi::bussbyte bus, event * e24, midi::byte channel)
 {
     xpc::automutex locker(m_mutex);
-    (void) bus;
-    (void) e24;
-    (void) channel;
-    // m_outbus_array.play(bus, e24, channel);
+    m_outbus_array.send_event(bus, e24, channel);
 }
 
 void
@@ -341,6 +356,32 @@ masterbus::play_and_flush (midi::bussbyte bus, event * ev, midi::byte channel)
     flush();
 }
 
+/**
+ *  Starts or stops the output workers.  The output thread goes through
+ *  the workers in play() and the clock functions, so the worker vector is
+ *  only changed with the lock held.  Stopping drains the queues while
+ *  holding it, which holds up play() for as long.
+ */
+
+bool
+masterbus::async_output (bool flag, std::size_t capacity)
+{
+    xpc::automutex locker(m_mutex);
+    return m_outbus_array.async_output(flag, capacity);
+}
+
+/**
+ *  Turns latency compensation on or off, which may start the workers; so
+ *  the lock is held, as in async_output().
+ */
+
+bool
+masterbus::compensate_latency (bool flag)
+{
+    xpc::automutex locker(m_mutex);
+    return m_outbus_array.compensate_latency(flag);
+}
+
 /**
  *  Set the clock for the given (legal) buss number.  The legality checks
  *  are a little loose, however.
@@ -573,40 +614,46 @@ masterbus::poll_for_midi () const
 }
 
 /**
- *  Start the given MIDI port.  This function is called by
- *  api_get_midi_event() when the ALSA event SND_SEQ_EVENT_PORT_START is
- *  received.  Unlike port_exit(), the port_start() function does rely on
- *  API-specific code, so we do need to create a virtual api_port_start()
- *  function to implement the port-start event.
+ *  Notes that a MIDI port has appeared.  Called by the API's port callback
+ *  (the ALSA announce port, or JACK port registration), on its own thread,
+ *  so this function only queues the change.  The busses are re-bound later
+ *  by process_port_changes().
  *
  *  \threadsafe
- *      Quite a lot is done during the lock for the ALSA implimentation.
  *
  * \param client
- *      Provides the client number, which is actually an ALSA concept.
+ *      Provides the client number, which is actually an ALSA concept, or -1.
  *
  * \param port
- *      Provides the client port, which is actually an ALSA concept.
+ *      Provides the client port, which is actually an ALSA concept, or -1.
+ *
+ * \param name
+ *      The "client:port" name of the port.  If empty, only a bus with the
+ *      same numbers can be re-bound.
+ *
+ * \param alias
+ *      The alias of the port, if any.
+ *
+ * \return
+ *      Always returns true.
  */
 
 bool
-masterbus::port_start (int /*client*/, int /*port*/)
+masterbus::port_start
+(
+    int client, int port,
+    const std::string & name,
+    const std::string & alias
+)
 {
-    xpc::automutex locker(m_mutex);
-
-    // api_port_start(client, port);        // TODO
-
-    return false;
+    m_port_watch.post(portwatch::action::appeared, client, port, name, alias);
+    return true;
 }
 
 /**
- *  Turn off the given port for the given client.  Both the input and output
- *  busses for the given client are stopped: that is, set to inactive.
- *
- *  This function is called by api_get_midi_event() when the ALSA event
- *  SND_SEQ_EVENT_PORT_EXIT is received.  Since port_exit() has no direct
- *  API-specific code in it, we do not need to create a virtual
- *  api_port_exit() function to implement the port-exit event.
+ *  Notes that a MIDI port has gone.  As with port_start(), the change is
+ *  only queued.  Both the input and output busses on the port are made
+ *  inactive by process_port_changes().
  *
  * \threadsafe
  *
@@ -616,18 +663,167 @@ masterbus::port_start (int /*client*/, int /*port*/)
  *
  * \param port
  *      The port to be acted on.  Both parameter must be matched before the
- *      buss is made inactive.  This value is actually an ALSA concept.
+ *      buss is made inactive, unless the name is given.
+ *
+ * \param name
+ *      The name of the port, if the API still has it.
+ *
+ * \param alias
+ *      The alias of the port, if any.
+ *
+ * \return
+ *      Always returns true.
  */
 
 bool
-masterbus::port_exit (int /*client*/, int /*port*/)
+masterbus::port_exit
+(
+    int client, int port,
+    const std::string & name,
+    const std::string & alias
+)
 {
-    xpc::automutex locker(m_mutex);
+    m_port_watch.post(portwatch::action::vanished, client, port, name, alias);
+    return true;
+}
 
-    // m_outbus_array.port_exit(client, port);
-    // m_inbus_array.port_exit(client, port);
+/**
+ *  Applies the queued port changes to the input and output busses: a bus
+ *  whose port vanished is made inactive, and is re-bound by name when the
+ *  port comes back, even with new numbers.  The output thread sees only
+ *  the bus's active flag change.
+ *
+ *  Called from the player's input loop, never from the output thread,
+ *  since re-opening a port can take a while.  It costs one atomic load when
+ *  nothing has changed.  The lock, which play() also takes, is held only
+ *  to find and deactivate busses and to re-activate them; the port is
+ *  re-opened without it.
+ *
+ * \return
+ *      Returns the number of busses deactivated or re-bound.
+ */
 
-    return false;
+int
+masterbus::process_port_changes ()
+{
+    int result = 0;
+    std::vector<portwatch::change> changes;
+    if (m_port_watch.take(changes))
+    {
+        for (const auto & pc : changes)
+        {
+            if (pc.pw_action == portwatch::action::vanished)
+            {
+                xpc::automutex locker(m_mutex);
+                if (m_outbus_array.port_vanished(pc))
+                    ++result;
+
+                if (m_inbus_array.port_vanished(pc))
+                    ++result;
+            }
+            else
+            {
+                int ob, ib;
+                {
+                    xpc::automutex locker(m_mutex);
+                    ob = m_outbus_array.find_replug(pc);
+                    ib = m_inbus_array.find_replug(pc);
+                }
+                int client = pc.pw_client;
+                int port = pc.pw_port;
+                bool outok = ob >= 0 &&
+                    m_outbus_array.rebind(bussbyte(ob), client, port);
+
+                bool inok = ib >= 0 &&
+                    m_inbus_array.rebind(bussbyte(ib), client, port);
+
+                if (outok || inok)
+                {
+                    xpc::automutex locker(m_mutex);
+                    if (outok)
+                    {
+                        m_outbus_array.replugged(bussbyte(ob));
+                        ++result;
+                    }
+                    if (inok)
+                    {
+                        m_inbus_array.replugged(bussbyte(ib));
+                        ++result;
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ *  Finds what a configuration would change in the live busses, and stages
+ *  the changes for apply_configuration().  Busses whose settings are the
+ *  same are not touched.
+ *
+ * \param cfg
+ *      A configuration that has been parsed without error.
+ *
+ * \return
+ *      Returns the number of changes staged.
+ */
+
+int
+masterbus::stage_configuration (const busconfig & cfg)
+{
+    std::vector<busconfig::change> changes;
+    int result;
+    {
+        xpc::automutex locker(m_mutex);
+        result = cfg.changes(m_outbus_array, m_inbus_array, changes);
+    }
+    m_config_stage.post(changes);
+    return result;
+}
+
+/**
+ *  Reads the [midi-clock] and [midi-input] sections of an "rc" file and
+ *  stages the differences.  Reading a file can take a while, so this is
+ *  not to be called from an I/O thread; see player::reload_configuration().
+ *
+ * \param filename
+ *      The configuration file to read.
+ *
+ * \param [out] errmsg
+ *      Gets the reason the file was rejected.  Nothing is staged then.
+ *
+ * \return
+ *      Returns true if the file was good, even if nothing changed.
+ */
+
+bool
+masterbus::reload_configuration
+(
+    const std::string & filename, std::string & errmsg
+)
+{
+    busconfig cfg;
+    bool result = cfg.parse_file(filename, errmsg);
+    if (result)
+        (void) stage_configuration(cfg);
+
+    return result;
+}
+
+/**
+ *  Applies the staged configuration changes.  Called by the output thread
+ *  at the top of each frame, and by the input loop when not playing.  It
+ *  costs one atomic load when nothing is staged, and never blocks.
+ *
+ * \return
+ *      Returns the number of busses changed.
+ */
+
+int
+masterbus::apply_configuration ()
+{
+    return m_config_stage.apply(m_outbus_array, m_inbus_array);
 }
 
 /**
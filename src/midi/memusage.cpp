@@ -0,0 +1,117 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          memusage.cpp
+ *
+ *  This module defines the memory-accounting helper class.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ */
+
+#include <sstream>                      /* std::ostringstream               */
+
+#include "midi/memusage.hpp"            /* midi::memusage class             */
+
+namespace midi
+{
+
+memusage::memusage () :
+    m_event_count   (0),
+    m_event_bytes   (0),
+    m_payload_bytes (0),
+    m_undo_count    (0),
+    m_undo_bytes    (0),
+    m_trigger_count (0),
+    m_trigger_bytes (0),
+    m_cold_count    (0),
+    m_cold_bytes    (0),
+    m_other_bytes   (0)
+{
+    // no code
+}
+
+memusage &
+memusage::operator += (const memusage & rhs)
+{
+    m_event_count   += rhs.m_event_count;
+    m_event_bytes   += rhs.m_event_bytes;
+    m_payload_bytes += rhs.m_payload_bytes;
+    m_undo_count    += rhs.m_undo_count;
+    m_undo_bytes    += rhs.m_undo_bytes;
+    m_trigger_count += rhs.m_trigger_count;
+    m_trigger_bytes += rhs.m_trigger_bytes;
+    m_cold_count    += rhs.m_cold_count;
+    m_cold_bytes    += rhs.m_cold_bytes;
+    m_other_bytes   += rhs.m_other_bytes;
+    return *this;
+}
+
+/**
+ *  Folds the whole of another usage record into the undo category.  Used
+ *  for counting undo/redo copies of event-lists, where the events and their
+ *  payloads are all part of the undo history.
+ */
+
+void
+memusage::add_as_undo (const memusage & mu)
+{
+    m_undo_count += 1;
+    m_undo_bytes += mu.total_bytes();
+}
+
+/**
+ *  Provides a compact, one-line-per-category dump for the test
+ *  applications.
+ */
+
+std::string
+memusage::to_string (const std::string & tag) const
+{
+    std::ostringstream os;
+    if (! tag.empty())
+        os << tag << ":\n";
+
+    os
+        << "  events:   " << m_event_count << " (" << m_event_bytes
+            << " bytes)\n"
+        << "  payload:  " << m_payload_bytes << " bytes\n"
+        << "  undo:     " << m_undo_count << " (" << m_undo_bytes
+            << " bytes)\n"
+        << "  triggers: " << m_trigger_count << " (" << m_trigger_bytes
+            << " bytes)\n"
+        << "  cold:     " << m_cold_count << " (" << m_cold_bytes
+            << " bytes)\n"
+        << "  other:    " << m_other_bytes << " bytes\n"
+        << "  total:    " << total_bytes() << " bytes\n"
+        ;
+    return os.str();
+}
+
+}           // namespace midi
+
+/*
+ * memusage.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,179 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          notetracker.cpp
+ *
+ *  This module defines the per-channel record of sounding notes.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ */
+
+#include "midi/event.hpp"               /* midi::event                      */
+#include "midi/notetracker.hpp"         /* midi::notetracker                */
+
+namespace midi
+{
+
+/**
+ *  The index of the lowest set bit of a non-zero word.
+ */
+
+static inline int
+lowest_bit (std::uint64_t w)
+{
+#if defined __GNUC__
+    return __builtin_ctzll(w);
+#else
+    int result = 0;
+    while ((w & 1) == 0)
+    {
+        w >>= 1;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+notetracker::notetracker () :
+    m_bits          (),
+    m_counts        (),
+    m_channel_mask  (0),
+    m_sounding      (0)
+{
+    clear();
+}
+
+void
+notetracker::clear ()
+{
+    m_bits.fill(0);
+    m_counts.fill(0);
+    m_channel_mask = 0;
+    m_sounding = 0;
+}
+
+void
+notetracker::note_on (midi::byte channel, midi::byte note)
+{
+    int s = slot(channel, note);
+    if (m_counts[s] < 255)
+    {
+        int ch = int(channel & 0x0F);
+        int n = int(note & 0x7F);
+        ++m_counts[s];
+        ++m_sounding;
+        m_bits[ch * 2 + (n >> 6)] |= std::uint64_t(1) << (n & 63);
+        m_channel_mask |= 1u << ch;
+    }
+}
+
+/**
+ *  Matches a Note Off with a Note On on the same channel.
+ *
+ * \return
+ *      Returns false if the note is not sounding on that channel, in which
+ *      case the Note Off need not be sent.
+ */
+
+bool
+notetracker::note_off (midi::byte channel, midi::byte note)
+{
+    int s = slot(channel, note);
+    bool result = m_counts[s] > 0;
+    if (result)
+    {
+        --m_sounding;
+        if (--m_counts[s] == 0)
+        {
+            int ch = int(channel & 0x0F);
+            int n = int(note & 0x7F);
+            int w = ch * 2 + (n >> 6);
+            m_bits[w] &= ~(std::uint64_t(1) << (n & 63));
+            if (m_bits[ch * 2] == 0 && m_bits[ch * 2 + 1] == 0)
+                m_channel_mask &= ~(1u << ch);
+        }
+    }
+    return result;
+}
+
+/**
+ *  Makes the Note Offs for everything that is sounding, one per unmatched
+ *  Note On, and then clears the table.  Only channels and words with set
+ *  bits are visited.
+ *
+ * \param [out] offs
+ *      The Note Offs are appended here, in channel and note order, ready to
+ *      be sent as one batch.
+ *
+ * \param tick
+ *      The timestamp for the events.
+ *
+ * \param velocity
+ *      The Note Off velocity.
+ *
+ * \return
+ *      Returns the number of events appended.
+ */
+
+int
+notetracker::release
+(
+    std::vector<event> & offs,
+    midi::pulse tick,
+    midi::byte velocity
+)
+{
+    int result = 0;
+    for (unsigned mask = m_channel_mask; mask != 0; mask &= mask - 1)
+    {
+        int ch = lowest_bit(mask);
+        for (int half = 0; half < 2; ++half)
+        {
+            std::uint64_t w = m_bits[ch * 2 + half];
+            for ( ; w != 0; w &= w - 1)
+            {
+                int n = half * 64 + lowest_bit(w);
+                int c = int(m_counts[ch * c_notes_count + n]);
+                event off
+                (
+                    tick, midi::status::note_off, midi::byte(ch), n, velocity
+                );
+                for (int i = 0; i < c; ++i)
+                    offs.push_back(off);
+
+                result += c;
+            }
+        }
+    }
+    clear();
+    return result;
+}
+
+}           // namespace midi
+
+/*
+ * notetracker.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,381 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          outworker.cpp
+ *
+ *  This module defines the per-bus output worker.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ */
+
+#include <chrono>                       /* std::chrono::steady_clock, etc.  */
+
+#include "c_macros.h"                   /* not_nullptr() macro              */
+#include "midi/bus.hpp"                 /* midi::bus output functions       */
+#include "midi/outworker.hpp"           /* midi::outworker class            */
+
+namespace midi
+{
+
+/**
+ *  Rounds the capacity up to a power of 2.
+ */
+
+static std::size_t
+ring_size (std::size_t capacity)
+{
+    std::size_t result = 16;
+    while (result < capacity)
+        result <<= 1;
+
+    return result;
+}
+
+/**
+ *  Allocates the slots.  The worker is not started until start() is called.
+ *
+ * \param b
+ *      The output bus to drive.  It must outlive the worker.
+ *
+ * \param capacity
+ *      The minimum number of queued items.  Rounded up to a power of 2.
+ */
+
+outworker::outworker (bus & b, std::size_t capacity) :
+    m_bus           (b),
+    m_ring          (ring_size(capacity)),
+    m_mask          (m_ring.size() - 1),
+    m_delay_us      (0),
+    m_head          (0),
+    m_tail          (0),
+    m_sent          (0),
+    m_failed        (0),
+    m_dropped       (0),
+    m_max_backlog   (0),
+    m_mutex         (),
+    m_wakeup        (),
+    m_sleeping      (false),
+    m_running       (false),
+    m_thread        (),
+    m_paused        (false),
+    m_parked        (false),
+    m_parked_cond   ()
+{
+    // no code
+}
+
+outworker::~outworker ()
+{
+    stop();
+}
+
+bool
+outworker::start ()
+{
+    bool result = ! m_running;
+    if (result)
+    {
+        m_running = true;
+        m_thread = std::thread(&outworker::worker, this);
+    }
+    return result;
+}
+
+/**
+ *  Stops the worker after it has sent whatever is still queued.  A paused
+ *  worker stops at once, since the bus may be in use.
+ */
+
+void
+outworker::stop ()
+{
+    if (m_running)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_wakeup.notify_one();
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+}
+
+/**
+ *  Stops the worker from touching the bus, and waits until it is parked
+ *  between items, so that an item being sent has been sent.  The queue is
+ *  left as it is.  Not to be called from the worker, and each call must be
+ *  followed by resume().  Returns at once if the worker is not running.
+ */
+
+void
+outworker::pause ()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_paused = true;
+    if (m_running)
+    {
+        m_wakeup.notify_one();
+        auto parked = [this] () { return m_parked || ! m_running; };
+        m_parked_cond.wait(lock, parked);
+    }
+}
+
+/**
+ *  Lets a paused worker carry on with the queue.
+ */
+
+void
+outworker::resume ()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_paused = false;
+    }
+    m_wakeup.notify_one();
+}
+
+std::int64_t
+outworker::now_us ()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>
+    (
+        steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+/**
+ *  Gets the next free slot for the producer, or null if the queue is full,
+ *  in which case the drop is counted.  The slot's due time is set here, so
+ *  that every kind of item gets the same delay.
+ */
+
+outworker::item *
+outworker::claim ()
+{
+    std::size_t head = m_head.load(std::memory_order_relaxed);
+    std::size_t tail = m_tail.load(std::memory_order_acquire);
+    if (head - tail > m_mask)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    item * result = &m_ring[head & m_mask];
+    long delay = m_delay_us.load(std::memory_order_relaxed);
+    result->i_due = delay > 0 ? now_us() + delay : 0 ;
+    return result;
+}
+
+/**
+ *  Makes the claimed slot visible to the worker, and wakes it if it is
+ *  asleep.  The sequentially-consistent store/load pair with the worker's
+ *  m_sleeping store/backlog load means at least one side sees the other.
+ */
+
+void
+outworker::publish ()
+{
+    std::size_t head = m_head.load(std::memory_order_relaxed) + 1;
+    m_head.store(head, std::memory_order_seq_cst);
+
+    std::size_t count = head - m_tail.load(std::memory_order_relaxed);
+    if (count > m_max_backlog.load(std::memory_order_relaxed))
+        m_max_backlog.store(count, std::memory_order_relaxed);
+
+    if (m_sleeping.load(std::memory_order_seq_cst))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wakeup.notify_one();
+    }
+}
+
+/**
+ *  Queues an event, SysEx, or clock start/stop.  Called from the output
+ *  thread only.
+ *
+ * \return
+ *      Returns false if the queue was full and the item was dropped.
+ */
+
+bool
+outworker::post (action a, const event * ev, byte channel)
+{
+    item * it = claim();
+    bool result = not_nullptr(it);
+    if (result)
+    {
+        it->i_action = a;
+        it->i_channel = channel;
+        if (not_nullptr(ev))
+            it->i_event = *ev;
+
+        publish();
+    }
+    return result;
+}
+
+/**
+ *  Queues a clock operation that needs a tick.
+ */
+
+bool
+outworker::post_clock (action a, pulse tick)
+{
+    item * it = claim();
+    bool result = not_nullptr(it);
+    if (result)
+    {
+        it->i_action = a;
+        it->i_tick = tick;
+        publish();
+    }
+    return result;
+}
+
+outworker::statistics
+outworker::stats () const
+{
+    statistics result;
+    result.posted = m_head.load(std::memory_order_acquire);
+    result.sent = m_sent.load(std::memory_order_relaxed);
+    result.failed = m_failed.load(std::memory_order_relaxed);
+    result.dropped = m_dropped.load(std::memory_order_relaxed);
+    result.backlog = backlog();
+    result.max_backlog = m_max_backlog.load(std::memory_order_relaxed);
+    return result;
+}
+
+void
+outworker::dispatch (const item & it)
+{
+    bool ok = true;
+    switch (it.i_action)
+    {
+    case action::event:
+        ok = m_bus.send_event(&it.i_event, it.i_channel);
+        break;
+
+    case action::sysex:
+        ok = m_bus.send_sysex(&it.i_event);
+        break;
+
+    case action::clock_start:
+        ok = m_bus.clock_start();
+        break;
+
+    case action::clock_stop:
+        ok = m_bus.clock_stop();
+        break;
+
+    case action::clock_continue:
+        ok = m_bus.clock_continue(it.i_tick);
+        break;
+
+    case action::init_clock:
+        ok = m_bus.init_clock(it.i_tick);
+        break;
+    }
+    m_sent.fetch_add(1, std::memory_order_relaxed);
+    if (! ok)
+        m_failed.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ *  The worker thread.  Sends everything queued, then sleeps until the
+ *  producer wakes it.  The timed wait is only a backstop.  On stop, the
+ *  rest of the queue is still sent, so that Note Offs are not lost.
+ *
+ *  With a delay set, the worker waits for the item at the front to come
+ *  due.  Items leave in the order posted, so a change in the delay never
+ *  reorders them.  On stop the delay is ignored.
+ *
+ *  While paused, the worker parks before the next item.  A stop ends the
+ *  pause.
+ */
+
+void
+outworker::worker ()
+{
+    for (;;)
+    {
+        if (m_paused.load(std::memory_order_acquire))
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_parked = true;
+            m_parked_cond.notify_all();
+            auto resumed = [this] () { return ! m_paused || ! m_running; };
+            m_wakeup.wait(lock, resumed);
+            m_parked = false;
+            if (m_paused)
+                break;                      /* stopped while paused         */
+
+            continue;
+        }
+
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail != m_head.load(std::memory_order_acquire))
+        {
+            const item & it = m_ring[tail & m_mask];
+            if (it.i_due > 0 && m_running)
+            {
+                std::int64_t wait = it.i_due - now_us();
+                if (wait > 0)
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    if (m_running && ! m_paused)
+                    {
+                        m_wakeup.wait_for
+                        (
+                            lock, std::chrono::microseconds(wait)
+                        );
+                    }
+                    continue;
+                }
+            }
+            dispatch(it);
+            m_tail.store(tail + 1, std::memory_order_release);
+            continue;
+        }
+        if (! m_running)
+            break;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_sleeping.store(true, std::memory_order_seq_cst);
+        bool idle = m_head.load(std::memory_order_seq_cst) == tail;
+        if (m_running && ! m_paused && idle)
+            m_wakeup.wait_for(lock, std::chrono::milliseconds(10));
+
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+}           // namespace midi
+
+/*
+ * outworker.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -24,15 +24,17 @@
  * \library       rtl66
  * \author        Chris Ahlstrom and others
  * \date          2022-07-10
- * \updates       2025-01-31
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  */
 
 #include <algorithm>                    /* std::find() for std::vector      */
+#include <chrono>                       /* std::chrono::microseconds        */
 
 #include "c_macros.h"                   /* not_nullptr macro                */
 #include "midi/calculations.hpp"        /* midi::tempo_us_from_bpm()        */
+#include "midi/eventfeed.hpp"           /* midi::eventfeed observer feed    */
 #include "midi/file.hpp"                /* midi::read_midi_file()           */
 #include "midi/player.hpp"              /* midi::player, this class         */
 #include "rtl/midi/find_midi_api.hpp"   /* rtl::find_midi_api() etc.        */
@@ -104,6 +106,12 @@ player::player (int out_portnumber, int in_portnumber) :
     m_track_max             (1024),
     m_track_high            (track::unassigned()),
     m_sort_on_install       (false),
+    m_lazy_decode           (false),
+    m_prefetch_thread       (),
+    m_prefetch_stop         (false),
+    m_reload_thread         (),
+    m_reload_error          (),
+    m_reload_ok             (true),
     m_smf_format            (1),
     m_out_thread            (),
     m_in_thread             (),
@@ -113,8 +121,20 @@ player::player (int out_portnumber, int in_portnumber) :
     m_jack_pad              (),                 /* data for JACK... & ALSA  */
     m_jack_tick             (0),
     m_dont_reset_ticks      (false),            /* support for pausing      */
+    m_loop_jack_positioned  (false),
+    m_loop_notes            (track::wrapnotes::close),
+    m_play_transform        (),
+    m_frame_transform       (),
     m_condition_var         (*this),            /* private access via cv()  */
     m_clock_info            (),
+    m_input_capture         (),
+    m_event_feed            (),
+    m_frame_clock           (nullptr),
+    m_mtc_generator         (),
+    m_mtc_bus               (midi::null_buss()),
+    m_mtc_follower          (),
+    m_mtc_follow            (false),
+    m_mtc_mutex             (),
     m_transport_info        (),                 /* a reference or pointer?  */
 #if defined RTL66_BUILD_JACK
     m_jack_transport                // TODO: use transportinfo() as a parameter.
@@ -142,6 +162,10 @@ player::player (int out_portnumber, int in_portnumber) :
 
 player::~player ()
 {
+    stop_prefetch();
+    if (m_reload_thread.joinable())
+        m_reload_thread.join();
+
     (void) finish();
 }
 
@@ -519,10 +543,174 @@ bool
 player::clear_all (bool clearplaylist)
 {
     (void) clearplaylist;
+    stop_prefetch();
     track_list().clear();
     return true;
 }
 
+/**
+ *  Decodes the tracks left deferred by a lazy load (see lazy_decode()).
+ *  A track that is needed before its turn is decoded on demand anyway, so
+ *  this only moves the work out of the way of playback.
+ *
+ * \param background
+ *      If true (the default), a thread does the decoding and this function
+ *      returns at once.  Otherwise the tracks are decoded before returning.
+ *
+ * \return
+ *      Returns the number of tracks that were deferred.
+ */
+
+int
+player::prefetch_tracks (bool background)
+{
+    stop_prefetch();
+
+    std::vector<track::pointer> pending;
+    for (const auto & trk : track_list().tracks())
+    {
+        if (trk && trk->is_deferred())
+            pending.push_back(trk);
+    }
+
+    int result = int(pending.size());
+    if (result > 0)
+    {
+        m_prefetch_stop = false;
+        if (background)
+            m_prefetch_thread = std::thread(&player::prefetch, this, pending);
+        else
+            prefetch(pending);
+    }
+    return result;
+}
+
+void
+player::stop_prefetch ()
+{
+    m_prefetch_stop = true;
+    if (m_prefetch_thread.joinable())
+        m_prefetch_thread.join();
+}
+
+/**
+ *  Decodes the pending tracks in priority order: an armed track first, then
+ *  the rest by track number.  The priority is checked again for each
+ *  track, so one armed while the prefetch runs goes next.  The shared
+ *  pointers keep each track alive even if it is deleted meanwhile.
+ */
+
+void
+player::prefetch (std::vector<track::pointer> pending)
+{
+    while (! pending.empty() && ! m_prefetch_stop)
+    {
+        auto next = std::find_if
+        (
+            pending.begin(), pending.end(),
+            [] (const track::pointer & t) { return t->armed(); }
+        );
+        if (next == pending.end())
+            next = pending.begin();
+
+        (void) (*next)->decode_deferred();
+        pending.erase(next);
+    }
+}
+
+/**
+ *  Reloads the clock and input settings of the busses from an "rc" file,
+ *  without stopping playback.  Only the busses whose settings differ are
+ *  changed, by the output thread at the top of its next frame (see
+ *  masterbus::apply_configuration()), and no port is re-opened.  A file
+ *  with an error is rejected whole.
+ *
+ * \param filename
+ *      The configuration file to read.
+ *
+ * \param background
+ *      If true (the default), a thread reads the file and this function
+ *      returns at once; call finish_reload() for the outcome.  Otherwise the
+ *      file is read and staged before returning.
+ *
+ * \return
+ *      Returns false if there is no master bus, or, when not in the
+ *      background, if the file was rejected.
+ */
+
+bool
+player::reload_configuration (const std::string & filename, bool background)
+{
+    bool result = bool(m_master_bus);
+    if (result)
+    {
+        (void) finish_reload();
+        if (background)
+            m_reload_thread = std::thread(&player::reload, this, filename);
+        else
+        {
+            reload(filename);
+            result = finish_reload();
+        }
+    }
+    return result;
+}
+
+/**
+ *  Waits for a background reload, if any, and reports its error.
+ *
+ * \return
+ *      Returns false if the last reload rejected its file.
+ */
+
+bool
+player::finish_reload ()
+{
+    if (m_reload_thread.joinable())
+        m_reload_thread.join();
+
+    bool result = m_reload_ok;
+    if (! result)
+    {
+        append_error_message(m_reload_error);
+        m_reload_error.clear();
+        m_reload_ok = true;
+    }
+    return result;
+}
+
+/**
+ *  The work of reload_configuration().  The error is kept for
+ *  finish_reload(), since append_error_message() is not for other threads.
+ */
+
+void
+player::reload (std::string filename)
+{
+    m_reload_ok = m_master_bus->reload_configuration(filename, m_reload_error);
+}
+
+/**
+ *  Totals the memory held by all of the tracks.  Derived classes add their
+ *  own storage (undo stacks, clipboards, playlists) to this value.  This is
+ *  a read-only walk of the track list, cheap enough to call once a second.
+ *
+ * \return
+ *      Returns the accumulated memory usage.
+ */
+
+memusage
+player::memory_usage () const
+{
+    memusage result;
+    for (const auto & trk : track_list().tracks())
+    {
+        if (trk)
+            trk->memory_usage(result);
+    }
+    return result;
+}
+
 /**
  *  For all active patterns/tracks, get its playing state, turn off the
  *  playing notes, set playing to false, zero the markers, and, if not in
@@ -558,6 +746,25 @@ player::reset_tracks (bool p)
      */
 }
 
+/**
+ *  Moves the active tracks from the right marker back to the left marker,
+ *  after the tail of the loop has been played, closing or carrying their
+ *  sounding notes per loop_notes().  Inactive tracks have nothing to do.
+ *  The transport tick is set to just before L, so that play() does not
+ *  take the head of the loop for a replay of the last frame.
+ */
+
+void
+player::loop_wrap (midi::pulse rtick, midi::pulse ltick)
+{
+    for (auto & trk : track_list().tracks())
+    {
+        if (trk->active())
+            trk->loop_wrap(rtick, ltick, loop_notes());
+    }
+    set_tick(ltick - 1);
+}
+
 /**
  *  Creates the midi::masterbus.  We need to delay creation until launch time,
  *  so that settings can be obtained before determining just how to set up the
@@ -580,7 +787,11 @@ player::create_master_bus ()
          *      rtl::rtmidi::api midiapi = rtl::rtmidi::selected(api);
          */
 
-         rtl::rtmidi::api midiapi = rtl::find_midi_api();
+        rtl::rtmidi::api midiapi = rtl::find_midi_api
+        (
+            rtl::rtmidi::api::unspecified,
+            midi::masterbus::engine_client_name()
+        );
         if (midiapi != rtl::rtmidi::api::unspecified)
         {
             /*
@@ -691,6 +902,13 @@ player::launch ()
             m_master_bus->get_port_statuses(m_clocks, m_inputs);
 #endif
 
+            /*
+             * The busses are up, so ask the APIs for their output latencies
+             * (only JACK reports them) before any output is sent.  The
+             * configured ones come in through reload_configuration().
+             */
+
+            (void) m_master_bus->query_output_latencies();
             if (m_in_portnumber >= 0)
                 launch_input_thread();
 
@@ -857,6 +1075,7 @@ player::finish ()
         cv().signal();                      /* signal the end of play       */
         (void) out_thread().finish();
         (void) in_thread().finish();
+        m_event_feed.close();               /* no publisher is left         */
 
         bool ok = deinit_transport();
 
@@ -946,7 +1165,10 @@ player::left_tick (midi::pulse tick)
         transportinfo().tick(tick);
     }
     else if (! is_jack_running())
+    {
         transportinfo().tick(tick);
+        (void) chase(tick);                     /* JACK: jack_reposition()  */
+    }
 
 //  if (m_left_tick >= m_right_tick)
 //      m_right_tick = m_left_tick + m_one_measure;
@@ -1014,7 +1236,39 @@ player::left_tick_snap (midi::pulse tick, midi::pulse snap)
     if (is_jack_master())                       /* don't use in slave mode  */
         position_jack(true, tick);
     else if (! is_jack_running())
+    {
         transportinfo().tick(tick);
+        (void) chase(tick);
+    }
+}
+
+/**
+ *  Restores the controller state in effect at a new position.  Each active
+ *  track sends the program changes, control changes, and pitch bend that
+ *  precede the tick (see track::chase()), and the last tempo found is
+ *  applied.  Called when the transport jumps.
+ *
+ * \param tick
+ *      The new position.
+ *
+ * \return
+ *      Returns the number of events sent.
+ */
+
+int
+player::chase (midi::pulse tick)
+{
+    int result = 0;
+    midi::bpm tempo = 0.0;
+    for (auto & trk : track_list().tracks())
+    {
+        if (trk->active())
+            result += trk->chase(tick, tempo);
+    }
+    if (tempo > 0.0 && tempo != beats_per_minute())
+        (void) beats_per_minute(tempo);
+
+    return result;
 }
 
 void
@@ -1323,6 +1577,7 @@ player::jack_reposition (midi::pulse tick, midi::pulse stoptick)
         set_reposition(true);
         start_tick(tick);
         jack_stop_tick(tick);
+        (void) chase(tick);
     }
 }
 
@@ -1458,9 +1713,18 @@ player::output_func ()
         long current;                           /* current time             */
         long elapsed_us, delta_us;              /* current - last           */
         long last = xpc::microtime();           /* beginning time           */
+        bool framed = false;                    /* following audio frames   */
+        transport::clock::frameclock::frame lastframe = 0;
+        if (frame_clock_active())
+            m_frame_clock->tempo(bpmfactor, ppq);
+
+        if (mtc_output())
+            mtc_locate(startpoint * pus * 1.0e-6);
+
         transportinfo().resolution_change_clear();
         while (is_running())
         {
+            (void) m_master_bus->apply_configuration(); /* staged reload    */
             if (transportinfo().resolution_change())    /* atomic boolean   */
             {
                 bwdenom = 4.0 / beat_width();
@@ -1473,6 +1737,8 @@ player::output_func ()
                 (
                     bpmfactor, ppq, bpm_times_ppqn, dct, pus
                 );
+                if (frame_clock_active())
+                    m_frame_clock->tempo(bpmfactor, ppq);
             }
 
             /**
@@ -1483,11 +1749,46 @@ player::output_func ()
             current = xpc::microtime();
             delta_us = elapsed_us = current - last;
 
-            long long delta_tick_num = bpm_times_ppqn * delta_us +
-                pad().js_delta_tick_frac;
+            /*
+             * With an active frame clock, the time elapsed is the frames
+             * the audio stream has counted, in units of 1/samplerate
+             * seconds instead of microseconds; the remainder is carried
+             * the same way, so there is no drift against the audio.
+             */
 
-            long delta_tick = long(delta_tick_num / 60000000LL);
-            pad().js_delta_tick_frac = long(delta_tick_num % 60000000LL);
+            long long delta_tick_num;
+            long long delta_tick_den;
+            if (frame_clock_active())
+            {
+                auto frames = m_frame_clock->frames();
+                if (! framed)
+                {
+                    lastframe = frames;
+                    pad().js_delta_tick_frac = 0;
+                    framed = true;
+                }
+                long long delta_frames = (long long)(frames - lastframe);
+                delta_tick_num = bpm_times_ppqn * delta_frames +
+                    pad().js_delta_tick_frac;
+
+                delta_tick_den = 60LL * m_frame_clock->sample_rate();
+                lastframe = frames;
+            }
+            else
+            {
+                if (framed)
+                {
+                    pad().js_delta_tick_frac = 0;
+                    framed = false;
+                }
+                delta_tick_num = bpm_times_ppqn * delta_us +
+                    pad().js_delta_tick_frac;
+
+                delta_tick_den = 60000000LL;
+            }
+
+            long delta_tick = long(delta_tick_num / delta_tick_den);
+            pad().js_delta_tick_frac = long(delta_tick_num % delta_tick_den);
 #if 0
             if (m_usemidiclock)
             {
@@ -1506,6 +1807,16 @@ player::output_func ()
                 delta_tick = m_clock_info.adjust_midi_tick();
             }
 #endif
+            if (m_mtc_follow)
+            {
+                double mtcseconds;
+                if (mtc_position(current * 1.0e-6, mtcseconds))
+                {
+                    double target = mtcseconds * 1.0e6 / pus;
+                    delta_tick = long(target - pad().js_current_tick);
+                    pad().js_delta_tick_frac = 0;
+                }
+            }
 
             bool jackrunning = jack_output(pad());
             if (jackrunning)
@@ -1550,29 +1861,32 @@ player::output_func ()
                      * code, so it is now permanent code.
                      */
 
-                    static bool jack_position_once = false;
                     midi::pulse rtick = right_tick();     /* can change? */
-                    if (pad().js_current_tick >= rtick)
+                    double looptick = pad().js_current_tick;
+                    if (transportinfo().loop_wrap(looptick) > 0)
                     {
-                        if (is_jack_master() && ! jack_position_once)
+                        if (is_jack_master() && ! m_loop_jack_positioned)
                         {
                             position_jack(true, left_tick());
-                            jack_position_once = true;
+                            m_loop_jack_positioned = true;
                         }
 
-                        double leftover_tick = pad().js_current_tick - rtick;
+                        /*
+                         * Play the tail of the frame, [cur, R), then wrap
+                         * only the tracks that need it.  The head of the
+                         * frame, [L, L + leftover], is played below, in
+                         * this same iteration.  Whole passes skipped by a
+                         * stall are not replayed in a burst.
+                         */
+
                         if (jack_transport_not_starting())  /* no FF/RW xrun */
-                        {
                             play(rtick - 1);
-                        }
-                        reset_tracks();
 
-                        midi::pulse ltick = left_tick();
-                        set_last_ticks(ltick);
-                        pad().js_current_tick = double(ltick) + leftover_tick;
+                        loop_wrap(rtick, left_tick());
+                        pad().js_current_tick = looptick;
                     }
                     else
-                        jack_position_once = false;
+                        m_loop_jack_positioned = false;
                 }
 
                 /*
@@ -1595,6 +1909,21 @@ player::output_func ()
                 (
                     midi::clock::action::emit, midi::pulse(pad().js_clock_tick)
                 );
+                if (mtc_output())
+                    mtc_emit(pad().js_current_tick * pus * 1.0e-6);
+
+                eventfeed::pin pinned;                  /* see close()      */
+                eventfeed * ef = pinned.feed();         /* rate-limited     */
+                if (not_nullptr(ef))
+                {
+                    ef->publish_transport
+                    (
+                        midi::pulse(pad().js_current_tick),
+                        m_master_bus->BPM(), ppq, true,
+                        transportinfo().looping(),
+                        beats_per_bar(), beat_width()
+                    );
+                }
             }
 
             /*
@@ -1612,6 +1941,14 @@ player::output_func ()
             if (next_clock_delta_us < (c_thread_trigger_width_us * 2.0))
                 delta_us = long(next_clock_delta_us);
 
+            if (mtc_output())                   /* wake for the next MTC    */
+            {
+                double nextqf = m_mtc_generator.next_seconds() * 1.0e6;
+                long mtc_us = long(nextqf - pad().js_current_tick * pus);
+                if (mtc_us >= 0 && mtc_us < delta_us)
+                    delta_us = mtc_us;
+            }
+
             if (delta_us > 0)
             {
                 (void) xpc::microsleep(int(delta_us));
@@ -1691,7 +2028,9 @@ player::input_func ()
 }
 
 /**
- *  A helper function for input_func().
+ *  A helper function for input_func().  Also applies any port changes
+ *  (see masterbus::process_port_changes()) here, off the output thread, and
+ *  a reloaded configuration when the output thread is not playing.
  */
 
 bool
@@ -1699,7 +2038,13 @@ player::poll_cycle ()
 {
     bool result = ! done();
     if (result)
+    {
+        (void) m_master_bus->process_port_changes();    /* hot-plugging     */
+        if (! is_running())
+            (void) m_master_bus->apply_configuration(); /* reload, stopped  */
+
         result = m_master_bus->poll_for_midi() > 0;
+    }
 
     if (result)
     {
@@ -1719,70 +2064,211 @@ player::poll_cycle ()
 #endif
             if (incoming)
             {
-                if (ev.is_below_sysex())                    /* below 0xF0   */
-                {
+                if (m_input_capture.capturing())
+                    (void) m_input_capture.capture(ev);
+
+                if (! handle_input_event(ev))
+                    return false;                   /* e.g. sense/reset     */
+            }
+        } while (m_master_bus->is_more_input());
+    }
+    return result;
+}
+
+/**
+ *  Handles one incoming event, whether from the input ports or from a
+ *  replay of a captured input session (see replay_input()).  This is the
+ *  body of the poll_cycle() loop.
+ *
+ * \return
+ *      Returns false if input processing should stop.
+ */
+
+bool
+player::handle_input_event (event & ev)
+{
+    if (ev.is_below_sysex())                    /* below 0xF0   */
+    {
 #if defined RTL66_PLATFORM_DEBUG_TMI
-                    std::string estr = ev.to_string();
-                    util::status_message("MIDI event", estr);
+        std::string estr = ev.to_string();
+        util::status_message("MIDI event", estr);
 #endif
 #if defined USE_MASTER_BUS
-                    if (m_master_bus->is_dumping())         /* see banner   */
-                    {
-                        ev.set_timestamp(tick());
-                        if (m_filter_by_channel)
-                            m_master_bus->dump_midi_input(ev);
-                        else
-                            m_master_bus->get_track()->stream_event(ev);
-                    }
+        if (m_master_bus->is_dumping())         /* see banner   */
+        {
+            ev.set_timestamp(tick());
+            if (m_filter_by_channel)
+                m_master_bus->dump_midi_input(ev);
+            else
+                m_master_bus->get_track()->stream_event(ev);
+        }
 #endif
-                }
-                else if (ev.is_midi_start())
-                {
-                    midi_start();
-                }
-                else if (ev.is_midi_continue())
-                {
-                    midi_continue();
-                }
-                else if (ev.is_midi_stop())
-                {
-                    midi_stop();
-                }
-                else if (ev.is_midi_clock())
-                {
-                    midi_clock();
-                }
-                else if (ev.is_midi_song_pos())
-                {
-                    midi_song_pos(ev);
-                }
-                else if (ev.is_tempo())             /* added for issue #76  */
-                {
-                    /*
-                     * Should we do this only if JACK transport is not
-                     * enabled?
-                     */
+    }
+    else if (ev.is_midi_start())
+    {
+        midi_start();
+    }
+    else if (ev.is_midi_continue())
+    {
+        midi_continue();
+    }
+    else if (ev.is_midi_stop())
+    {
+        midi_stop();
+    }
+    else if (ev.is_midi_clock())
+    {
+        midi_clock();
+    }
+    else if (ev.is_midi_song_pos())
+    {
+        midi_song_pos(ev);
+    }
+    else if (ev.is_quarter_frame())
+    {
+        midi_quarter_frame(ev);
+    }
+    else if (ev.is_tempo())             /* added for issue #76  */
+    {
+        /*
+         * Should we do this only if JACK transport is not
+         * enabled?
+         */
 
-                    if (is_jack_master() || ! is_jack_running())
-                        (void) beats_per_minute(ev.tempo());
-                }
-                else if (ev.is_sysex())
-                {
-                    midi_sysex(ev);
-                }
+        if (is_jack_master() || ! is_jack_running())
+            (void) beats_per_minute(ev.tempo());
+    }
+    else if (ev.is_sysex())
+    {
+        midi_sysex(ev);
+    }
 #if defined USE_ACTIVE_SENSE_AND_RESET
-                else if (ev.is_sense_reset())
-                {
-                    return false;                   /* see note in banner   */
-                }
+    else if (ev.is_sense_reset())
+    {
+        return false;                   /* see note in banner   */
+    }
 #endif
-                else
-                {
-                    /* ignore the event */
-                }
+    else
+    {
+        /* ignore the event */
+    }
+    return true;
+}
+
+/**
+ *  Starts recording incoming MIDI events to a capture file.  Every event
+ *  read by poll_cycle() is written with its bus and arrival time, before it
+ *  is handled.
+ */
+
+bool
+player::start_input_capture (const std::string & filename)
+{
+    bool result = m_input_capture.open_for_capture(filename);
+    if (! result)
+        util::file_error("Cannot capture input to", filename);
+
+    return result;
+}
+
+void
+player::stop_input_capture ()
+{
+    if (m_input_capture.capturing())
+        m_input_capture.close();
+}
+
+/**
+ *  Opens the observer feed, so that the output busses and the output
+ *  thread publish to it.  Best opened before launch(), so that observers
+ *  see everything from the start.  finish() closes it.
+ *
+ * \param name
+ *      The shared-memory name; see eventfeed::open().
+ *
+ * \return
+ *      Returns true if the feed is open.
+ */
+
+bool
+player::open_event_feed (const std::string & name)
+{
+    bool result = m_event_feed.open(name);
+    if (! result)
+        util::error_message("Cannot open the event feed", name);
+
+    return result;
+}
+
+/**
+ *  Feeds a captured input session back through handle_input_event(), the
+ *  same path the input thread uses, so that a bug seen live can be
+ *  reproduced, and latency regressions measured, without the hardware.
+ *
+ * \param filename
+ *      The file written by start_input_capture().
+ *
+ * \param realtime
+ *      If true, each event is delivered at its original offset from the
+ *      start of the replay, and the lateness of each delivery is measured.
+ *      If false, events are delivered as fast as possible, which measures
+ *      throughput.
+ *
+ * \param [out] report
+ *      Receives the timing report: event count, throughput, and the
+ *      distribution of lateness and service time, in microseconds.
+ *
+ * \return
+ *      Returns true if the file could be opened and at least one event was
+ *      replayed.
+ */
+
+bool
+player::replay_input
+(
+    const std::string & filename,
+    bool realtime,
+    std::string & report
+)
+{
+    inputlog replay;
+    bool result = replay.open_for_replay(filename);
+    if (result)
+    {
+        replaystats stats;
+        event ev;
+        std::uint64_t offset_us;
+        stats.start();
+
+        std::uint64_t start_us = inputlog::now_us();
+        while (replay.next(ev, offset_us))
+        {
+            std::uint64_t due_us = start_us + offset_us;
+            std::uint64_t now_us = inputlog::now_us();
+            if (realtime && due_us > now_us)
+            {
+                std::this_thread::sleep_for
+                (
+                    std::chrono::microseconds(due_us - now_us)
+                );
+                now_us = inputlog::now_us();
             }
-        } while (m_master_bus->is_more_input());
+
+            std::uint64_t late_us = realtime && now_us > due_us ?
+                now_us - due_us : 0 ;
+
+            bool ok = handle_input_event(ev);
+            stats.add(late_us, inputlog::now_us() - now_us);
+            if (! ok)
+                break;
+        }
+        stats.finish();
+        report = stats.report();
+        result = stats.count() > 0;
     }
+    else
+        util::file_error("Cannot replay input from", filename);
+
     return result;
 }
 
@@ -1949,7 +2435,120 @@ player::midi_song_pos (const event & ev)
 void
 player::midi_sysex (const event & ev)
 {
-     m_master_bus->sysex(/*port/buss number */ 0, &ev);     // TODO
+    const midi::message & msg = ev.get_message();
+    if (msg.size() == 10)                           /* MTC full frame?      */
+    {
+        midi::bytes data;
+        for (std::size_t i = 0; i < msg.size(); ++i)
+            data.push_back(msg[i]);
+
+        std::lock_guard<std::mutex> lock(m_mtc_mutex);
+        if (m_mtc_follower.receive_full_frame(data))
+        {
+            if (m_mtc_follow && ! is_running())
+                set_tick(mtc_pulse(m_mtc_follower.position(0.0)));
+
+            return;
+        }
+    }
+    if (m_master_bus)                               /* none if replaying    */
+        m_master_bus->sysex(/*port/buss number */ 0, &ev); // TODO
+}
+
+/**
+ * EVENT_MIDI_QUARTER_FRAME:
+ *
+ *      MIDI Time Code.  The follower rebuilds the position from the
+ *      quarter frames, timed by their arrival on the microsecond clock that
+ *      the output thread also reads.  While playing, the output thread
+ *      moves to the followed position; when stopped, the position is set
+ *      here.
+ */
+
+void
+player::midi_quarter_frame (const event & ev)
+{
+    midi::byte d0;
+    ev.get_data(d0);
+
+    double now = double(xpc::microtime()) * 1.0e-6;
+    std::lock_guard<std::mutex> lock(m_mtc_mutex);
+    if (m_mtc_follower.receive_quarter_frame(d0, now))
+    {
+        if (m_mtc_follow && ! is_running())
+            set_tick(mtc_pulse(m_mtc_follower.position(now)));
+    }
+}
+
+/**
+ *  Gets the position given by incoming MIDI Time Code.
+ *
+ * \param now
+ *      The time, in seconds, on the xpc::microtime() clock.
+ *
+ * \param [out] seconds
+ *      The position, if locked.
+ *
+ * \return
+ *      Returns true if the follower has a position.
+ */
+
+bool
+player::mtc_position (double now, double & seconds) const
+{
+    std::lock_guard<std::mutex> lock(m_mtc_mutex);
+    bool result = m_mtc_follower.locked();
+    if (result)
+        seconds = m_mtc_follower.position(now);
+
+    return result;
+}
+
+/**
+ *  Converts MTC seconds to ticks at the current tempo.
+ */
+
+midi::pulse
+player::mtc_pulse (double seconds) const
+{
+    double bpmfactor = m_master_bus->BPM() * 4.0 / beat_width();
+    double ticks = seconds * bpmfactor * m_master_bus->PPQN() / 60.0;
+    return ticks > 0.0 ? midi::pulse(ticks + 0.5) : 0 ;
+}
+
+/**
+ *  Sends the MTC full frame for a position, and restarts the quarter
+ *  frames from there.
+ */
+
+void
+player::mtc_locate (double seconds)
+{
+    event ev;
+    (void) ev.set_sysex(m_mtc_generator.locate(seconds));
+    (void) m_master_bus->sysex(m_mtc_bus, &ev);
+}
+
+/**
+ *  Sends the quarter frames due up to the given position.  The status
+ *  low nybble travels as the "channel", as bus_out::send_event() combines
+ *  them.
+ */
+
+void
+player::mtc_emit (double seconds)
+{
+    std::vector<transport::clock::quarter_frame> qfs;
+    if (m_mtc_generator.quarter_frames(seconds, qfs) > 0)
+    {
+        const midi::byte qf = midi::to_byte(midi::status::quarter_frame);
+        for (const auto & q : qfs)
+        {
+            event ev(0, qf, q.qf_data);
+            m_master_bus->play(m_mtc_bus, &ev, qf & 0x0F);
+        }
+        (void) m_master_bus->flush();
+    }
 }
 
 /**
@@ -2159,6 +2758,7 @@ player::play (midi::pulse tick)
     {
         bool songmode = song_mode();
         set_tick(tick);
+        m_frame_transform = std::atomic_load(&m_play_transform);
         for (const auto & trk : track_list().tracks())
         {
             if (trk)
@@ -0,0 +1,210 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          portwatch.cpp
+ *
+ *  This module defines the queue of system port changes.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ */
+
+#include <cctype>                       /* std::isdigit(), std::isspace()   */
+
+#include "midi/portnaming.hpp"          /* midi::extract_nickname()         */
+#include "midi/portwatch.hpp"           /* midi::portwatch class            */
+
+namespace midi
+{
+
+/**
+ *  True if the text holds only digits and colons, such as "20" or "24:0".
+ */
+
+static bool
+all_numbers (const std::string & text)
+{
+    bool result = ! text.empty();
+    for (auto c : text)
+    {
+        if (! std::isdigit(static_cast<unsigned char>(c)) && c != ':')
+        {
+            result = false;
+            break;
+        }
+    }
+    return result;
+}
+
+static bool
+is_space (char c)
+{
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+/**
+ *  Lower-cases the name, collapses the white space, and drops the bracketed
+ *  numbers ("[20]") and the addresses ("24:0").  Other numbers, as in
+ *  "MIDI 1", are kept.
+ */
+
+static std::string
+normalized (const std::string & name)
+{
+    std::string result;
+    std::size_t pos = 0;
+    std::size_t len = name.length();
+    while (pos < len)
+    {
+        while (pos < len && is_space(name[pos]))
+            ++pos;
+
+        std::size_t end = pos;
+        while (end < len && ! is_space(name[end]))
+            ++end;
+
+        if (end > pos)
+        {
+            std::string word = name.substr(pos, end - pos);
+            char first = word[0];
+            char last = word[word.length() - 1];
+            bool address = word.find(':') != std::string::npos;
+            bool numbers = address && all_numbers(word);
+            if ((first == '[' && last == ']') || (first == '(' && last == ')'))
+                numbers = all_numbers(word.substr(1, word.length() - 2));
+
+            if (! numbers)
+            {
+                if (! result.empty())
+                    result += ' ';
+
+                for (auto c : word)
+                {
+                    int lc = std::tolower(static_cast<unsigned char>(c));
+                    result += char(lc);
+                }
+            }
+        }
+        pos = end;
+    }
+    return result;
+}
+
+portwatch::portwatch () :
+    m_changes   (),
+    m_mutex     (),
+    m_pending   (false)
+{
+    // no code
+}
+
+/**
+ *  Queues a change.  Called from the API's notification or input thread.
+ *
+ * \param a
+ *      Whether the port appeared or vanished.
+ *
+ * \param client
+ *      The client (ALSA) or -1 if the API has no numbers.
+ *
+ * \param port
+ *      The port number, or -1.
+ *
+ * \param name
+ *      The full "client:port" name, if known.
+ *
+ * \param alias
+ *      The port alias, if the API has one (JACK).
+ */
+
+void
+portwatch::post
+(
+    action a, int client, int port,
+    const std::string & name,
+    const std::string & alias
+)
+{
+    change c;
+    c.pw_action = a;
+    c.pw_client = client;
+    c.pw_port = port;
+    c.pw_name = name;
+    c.pw_alias = alias;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_changes.push_back(c);
+    m_pending = true;
+}
+
+/**
+ *  Moves the queued changes to the caller.
+ *
+ * \param [out] changes
+ *      Gets the changes, oldest first.  Its old contents are dropped.
+ *
+ * \return
+ *      Returns true if there were any changes.
+ */
+
+bool
+portwatch::take (std::vector<change> & changes)
+{
+    changes.clear();
+    if (m_pending)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        changes.swap(m_changes);
+        m_pending = false;
+    }
+    return ! changes.empty();
+}
+
+/**
+ *  Provides the key under which a port is looked up when it comes back.
+ *  For example, "a2j:nanoKEY2 [20] (playback): nanoKEY2 nanoKEY2 _ CTRL"
+ *  and "a2j:nanoKEY2 [24] (playback): nanoKEY2 nanoKEY2 _ CTRL" give the
+ *  same key.  A JACK alias can be given here too, since system port names
+ *  such as "system:midi_capture_3" are renumbered on a replug, while the
+ *  alias is not.
+ *
+ * \param name
+ *      The full port name, or an alias.
+ *
+ * \return
+ *      Returns the normalized nickname, which is empty if the name is.
+ */
+
+std::string
+portwatch::identity (const std::string & name)
+{
+    return name.empty() ? name : normalized(extract_nickname(name)) ;
+}
+
+}           // namespace midi
+
+/*
+ * portwatch.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -24,7 +24,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2015-10-10
- * \updates       2025-01-31
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This class is important when writing the MIDI and track data out to a
@@ -43,6 +43,25 @@
 namespace midi
 {
 
+/**
+ *  The number of transformed notes a track can hold sounding before
+ *  m_note_pairs has to grow.  Reserved when the track is created, so that
+ *  put_event_on_bus() does not allocate in the output thread.  A full
+ *  keyboard's worth.
+ */
+
+static const std::size_t c_note_pairs_reserve = c_notes_count;
+
+/**
+ *  The index of a (channel, note) pair, as used by m_note_pairs.
+ */
+
+static inline std::uint16_t
+note_slot (midi::byte channel, midi::byte note)
+{
+    return std::uint16_t(int(channel & 0x0F) * c_notes_count + (note & 0x7F));
+}
+
 /**
  *  Default constructor.
  */
@@ -56,7 +75,15 @@ track::track (number tn) :
     m_active            (false),
     m_notes_on          (0),
     m_master_bus        (nullptr),
-    m_playing_notes     (),                 /* an array                     */
+    m_playing_notes     (),
+    m_carried_offs      (),
+    m_play_transform    (),
+    m_emit_transform    (),
+    m_note_pairs        (),
+    m_chase             (),
+    m_deferred          (false),
+    m_deferred_sort     (false),
+    m_deferred_verify   (false),
     m_armed             (false),
     m_recording         (false),
     m_recording_type    (record::normal),
@@ -75,6 +102,7 @@ track::track (number tn) :
     m_midi_channel      (0),
     m_free_channel      (false)
 {
+    m_note_pairs.reserve(c_note_pairs_reserve);
     // copy_events(evlist);
 }
 
@@ -100,6 +128,9 @@ track::set_armed (bool p)
     bool result = p != armed();
     if (result)
     {
+        if (p && is_deferred())
+            (void) decode_deferred();
+
         armed(p);
         if (! p)
             off_playing_notes();
@@ -305,8 +336,10 @@ track::track_playing_change (bool on, bool qinprogress)
 }
 
 /**
- *  Sends a note-off event for all active notes.  This function does not
- *  bother checking if m_master_bus is a null pointer.
+ *  Sends a note-off event for all active notes, on the channel each was
+ *  played on, as one batch with a single flush, through send_on_bus() and
+ *  flush_bus().  This function does not bother checking if m_master_bus is
+ *  a null pointer.
  *
  * \threadsafe
  */
@@ -315,21 +348,17 @@ void
 track::off_playing_notes ()
 {
     xpc::automutex locker(m_mutex);
-    int channel = 0;    // TODO: free_channel() ? 0 : seq_midi_channel() ;
-    event e(0, midi::status::note_off, channel, 0, 0);
-    for (int x = 0; x < c_notes_count; ++x)
+    m_carried_offs.clear();
+    m_note_pairs.clear();
+    if (m_playing_notes.any())
     {
-        while (m_playing_notes[x] > 0)
-        {
-            e.set_data(x);
-            // TODO
-            // master_bus()->play(m_true_bus, &e, channel);
-            --m_playing_notes[x];
-        }
+        std::vector<event> offs;
+        (void) m_playing_notes.release(offs);
+        for (const auto & e : offs)
+            send_on_bus(e, e.channel(), false);
+
+        flush_bus();
     }
-    // TODO
-    // if (not_nullptr(master_bus()))
-    //     master_bus()->flush();
 }
 
 /**
@@ -371,6 +400,139 @@ track::pause (bool song_mode)
         set_armed(state);
 }
 
+/**
+ *  Readies the track for playback to jump from the right (R) marker back to
+ *  the left (L) marker, after the frame up to R has been played.  Unlike
+ *  stop(), nothing is done to a track with no sounding notes except moving
+ *  its last tick, and the armed state is left alone.
+ *
+ *  With wrapnotes::carry, each sounding note keeps going: the earliest Note
+ *  Off for it that play() would have reached after R is queued to go out
+ *  the same number of ticks after L.  A note with no such Note Off in the
+ *  track is closed at the seam, as with wrapnotes::close.
+ *
+ * \param righttick
+ *      The R marker, the end of the frame just played.
+ *
+ * \param lefttick
+ *      The L marker, where the next frame starts.
+ *
+ * \param policy
+ *      Whether to close or carry the sounding notes.
+ *
+ * \threadsafe
+ */
+
+void
+track::loop_wrap
+(
+    midi::pulse righttick, midi::pulse lefttick, wrapnotes policy
+)
+{
+    xpc::automutex locker(m_mutex);
+    if (m_playing_notes.any())
+    {
+        if (policy == wrapnotes::carry)
+        {
+            midi::pulse len = length() > 0 ?
+                length() : parent()->get_ppqn() ;
+
+            midi::pulse jump = righttick - lefttick;
+            notetracker uncarried = m_playing_notes;
+            for (auto & c : m_carried_offs)     /* pending from last wrap   */
+            {
+                midi::byte ch = c.channel();
+                midi::byte note = c.get_note();
+                c.set_timestamp(c.timestamp() - jump);
+                follow_note(ch, note, false);
+                (void) uncarried.note_off(ch, note);
+            }
+
+            std::vector<event> carried;
+            for (const auto & e : events())
+            {
+                if (e.is_note_off())
+                {
+                    midi::byte ch = free_channel() ?
+                        e.channel() : track_midi_channel() ;
+
+                    midi::byte note = e.get_note();
+                    midi::byte outch = ch;
+                    midi::byte outnote = note;
+                    follow_note(outch, outnote, false);
+                    if (uncarried.sounding(outch, outnote))
+                    {
+                        midi::pulse gap = (e.timestamp() - righttick) % len;
+                        if (gap < 0)
+                            gap += len;
+
+                        midi::pulse due = lefttick + gap;
+                        auto c = carried.begin();
+                        for ( ; c != carried.end(); ++c)
+                        {
+                            if (c->get_note() == note && c->channel() == ch)
+                                break;
+                        }
+                        if (c == carried.end())
+                        {
+                            carried.push_back(e);
+                            carried.back().set_channel(ch);
+                            carried.back().set_timestamp(due);
+                        }
+                        else if (due < c->timestamp())
+                            c->set_timestamp(due);
+                    }
+                }
+            }
+            for (const auto & c : carried)
+            {
+                midi::byte ch = c.channel();
+                midi::byte note = c.get_note();
+                follow_note(ch, note, false);
+                (void) uncarried.note_off(ch, note);
+                m_carried_offs.push_back(c);
+            }
+
+            /*
+             * The notes with no Note Off to carry are closed here.  These
+             * offs are already on the outgoing channel and note.
+             */
+
+            std::vector<event> offs;
+            if (uncarried.release(offs) > 0)
+            {
+                for (const auto & e : offs)
+                {
+                    midi::byte ch = e.channel();
+                    midi::byte note = e.get_note();
+                    if (m_playing_notes.note_off(ch, note))
+                    {
+                        event evout;
+                        evout.prep_for_send(m_parent->tick(), e);
+                        send_on_bus(evout, ch, false);
+                    }
+                    if (! m_playing_notes.sounding(ch, note))
+                    {
+                        std::uint16_t to = note_slot(ch, note);
+                        auto p = m_note_pairs.begin();
+                        while (p != m_note_pairs.end())
+                        {
+                            if (p->second == to)
+                                p = m_note_pairs.erase(p);
+                            else
+                                ++p;
+                        }
+                    }
+                }
+                flush_bus();
+            }
+        }
+        else
+            off_playing_notes();
+    }
+    m_last_tick = lefttick;
+}
+
 /**
  *
  * \param tick
@@ -437,6 +599,7 @@ track::live_play (midi::pulse tick)
     xpc::automutex locker(m_mutex);
     midi::pulse start_tick = m_last_tick;
     midi::pulse end_tick = tick;              /* ditto                        */
+    m_emit_transform = std::atomic_load(&m_play_transform);
     if (armed())                            /* play notes in the frame      */
     {
         midi::pulse len = length() > 0 ?
@@ -463,6 +626,7 @@ track::live_play (midi::pulse tick)
         }
 #endif
 
+        int sent = play_carried_offs(end_tick);     /* flush once, at end   */
         auto e = events().begin();
         while (e != events().end())
         {
@@ -476,7 +640,8 @@ track::live_play (midi::pulse tick)
                     parent()->beats_per_minute(er.tempo());
                 }
 #endif
-                put_event_on_bus(er);               /* frame still going    */
+                if (put_event_on_bus(er, false))
+                    ++sent;                         /* frame still going    */
             }
             else if (stamp > end_tick_offset)
                 break;                              /* frame is done        */
@@ -489,6 +654,8 @@ track::live_play (midi::pulse tick)
                 (void) xpc::microsleep(1);
             }
         }
+        if (sent > 0)
+            flush_bus();
     }
     m_last_tick = end_tick + 1;                     /* for next frame       */
 }
@@ -528,6 +695,7 @@ track::play
 {
     xpc::automutex locker(m_mutex);
     midi::pulse start_tick = m_last_tick;
+    m_emit_transform = std::atomic_load(&m_play_transform);
     if (armed())                                    /* play notes in frame  */
     {
         midi::pulse len = length() > 0 ?
@@ -555,6 +723,7 @@ track::play
         }
 #endif
 
+        int sent = play_carried_offs(tick);         /* flush once, at end   */
         auto e = events().begin();
         while (e != events().end())
         {
@@ -569,7 +738,8 @@ track::play
                 }
                 else if (! er.is_ex_data())
                 {
-                    put_event_on_bus(er);       /* frame still going    */
+                    if (put_event_on_bus(er, false))
+                        ++sent;                     /* frame still going    */
                 }
             }
             else if (stamp > end_tick_offset)
@@ -591,6 +761,8 @@ track::play
                 (void) xpc::microsleep(1);
             }
         }
+        if (sent > 0)
+            flush_bus();
     }
     m_last_tick = tick + 1;                         /* for next frame       */
 }
@@ -604,6 +776,67 @@ track::track_name (const std::string & n)
         set_dirty();
 }
 
+/**
+ *  Adds the memory held by this track to the accounting object: the events
+ *  and their payloads, plus the raw byte buffer used for file reading and
+ *  writing (counted as "other").  The raw bytes of a deferred track are
+ *  counted as cold, and do not force decoding.
+ */
+
+void
+track::memory_usage (memusage & mu) const
+{
+    if (is_deferred())
+        mu.add_cold(data().deferred_size());
+    else
+        events().memory_usage(mu);
+
+    mu.add_other(data().byte_list().capacity());
+}
+
+/**
+ *  Decodes the events of a track loaded with deferred decoding, then does
+ *  the sort and verification that were put off when it was installed (see
+ *  sort_events() and set_length()).  The result is the same event list that
+ *  an ordinary load would have produced.
+ *
+ *  The work is done on data().events(), not events(), which would decode
+ *  again.  The deferred flag is cleared last, because is_deferred() is read
+ *  without the mutex: once it is false, the events are complete.
+ *
+ * \threadsafe
+ *
+ * \return
+ *      Returns true if the track was deferred and was decoded.
+ */
+
+bool
+track::decode_deferred ()
+{
+    xpc::automutex locker(m_mutex);
+    bool result = is_deferred();
+    if (result)
+    {
+        eventlist & evl = data().events();
+        result = data().decode_deferred(*this);
+        if (result)
+        {
+            if (m_deferred_sort)
+                evl.sort();
+
+            evl.length(length());
+            if (m_deferred_verify)
+                evl.verify_and_link(length());
+        }
+        else
+            errprint("Deferred track decode failed");
+
+        m_deferred_sort = m_deferred_verify = false;
+        m_deferred = false;                 /* events() is usable from here */
+    }
+    return result;
+}
+
 /**
  *  Sets the "parent" of this track, so that it can get some extra
  *  information about the performance.  Remember that m_parent is not at all
@@ -634,6 +867,7 @@ track::set_parent (player * p, lib66::toggler sorting)
         midi::pulse ppnote = 4 * p->get_ppqn() / beat_width();
         midi::pulse barlength = ppnote * beats_per_bar();
         m_parent = p;
+        m_chase.interval(8 * barlength);    /* a checkpoint every 8 bars    */
         manufacturer_id(p->manufacturer_id());
 #if defined USE_MASTER_BUS
         master_midi_bus(p->master_bus());
@@ -821,9 +1055,17 @@ track::set_length (midi::pulse len, bool verify)
         else
             len = length();
 
-        events().length(len);
-        if (verify)
-            verify_and_link();
+        if (is_deferred())
+        {
+            if (verify)
+                m_deferred_verify = true;   /* see decode_deferred()    */
+        }
+        else
+        {
+            events().length(len);
+            if (verify)
+                verify_and_link();
+        }
 
         if (was_playing)                        /* start up and refresh     */
             set_armed(true);
@@ -1003,43 +1245,222 @@ track::beat_width (int bw, bool user_change)
 }
 
 /**
- *  Takes an event that this track is holding, and places it on the MIDI
- *  buss.  This function does not bother checking if m_master_bus is a null
- *  pointer.
+ *  Takes an event that this track is holding, and places a copy of it on
+ *  the MIDI buss.  This function does not bother checking if m_master_bus
+ *  is a null pointer.
+ *
+ *  The output channel is the event channel if free_channel() is true.
+ *  Otherwise it is the pattern channel.  The copy then goes through the
+ *  track's transform and the player's transform for the frame, if any.
+ *  The stored event is never changed.
  *
- *  Note that the call to midi_channel() yields the event channel if
- *  free_channel() is true.  Otherwise the global pattern channel is true.
+ *  Sounding notes are counted per outgoing channel and note, so a Note Off
+ *  only matches a Note On on the same channel.  A Note Off (or aftertouch)
+ *  follows its Note On to wherever the transforms sent it, so a transform
+ *  change while a note is held does not leave it hanging.
  *
  * \param ev
  *      The event to put on the buss.
  *
+ * \param flush
+ *      If false, the caller flushes once after queuing a batch of events.
+ *
+ * \return
+ *      Returns false if the event was a Note Off for a note that is not
+ *      sounding, and so was not sent.
+ *
  * \threadsafe
  */
 
-void
-track::put_event_on_bus (const event & ev)
+bool
+track::put_event_on_bus (const event & ev, bool flush)
 {
-    midi::byte note = ev.get_note();
-    bool skip = false;
+    midi::byte channel = free_channel() ? ev.channel() : track_midi_channel() ;
+    const transform * tt = m_emit_transform.get();
+    const transform * pt = m_parent->frame_transform();
+    if (not_nullptr(tt) && tt->identity())
+        tt = nullptr;
+
+    if (not_nullptr(pt) && pt->identity())
+        pt = nullptr;
+
+    bool result = true;
+    event evout;
+    evout.prep_for_send(m_parent->tick(), ev);              /* issue #100   */
     if (ev.is_note_on())
     {
-        ++m_playing_notes[note];
+        std::uint16_t from = note_slot(channel, ev.get_note());
+        if (not_nullptr(tt))
+            tt->apply(evout, channel);
+
+        if (not_nullptr(pt))
+            pt->apply(evout, channel);
+
+        std::uint16_t to = note_slot(channel, evout.get_note());
+        if (to != from)
+            m_note_pairs.emplace_back(from, to);
+
+        m_playing_notes.note_on(channel, evout.get_note());
+    }
+    else if (ev.is_note())                  /* Note Off or aftertouch       */
+    {
+        midi::byte note = ev.get_note();
+        bool off = ev.is_note_off();
+        follow_note(channel, note, off);
+        evout.set_note(note);
+        if (off)
+            result = m_playing_notes.note_off(channel, note);
     }
-    else if (ev.is_note_off())
+    else if (ev.has_channel())
     {
-        if (m_playing_notes[note] == 0)
-            skip = true;
-        else
-            --m_playing_notes[note];
+        if (not_nullptr(tt))
+            channel = tt->channel(channel);
+
+        if (not_nullptr(pt))
+            channel = pt->channel(channel);
     }
-    if (! skip)
+    if (result)
+        send_on_bus(evout, channel, flush);
+
+    return result;
+}
+
+/**
+ *  Puts the finished event on the track's bus.  This and flush_bus() are
+ *  the only places output leaves the track, and they are virtual so that a
+ *  derived track can route the output elsewhere, or count it.
+ */
+
+void
+track::send_on_bus (const event & evout, midi::byte channel, bool flush)
+{
+#if defined USE_MASTER_BUS
+    if (flush)
+        master_bus()->play_and_flush(m_true_bus, &evout, channel);
+    else
+        master_bus()->play(m_true_bus, &evout, channel);
+#else
+    (void) evout;
+    (void) channel;
+    (void) flush;
+#endif
+}
+
+/**
+ *  Finds where a note of this track went out, if a transform moved it.
+ *
+ * \param [inout] channel
+ *      The track's channel for the note, replaced by the outgoing channel.
+ *
+ * \param [inout] note
+ *      The note in the track, replaced by the outgoing note.
+ *
+ * \param off
+ *      If true, the note is being released, and the oldest pairing for it
+ *      is dropped.
+ */
+
+void
+track::follow_note (midi::byte & channel, midi::byte & note, bool off)
+{
+    if (! m_note_pairs.empty())
     {
-        event evout;
-        evout.prep_for_send(m_parent->tick(), ev);          /* issue #100   */
+        std::uint16_t from = note_slot(channel, note);
+        for (auto p = m_note_pairs.begin(); p != m_note_pairs.end(); ++p)
+        {
+            if (p->first == from)
+            {
+                channel = midi::byte(p->second / c_notes_count);
+                note = midi::byte(p->second % c_notes_count);
+                if (off)
+                    (void) m_note_pairs.erase(p);
+
+                break;
+            }
+        }
+    }
+}
+
+/**
+ *  Flushes the bus once after a frame (or batch) of events queued by
+ *  put_event_on_bus() with flush = false.
+ */
+
+void
+track::flush_bus ()
+{
 #if defined USE_MASTER_BUS
-        master_bus()->play_and_flush(m_true_bus, &evout, midi_channel(ev));
+    if (not_nullptr(master_bus()))
+        master_bus()->flush();
 #endif
+}
+
+/**
+ *  Sends the Note Offs carried across a loop wrap that are due by the given
+ *  tick.  Called with the track locked, before the frame's own events, and
+ *  does not flush.
+ *
+ * \return
+ *      Returns the number of events put on the bus.
+ */
+
+int
+track::play_carried_offs (midi::pulse tick)
+{
+    int result = 0;
+    auto c = m_carried_offs.begin();
+    while (c != m_carried_offs.end())
+    {
+        if (c->timestamp() <= tick)
+        {
+            if (put_event_on_bus(*c, false))
+                ++result;
+
+            c = m_carried_offs.erase(c);
+        }
+        else
+            ++c;
+    }
+    return result;
+}
+
+/**
+ *  Sends the program changes, control changes, and pitch bend that are in
+ *  effect just before the given tick, so that playback from there sounds as
+ *  it would have if played from the start.  Used when the transport jumps.
+ *
+ * \threadsafe
+ *
+ * \param tick
+ *      The new position.
+ *
+ * \param [out] tempo
+ *      Set to the tempo in effect, if this track has tempo events before the
+ *      tick.  Otherwise left unchanged.
+ *
+ * \return
+ *      Returns the number of events sent.
+ */
+
+int
+track::chase (midi::pulse tick, midi::bpm & tempo)
+{
+    xpc::automutex locker(m_mutex);
+    int result = 0;
+    chasestate state;
+    if (m_chase.chase(events(), tick, state))
+    {
+        std::vector<event> chased;
+        result = state.fill_events(chased, tick);
+        for (const auto & ev : chased)
+            (void) put_event_on_bus(ev, false);
+
+        flush_bus();
+
+        if (state.tempo() > 0.0)
+            tempo = state.tempo();
     }
+    return result;
 }
 
 void
@@ -1091,6 +1512,7 @@ track::add_event (const event & er)
     if (result)
     {
         verify_and_link();                  /* for proper drawing; sorts    */
+        m_chase.invalidate(events(), er.timestamp());
         modify(lib66:: notification::yes);  /* notify of changes            */
     }
     return result;
@@ -1116,14 +1538,19 @@ bool
 track::append_event (const event & er)
 {
     xpc::automutex locker(m_mutex);
-    return events().append(er);     /* does *not* sort, too time-consuming */
+    bool result = events().append(er); /* does *not* sort, too slow        */
+    m_chase.invalidate(events(), er.timestamp());
+    return result;
 }
 
 void
 track::sort_events ()
 {
     xpc::automutex locker(m_mutex);
-    events().sort();
+    if (is_deferred())
+        m_deferred_sort = true;             /* see decode_deferred()        */
+    else
+        events().sort();
 }
 
 /**
@@ -24,7 +24,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2015-10-10
- * \updates       2025-01-16
+ * \updates       2026-10-18
  *
  * \license       GNU GPLv2 or above
  *
@@ -102,6 +102,7 @@
  *  ----------------       ----------------         song_fill_seq_trigger()
  */
 
+#include <array>                        /* std::array<>                     */
 #include <fstream>                      /* std::ifstream and std::ofstream  */
 
 #include "c_macros.h"                   /* errprint() macro                 */
@@ -169,7 +170,9 @@ trackdata::trackdata () :
     m_data                  (),
     m_running_status_action (rsaction::recover),
     m_manufacturer_id       (),
-    m_end_of_track_found    (false)
+    m_end_of_track_found    (false),
+    m_deferred_bytes        (),
+    m_put_status            (0)
 {
     // Empty body
 }
@@ -836,6 +839,7 @@ trackdata::put_meta_header
 {
     midi::byte metamarker = midi::to_byte(midi::status::meta_msg);
     midi::byte metacode = midi::to_byte(metaevent);
+    m_put_status = 0;                               /* cancels running st.  */
     put_varinum(midi::ulong(deltatime));
     put(metamarker);                                /* 0xFF meta marker     */
     put(metacode);                                  /* which meta event     */
@@ -989,16 +993,35 @@ trackdata::seqspec_item_size (long data_length) const
  *
  * \param deltatime
  *      Provides the time-location of the event.
+ *
+ * \param packing
+ *      If running status is on, the status byte is left out when it equals
+ *      the last one written.  If Note Off conversion is on, a Note Off is
+ *      written as a Note On of velocity 0.  The default writes the event
+ *      as is.
  */
 
 void
-trackdata::put_channel_event (const event & e, midi::pulse deltatime)
+trackdata::put_channel_event
+(
+    const event & e,
+    midi::pulse deltatime,
+    const smfpacking & packing
+)
 {
     midi::byte d0 = e.data(0);
     midi::byte d1 = e.data(1);
     midi::byte st = e.status();
+    if (packing.sp_zero_note_offs && midi::is_note_off_msg(st))
+    {
+        st = midi::to_byte(midi::status::note_on) | midi::mask_channel(st);
+        d1 = 0;
+    }
     put_varinum(midi::ulong(deltatime));        /* encode delta_time    */
-    put(st);                                    /* add (fixed) status   */
+    if (! packing.sp_running_status || st != m_put_status)
+        put(st);                                /* add (fixed) status   */
+
+    m_put_status = packing.sp_running_status ? st : 0 ;
     if (e.has_channel())
     {
         midi::status s = midi::to_status(mask_status(st));
@@ -1053,6 +1076,7 @@ trackdata::put_channel_event (const event & e, midi::pulse deltatime)
 void
 trackdata::put_ex_event (const event & e, midi::pulse deltatime)
 {
+    m_put_status = 0;                           /* cancels running status   */
     put_varinum(midi::ulong(deltatime));        /* encode delta_time        */
     if (e.is_sysex())
     {
@@ -1204,6 +1228,201 @@ trackdata::put_tempo (int usperqn)
     put(tt[2]);
 }
 
+/**
+ *  Remembers, during one packed put_track(), the values already written, so
+ *  that an event that changes nothing can be left out.  See smfpacking.
+ *  Each track is filled by one thread, so this lives on its stack.
+ */
+
+class repeats
+{
+
+private:
+
+    const smfpacking & m_packing;
+
+    /**
+     *  The last value of each controller of each channel, or -1 if not yet
+     *  written (or forgotten).
+     */
+
+    std::array<std::array<short, 128>, 16> m_controls;
+
+    /**
+     *  The last 14-bit pitch-wheel value of each channel, or -1.
+     */
+
+    std::array<int, 16> m_bends;
+
+    /**
+     *  The Tempo and Time Signature events (FF mm len data) written at
+     *  m_meta_tick.
+     */
+
+    midi::pulse m_meta_tick;
+    midi::bytes m_tempo;
+    midi::bytes m_time_sig;
+
+public:
+
+    repeats (const smfpacking & packing) :
+        m_packing   (packing),
+        m_controls  (),
+        m_bends     (),
+        m_meta_tick (0),
+        m_tempo     (),
+        m_time_sig  ()
+    {
+        forget();
+    }
+
+    bool redundant (const event & e);
+    bool redundant_meta (midi::pulse tick, const midi::bytes & msg);
+
+private:
+
+    void forget ()
+    {
+        for (int ch = 0; ch < 16; ++ch)
+            forget(ch);
+    }
+
+    void forget (int ch)
+    {
+        m_controls[ch].fill(-1);
+        m_bends[ch] = -1;
+    }
+
+    /**
+     *  An NRPN select (99, 98) makes the data entries go to an NRPN, and an
+     *  RPN select (101, 100) to an RPN, so a select of the other kind is
+     *  needed again afterwards even if its value has not changed.
+     */
+
+    void forget_selects (int ch, bool nrpn)
+    {
+        int msb = nrpn ? 101 : 99;
+        m_controls[ch][msb] = m_controls[ch][msb - 1] = -1;
+    }
+
+};
+
+/**
+ *  Controllers that act each time they are sent, rather than set a value:
+ *  data entry (6, 38), data increment and decrement (96, 97), and the
+ *  channel mode messages (120 and up).
+ */
+
+static bool
+acts_on_repeat (int cc)
+{
+    return cc == 6 || cc == 38 || cc == 96 || cc == 97 || cc >= 120;
+}
+
+/**
+ *  Checks an event, and logs it as written if it is to be kept.
+ *
+ * \param e
+ *      The event, with its channel already fixed by the caller.
+ *
+ * \return
+ *      Returns true if the event is to be left out.
+ */
+
+bool
+repeats::redundant (const event & e)
+{
+    bool result = false;
+    if (e.has_channel())
+    {
+        if (m_packing.sp_drop_repeats)
+        {
+            int ch = int(midi::mask_channel(e.status()));
+            if (e.is_controller())
+            {
+                int cc = int(e.d0()) & 0x7F;
+                short value = short(e.d1());
+                if (acts_on_repeat(cc))
+                {
+                    if (cc == 121)                  /* Reset All Ctrlrs.    */
+                        forget(ch);
+                }
+                else if (m_controls[ch][cc] == value)
+                    result = true;
+                else
+                {
+                    m_controls[ch][cc] = value;
+                    if (cc >= 98 && cc <= 101)
+                        forget_selects(ch, cc < 100);
+                }
+            }
+            else if (e.is_pitchbend())
+            {
+                int value = int(e.d0()) | (int(e.d1()) << 7);
+                if (m_bends[ch] == value)
+                    result = true;
+                else
+                    m_bends[ch] = value;
+            }
+        }
+    }
+    else if (e.is_sysex())
+    {
+        if (m_packing.sp_drop_repeats)
+            forget();                               /* might be a reset     */
+    }
+    else if (e.is_tempo() || e.is_time_signature())
+    {
+        if (m_packing.sp_dedupe_metas)
+        {
+            midi::bytes msg;
+            size_t count = e.meta_data_size();
+            for (size_t i = 0; i < count; ++i)
+                msg.push_back(e.get_message(i));
+
+            result = redundant_meta(e.timestamp(), msg);
+        }
+    }
+    return result;
+}
+
+/**
+ *  Checks a Tempo or Time Signature event, and logs it as written if it is
+ *  to be kept.
+ *
+ * \param tick
+ *      The time of the event.
+ *
+ * \param msg
+ *      The event as written, FF mm len data.
+ *
+ * \return
+ *      Returns true if the same event was already written at this tick.
+ */
+
+bool
+repeats::redundant_meta (midi::pulse tick, const midi::bytes & msg)
+{
+    bool result = false;
+    if (m_packing.sp_dedupe_metas && msg.size() > 1)
+    {
+        if (tick != m_meta_tick)
+        {
+            m_meta_tick = tick;
+            m_tempo.clear();
+            m_time_sig.clear();
+        }
+
+        bool tempo = msg[1] == midi::to_byte(midi::meta::set_tempo);
+        midi::bytes & last = tempo ? m_tempo : m_time_sig ;
+        if (last == msg)
+            result = true;
+        else
+            last = msg;
+    }
+    return result;
+}
+
 /**
  *  This function fills the given track's midi::bytes vector with MIDI data
  *  from the current track's midi::eventlist vector, preparatory to writing it
@@ -1267,17 +1486,28 @@ trackdata::put_tempo (int usperqn)
  *      we want to write out a regular MIDI track without this information; it
  *      writes a smaller file. Defaults to true.
  *
+ * \param packing
+ *      Selects the size optimizations, which are all off by default.  An
+ *      event left out passes its delta time on to the next event.
+ *
  * \return
  *      Returns true if the track data could be written. It fails only
  *      if there is a mixup in delta times.
  */
 
 bool
-trackdata::put_track (/*const*/ track & trk, int tempotrack, bool doseqspec)
+trackdata::put_track
+(
+    /*const*/ track & trk,
+    int tempotrack,
+    bool doseqspec,
+    const smfpacking & packing
+)
 {
     bool result = true;
     int trkno = trk.track_number();
     eventlist evl = events();
+    repeats written(packing);
     evl.sort();                             /* hmmmm                        */
     clear_buffer();                         /* must reconstruct raw bytes   */
     put_track_number(trkno);                /* optional, but add it anyway  */
@@ -1285,10 +1515,23 @@ trackdata::put_track (/*const*/ track & trk, int tempotrack, bool doseqspec)
     if (trkno == tempotrack)                /* see notes about Meta events  */
     {
         if (evl.has_time_signature())
+        {
+            size_t mark = size() + 1;       /* skip the 0 delta time        */
             put_time_sig(trk.info().timesig_info());
-
+            (void) written.redundant_meta
+            (
+                0, midi::bytes(byte_list().begin() + mark, byte_list().end())
+            );
+        }
         if (evl.has_tempo())
+        {
+            size_t mark = size() + 1;
             put_tempo(trk.info().tempo_info().us_per_quarter_note());
+            (void) written.redundant_meta
+            (
+                0, midi::bytes(byte_list().begin() + mark, byte_list().end())
+            );
+        }
     }
 
     midi::pulse timestamp = 0;
@@ -1304,17 +1547,20 @@ trackdata::put_track (/*const*/ track & trk, int tempotrack, bool doseqspec)
             result = false;
             break;
         }
+        if (e.has_channel() && ! trk.free_channel())    /* fix event first  */
+        {
+            midi::byte channel = trk.track_midi_channel();
+            midi::byte st = midi::mask_status(e.status());
+            st = st | channel;                      /* channel from track   */
+            e.set_status(st);
+        }
+        if (written.redundant(e))
+            continue;                               /* delta carries over   */
+
         prevtimestamp = timestamp;
-        if (e.has_channel())                        /* fix event before put */
+        if (e.has_channel())
         {
-            if (! trk.free_channel())           // || is_null_channel(channel))
-            {
-                midi::byte channel = trk.track_midi_channel();
-                midi::byte st = midi::mask_status(e.status());
-                st = st | channel;                  /* channel from track   */
-                e.set_status(st);
-            }
-            put_channel_event(e, deltatime);
+            put_channel_event(e, deltatime, packing);
         }
         else if (e.is_ex_data())                    /* meta or sysex        */
         {
@@ -1353,12 +1599,20 @@ trackdata::put_track (/*const*/ track & trk, int tempotrack, bool doseqspec)
  *
  *  For now, we don't sort the events. They come out in the order they
  *  were read in.
+ *
+ * \param packing
+ *      Selects the size optimizations, as for put_track().
  */
 
 bool
-trackdata::put_track_events (/*const*/ track & /*trk*/)
+trackdata::put_track_events
+(
+    /*const*/ track & /*trk*/,
+    const smfpacking & packing
+)
 {
     bool result = true;
+    repeats written(packing);
     midi::pulse timestamp = 0;
     midi::pulse deltatime = 0;
     midi::pulse prevtimestamp = 0;
@@ -1388,9 +1642,12 @@ trackdata::put_track_events (/*const*/ track & /*trk*/)
             result = false;
             break;
         }
+        if (written.redundant(e))
+            continue;                               /* delta carries over   */
+
         prevtimestamp = timestamp;
         if (e.has_channel())
-            put_channel_event(e, deltatime);
+            put_channel_event(e, deltatime, packing);
         else if (e.is_ex_data())                    /* meta or sysex        */
             put_ex_event(e, deltatime);
     }
@@ -1531,9 +1788,17 @@ trackdata::put_track_events (/*const*/ track & /*trk*/)
  * \param trklength
  *      The length of the track data.
  *
+ * \param deferred
+ *      If true (the default is false), only the track-level data (name,
+ *      time and key signatures, tempo, SeqSpecs, channel) is extracted, and
+ *      the raw bytes are kept for decode_deferred().  The chunk is still
+ *      walked to the end, so a malformed track is caught at load time.
+ *
  * \return
  *      Returns the offset into the next track if successful. Otherwise,
- *      0 is returned.
+ *      0 is returned.  A bad event with rsaction::abort returns 1, as it
+ *      always has: the events before it are kept, and file::parse_smf_1()
+ *      finds no track header at offset 1, so no more tracks are read.
  */
 
 size_t
@@ -1541,15 +1806,85 @@ trackdata::parse_track
 (
     track & trk,
     const util::bytevector & data,
-    size_t offset, size_t trklength
+    size_t offset, size_t trklength,
+    bool deferred
 )
+{
+    size_t result = offset + trklength;     /* presumed next track offset   */
+    clear_all();                            /* clear events and raw bytes   */
+    m_deferred_bytes.clear();
+    m_data.assign(data.byte_list(), offset, trklength);
+
+    bool aborted = ! parse_events(trk, deferred);
+    if (deferred)
+    {
+        m_events.release();                 /* meta events come back later  */
+        m_deferred_bytes.swap(m_data.byte_list());
+        clear_buffer();
+    }
+    if (aborted)
+        result = 1;                         /* don't process more tracks    */
+
+    return result;
+}
+
+/**
+ *  Turns the raw bytes saved by a deferred parse_track() into events.  The
+ *  bytes are parsed by a scratch trackdata and a scratch track, so that the
+ *  track settings (which the deferred parse already set, and which may have
+ *  been changed since) are left alone, and so that m_data, which may be in
+ *  use for writing, is not touched.
+ *
+ *  A bad event that aborts the parse keeps the events before it, as the
+ *  ordinary load does.
+ *
+ * \param trk
+ *      The track that owns this data.  Only its number is used.
+ *
+ * \return
+ *      Returns true if there were deferred bytes.
+ */
+
+bool
+trackdata::decode_deferred (track & trk)
+{
+    bool result = ! m_deferred_bytes.empty();
+    if (result)
+    {
+        trackdata temp;
+        track scratch(trk.track_number());
+        temp.m_running_status_action = m_running_status_action;
+        temp.m_manufacturer_id = m_manufacturer_id;
+        temp.m_data.assign(m_deferred_bytes, 0, m_deferred_bytes.size());
+        (void) temp.parse_events(scratch, false);   /* false: aborted     */
+        m_events = temp.m_events;
+        midi::bytes().swap(m_deferred_bytes);
+    }
+    return result;
+}
+
+/**
+ *  The event loop of parse_track(), which see.  The track bytes are in
+ *  m_data.
+ *
+ * \param trk
+ *      The track whose settings are set from the meta events.
+ *
+ * \param deferred
+ *      If true, channel events are skipped rather than decoded.
+ *
+ * \return
+ *      Returns false if a bad event aborted the load (rsaction::abort).
+ *      The events before it are kept.
+ */
+
+bool
+trackdata::parse_events (track & trk, bool deferred)
 {
     int evcount = 0;                        /* for sanity checking          */
 //  TODO
 //  bool timesig_set = false;               /* first time-sig wins          */
     bool error_reported = false;            /* for handling message         */
-
-    size_t result = offset + trklength;     /* presumed next track offset   */
     midi::pulse runningtime = 0;            /* reset timestamp accumulator  */
     midi::pulse currenttime = 0;            /* adjust by PPQN?              */
     midi::ushort trkno = c_ushort_max;      /* see midibytes.hpp            */
@@ -1558,8 +1893,6 @@ trackdata::parse_track
     midi::byte last_runningstatus = 0;      /* EXPERIMENTAL                 */
     bool skip_to_end = false;               /* EXPERIMENTAL                 */
     bool finished = false;
-    clear_all();                            /* clear events and raw bytes   */
-    m_data.assign(data.byte_list(), offset, trklength);
     while (! finished)                      /* get the events in the track  */
     {
         if (done())                         /* safety check                 */
@@ -1650,6 +1983,12 @@ trackdata::parse_track
         case midi::status::control_change:
         case midi::status::pitch_wheel:
 
+            if (deferred)
+            {
+                skip(2);
+                tentative_channel = channel;
+                break;
+            }
             d0 = get();                                 /* gets a byte      */
             d1 = get();
             if (midi::is_note_off_velocity(eventcode, d1))
@@ -1675,6 +2014,12 @@ trackdata::parse_track
         case midi::status::program_change:              /* 1-byte events    */
         case midi::status::channel_pressure:
 
+            if (deferred)
+            {
+                skip(1);
+                tentative_channel = channel;
+                break;
+            }
             d0 = get();
             e.set_data(d0);                             /* set data in ev   */
             if (append_event(e))                        /* does not sort    */
@@ -1771,7 +2116,7 @@ trackdata::parse_track
                 std::string msg = "Bad event";
                 skip_to_end = track_error(msg, trk);
                 if (m_running_status_action == rsaction::abort)
-                    return true;    /* don't process more tracks    */
+                    return false;   /* don't process more tracks    */
                 else
                     error_reported = true;
             }
@@ -1813,7 +2158,7 @@ trackdata::parse_track
          * The rest is handled in the midi::file class.
          */
     }
-    return result;
+    return true;
 }
 
 /*-------------------------------------------------------------------------
@@ -0,0 +1,214 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          transform.cpp
+ *
+ *  This module defines the play-time transform of outgoing events.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ */
+
+#include <cmath>                        /* std::sqrt()                      */
+
+#include "midi/event.hpp"               /* midi::event                      */
+#include "midi/transform.hpp"           /* midi::transform                  */
+
+namespace midi
+{
+
+/**
+ * \ctor transform
+ *
+ *  The default transform changes nothing.
+ */
+
+transform::transform () :
+    m_transpose         (0),
+    m_velocity_scale    (1.0),
+    m_velocity_offset   (0),
+    m_velocity_curve    (curve::linear),
+    m_note_low          (0),
+    m_note_high         (c_notes_count - 1),
+    m_channel_map       (),
+    m_note_table        (),
+    m_velocity_table    (),
+    m_identity          (true)
+{
+    for (int ch = 0; ch < c_channel_max; ++ch)
+        m_channel_map[ch] = midi::byte(ch);
+
+    rebuild();
+}
+
+transform::transform
+(
+    int transpose,
+    double velscale,
+    int veloffset,
+    curve velcurve
+) :
+    transform   ()
+{
+    m_transpose = transpose;
+    m_velocity_scale = velscale;
+    m_velocity_offset = veloffset;
+    m_velocity_curve = velcurve;
+    rebuild();
+}
+
+void
+transform::transpose (int semitones)
+{
+    m_transpose = semitones;
+    rebuild();
+}
+
+void
+transform::velocity_map (double scale, int offset, curve c)
+{
+    m_velocity_scale = scale;
+    m_velocity_offset = offset;
+    m_velocity_curve = c;
+    rebuild();
+}
+
+void
+transform::channel_map (midi::byte from, midi::byte to)
+{
+    if (is_good_channel(from) && is_good_channel(to))
+    {
+        m_channel_map[from] = to;
+        rebuild();
+    }
+}
+
+/**
+ *  Sets the range of outgoing notes.  A transposed note outside the range
+ *  is moved by octaves into it; if the range is narrower than an octave,
+ *  the note is held at the nearer end.
+ */
+
+void
+transform::note_range (midi::byte low, midi::byte high)
+{
+    low &= 0x7F;
+    high &= 0x7F;
+    if (low <= high)
+    {
+        m_note_low = low;
+        m_note_high = high;
+        rebuild();
+    }
+}
+
+/**
+ *  Refills the tables from the settings.
+ */
+
+void
+transform::rebuild ()
+{
+    bool identity = true;
+    int low = int(m_note_low);
+    int high = int(m_note_high);
+    bool foldable = high - low >= 11;
+    for (int n = 0; n < c_notes_count; ++n)
+    {
+        int note = n + m_transpose;
+        if (foldable)
+        {
+            while (note < low)
+                note += 12;
+
+            while (note > high)
+                note -= 12;
+        }
+        if (note < low)
+            note = low;
+        else if (note > high)
+            note = high;
+
+        m_note_table[n] = midi::byte(note);
+        if (note != n)
+            identity = false;
+    }
+    m_velocity_table[0] = 0;
+    for (int v = 1; v < c_notes_count; ++v)
+    {
+        double x = v / 127.0;
+        if (m_velocity_curve == curve::soft)
+            x = std::sqrt(x);
+        else if (m_velocity_curve == curve::hard)
+            x = x * x;
+
+        int vel = int(x * 127.0 * m_velocity_scale + 0.5) + m_velocity_offset;
+        if (vel < 1)
+            vel = 1;                            /* not a disguised Note Off */
+        else if (vel > 127)
+            vel = 127;
+
+        m_velocity_table[v] = midi::byte(vel);
+        if (vel != v)
+            identity = false;
+    }
+    for (int ch = 0; ch < c_channel_max; ++ch)
+    {
+        if (m_channel_map[ch] != ch)
+            identity = false;
+    }
+    m_identity = identity;
+}
+
+/**
+ *  Transforms the outgoing copy of an event.  The channel is remapped for
+ *  every channel message, and a Note On gets its note and velocity from the
+ *  tables.  Note Offs and aftertouch are left to the caller, which must send
+ *  them to the note that the Note On became, even if the transform has since
+ *  changed.  See track::put_event_on_bus().
+ *
+ * \param ev
+ *      The outgoing copy, never the stored event.
+ *
+ * \param [inout] ch
+ *      The channel that the event goes out on.
+ */
+
+void
+transform::apply (event & ev, midi::byte & ch) const
+{
+    ch = m_channel_map[ch & 0x0F];
+    if (ev.is_note_on())
+    {
+        ev.set_note(m_note_table[ev.get_note() & 0x7F]);
+        ev.note_velocity(m_velocity_table[ev.note_velocity() & 0x7F]);
+    }
+}
+
+}           // namespace midi
+
+/*
+ * transform.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,564 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          undostack.cpp
+ *
+ *  This module defines the bounded undo/redo stack of event-lists.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  The snapshots always form three runs, oldest to newest: spilled to the
+ *  temporary file, packed in memory, and live.  Spilling starts at the
+ *  front, so the spill file is written and reclaimed in stack order.
+ *
+ *  The undotrimmer owns the one background thread.  It keeps a registry of
+ *  the stacks, guarded by its own mutex, which is held only to add, remove,
+ *  or look up a stack, never during a trim, so that making or destroying a
+ *  stack does not wait for the disk.  The thread takes a stack's trim mutex
+ *  while the stack is still registered; a destructor unregisters, then
+ *  takes the same mutex, so a stack is never destroyed in the middle of a
+ *  trim.  The wake-up uses a separate mutex, held only briefly, so that
+ *  push() never waits for a trim pass of another stack.
+ */
+
+#include <condition_variable>         /* std::condition_variable          */
+#include <new>                          /* std::nothrow                     */
+#include <set>                          /* std::set<>                       */
+#include <thread>                       /* std::thread                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "c_macros.h"                   /* not_nullptr() macro              */
+#include "midi/memusage.hpp"            /* midi::memusage class             */
+#include "midi/undostack.hpp"           /* midi::undostack class            */
+
+namespace midi
+{
+
+/**
+ *  The background thread that trims the undo stacks.  There is one for the
+ *  process, created when the first stack is created.  It is never
+ *  destroyed, so that stacks destroyed during static destruction can still
+ *  unregister; the thread is detached and ends with the process.
+ */
+
+class undotrimmer
+{
+
+private:
+
+    std::mutex m_registry_mutex;
+    std::set<undostack *> m_stacks;
+    std::vector<undostack *> m_pending;
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake_cv;
+    bool m_wake;
+
+public:
+
+    undotrimmer () :
+        m_registry_mutex    (),
+        m_stacks            (),
+        m_pending           (),
+        m_wake_mutex        (),
+        m_wake_cv           (),
+        m_wake              (false)
+    {
+        std::thread t(&undotrimmer::run, this);
+        t.detach();
+    }
+
+    static undotrimmer & get ()
+    {
+        static undotrimmer * s_trimmer = new undotrimmer();
+        return *s_trimmer;
+    }
+
+    void add (undostack * u)
+    {
+        std::lock_guard<std::mutex> lk(m_registry_mutex);
+        (void) m_stacks.insert(u);
+    }
+
+    /**
+     *  Unregisters a stack, then waits for a trim of it that may be under
+     *  way.
+     */
+
+    void remove (undostack * u)
+    {
+        {
+            std::lock_guard<std::mutex> lk(m_registry_mutex);
+            (void) m_stacks.erase(u);
+        }
+        std::lock_guard<std::mutex> tl(u->m_trim_mutex);
+    }
+
+    void wake ()
+    {
+        {
+            std::lock_guard<std::mutex> lk(m_wake_mutex);
+            m_wake = true;
+        }
+        m_wake_cv.notify_one();
+    }
+
+private:
+
+    void run ()
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lk(m_wake_mutex);
+                m_wake_cv.wait(lk, [this] { return m_wake; });
+                m_wake = false;
+            }
+            {
+                std::lock_guard<std::mutex> lk(m_registry_mutex);
+                m_pending.clear();
+                for (auto u : m_stacks)
+                {
+                    if (u->m_trim_pending)
+                        m_pending.push_back(u);
+                }
+            }
+            for (auto u : m_pending)
+            {
+                std::unique_lock<std::mutex> tl;
+                {
+                    std::lock_guard<std::mutex> lk(m_registry_mutex);
+                    if (m_stacks.count(u) == 0)
+                        continue;                   /* destroyed meanwhile  */
+
+                    tl = std::unique_lock<std::mutex>(u->m_trim_mutex);
+                }
+                (void) u->trim();
+            }
+        }
+    }
+
+};          // class undotrimmer
+
+/**
+ *  The budget is on by default.  See c_budget_default.
+ */
+
+std::atomic<std::size_t> undostack::sm_budget{undostack::c_budget_default};
+std::atomic<std::size_t> undostack::sm_total_bytes{0};
+std::atomic<int> undostack::sm_default_depth{undostack::c_depth_default};
+std::atomic<bool> undostack::sm_background{true};
+
+/**
+ *  Principal constructor.
+ *
+ * \param livelimit
+ *      The number of the newest snapshots to keep as live event-lists.
+ *      These are restored by a plain copy.  Must be at least 1.
+ *
+ * \param depthlimit
+ *      The maximum number of snapshots.  Zero means no limit.  The default,
+ *      c_depth_configured, uses default_depth().
+ */
+
+undostack::undostack (int livelimit, int depthlimit) :
+    m_slots         (),
+    m_mutex         (),
+    m_trim_mutex    (),
+    m_trim_pending  (false),
+    m_live_limit    (livelimit > 0 ? livelimit : 1),
+    m_depth_limit
+    (
+        depthlimit == c_depth_configured ? default_depth() :
+            (depthlimit > 0 ? depthlimit : 0)
+    ),
+    m_packed_bytes  (0),
+    m_spilled       (0),
+    m_spill_file    (nullptr),
+    m_spill_end     (0),
+    m_spill_bytes   (0)
+{
+    undotrimmer::get().add(this);
+}
+
+undostack::~undostack ()
+{
+    undotrimmer::get().remove(this);
+    clear();
+    if (not_nullptr(m_spill_file))
+        (void) std::fclose(m_spill_file);
+}
+
+/**
+ *  Sets the depth limit, dropping the oldest snapshots if needed.
+ */
+
+void
+undostack::depth_limit (int d)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_depth_limit = d > 0 ? d : 0 ;
+    while (m_depth_limit > 0 && int(m_slots.size()) > m_depth_limit)
+    {
+        release_slot(m_slots.front());
+        m_slots.pop_front();
+    }
+}
+
+/**
+ *  Pushes a copy of the event-list.  If the depth limit is reached, the
+ *  oldest snapshot is dropped.  The snapshot that moves out of the live
+ *  window is packed, and the memory budget checked, by trim(), which is
+ *  normally left to the background thread.
+ */
+
+void
+undostack::push (const eventlist & evl)
+{
+    slot s;
+    s.s_live.reset(new (std::nothrow) eventlist(evl));
+    s.s_offset = (-1);
+    s.s_size = 0;
+    if (s.s_live)
+    {
+        bool needtrim;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            if (m_depth_limit > 0 && int(m_slots.size()) >= m_depth_limit)
+            {
+                release_slot(m_slots.front());
+                m_slots.pop_front();
+            }
+            m_slots.push_back(std::move(s));
+            needtrim = int(m_slots.size()) > m_live_limit;
+        }
+        if (needtrim)
+        {
+            m_trim_pending = true;
+            if (background_trim())
+                undotrimmer::get().wake();
+            else
+                (void) trim();
+        }
+    }
+}
+
+/**
+ *  Pops the newest snapshot into the destination.
+ *
+ * \return
+ *      Returns true if there was a snapshot and it was restored.  If the
+ *      snapshot could not be read back, it is still removed, and false is
+ *      returned, leaving the destination unchanged.
+ */
+
+bool
+undostack::pop (eventlist & destination)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    bool result = ! m_slots.empty();
+    if (result)
+    {
+        slot & s = m_slots.back();
+        if (s.s_live)
+        {
+            destination = *s.s_live;
+        }
+        else
+        {
+            eventlist temp;
+            if (s.s_offset >= 0)
+            {
+                midi::bytes data(s.s_size);
+                result = not_nullptr(m_spill_file) &&
+                    std::fseek(m_spill_file, s.s_offset, SEEK_SET) == 0 &&
+                    std::fread(data.data(), 1, s.s_size, m_spill_file) ==
+                        s.s_size;
+
+                if (result)
+                    result = temp.unpack(data);
+
+                m_spill_end = s.s_offset;
+            }
+            else
+                result = temp.unpack(s.s_packed);
+
+            if (result)
+                destination = temp;
+        }
+        release_slot(s);
+        m_slots.pop_back();
+    }
+    return result;
+}
+
+void
+undostack::clear ()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (auto & s : m_slots)
+        release_slot(s);
+
+    m_slots.clear();
+    m_spilled = 0;
+    m_spill_end = 0;
+    m_spill_bytes = 0;
+}
+
+/**
+ *  Packs the snapshots that have left the live window, and spills the
+ *  oldest packed ones while all stacks are over budget.  The mutex is
+ *  taken for one snapshot at a time.
+ *
+ * \return
+ *      Returns the number of snapshots packed or spilled.
+ */
+
+int
+undostack::trim ()
+{
+    int result = 0;
+    m_trim_pending = false;
+    for (;;)
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (trim_step())
+            ++result;
+        else
+            break;
+    }
+    return result;
+}
+
+std::size_t
+undostack::spilled () const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_spilled;
+}
+
+/**
+ *  The used size of the spill file, including any holes.
+ */
+
+std::size_t
+undostack::spill_file_size () const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return std::size_t(m_spill_end);
+}
+
+std::size_t
+undostack::packed_bytes () const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_packed_bytes;
+}
+
+/**
+ *  Adds the snapshots to the undo count.  Spilled snapshots cost only
+ *  their slot.
+ */
+
+void
+undostack::memory_usage (memusage & mu) const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (const auto & s : m_slots)
+    {
+        if (s.s_live)
+        {
+            memusage temp;
+            s.s_live->memory_usage(temp);
+            temp.add_other(sizeof(slot));
+            mu.add_as_undo(temp);
+        }
+        else
+            mu.add_undo(1, sizeof(slot) + s.s_packed.capacity());
+    }
+}
+
+/**
+ *  Does one unit of trimming: packs the oldest live snapshot outside the
+ *  live window, or else moves one spilled snapshot down into a hole (see
+ *  compact_step()), or else spills the oldest packed snapshot if all
+ *  stacks are over budget.  The caller holds the mutex.
+ *
+ * \return
+ *      Returns true if a snapshot was packed or spilled.
+ */
+
+bool
+undostack::trim_step ()
+{
+    int oldest_live = int(m_slots.size()) - m_live_limit - 1;
+    if (oldest_live >= 0 && m_slots[oldest_live].s_live)
+    {
+        int i = oldest_live;
+        while (i > 0 && m_slots[i - 1].s_live)
+            --i;
+
+        pack_slot(m_slots[i]);
+        return true;
+    }
+    if (compact_step())
+        return true;
+
+    std::size_t b = sm_budget;
+    if (b == 0 || sm_total_bytes <= b || m_spilled >= m_slots.size())
+        return false;
+
+    return spill_slot(m_slots[m_spilled]);
+}
+
+void
+undostack::pack_slot (slot & s)
+{
+    if (s.s_live)
+    {
+        s.s_live->pack(s.s_packed);
+        s.s_packed.shrink_to_fit();
+        s.s_live.reset();
+        m_packed_bytes += s.s_packed.capacity();
+        sm_total_bytes += s.s_packed.capacity();
+    }
+}
+
+/**
+ *  Writes a packed snapshot to the spill file, which is created when first
+ *  needed.  If the file cannot be created or written, or the snapshot is
+ *  still live, the snapshot stays in memory.
+ */
+
+bool
+undostack::spill_slot (slot & s)
+{
+    if (s.s_live)
+        return false;
+
+    if (is_nullptr(m_spill_file))
+    {
+        m_spill_file = std::tmpfile();
+        if (is_nullptr(m_spill_file))
+            return false;
+    }
+
+    std::size_t sz = s.s_packed.size();
+    bool result = std::fseek(m_spill_file, m_spill_end, SEEK_SET) == 0 &&
+        std::fwrite(s.s_packed.data(), 1, sz, m_spill_file) == sz;
+
+    if (result)
+    {
+        std::size_t cap = s.s_packed.capacity();
+        s.s_offset = m_spill_end;
+        s.s_size = sz;
+        m_spill_end += long(sz);
+        m_spill_bytes += sz;
+        m_packed_bytes -= cap;
+        sm_total_bytes -= cap;
+        midi::bytes().swap(s.s_packed);
+        ++m_spilled;
+    }
+    return result;
+}
+
+/**
+ *  Moves the first spilled snapshot that is not where it would be in a
+ *  packed file down to that place, if the holes left by the depth limit
+ *  take up more of the file than the snapshots.  The snapshots keep their
+ *  order in the file, so pop() can still reclaim the space.
+ *
+ * \return
+ *      Returns true if a snapshot was moved.
+ */
+
+bool
+undostack::compact_step ()
+{
+    bool result = false;
+    std::size_t holes = std::size_t(m_spill_end) - m_spill_bytes;
+    if (m_spilled > 0 && holes > m_spill_bytes)
+    {
+        long expected = 0;
+        for (std::size_t i = 0; i < m_spilled; ++i)
+        {
+            slot & s = m_slots[i];
+            if (s.s_offset != expected)
+            {
+                midi::bytes data(s.s_size);
+                result =
+                    std::fseek(m_spill_file, s.s_offset, SEEK_SET) == 0 &&
+                    std::fread(data.data(), 1, s.s_size, m_spill_file) ==
+                        s.s_size &&
+                    std::fseek(m_spill_file, expected, SEEK_SET) == 0 &&
+                    std::fwrite(data.data(), 1, s.s_size, m_spill_file) ==
+                        s.s_size;
+
+                if (result)
+                {
+                    s.s_offset = expected;
+                    if (i + 1 == m_spilled)
+                        m_spill_end = expected + long(s.s_size);
+                }
+                break;
+            }
+            expected += long(s.s_size);
+        }
+    }
+    return result;
+}
+
+/**
+ *  Removes a slot's packed bytes from the totals.  The spill file space is
+ *  reclaimed by pop() and clear(), or by compact_step() if the slot is
+ *  dropped by the depth limit.  The caller removes the slot, which is
+ *  always at the front or the back, and thus at the edge of the spilled
+ *  run if it was spilled.
+ */
+
+void
+undostack::release_slot (slot & s)
+{
+    std::size_t cap = s.s_packed.capacity();
+    if (cap > 0)
+    {
+        m_packed_bytes -= cap;
+        sm_total_bytes -= cap;
+        midi::bytes().swap(s.s_packed);
+    }
+    if (s.s_offset >= 0 && m_spilled > 0)
+    {
+        m_spill_bytes -= s.s_size;
+        if (--m_spilled == 0)
+            m_spill_end = 0;
+    }
+
+    s.s_live.reset();
+}
+
+}           // namespace midi
+
+/*
+ * undostack.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
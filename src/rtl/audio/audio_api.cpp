@@ -24,11 +24,13 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2023-03-07
- * \updates       2023-03-17
+ * \updates       2026-10-18
  * \license       See above.
  *
  */
 
+#include <algorithm>                    /* std::min()                       */
+#include <cmath>                        /* std::llround()                   */
 #include <cstring>                      /* std::memset()                    */
 
 #include "c_macros.h"                   /* not_nullptr() and friends        */
@@ -58,7 +60,14 @@ audio_api::audio_api () :
     m_device_list       (),
     m_currentdeviceid   (129),
     m_stream            (),
-    m_show_warnings     (true)
+    m_show_warnings     (true),
+    m_push_mode         (false),
+    m_push_output       (),
+    m_push_input        (),
+    m_push_write_scratch(),
+    m_push_read_scratch (),
+    m_underruns         (0),
+    m_overruns          (0)
 {
     clear_stream_info();
 }
@@ -84,6 +93,7 @@ audio_api::open_stream
         return false;
     }
     clear_stream_info();
+    m_push_mode = false;
     if (not_nullptr(outparameters) && outparameters->nchannels() < 1)
     {
         std::string msg = "open_stream: output stream_parameters nchannels < 1";
@@ -176,10 +186,238 @@ audio_api::open_stream
     if (not_nullptr(options))
         options->numberofbuffers(m_stream.nbuffers());
 
+    m_frame_clock.sample_rate(m_stream.samplerate());
+    m_frame_clock.reset();
+    m_frame_clock.active(true);
     m_stream.state(stream_state::stopped);
     return true;
 }
 
+/**
+ *  Opens a stream in push mode.  The application supplies and takes audio
+ *  with write() and read(), as float frames, instead of in a callback.
+ *  The parameters are those of open_stream(), except for the callback and
+ *  its data.
+ *
+ *  The output ring starts empty, so the application should write a few
+ *  buffers before starting the stream, or the first callbacks count as
+ *  underruns.
+ *
+ * \param sformat
+ *      The stream's sample format.  The conversion from (and to) float is
+ *      done in write() (and read()), not in the callback.
+ *
+ * \param ringframes
+ *      The depth of each ring, in frames, rounded up to a power of two.  It
+ *      should be several times bufferframes.  If 0, four buffers are used.
+ *
+ * \return
+ *      Returns true if the stream was opened.
+ */
+
+bool
+audio_api::open_push_stream
+(
+    stream_parameters * outparameters,
+    stream_parameters * inparameters,
+    stream_format sformat,
+    unsigned samplerate,
+    unsigned bufferframes,
+    unsigned ringframes,
+    stream_options * options,
+    rterror::callback_t errorcb
+)
+{
+    bool result = open_stream
+    (
+        outparameters, inparameters, sformat, samplerate, bufferframes,
+        push_callback, this, options, errorcb
+    );
+    if (result)
+    {
+        if (ringframes == 0)
+            ringframes = 4 * m_stream.buffersize();
+
+        std::size_t samplebytes = format_bytes(sformat);
+        unsigned ochannels = m_stream.nuserchannels(stream_mode::output);
+        unsigned ichannels = m_stream.nuserchannels(stream_mode::input);
+        (void) m_push_output.resize(ringframes, ochannels * samplebytes);
+        (void) m_push_input.resize(ringframes, ichannels * samplebytes);
+        m_push_write_scratch.assign
+        (
+            m_push_output.capacity() * m_push_output.frame_bytes(), 0
+        );
+        m_push_read_scratch.assign
+        (
+            m_push_input.capacity() * m_push_input.frame_bytes(), 0
+        );
+        m_underruns = m_overruns = 0;
+        m_push_mode = true;
+    }
+    return result;
+}
+
+/**
+ *  Push mode: queues float frames (interleaved) for playback.  They are
+ *  converted to the stream format here, so that the callback only copies
+ *  them.
+ *
+ * \param samples
+ *      The frames, with one sample for each output channel.
+ *
+ * \param frames
+ *      The number of frames.
+ *
+ * \param timeoutms
+ *      If 0 (the default), only the frames that fit now are queued.  If
+ *      positive, the longest to wait each time the ring is full.  If
+ *      negative, wait as long as needed.
+ *
+ * \return
+ *      Returns the number of frames queued.
+ */
+
+std::size_t
+audio_api::write (const float * samples, std::size_t frames, int timeoutms)
+{
+    std::size_t result = 0;
+    std::size_t framebytes = m_push_output.frame_bytes();
+    if (m_push_mode && framebytes > 0)
+    {
+        unsigned channels = m_stream.nuserchannels(stream_mode::output);
+        stream_format sformat = m_stream.userformat();
+        while (result < frames)
+        {
+            std::size_t room = m_push_output.writable();
+            if (room == 0)
+            {
+                if (m_push_output.wait_writable(1, timeoutms))
+                    continue;
+                else
+                    break;
+            }
+
+            std::size_t count = std::min(room, frames - result);
+            convert_from_float
+            (
+                samples + result * channels, m_push_write_scratch.data(),
+                count * channels, sformat
+            );
+            result += m_push_output.write
+            (
+                m_push_write_scratch.data(), count
+            );
+        }
+    }
+    return result;
+}
+
+/**
+ *  Push mode: takes recorded frames, converted to float (interleaved).
+ *
+ * \param [out] samples
+ *      The destination, with room for one sample per input channel for each
+ *      frame.
+ *
+ * \param frames
+ *      The number of frames wanted.
+ *
+ * \param timeoutms
+ *      As for write(), but waiting for data.
+ *
+ * \return
+ *      Returns the number of frames taken.
+ */
+
+std::size_t
+audio_api::read (float * samples, std::size_t frames, int timeoutms)
+{
+    std::size_t result = 0;
+    std::size_t framebytes = m_push_input.frame_bytes();
+    if (m_push_mode && framebytes > 0)
+    {
+        unsigned channels = m_stream.nuserchannels(stream_mode::input);
+        stream_format sformat = m_stream.userformat();
+        while (result < frames)
+        {
+            std::size_t count = m_push_input.read
+            (
+                m_push_read_scratch.data(),
+                std::min(frames - result, m_push_input.capacity())
+            );
+            if (count == 0)
+            {
+                if (m_push_input.wait_readable(1, timeoutms))
+                    continue;
+                else
+                    break;
+            }
+            convert_to_float
+            (
+                m_push_read_scratch.data(), samples + result * channels,
+                count * channels, sformat
+            );
+            result += count;
+        }
+    }
+    return result;
+}
+
+/**
+ *  The callback used in push mode.  The user data is the audio_api.
+ */
+
+int
+audio_api::push_callback
+(
+    void * outputbuffer, void * inputbuffer,
+    int nframes, double /*streamtime*/,
+    stream_status /*status*/, void * userdata
+)
+{
+    audio_api * self = static_cast<audio_api *>(userdata);
+    return self->push_service
+    (
+        static_cast<char *>(outputbuffer),
+        static_cast<const char *>(inputbuffer), nframes
+    );
+}
+
+/**
+ *  Copies frames from the output ring to the device and from the device to
+ *  the input ring.  Nothing here allocates, converts, or blocks; waking a
+ *  waiting writer or reader takes a mutex only if one is waiting.
+ */
+
+int
+audio_api::push_service
+(
+    char * outputbuffer, const char * inputbuffer, int nframes
+)
+{
+    std::size_t frames = nframes > 0 ? std::size_t(nframes) : 0 ;
+    if (not_nullptr(outputbuffer) && m_push_output.frame_bytes() > 0)
+    {
+        std::size_t count = m_push_output.read(outputbuffer, frames);
+        if (count < frames)
+        {
+            std::size_t framebytes = m_push_output.frame_bytes();
+            std::memset
+            (
+                outputbuffer + count * framebytes, 0,
+                (frames - count) * framebytes
+            );
+            ++m_underruns;
+        }
+    }
+    if (not_nullptr(inputbuffer) && m_push_input.frame_bytes() > 0)
+    {
+        if (m_push_input.write(inputbuffer, frames) < frames)
+            ++m_overruns;
+    }
+    return static_cast<int>(callback_result::normal);
+}
+
 /**
  *  This function MUST be implemented in all subclasses! Within each API, this
  *  function will be used to:
@@ -685,15 +923,16 @@ audio_api::convert_buffer
 /**
  *  Subclasses that do not provide their own implementation of
  *  get_stream_time() should call this function once per buffer I/O to
- *  provide basic stream time support.
+ *  provide basic stream time support.  The frame clock advances by one
+ *  buffer, and the stream time is computed from its frame count rather
+ *  than summed, so it has no rounding drift however long the stream runs.
  */
 
 void
 audio_api::tick_stream_time ()
 {
-    double strmtime = m_stream.streamtime();
-    strmtime += m_stream.buffersize() * 1.0 / m_stream.samplerate();
-    m_stream.streamtime(strmtime);
+    m_frame_clock.advance(m_stream.buffersize());
+    m_stream.streamtime(m_frame_clock.seconds());
 
   /*
 #if defined( HAVE_GETTIMEOFDAY )
@@ -702,6 +941,26 @@ audio_api::tick_stream_time ()
   */
 }
 
+/**
+ *  Sets the stream time, moving the frame clock to the nearest frame.
+ */
+
+void
+audio_api::set_stream_time (double t)
+{
+    if (t >= 0.0)
+    {
+        unsigned sr = m_frame_clock.sample_rate();
+        if (sr > 0)
+        {
+            m_frame_clock.reset(std::llround(t * sr));
+            m_stream.streamtime(m_frame_clock.seconds());
+        }
+        else
+            m_stream.streamtime(t);
+    }
+}
+
 }           // namespace rtl
 
 /*
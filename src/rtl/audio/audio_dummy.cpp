@@ -0,0 +1,255 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          audio_dummy.cpp
+ *
+ *      Implements the headless, timer-driven audio device.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ */
+
+#include <chrono>                       /* std::chrono::steady_clock        */
+#include <cstring>                      /* std::memcpy(), std::memset()     */
+
+#include "rtl/audio/audio_dummy.hpp"    /* rtl::audio_dummy class           */
+
+namespace rtl
+{
+
+/**
+ *  The default buffer size, in frames, if the caller asks for 0.
+ */
+
+static const unsigned c_dummy_buffer_frames = 256;
+
+audio_dummy::audio_dummy () :
+    audio_api           (),
+    m_thread            (),
+    m_thread_running    (false),
+    m_output_buffer     (),
+    m_input_buffer      ()
+{
+    // no code
+}
+
+audio_dummy::~audio_dummy ()
+{
+    join();
+}
+
+/**
+ *  There is always one device, "Dummy", with two channels each way.
+ */
+
+bool
+audio_dummy::probe_devices ()
+{
+    if (device_list().empty())
+    {
+        device_info info;
+        info.ID(1);
+        info.name("Dummy");
+        info.output_channels(2);
+        info.input_channels(2);
+        info.is_default_output(true);
+        info.is_default_input(true);
+        device_list().push_back(info);
+    }
+    return true;
+}
+
+/**
+ *  Accepts any format, rate, and buffer size for up to two channels, and
+ *  sets up the user buffer for the given direction.
+ */
+
+bool
+audio_dummy::probe_device_open
+(
+    unsigned device,
+    stream_mode mode,
+    unsigned channels,
+    unsigned firstchannel, unsigned samplerate,
+    stream_format format, unsigned * buffersize,
+    stream_options * /*options*/
+)
+{
+    bool result = device < unsigned(device_list().size()) &&
+        channels + firstchannel <= 2 && samplerate > 0 &&
+        (mode == stream_mode::output || mode == stream_mode::input);
+
+    if (result)
+    {
+        if (*buffersize == 0)
+            *buffersize = c_dummy_buffer_frames;
+
+        api_stream & s = stream();
+        if (s.mode() == stream_mode::output && mode == stream_mode::input)
+            s.mode(stream_mode::duplex);
+        else
+            s.mode(mode);
+
+        s.samplerate(samplerate);
+        s.buffersize(*buffersize);
+        s.nuserchannels(mode, channels);
+        s.userformat(format);
+
+        std::size_t bytes = std::size_t(*buffersize) * channels *
+            format_bytes(format);
+
+        if (mode == stream_mode::output)
+            m_output_buffer.assign(bytes, 0);
+        else
+            m_input_buffer.assign(bytes, 0);
+    }
+    return result;
+}
+
+bool
+audio_dummy::close_stream ()
+{
+    bool result = is_stream_open();
+    if (result)
+    {
+        join();
+        clear_stream_info();
+        m_output_buffer.clear();
+        m_input_buffer.clear();
+    }
+    else
+        error(rterror::kind::warning, "audio_dummy: no open stream to close");
+
+    return result;
+}
+
+bool
+audio_dummy::start_stream ()
+{
+    bool result = stream().state() == stream_state::stopped;
+    if (result)
+    {
+        join();                         /* in case the callback stopped it  */
+        stream().state(stream_state::running);
+        m_thread_running = true;
+        m_thread = std::thread(&audio_dummy::run, this);
+    }
+    else
+        error(rterror::kind::warning, "audio_dummy: stream not stopped");
+
+    return result;
+}
+
+bool
+audio_dummy::stop_stream ()
+{
+    bool result = is_stream_running();
+    if (result)
+    {
+        join();
+        stream().state(stream_state::stopped);
+    }
+    return result;
+}
+
+bool
+audio_dummy::abort_stream ()
+{
+    return stop_stream();
+}
+
+/**
+ *  Stops the thread, if any, and waits for it.
+ */
+
+void
+audio_dummy::join ()
+{
+    m_thread_running = false;
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+/**
+ *  The device thread.  It wakes once per buffer period, on a schedule kept
+ *  from the start so that it does not drift, and calls the callback.  If
+ *  the callback asks to stop, the thread ends and the stream is stopped.
+ */
+
+void
+audio_dummy::run ()
+{
+    using clock = std::chrono::steady_clock;
+    api_stream & s = stream();
+    callback_t cb = reinterpret_cast<callback_t>(s.callbackinfo().callback());
+    void * userdata = s.callbackinfo().userdata();
+    bool playing = s.mode() != stream_mode::input;
+    bool recording = s.mode() != stream_mode::output;
+    bool loopback = s.mode() == stream_mode::duplex &&
+        m_output_buffer.size() == m_input_buffer.size();
+
+    int nframes = int(s.buffersize());
+    auto period = std::chrono::duration_cast<clock::duration>
+    (
+        std::chrono::duration<double>(double(nframes) / s.samplerate())
+    );
+    auto next = clock::now();
+    while (m_thread_running)
+    {
+        int rc = static_cast<int>(callback_result::normal);
+        if (not_nullptr(cb))
+        {
+            rc = cb
+            (
+                playing ? m_output_buffer.data() : nullptr,
+                recording ? m_input_buffer.data() : nullptr,
+                nframes, s.streamtime(), static_cast<stream_status>(0),
+                userdata
+            );
+        }
+        if (loopback)
+        {
+            std::memcpy
+            (
+                m_input_buffer.data(), m_output_buffer.data(),
+                m_input_buffer.size()
+            );
+        }
+        tick_stream_time();
+        if (rc != static_cast<int>(callback_result::normal))
+        {
+            s.state(stream_state::stopped);
+            break;
+        }
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+}           // namespace rtl
+
+/*
+ * audio_dummy.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,415 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          audio_ring.cpp
+ *
+ *      Implements the lock-free frame ring and the sample conversions.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ */
+
+#include <algorithm>                    /* std::min()                       */
+#include <chrono>                       /* std::chrono::milliseconds        */
+#include <cstring>                      /* std::memcpy()                    */
+
+#include "rtl/audio/audio_ring.hpp"     /* rtl::audio_ring class            */
+#include "rtl/audio/audio_support.hpp"  /* rtl::Int24, Int16, etc.          */
+
+namespace rtl
+{
+
+audio_ring::audio_ring () :
+    m_buffer        (),
+    m_frame_bytes   (0),
+    m_capacity      (0),
+    m_mask          (0),
+    m_write_count   (0),
+    m_read_count    (0),
+    m_wait_mutex    (),
+    m_wait_cond     (),
+    m_waiting       (false)
+{
+    // no code
+}
+
+/**
+ *  Allocates the ring.  Not to be called while either side is using it.
+ *
+ * \param frames
+ *      The depth wanted, in frames.  It is rounded up to a power of two.
+ *
+ * \param framebytes
+ *      The size of one frame: the channel count times the sample size.
+ *
+ * \return
+ *      Returns false if either parameter is 0.
+ */
+
+bool
+audio_ring::resize (std::size_t frames, std::size_t framebytes)
+{
+    bool result = frames > 0 && framebytes > 0;
+    if (result)
+    {
+        std::size_t capacity = 1;
+        while (capacity < frames)
+            capacity <<= 1;
+
+        m_buffer.assign(capacity * framebytes, 0);
+        m_frame_bytes = framebytes;
+        m_capacity = capacity;
+        m_mask = capacity - 1;
+    }
+    else
+    {
+        m_buffer.clear();
+        m_frame_bytes = m_capacity = m_mask = 0;
+    }
+    clear();
+    return result;
+}
+
+/**
+ *  Empties the ring.  Like resize(), only for when neither side is active.
+ */
+
+void
+audio_ring::clear ()
+{
+    m_write_count = 0;
+    m_read_count = 0;
+}
+
+/**
+ *  Producer side: copies up to count frames into the ring.
+ *
+ * \return
+ *      Returns the number of frames copied, which is less than count if the
+ *      ring is short of room.
+ */
+
+std::size_t
+audio_ring::write (const void * frames, std::size_t count)
+{
+    std::size_t w = m_write_count.load(std::memory_order_relaxed);
+    std::size_t r = m_read_count.load(std::memory_order_acquire);
+    std::size_t result = std::min(count, m_capacity - (w - r));
+    if (result > 0)
+    {
+        const char * source = static_cast<const char *>(frames);
+        std::size_t start = w & m_mask;
+        std::size_t first = std::min(result, m_capacity - start);
+        std::memcpy
+        (
+            &m_buffer[start * m_frame_bytes], source, first * m_frame_bytes
+        );
+        if (result > first)
+        {
+            std::memcpy
+            (
+                &m_buffer[0], source + first * m_frame_bytes,
+                (result - first) * m_frame_bytes
+            );
+        }
+        m_write_count.store(w + result, std::memory_order_release);
+        wake();
+    }
+    return result;
+}
+
+/**
+ *  Consumer side: copies up to count frames out of the ring.
+ *
+ * \return
+ *      Returns the number of frames copied, which is less than count if the
+ *      ring is short of data.
+ */
+
+std::size_t
+audio_ring::read (void * frames, std::size_t count)
+{
+    std::size_t r = m_read_count.load(std::memory_order_relaxed);
+    std::size_t w = m_write_count.load(std::memory_order_acquire);
+    std::size_t result = std::min(count, w - r);
+    if (result > 0)
+    {
+        char * destination = static_cast<char *>(frames);
+        std::size_t start = r & m_mask;
+        std::size_t first = std::min(result, m_capacity - start);
+        std::memcpy
+        (
+            destination, &m_buffer[start * m_frame_bytes],
+            first * m_frame_bytes
+        );
+        if (result > first)
+        {
+            std::memcpy
+            (
+                destination + first * m_frame_bytes, &m_buffer[0],
+                (result - first) * m_frame_bytes
+            );
+        }
+        m_read_count.store(r + result, std::memory_order_release);
+        wake();
+    }
+    return result;
+}
+
+/**
+ *  Waits until there is room for (or data for) the given number of frames,
+ *  or the timeout passes.  Only the application side waits.
+ *
+ * \param count
+ *      The number of frames needed.  More than the capacity is treated as
+ *      the capacity.
+ *
+ * \param timeoutms
+ *      The longest wait, in milliseconds.  If 0, there is no wait, only a
+ *      check.  If negative, there is no time limit.
+ *
+ * \return
+ *      Returns true if the frames are available.
+ */
+
+bool
+audio_ring::wait_writable (std::size_t count, int timeoutms)
+{
+    return wait_for(true, count, timeoutms);
+}
+
+bool
+audio_ring::wait_readable (std::size_t count, int timeoutms)
+{
+    return wait_for(false, count, timeoutms);
+}
+
+bool
+audio_ring::wait_for (bool writing, std::size_t count, int timeoutms)
+{
+    if (count > m_capacity)
+        count = m_capacity;
+
+    auto ready = [this, writing, count] ()
+    {
+        return (writing ? writable() : readable()) >= count;
+    };
+    bool result = ready();
+    if (! result && timeoutms != 0 && m_capacity > 0)
+    {
+        std::unique_lock<std::mutex> lock(m_wait_mutex);
+        m_waiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (timeoutms < 0)
+        {
+            m_wait_cond.wait(lock, ready);
+            result = true;
+        }
+        else
+        {
+            result = m_wait_cond.wait_for
+            (
+                lock, std::chrono::milliseconds(timeoutms), ready
+            );
+        }
+        m_waiting = false;
+    }
+    return result;
+}
+
+/**
+ *  Wakes a waiting application thread.  The audio callback takes the mutex
+ *  only when someone is waiting, and then only to notify.  The fence
+ *  orders the index update before the check of m_waiting, matching the
+ *  waiter, which sets m_waiting before checking the indices.
+ */
+
+void
+audio_ring::wake ()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiting)
+    {
+        std::lock_guard<std::mutex> lock(m_wait_mutex);
+        m_wait_cond.notify_all();
+    }
+}
+
+/*
+ * Sample conversion.
+ */
+
+namespace
+{
+
+template <typename T>
+void
+put_sample (char * destination, std::size_t index, T value)
+{
+    std::memcpy(destination + index * sizeof(T), &value, sizeof(T));
+}
+
+template <typename T>
+T
+get_sample (const char * source, std::size_t index)
+{
+    T value;
+    std::memcpy(&value, source + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+inline float
+clamped (float f)
+{
+    return f > 1.0f ? 1.0f : (f < -1.0f ? -1.0f : f) ;
+}
+
+}           // namespace (anonymous)
+
+void
+convert_from_float
+(
+    const float * source, char * destination,
+    std::size_t samples, stream_format format
+)
+{
+    switch (format)
+    {
+        case stream_format::sint8:
+
+            for (std::size_t i = 0; i < samples; ++i)
+            {
+                auto v = static_cast<signed char>(clamped(source[i]) * 127.0f);
+                put_sample(destination, i, v);
+            }
+            break;
+
+        case stream_format::sint16:
+
+            for (std::size_t i = 0; i < samples; ++i)
+            {
+                auto v = Int16(clamped(source[i]) * 32767.0f);
+                put_sample(destination, i, v);
+            }
+            break;
+
+        case stream_format::sint24:
+
+            for (std::size_t i = 0; i < samples; ++i)
+            {
+                Int24 v;
+                v = int(clamped(source[i]) * 8388607.0f);
+                std::memcpy(destination + i * 3, &v, 3);
+            }
+            break;
+
+        case stream_format::sint32:
+
+            for (std::size_t i = 0; i < samples; ++i)
+            {
+                double d = double(clamped(source[i])) * 2147483647.0;
+                put_sample(destination, i, Int32(d));
+            }
+            break;
+
+        case stream_format::float32:
+
+            std::memcpy(destination, source, samples * sizeof(float));
+            break;
+
+        case stream_format::float64:
+
+            for (std::size_t i = 0; i < samples; ++i)
+                put_sample(destination, i, Float64(source[i]));
+            break;
+
+        default:
+
+            break;
+    }
+}
+
+void
+convert_to_float
+(
+    const char * source, float * destination,
+    std::size_t samples, stream_format format
+)
+{
+    switch (format)
+    {
+        case stream_format::sint8:
+
+            for (std::size_t i = 0; i < samples; ++i)
+                destination[i] = get_sample<signed char>(source, i) / 127.0f;
+            break;
+
+        case stream_format::sint16:
+
+            for (std::size_t i = 0; i < samples; ++i)
+                destination[i] = get_sample<Int16>(source, i) / 32767.0f;
+            break;
+
+        case stream_format::sint24:
+
+            for (std::size_t i = 0; i < samples; ++i)
+            {
+                Int24 v;
+                std::memcpy(&v, source + i * 3, 3);
+                destination[i] = static_cast<Int32>(v) / 8388607.0f;
+            }
+            break;
+
+        case stream_format::sint32:
+
+            for (std::size_t i = 0; i < samples; ++i)
+            {
+                double d = get_sample<Int32>(source, i) / 2147483647.0;
+                destination[i] = float(d);
+            }
+            break;
+
+        case stream_format::float32:
+
+            std::memcpy(destination, source, samples * sizeof(float));
+            break;
+
+        case stream_format::float64:
+
+            for (std::size_t i = 0; i < samples; ++i)
+                destination[i] = float(get_sample<Float64>(source, i));
+            break;
+
+        default:
+
+            break;
+    }
+}
+
+}           // namespace rtl
+
+/*
+ * audio_ring.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -25,7 +25,7 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2023-03-07
- * \updates       2025-01-20
+ * \updates       2026-10-18
  * \license       See above.
  *
  */
@@ -403,6 +403,81 @@ rtaudio::open_stream
     return result;
 }
 
+bool
+rtaudio::open_push_stream
+(
+    stream_parameters * outparameters,
+    stream_parameters * inparameters,
+    stream_format format,
+    unsigned samplerate,
+    unsigned bufferframes,
+    unsigned ringframes,
+    stream_options * options,
+    rterror::callback_t errorcb
+)
+{
+    bool result = not_nullptr(rt_api_ptr());
+    if (result)
+    {
+        result = rt_api_ptr()->open_push_stream
+        (
+            outparameters,
+            inparameters,
+            format,
+            samplerate,
+            bufferframes,
+            ringframes,
+            options,
+            errorcb
+        );
+    }
+    return result;
+}
+
+std::size_t
+rtaudio::write (const float * samples, std::size_t frames, int timeoutms)
+{
+    return not_nullptr(rt_api_ptr()) ?
+        rt_api_ptr()->write(samples, frames, timeoutms) : 0 ;
+}
+
+std::size_t
+rtaudio::read (float * samples, std::size_t frames, int timeoutms)
+{
+    return not_nullptr(rt_api_ptr()) ?
+        rt_api_ptr()->read(samples, frames, timeoutms) : 0 ;
+}
+
+std::size_t
+rtaudio::push_writable () const
+{
+    return not_nullptr(rt_api_ptr()) ? rt_api_ptr()->push_writable() : 0 ;
+}
+
+std::size_t
+rtaudio::push_readable () const
+{
+    return not_nullptr(rt_api_ptr()) ? rt_api_ptr()->push_readable() : 0 ;
+}
+
+unsigned long
+rtaudio::underruns () const
+{
+    return not_nullptr(rt_api_ptr()) ? rt_api_ptr()->underruns() : 0 ;
+}
+
+unsigned long
+rtaudio::overruns () const
+{
+    return not_nullptr(rt_api_ptr()) ? rt_api_ptr()->overruns() : 0 ;
+}
+
+transport::clock::frameclock *
+rtaudio::frame_clock ()
+{
+    return not_nullptr(rt_api_ptr()) ? &rt_api_ptr()->frame_clock() : nullptr ;
+}
+
 rtaudio::api
 rtaudio::get_current_api () noexcept
 {
@@ -24,7 +24,7 @@
  * \library       rtl66
  * \author        Gary P. Scavone; severe refactoring by Chris Ahlstrom
  * \date          2022-06-07
- * \updates       2024-05-14
+ * \updates       2026-10-18
  * \license       See above.
  *
  * To do:
@@ -47,7 +47,9 @@
 #include "midi/event.hpp"               /* midi::event class                */
 #include "midi/eventcodes.hpp"          /* midi::is_sysex_end()             */
 #include "midi/ports.hpp"               /* midi::ports                      */
+#include "rtl/midi/find_midi_api.hpp"   /* rtl::adopt_client_handle()       */
 #include "rtl/midi/alsa/midi_alsa_data.hpp"  /* rtl::rtmidi::midi_alsa_data */
+#include "rtl/midi/alsa/midi_alsa_input.hpp" /* rtl::midi_alsa_input       */
 
 namespace rtl
 {
@@ -91,6 +93,44 @@ detect_alsa (bool checkports)
     return result;
 }
 
+static void
+close_alsa_client (void * handle)
+{
+    (void) ::snd_seq_close(reinterpret_cast<snd_seq_t *>(handle));
+}
+
+/**
+ *  The cheap ALSA probe: opens the sequencer device, without looking at
+ *  ports.  The client is not closed, but parked (see find_midi_api.cpp) for
+ *  the engine or port opened next, which renames it.
+ */
+
+bool
+probe_alsa (const std::string & clientname)
+{
+    snd_seq_t * alsaman;
+    int rc = ::snd_seq_open
+    (
+        &alsaman, "default", SND_SEQ_OPEN_DUPLEX, SND_SEQ_NONBLOCK
+    );
+    bool result = rc == 0;
+    if (result)
+    {
+        if (! clientname.empty())
+            (void) ::snd_seq_set_client_name(alsaman, clientname.c_str());
+
+        park_client_handle
+        (
+            rtmidi::api::alsa, alsaman, clientname, close_alsa_client
+        );
+    }
+    else
+    {
+        errprint("ALSA not detected");
+    }
+    return result;
+}
+
 /**
  * Since this is build info, we do not use the run-time version of ALSA
  * that can be obtained from snd_asoundlib_version().
@@ -119,353 +159,6 @@ set_alsa_version ()
 
 #endif
 
-/**
- *  The ALSA Sequencer API is based on the use of a callback function for MIDI
- *  input.  API information found at
- *
- *      http://www.alsa-project.org/documentation.php#Library
- *
- *  Thanks to Pedro Lopez-Cabanillas for help with the ALSA sequencer time stamps
- *  and other assorted fixes!!!
- *
- *  If you don't need timestamping for incoming MIDI events, define the
- *  preprocessor definition RTL66_ALSA_AVOID_TIMESTAMPING to save resources
- *  associated with the ALSA sequencer queues.
- *
- *  For example, Seq66 seems to need this macro to be defined.
- *
- *      #define RTL66_ALSA_AVOID_TIMESTAMPING
- *
- *  If you want to include the "announce" port, as done ins Seq66, define this
- *  macro:
- *
- *      #define RTL66_ALSA_ANNOUNCE_PORT
- *
- *  Note that there are two known ALSA ports (clients):
- *
- *      -   SND_SEQ_PORT_SYSTEM_TIMER       = 0
- *      -   SND_SEQ_PORT_SYSTEM_ANNOUNCE    = 1
- *
- *  Not used:
- *
- *      #define PORT_TYPE (pinfo, bits ) \
- *              ((snd_seq_port_info_get_capability(pinfo) & (bits)) == (bits))
- */
-
-/*------------------------------------------------------------------------
- * Time calculation
- *------------------------------------------------------------------------*/
-
-static int
-calculate_time
-(
-    snd_seq_real_time_t x,  /* the event time   */
-    snd_seq_real_time_t y   /* the last time    */
-)
-{
-    if (x.tv_nsec < y.tv_nsec)
-    {
-        int nsec = int(y.tv_nsec - x.tv_nsec) / 1000000000 + 1;
-        y.tv_nsec -= 1000000000 * nsec;
-        y.tv_sec += nsec;
-    }
-    if (x.tv_nsec - y.tv_nsec > 1000000000)
-    {
-        int nsec = int(x.tv_nsec - y.tv_nsec) / 1000000000;
-        y.tv_nsec += 1000000000 * nsec;
-        y.tv_sec -= nsec;
-    }
-    return int(x.tv_sec) - int(y.tv_sec) +
-        int(x.tv_nsec - y.tv_nsec) * 1E-9;
-}
-
-/*------------------------------------------------------------------------
- * ALSA callbacks
- *------------------------------------------------------------------------*/
-
-/**
- *  The ALSA sequencer has a maximum buffer size for MIDI sysex
- *  events of 256 bytes.  If a device sends sysex messages larger
- *  than this, they are segmented into 256 byte chunks.  So,
- *  we'll watch for this and concatenate sysex chunks into a
- *  single sysex message if necessary.
- *
- * Calculating the time-stamp:
- *
- * Method 1: Use the system time.
- *
- *      (void) gettimeofday(&tv, (struct timezone *) NULL);
- *      time = (tv.tv_sec * 1000000) + tv.tv_usec;
- *
- * Method 2: Use the ALSA sequencer event time data. Thanks to Pedro
- *           Lopez-Cabanillas!.
- *
- * Using method from:
- *
- *      https://www.gnu.org/software/libc/manual/html_node/Elapsed-Time.html
- *
- *      Perform the carry for the later subtraction by updating y.
- *      Temp var y is timespec because computation requires signed types,
- *      while snd_seq_real_time_t has unsigned types.
- *
- * API data:
- *
- *      -#  Every API has an rtmidi_in_data structure [accessor: input_data()].
- *          -#  It's address is passed as an argument to pthread_create().
- *          -#  It has a void pointer to an API-specific data structure
- *              [midi_<APINAME>_data, accessor: api_data()].
- *      -#  The API-specific pointer can then be obtained by using a call to
- *          the API's data_cast() function.
- *
- * Riddles to solve:
- *
- *      -   Handling of 0xF9 MIDI Timing Tick.
- *      -   What's the status byte for MIDI Time Code? Is it the
- *          Quarter Frame (midi::status::quarter_frame) byte, 0xF1?
- *      -   Full Time Code: F0 7F 7F 01 01 hh mm ss ff F7
- *
- *  See https://en.wikipedia.org/wiki/MIDI_timecode
- */
-
-void *
-midi_alsa_handler (void * ptr)
-{
-    rtmidi_in_data * rtidata = midi_api::static_in_data_cast(ptr);
-    midi_alsa_data * apidata = midi_alsa::static_data_cast(rtidata->api_data());
-    double time;
-    bool moresysex = false;
-    bool dodecode = false;
-    midi::message message;
-    int poll_fd_count;
-    struct pollfd * poll_fds;
-    snd_seq_event_t * ev;
-
-    /*
-     * Why 0? That's the buffer size.  RtMidi does this, too.
-     */
-
-    int rc = ::snd_midi_event_new(0, apidata->event_address());
-    if (rc < 0)
-    {
-        rtidata->do_input(false);
-        error_print ("midi_alsa_handler", "error init'ing MIDI event parser");
-        return nullptr;
-    }
-
-    midi::byte * buffer = new (std::nothrow) midi::byte[apidata->buffer_size()];
-    if (is_nullptr(buffer))
-    {
-        rtidata->do_input(false);
-        snd_midi_event_free(apidata->event_parser());   /* null check?  */
-        apidata->event_parser(nullptr);
-        error_print("midi_alsa_handler", "error init'ing buffer");
-        return nullptr;
-    }
-    snd_midi_event_init(apidata->event_parser());       /* null check?  */
-
-    /*
-     * Suppress running status messages.
-     */
-
-    snd_midi_event_no_status(apidata->event_parser(), 1);
-    poll_fd_count = 1 + ::snd_seq_poll_descriptors_count
-    (
-        apidata->alsa_client(), POLLIN
-    );
-    poll_fds = (struct pollfd *) alloca(poll_fd_count * sizeof(struct pollfd));
-    ::snd_seq_poll_descriptors
-    (
-        apidata->alsa_client(), poll_fds + 1, poll_fd_count - 1, POLLIN
-    );
-    poll_fds[0].fd = apidata->trigger_fd(0);
-    poll_fds[0].events = POLLIN;
-    while (rtidata->do_input())
-    {
-        if (::snd_seq_event_input_pending(apidata->alsa_client(), 1) == 0)
-        {
-            // no data pending
-
-            if (poll(poll_fds, poll_fd_count, -1) >= 0)
-            {
-                if (poll_fds[0].revents & POLLIN)
-                {
-                    bool dummy;
-                    int rc = read(poll_fds[0].fd, &dummy, sizeof(dummy));
-                    if (rc == (-1))
-                        break;
-                }
-            }
-            continue;
-        }
-
-        // If here, there should be data.
-
-        int rc = ::snd_seq_event_input(apidata->alsa_client(), &ev);
-        if (rc == -ENOSPC)
-        {
-            error_print("midi_alsa::midi_alsa_handler", "MIDI input overrun");
-            continue;
-        }
-        else if (rc <= 0)
-        {
-            error_print("midi_alsa::midi_alsa_handler", "unknown input error");
-            perror("System reports");
-            continue;
-        }
-
-        /*
-         * This is a bit weird, but we now have to decode an ALSA MIDI
-         * event (back) into MIDI bytes.  We'll ignore non-MIDI types.
-         */
-
-        if (! moresysex)
-            message.clear();
-
-        dodecode = false;
-        switch (ev->type )
-        {
-        case SND_SEQ_EVENT_PORT_SUBSCRIBED:
-#if defined PLATFORM_DEBUG
-            debug_print("midi_alsa::midi_alsa_handler", "port subscribed");
-#endif
-            break;
-
-        case SND_SEQ_EVENT_PORT_UNSUBSCRIBED:
-#if defined PLATFORM_DEBUG
-            debug_print("midi_alsa::midi_alsa_handler", "port unsubscribed");
-            std::cout
-                << "sender = " << (int) ev->data.connect.sender.client << ":"
-                << (int) ev->data.connect.sender.port
-                << ", dest = " << (int) ev->data.connect.dest.client << ":"
-                << (int) ev->data.connect.dest.port
-                << std::endl
-                ;
-#endif
-            break;
-
-        case SND_SEQ_EVENT_QFRAME:                  // MIDI time code
-            if (rtidata->allow_time_code())
-                dodecode = true;
-            break;
-
-        case SND_SEQ_EVENT_TICK:                    // 0xF9 MIDI timing tick
-            if (rtidata->allow_time_code())
-                dodecode = true;
-            break;
-
-        case SND_SEQ_EVENT_CLOCK:                   // 0xF8 MIDI clock tick
-            if (rtidata->allow_time_code())
-                dodecode = true;
-            break;
-
-        case SND_SEQ_EVENT_SENSING:                 // 0xFE Active sensing
-            if (rtidata->allow_active_sensing())
-                dodecode = true;
-            break;
-
-        case SND_SEQ_EVENT_SYSEX:                   // 0xF0 System Exclusive
-            if (rtidata->allow_sysex())
-                break;
-
-            if (ev->data.ext.len > apidata->buffer_size())
-            {
-                apidata->buffer_size(ev->data.ext.len);
-                delete [] buffer;
-                buffer = new (std::nothrow) midi::byte[apidata->buffer_size()];
-                if (is_nullptr(buffer))
-                {
-                    rtidata->do_input(false);
-                    error_print
-                    (
-                        "midi_alsa_in::midi_alsa_handler",
-                        "error resizing buffer"
-                    );
-                    break;
-                }
-            }
-            dodecode = true;
-            break;
-
-        default:
-            dodecode = true;
-        }
-        if (dodecode)
-        {
-            long nbytes = snd_midi_event_decode
-            (
-                apidata->event_parser(), buffer, apidata->buffer_size(), ev
-            );
-            if (nbytes > 0)                 // see banner
-            {
-                if (! moresysex)
-                {
-                    message.assign(buffer, &buffer[nbytes]);
-                }
-                else
-                {
-                    message.append(buffer, &buffer[nbytes]);
-                }
-                moresysex = (ev->type == SND_SEQ_EVENT_SYSEX) &&
-                    ! midi::is_sysex_end_msg(message.back());     // 0xF7
-
-                if (! moresysex)
-                {
-                    /*
-                     * Calculate the time stamp.  See the banner.
-                     * Then compute the time difference.
-                     */
-
-                    time = calculate_time(ev->time.time, apidata->last_time());
-                    apidata->last_time(ev->time.time);
-                    if (rtidata->first_message())
-                    {
-                        rtidata->first_message(false);
-                        message.jack_stamp(0.0);
-                    }
-                    else
-                        message.jack_stamp(time);
-                }
-                else
-                {
-#if defined PLATFORM_DEBUG
-                    error_print
-                    (
-                        "midi_alsa_in::midi_alsa_handler",
-                        "parsing error/non-MIDI-event"
-                    );
-#endif
-                }
-            }
-        }
-        ::snd_seq_free_event(ev);
-        if (message.empty() || moresysex)
-            continue;
-
-        if (rtidata->using_callback())
-        {
-            rtmidi_in_data::callback_t cb = rtidata->user_callback();
-            cb(message.jack_stamp(), &message, rtidata->user_data());
-        }
-        else
-        {
-            /*
-             * As long as we haven't reached our queue size limit, push the
-             * message.
-             */
-
-            if (! rtidata->queue().push(message))
-                error_print("midi_alsa_in", "message queue limit reached");
-        }
-    }
-    if (not_nullptr(buffer))
-        delete [] buffer;
-
-    snd_midi_event_free(apidata->event_parser());
-    apidata->event_parser(nullptr);
-    apidata->thread_handle(apidata->dummy_thread_id());
-    return 0;
-}
-
 /*------------------------------------------------------------------------
  * get_port_info() and related functions
  *------------------------------------------------------------------------*/
@@ -763,16 +456,26 @@ midi_alsa::~midi_alsa ()
  *      the snd_seq_t client handle in the midi_alsa_data structure held
  *      by this class instance.
  *  -   The desired client name is retrieved and set.
+ *
+ *  If probe_alsa() left a client open (always duplex), it is adopted and
+ *  renamed instead of opening another.
  */
 
 void *
 midi_alsa::engine_connect ()
 {
     void * result = nullptr;
-    snd_seq_t * seq;
-    int streams = is_output() ? SND_SEQ_OPEN_OUTPUT : SND_SEQ_OPEN_DUPLEX;
-    int mode = SND_SEQ_NONBLOCK;
-    int rc = ::snd_seq_open(&seq, "default", streams, mode);
+    snd_seq_t * seq = reinterpret_cast<snd_seq_t *>
+    (
+        adopt_client_handle(rtmidi::api::alsa)
+    );
+    int rc = 0;
+    if (is_nullptr(seq))
+    {
+        int streams = is_output() ? SND_SEQ_OPEN_OUTPUT : SND_SEQ_OPEN_DUPLEX;
+        int mode = SND_SEQ_NONBLOCK;
+        rc = ::snd_seq_open(&seq, "default", streams, mode);
+    }
     if (rc == 0)
     {
         bool ok = set_seq_client_name(seq, client_name());
@@ -1413,21 +1116,23 @@ midi_alsa::start_input_thread (rtmidi_in_data & indata)
     if (is_input())
     {
         midi_alsa_data & data = alsa_data();
-        pthread_attr_t attr;
-        pthread_attr_init(&attr);
-        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-        pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
 
-        int err = pthread_create
+        midi::portwatch * watch = have_master_bus() ?
+            &master_bus()->port_watch() : nullptr ;
+
+        result = midi_alsa_input::instance().add
         (
-            data.thread_address(), &attr, midi_alsa_handler, &indata
+            data.alsa_client(), data.vport(), &indata, &data, watch
         );
-        pthread_attr_destroy(&attr);
-        result = err == 0;
     }
     return result;
 }
 
+/**
+ *  With the shared input service, this unregisters the port; when it
+ *  returns, no delivery to the port is in progress.
+ */
+
 bool
 midi_alsa::join_input_thread ()
 {
@@ -1435,8 +1140,11 @@ midi_alsa::join_input_thread ()
     if (is_input())
     {
         midi_alsa_data & data = alsa_data();
-        if (! pthread_equal(data.thread_handle(), data.dummy_thread_id()))
-            pthread_join(data.thread_handle(), NULL);
+
+        (void) midi_alsa_input::instance().remove
+        (
+            data.alsa_client(), data.vport()
+        );
     }
     return result;
 }
@@ -1721,104 +1429,146 @@ midi_alsa::send_message (const midi::byte * message, size_t sz)
 int
 midi_alsa::get_io_port_info (midi::ports & ioports, bool preclear)
 {
-    int result = 0;
-    midi_alsa_data & data = alsa_data();
-    snd_seq_t * seq = data.alsa_client();
     if (preclear)
         ioports.clear();
 
-    if (not_nullptr(seq))
+    int result = is_output() ?
+        enumerate_ports(nullptr, &ioports) :
+        enumerate_ports(&ioports, nullptr) ;
+
+    if (result == 0)
+        result = (-1);
+
+    return result;
+}
+
+/**
+ *  Gets both port lists in one walk of the ALSA clients, rather than one
+ *  walk (and one client) for each direction.  The lists are not cleared.
+ *
+ * \return
+ *      Returns the total number of ports found, which can be 0, or -1 if
+ *      there is no ALSA client.
+ */
+
+int
+midi_alsa::get_all_io_port_info (midi::ports & inports, midi::ports & outports)
+{
+    return enumerate_ports(&inports, &outports);
+}
+
+/**
+ *  Walks the ALSA clients and their ports, adding each MIDI port to the
+ *  list (or lists) whose capabilities it has.  Ports with output (write)
+ *  capabilities go to outports, those with input (read) capabilities go to
+ *  inports.  Either list can be null to skip that direction.
+ */
+
+int
+midi_alsa::enumerate_ports (midi::ports * inports, midi::ports * outports)
+{
+    int result = 0;
+    midi_alsa_data & data = alsa_data();
+    snd_seq_t * seq = data.alsa_client();
+    if (is_nullptr(seq))
+        return (-1);
+
+    snd_seq_port_info_t * pinfo;
+    snd_seq_client_info_t * cinfo;
+    snd_seq_client_info_alloca(&cinfo);
+    snd_seq_client_info_set_client(cinfo, -1);
+    while (snd_seq_query_next_client(seq, cinfo) >= 0)
     {
-        bool iswriteable = is_output();
-        snd_seq_port_info_t * pinfo;
-        snd_seq_client_info_t * cinfo;
-        snd_seq_client_info_alloca(&cinfo);
-        snd_seq_client_info_set_client(cinfo, -1);
-        while (snd_seq_query_next_client(seq, cinfo) >= 0)
+        int client = snd_seq_client_info_get_client(cinfo);
+        if (client == SND_SEQ_CLIENT_SYSTEM)        /* i.e. 0 in alsa/seq.h */
         {
-            int client = snd_seq_client_info_get_client(cinfo);
-            if (client == SND_SEQ_CLIENT_SYSTEM)    /* i.e. 0 in alsa/seq.h */
-            {
 #if defined RTL66_ALSA_ANNOUNCE_PORT        /* unrecommended (Seq66 issues) */
-                /*
-                 * Client 0 won't have ports (timer and announce) that match
-                 * the MIDI-generic and Synth types checked below. So we
-                 * add it anyway.  But this feature is deprecated and
-                 * undesirable.  Same for the timer port.
-                 */
+            /*
+             * Client 0 won't have ports (timer and announce) that match
+             * the MIDI-generic and Synth types checked below. So we
+             * add it anyway.  But this feature is deprecated and
+             * undesirable.  Same for the timer port.
+             */
 
-                if (! iswriteable)
-                {
-                    ioports.add
-                    (
-                        SND_SEQ_CLIENT_SYSTEM, "system",
-                        SND_SEQ_PORT_SYSTEM_ANNOUNCE, "announce",
-                        midi::port::io::input, midi::port::kind::system,
-                        0   // TEMPORARY global_queue()
-                    );
-                    ++result;
-                }
+            if (not_nullptr(inports))
+            {
+                inports->add
+                (
+                    SND_SEQ_CLIENT_SYSTEM, "system",
+                    SND_SEQ_PORT_SYSTEM_ANNOUNCE, "announce",
+                    midi::port::io::input, midi::port::kind::system,
+                    0   // TEMPORARY global_queue()
+                );
+                ++result;
+            }
 #else
-                continue;
+            continue;
 #endif
-            }
-            snd_seq_port_info_alloca(&pinfo);
-            snd_seq_port_info_set_client(pinfo, client); /* reset query info */
-            snd_seq_port_info_set_port(pinfo, -1);
-            while (::snd_seq_query_next_port(seq, pinfo) >= 0)
-            {
-                unsigned ptype = snd_seq_port_info_get_type(pinfo);
-                if (not_a_midi_client(ptype))   // check_port_type(pinfo))
-                    continue;
+        }
+        snd_seq_port_info_alloca(&pinfo);
+        snd_seq_port_info_set_client(pinfo, client);    /* reset query info */
+        snd_seq_port_info_set_port(pinfo, -1);
+        while (::snd_seq_query_next_port(seq, pinfo) >= 0)
+        {
+            unsigned ptype = snd_seq_port_info_get_type(pinfo);
+            if (not_a_midi_client(ptype))   // check_port_type(pinfo))
+                continue;
 
-                std::string clientname = snd_seq_client_info_get_name(cinfo);
-                std::string portname = snd_seq_port_info_get_name(pinfo);
-                int portnumber = snd_seq_port_info_get_port(pinfo);
-                unsigned caps = snd_seq_port_info_get_capability(pinfo);
+            std::string clientname = snd_seq_client_info_get_name(cinfo);
+            std::string portname = snd_seq_port_info_get_name(pinfo);
+            int portnumber = snd_seq_port_info_get_port(pinfo);
+            unsigned caps = snd_seq_port_info_get_capability(pinfo);
 
-                /*
-                 * Added recently to the original RtMidi library.
-                 * Not sure that we need it here, though.
-                 */
+            /*
+             * Added recently to the original RtMidi library.
+             * Not sure that we need it here, though.
+             */
 
-                if (no_routing_allowed(caps))
-                    continue;
+            if (no_routing_allowed(caps))
+                continue;
+
+            bool can_add_in = not_nullptr(inports) &&
+                (caps & sm_input_caps) == sm_input_caps;
 
-                bool can_add = iswriteable ?
-                    (caps & sm_output_caps) == sm_output_caps :
-                    (caps & sm_input_caps) == sm_input_caps ;
+            bool can_add_out = not_nullptr(outports) &&
+                (caps & sm_output_caps) == sm_output_caps;
 
 #if defined PLATFORM_DEBUG_TMI
-                std::string s = alsa_port_capabilities(caps);
-                s += "- ";
-                s += clientname;
-                infoprint(s.c_str());
+            std::string s = alsa_port_capabilities(caps);
+            s += "- ";
+            s += clientname;
+            infoprint(s.c_str());
 #endif
 
-                if (can_add)
-                {
-                    ioports.add
-                    (
-                        client, clientname, portnumber, portname,
-                        midi::port::io::input, midi::port::kind::normal
-                    );
-                    ++result;
-                }
-                else
-                {
-                    /*
-                     * When VMPK is running, we get this message for a
-                     * client-name of 'VMPK Output'.
-                     */
+            if (can_add_in)
+            {
+                inports->add
+                (
+                    client, clientname, portnumber, portname,
+                    midi::port::io::input, midi::port::kind::normal
+                );
+                ++result;
+            }
+            if (can_add_out)
+            {
+                outports->add
+                (
+                    client, clientname, portnumber, portname,
+                    midi::port::io::input, midi::port::kind::normal
+                );
+                ++result;
+            }
+            if (! can_add_in && ! can_add_out)
+            {
+                /*
+                 * When VMPK is running, we get this message for a
+                 * client-name of 'VMPK Output'.
+                 */
 
-                    printf("Ignoring ALSA port '%s'\n", clientname.c_str());
-                }
+                printf("Ignoring ALSA port '%s'\n", clientname.c_str());
             }
         }
     }
-    if (result == 0)
-        result = (-1);
-
     return result;
 }
 
@@ -2124,27 +1874,29 @@ midi_alsa::get_midi_event (midi::event * inev)
     case SND_SEQ_EVENT_PORT_START:
     {
         /*
-         * Figure out how to best do this.  It has way too many parameters
-         * now, and is currently meant to be called from mastermidibus.
-         * See mastermidibase::port_start().
-         *
-         * port_start(masterbus, ev->data.addr.client, ev->data.addr.port);
-         * api_port_start (mastermidibus & masterbus, int bus, int port)
+         * With a master bus, the input service posts these events to its
+         * port watch; see midi_alsa_input::announce().  This polled path
+         * passes on only the numbers.
          */
 
-        // result = show_event(ev, "Port start");
+        if (have_master_bus())
+        {
+            (void) master_bus()->port_start
+            (
+                ev->data.addr.client, ev->data.addr.port
+            );
+        }
         break;
     }
     case SND_SEQ_EVENT_PORT_EXIT:
     {
-        /*
-         * The port_exit() function is defined in mastermidibase and in
-         * businfo.  They seem to cover this functionality.
-         *
-         * port_exit(masterbus, ev->data.addr.client, ev->data.addr.port);
-         */
-
-        // result = show_event(ev, "Port exit");
+        if (have_master_bus())
+        {
+            (void) master_bus()->port_exit
+            (
+                ev->data.addr.client, ev->data.addr.port
+            );
+        }
         break;
     }
     case SND_SEQ_EVENT_PORT_CHANGE:
@@ -0,0 +1,774 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          midi_alsa_input.cpp
+ *
+ *    A single input thread serving all ALSA input ports.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ */
+
+#include "rtl/midi/alsa/midi_alsa_input.hpp"  /* rtl::midi_alsa_input      */
+
+#if defined RTL66_BUILD_ALSA
+
+#include <cerrno>                       /* errno, ENOSPC, EINTR             */
+#include <poll.h>                       /* ::poll(), struct pollfd          */
+#include <unistd.h>                     /* ::pipe(), ::read(), ::write()    */
+
+#include "c_macros.h"                   /* not_nullptr() and friends        */
+#include "midi/eventcodes.hpp"          /* midi::is_sysex_end_msg()         */
+#include "rtl/api_base.hpp"             /* rtl::error_print()               */
+#include "rtl/midi/rtmidi_in_data.hpp"  /* rtl::rtmidi_in_data             */
+#include "rtl/midi/alsa/midi_alsa_data.hpp"  /* rtl::midi_alsa_data         */
+
+namespace rtl
+{
+
+int midi_alsa_input::sm_rt_priority = 0;
+
+/**
+ *  The seconds between two ALSA real-time stamps.
+ */
+
+static double
+delta_seconds (snd_seq_real_time_t now, snd_seq_real_time_t last)
+{
+    return double(long(now.tv_sec) - long(last.tv_sec)) +
+        double(long(now.tv_nsec) - long(last.tv_nsec)) * 1E-9;
+}
+
+midi_alsa_input &
+midi_alsa_input::instance ()
+{
+    static midi_alsa_input s_service;
+    return s_service;
+}
+
+midi_alsa_input::midi_alsa_input () :
+    m_listeners     (),
+    m_mutex         (),
+    m_busy_client   (nullptr),
+    m_busy_port     (-1),
+    m_delivery      (),
+    m_idle          (),
+    m_poll_fds      (),
+    m_poll_clients  (),
+    m_rebuild       (true),
+    m_trigger_fds   { -1, -1 },
+    m_parser        (nullptr),
+    m_buffer        (256),
+    m_thread        (),
+    m_joinable      (false),
+    m_running       (false),
+    m_overruns      (0)
+{
+    if (::pipe(m_trigger_fds) != 0)
+        error_print("midi_alsa_input", "pipe() failed");
+
+    if (::snd_midi_event_new(0, &m_parser) == 0)
+        ::snd_midi_event_no_status(m_parser, 1);    /* no running status    */
+    else
+        m_parser = nullptr;
+}
+
+midi_alsa_input::~midi_alsa_input ()
+{
+    stop();
+    if (not_nullptr(m_parser))
+        ::snd_midi_event_free(m_parser);
+
+    if (m_trigger_fds[0] >= 0)
+    {
+        ::close(m_trigger_fds[0]);
+        ::close(m_trigger_fds[1]);
+    }
+}
+
+/**
+ *  Registers an input port.  The thread is started with the first port.
+ *
+ * \param client
+ *      The ALSA client that owns the port.  Must be opened non-blocking.
+ *
+ * \param port
+ *      The local port number, as seen in ev->dest.port.
+ *
+ * \param indata
+ *      The rtmidi input data that receives the messages, via its callback
+ *      or its queue.
+ *
+ * \param apidata
+ *      The ALSA data of the port, which holds the last event time.
+ *
+ * \param watch
+ *      If not null, the port is subscribed to the ALSA announce port, and
+ *      the port changes it announces are posted here.
+ *
+ * \return
+ *      Returns true if the port was added and the thread is running.
+ */
+
+bool
+midi_alsa_input::add
+(
+    snd_seq_t * client, int port,
+    rtmidi_in_data * indata, midi_alsa_data * apidata,
+    midi::portwatch * watch
+)
+{
+    bool result = not_nullptr_2(client, indata) && port >= 0;
+    if (result)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (is_nullptr(find(client, port)))
+            {
+                listener lr;
+                lr.l_client = client;
+                lr.l_port = port;
+                lr.l_in_data = indata;
+                lr.l_api_data = apidata;
+                lr.l_port_watch = watch;
+                lr.l_more_sysex = false;
+                lr.l_received = 0;
+                m_listeners.push_back(lr);
+                m_rebuild = true;
+                if (not_nullptr(watch))
+                {
+                    int rc = ::snd_seq_connect_from
+                    (
+                        client, port, SND_SEQ_CLIENT_SYSTEM,
+                        SND_SEQ_PORT_SYSTEM_ANNOUNCE
+                    );
+                    if (rc < 0)
+                        error_print("midi_alsa_input", "no announce port");
+                }
+            }
+        }
+        result = m_running ? true : start() ;
+        wake();
+    }
+    return result;
+}
+
+/**
+ *  Unregisters a port.  On return, no delivery to it is in progress, unless
+ *  it is called from that port's own callback.  The thread stops when the
+ *  last port is removed.
+ */
+
+bool
+midi_alsa_input::remove (snd_seq_t * client, int port)
+{
+    bool result = false;
+    bool empty = false;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (auto li = m_listeners.begin(); li != m_listeners.end(); ++li)
+        {
+            if (li->l_client == client && li->l_port == port)
+            {
+                if (not_nullptr(li->l_port_watch))
+                {
+                    (void) ::snd_seq_disconnect_from
+                    (
+                        client, port, SND_SEQ_CLIENT_SYSTEM,
+                        SND_SEQ_PORT_SYSTEM_ANNOUNCE
+                    );
+                }
+                m_listeners.erase(li);
+                m_rebuild = result = true;
+                break;
+            }
+        }
+        empty = m_listeners.empty();
+        if (result && ! in_service_thread())
+        {
+            m_idle.wait
+            (
+                lock, [&] ()
+                {
+                    return m_busy_client != client || m_busy_port != port;
+                }
+            );
+        }
+    }
+    if (empty)
+        stop();
+    else if (result)
+        wake();
+
+    return result;
+}
+
+int
+midi_alsa_input::port_count ()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return int(m_listeners.size());
+}
+
+/**
+ *  The number of messages delivered to a port, for testing.
+ */
+
+unsigned long
+midi_alsa_input::received (snd_seq_t * client, int port)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    listener * lr = find(client, port);
+    return not_nullptr(lr) ? lr->l_received : 0 ;
+}
+
+midi_alsa_input::listener *
+midi_alsa_input::find (snd_seq_t * client, int port)
+{
+    for (auto & lr : m_listeners)
+    {
+        if (lr.l_client == client && lr.l_port == port)
+            return &lr;
+    }
+    return nullptr;
+}
+
+/**
+ *  True if the caller is the service thread, that is, a port callback.
+ */
+
+bool
+midi_alsa_input::in_service_thread () const
+{
+    return m_joinable && pthread_equal(m_thread, pthread_self());
+}
+
+/**
+ *  Starts the thread, with SCHED_FIFO if rt_priority() was set, falling
+ *  back to SCHED_OTHER if that is not permitted.  A thread that was stopped
+ *  from its own callback is joined first, or, if this is that callback, it
+ *  simply keeps running.
+ */
+
+bool
+midi_alsa_input::start ()
+{
+    bool result = ! m_running;
+    if (result && m_joinable)
+    {
+        if (in_service_thread())
+            m_running = true;                   /* still inside service()   */
+        else
+        {
+            pthread_join(m_thread, NULL);
+            m_joinable = false;
+        }
+    }
+    if (result && ! m_running)
+    {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+        m_running = true;
+
+        int err = -1;
+        if (sm_rt_priority > 0)
+        {
+            struct sched_param param;
+            param.sched_priority = sm_rt_priority;
+            pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+            pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+            pthread_attr_setschedparam(&attr, &param);
+            err = pthread_create(&m_thread, &attr, service_thread, this);
+            if (err != 0)
+            {
+                pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+                pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+            }
+        }
+        if (err != 0)
+            err = pthread_create(&m_thread, &attr, service_thread, this);
+
+        pthread_attr_destroy(&attr);
+        result = err == 0;
+        m_joinable = result;
+        if (! result)
+        {
+            m_running = false;
+            error_print("midi_alsa_input", "cannot start input thread");
+        }
+    }
+    return result;
+}
+
+/**
+ *  Stops the thread.  Called from a callback, it cannot join itself, so
+ *  the join is left to the next start() or stop().
+ */
+
+void
+midi_alsa_input::stop ()
+{
+    if (m_running)
+    {
+        m_running = false;
+        wake();
+    }
+    if (m_joinable && ! in_service_thread())
+    {
+        pthread_join(m_thread, NULL);
+        m_joinable = false;
+    }
+}
+
+void
+midi_alsa_input::wake ()
+{
+    if (m_trigger_fds[1] >= 0)
+    {
+        bool flag = true;
+        if (::write(m_trigger_fds[1], &flag, sizeof flag) < 0)
+            error_print("midi_alsa_input", "trigger write failed");
+    }
+}
+
+/**
+ *  Rebuilds the poll set, once per distinct client.  Called with the mutex
+ *  held.
+ */
+
+void
+midi_alsa_input::rebuild ()
+{
+    m_poll_fds.clear();
+    m_poll_clients.clear();
+
+    struct pollfd trigger;
+    trigger.fd = m_trigger_fds[0];
+    trigger.events = POLLIN;
+    trigger.revents = 0;
+    m_poll_fds.push_back(trigger);
+    m_poll_clients.push_back(nullptr);
+
+    std::vector<snd_seq_t *> clients;
+    for (const auto & lr : m_listeners)
+    {
+        bool found = false;
+        for (auto c : clients)
+        {
+            if (c == lr.l_client)
+            {
+                found = true;
+                break;
+            }
+        }
+        if (found)
+            continue;
+
+        clients.push_back(lr.l_client);
+
+        int count = ::snd_seq_poll_descriptors_count(lr.l_client, POLLIN);
+        if (count > 0)
+        {
+            std::size_t first = m_poll_fds.size();
+            m_poll_fds.resize(first + std::size_t(count));
+            (void) ::snd_seq_poll_descriptors
+            (
+                lr.l_client, &m_poll_fds[first], unsigned(count), POLLIN
+            );
+            m_poll_clients.resize(m_poll_fds.size(), lr.l_client);
+        }
+    }
+    m_rebuild = false;
+}
+
+/**
+ *  Turns a sequencer event into MIDI bytes.  Channel and system messages
+ *  are built directly; (N)RPN and 14-bit controllers, which expand to
+ *  several messages, go through the ALSA decoder.
+ *
+ * \return
+ *      Returns false for events that carry no MIDI bytes.
+ */
+
+bool
+midi_alsa_input::decode (const snd_seq_event_t * ev, midi::message & msg)
+{
+    const snd_seq_ev_note_t & note = ev->data.note;
+    const snd_seq_ev_ctrl_t & ctrl = ev->data.control;
+    bool result = true;
+    switch (ev->type)
+    {
+    case SND_SEQ_EVENT_NOTEON:
+        msg.push(midi::byte(0x90 | (note.channel & 0x0F)));
+        msg.push(midi::byte(note.note & 0x7F));
+        msg.push(midi::byte(note.velocity & 0x7F));
+        break;
+
+    case SND_SEQ_EVENT_NOTEOFF:
+        msg.push(midi::byte(0x80 | (note.channel & 0x0F)));
+        msg.push(midi::byte(note.note & 0x7F));
+        msg.push(midi::byte(note.velocity & 0x7F));
+        break;
+
+    case SND_SEQ_EVENT_KEYPRESS:
+        msg.push(midi::byte(0xA0 | (note.channel & 0x0F)));
+        msg.push(midi::byte(note.note & 0x7F));
+        msg.push(midi::byte(note.velocity & 0x7F));
+        break;
+
+    case SND_SEQ_EVENT_CONTROLLER:
+        msg.push(midi::byte(0xB0 | (ctrl.channel & 0x0F)));
+        msg.push(midi::byte(ctrl.param & 0x7F));
+        msg.push(midi::byte(ctrl.value & 0x7F));
+        break;
+
+    case SND_SEQ_EVENT_PGMCHANGE:
+        msg.push(midi::byte(0xC0 | (ctrl.channel & 0x0F)));
+        msg.push(midi::byte(ctrl.value & 0x7F));
+        break;
+
+    case SND_SEQ_EVENT_CHANPRESS:
+        msg.push(midi::byte(0xD0 | (ctrl.channel & 0x0F)));
+        msg.push(midi::byte(ctrl.value & 0x7F));
+        break;
+
+    case SND_SEQ_EVENT_PITCHBEND:
+    {
+        int bend = ctrl.value + 8192;
+        msg.push(midi::byte(0xE0 | (ctrl.channel & 0x0F)));
+        msg.push(midi::byte(bend & 0x7F));
+        msg.push(midi::byte((bend >> 7) & 0x7F));
+        break;
+    }
+
+    case SND_SEQ_EVENT_SONGPOS:
+        msg.push(midi::byte(0xF2));
+        msg.push(midi::byte(ctrl.value & 0x7F));
+        msg.push(midi::byte((ctrl.value >> 7) & 0x7F));
+        break;
+
+    case SND_SEQ_EVENT_SONGSEL:
+        msg.push(midi::byte(0xF3));
+        msg.push(midi::byte(ctrl.value & 0x7F));
+        break;
+
+    case SND_SEQ_EVENT_QFRAME:
+        msg.push(midi::byte(0xF1));
+        msg.push(midi::byte(ctrl.value & 0x7F));
+        break;
+
+    case SND_SEQ_EVENT_TUNE_REQUEST:    msg.push(midi::byte(0xF6)); break;
+    case SND_SEQ_EVENT_CLOCK:           msg.push(midi::byte(0xF8)); break;
+    case SND_SEQ_EVENT_TICK:            msg.push(midi::byte(0xF9)); break;
+    case SND_SEQ_EVENT_START:           msg.push(midi::byte(0xFA)); break;
+    case SND_SEQ_EVENT_CONTINUE:        msg.push(midi::byte(0xFB)); break;
+    case SND_SEQ_EVENT_STOP:            msg.push(midi::byte(0xFC)); break;
+    case SND_SEQ_EVENT_SENSING:         msg.push(midi::byte(0xFE)); break;
+    case SND_SEQ_EVENT_RESET:           msg.push(midi::byte(0xFF)); break;
+
+    case SND_SEQ_EVENT_SYSEX:
+    {
+        midi::byte * data = reinterpret_cast<midi::byte *>(ev->data.ext.ptr);
+        if (ev->data.ext.len > 0)
+            msg.append(data, data + ev->data.ext.len);
+        else
+            result = false;
+        break;
+    }
+
+    case SND_SEQ_EVENT_CONTROL14:
+    case SND_SEQ_EVENT_NONREGPARAM:
+    case SND_SEQ_EVENT_REGPARAM:
+    {
+        long n = is_nullptr(m_parser) ? 0 : ::snd_midi_event_decode
+        (
+            m_parser, m_buffer.data(), long(m_buffer.size()), ev
+        );
+        if (n > 0)
+            msg.append(m_buffer.data(), m_buffer.data() + n);
+        else
+            result = false;
+        break;
+    }
+
+    default:
+        result = false;
+        break;
+    }
+    return result;
+}
+
+/**
+ *  Posts a port start or exit from the announce port to the listener's port
+ *  watch.  For a new port, the "client:port" name is looked up now, since it
+ *  is what the port is known by when it comes back.  A port that has gone
+ *  can no longer be looked up, so only its numbers are posted.  Every port
+ *  with a watch gets the announcements; posting one twice does no harm.
+ */
+
+void
+midi_alsa_input::announce (listener & lr, const snd_seq_event_t * ev)
+{
+    if (is_nullptr(lr.l_port_watch))
+        return;
+
+    int client = int(ev->data.addr.client);
+    int port = int(ev->data.addr.port);
+    if (ev->type == SND_SEQ_EVENT_PORT_START)
+    {
+        std::string name;
+        snd_seq_client_info_t * cinfo;
+        snd_seq_port_info_t * pinfo;
+        snd_seq_client_info_alloca(&cinfo);
+        snd_seq_port_info_alloca(&pinfo);
+        if
+        (
+            ::snd_seq_get_any_client_info(lr.l_client, client, cinfo) >= 0 &&
+            ::snd_seq_get_any_port_info(lr.l_client, client, port, pinfo) >= 0
+        )
+        {
+            name = ::snd_seq_client_info_get_name(cinfo);
+            name += ":";
+            name += ::snd_seq_port_info_get_name(pinfo);
+        }
+        lr.l_port_watch->post
+        (
+            midi::portwatch::action::appeared, client, port, name
+        );
+    }
+    else if (ev->type == SND_SEQ_EVENT_PORT_EXIT)
+    {
+        lr.l_port_watch->post(midi::portwatch::action::vanished, client, port);
+    }
+}
+
+/**
+ *  Filters, decodes, and time-stamps one event for its port, leaving the
+ *  message in m_delivery.  SysEx arriving in several chunks is put back
+ *  together first.  An event that comes between the chunks, such as a
+ *  clock, is decoded straight into m_delivery and delivered on its own,
+ *  leaving the pending SysEx alone.  Called with the mutex held.
+ *
+ * \return
+ *      Returns true if there is a message to deliver.
+ */
+
+bool
+midi_alsa_input::prepare (listener & lr, const snd_seq_event_t * ev)
+{
+    rtmidi_in_data * rtidata = lr.l_in_data;
+    switch (ev->type)
+    {
+    case SND_SEQ_EVENT_QFRAME:
+    case SND_SEQ_EVENT_TICK:
+    case SND_SEQ_EVENT_CLOCK:
+        if (! rtidata->allow_time_code())
+            return false;
+        break;
+
+    case SND_SEQ_EVENT_SENSING:
+        if (! rtidata->allow_active_sensing())
+            return false;
+        break;
+
+    case SND_SEQ_EVENT_SYSEX:
+        if (! rtidata->allow_sysex())
+            return false;
+        break;
+
+    default:
+        break;
+    }
+
+    bool separate = lr.l_more_sysex && ev->type != SND_SEQ_EVENT_SYSEX;
+    midi::message & message = separate ? m_delivery : lr.l_message ;
+    if (separate || ! lr.l_more_sysex)
+        message.clear();
+
+    if (! decode(ev, message) || message.empty())
+        return false;
+
+    if (! separate)
+    {
+        lr.l_more_sysex = ev->type == SND_SEQ_EVENT_SYSEX &&
+            ! midi::is_sysex_end_msg(message.back());
+
+        if (lr.l_more_sysex)
+            return false;
+    }
+
+    if (not_nullptr(lr.l_api_data))
+    {
+        double time = delta_seconds(ev->time.time, lr.l_api_data->last_time());
+        lr.l_api_data->last_time(ev->time.time);
+        if (rtidata->first_message())
+        {
+            rtidata->first_message(false);
+            time = 0.0;
+        }
+        message.jack_stamp(time);
+    }
+    ++lr.l_received;
+    if (! separate)
+        m_delivery = message;                   /* reuses its capacity      */
+
+    return true;
+}
+
+/**
+ *  Hands m_delivery to the port's callback or queue.  Called without the
+ *  mutex, so the callback may add or remove ports.
+ */
+
+void
+midi_alsa_input::deliver (rtmidi_in_data * rtidata)
+{
+    if (rtidata->using_callback())
+    {
+        rtmidi_in_data::callback_t cb = rtidata->user_callback();
+        cb(m_delivery.jack_stamp(), &m_delivery, rtidata->user_data());
+    }
+    else if (! rtidata->queue().push(m_delivery))
+        error_print("midi_alsa_input", "message queue limit reached");
+}
+
+/**
+ *  Reads every pending event of a client.  Called with the mutex held; it
+ *  is released while each message is delivered, and the draining stops if
+ *  the port set changed meanwhile, since the client may be gone.  Events
+ *  for ports that are not (or no longer) registered are dropped.
+ */
+
+void
+midi_alsa_input::drain
+(
+    std::unique_lock<std::mutex> & lock, snd_seq_t * client
+)
+{
+    while (! m_rebuild)
+    {
+        snd_seq_event_t * ev = nullptr;
+        int rc = ::snd_seq_event_input(client, &ev);
+        if (rc == -ENOSPC)
+        {
+            ++m_overruns;
+            error_print("midi_alsa_input", "MIDI input overrun");
+            continue;
+        }
+        if (rc < 0 || is_nullptr(ev))
+            break;                              /* -EAGAIN: all read        */
+
+        rtmidi_in_data * target = nullptr;
+        listener * lr = find(client, int(ev->dest.port));
+        if (not_nullptr(lr))
+        {
+            if (ev->source.client == SND_SEQ_CLIENT_SYSTEM &&
+                ev->source.port == SND_SEQ_PORT_SYSTEM_ANNOUNCE)
+            {
+                announce(*lr, ev);
+            }
+            else if (prepare(*lr, ev))
+            {
+                target = lr->l_in_data;
+                m_busy_client = client;
+                m_busy_port = lr->l_port;
+            }
+        }
+        ::snd_seq_free_event(ev);
+        if (not_nullptr(target))
+        {
+            lock.unlock();
+            deliver(target);
+            lock.lock();
+            m_busy_client = nullptr;
+            m_busy_port = -1;
+            m_idle.notify_all();
+        }
+    }
+}
+
+/**
+ *  The thread body: poll, then drain each client that has input.
+ */
+
+void
+midi_alsa_input::service ()
+{
+    while (m_running)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_rebuild)
+                rebuild();
+        }
+
+        int rc = ::poll(m_poll_fds.data(), nfds_t(m_poll_fds.size()), -1);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            error_print("midi_alsa_input", "poll() failed");
+            break;
+        }
+        if (m_poll_fds[0].revents & POLLIN)
+        {
+            bool flag;
+            if (::read(m_poll_fds[0].fd, &flag, sizeof flag) < 0)
+                break;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_rebuild)
+            continue;                           /* set changed; re-poll     */
+
+        snd_seq_t * last = nullptr;
+        for (std::size_t i = 1; i < m_poll_fds.size(); ++i)
+        {
+            snd_seq_t * client = m_poll_clients[i];
+            if (client != last && (m_poll_fds[i].revents & (POLLIN | POLLERR)))
+            {
+                drain(lock, client);
+                last = client;
+            }
+        }
+    }
+}
+
+void *
+midi_alsa_input::service_thread (void * self)
+{
+    static_cast<midi_alsa_input *>(self)->service();
+    return nullptr;
+}
+
+}           // namespace rtl
+
+#endif      // RTL66_BUILD_ALSA
+
+/*
+ * midi_alsa_input.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -25,11 +25,14 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2022-07-23
- * \updates       2024-06-01
+ * \updates       2026-10-18
  * \license       See above.
  *
  */
 
+#include <mutex>                                /* std::mutex, lock_guard   */
+#include <vector>                               /* std::vector<>            */
+
 #include "rtl/midi/find_midi_api.hpp"       /* rtl API searching functions  */
 #include "rtl/midi/midi_dummy.hpp"          /* rtl::midi_web classes        */
 #include "rtl/midi/alsa/midi_alsa.hpp"      /* rtl::midi_alsa classes       */
@@ -49,39 +52,352 @@
 namespace rtl
 {
 
+/*------------------------------------------------------------------------
+ * Probe cache and parked client handles
+ *------------------------------------------------------------------------*/
+
+namespace
+{
+
+/**
+ *  How long to wait for a JACK server to answer a probe.  A stalled
+ *  server can otherwise hold up jack_client_open() for many seconds.
+ */
+
+const int c_jack_probe_timeout_ms = 1000;
+
+/**
+ *  A client handle left open by a probe, waiting to be adopted.
+ */
+
+struct parked_client
+{
+    rtmidi::api pc_api;
+    void * pc_handle;
+    std::string pc_name;
+    client_closer pc_closer;
+};
+
+/**
+ *  Holds the probe results (-1 = not probed, 0 = absent, 1 = present) and
+ *  the parked handles.  Handles never adopted are closed at exit.
+ */
+
+class probe_cache
+{
+
+public:
+
+    std::mutex m_mutex;
+    std::vector<int> m_results;
+    std::vector<parked_client> m_parked;
+
+    probe_cache () :
+        m_mutex     (),
+        m_results   (std::size_t(midiapi_to_int(rtmidi::api::max)), (-1)),
+        m_parked    ()
+    {
+        // no code
+    }
+
+    ~probe_cache ()
+    {
+        close_parked(rtmidi::api::max);
+    }
+
+    /**
+     *  Closes and forgets every parked handle, except one for the given
+     *  API.  Not locked; the caller must hold m_mutex.
+     */
+
+    void close_parked (rtmidi::api keep)
+    {
+        for (auto pi = m_parked.begin(); pi != m_parked.end(); /* ++pi */)
+        {
+            if (pi->pc_api == keep)
+            {
+                ++pi;
+            }
+            else
+            {
+                if (not_nullptr(pi->pc_closer))
+                    pi->pc_closer(pi->pc_handle);
+
+                pi = m_parked.erase(pi);
+            }
+        }
+    }
+
+};
+
+probe_cache &
+probes ()
+{
+    static probe_cache s_probe_cache;
+    return s_probe_cache;
+}
+
+/**
+ *  The actual probe of one API, done once per API.  APIs with no client to
+ *  open fall back to their detection functions.  The retry flag is set if
+ *  the answer is not final (a JACK server that did not answer in time),
+ *  so that it is not cached.
+ */
+
+bool
+run_probe (rtmidi::api rapi, const std::string & cname, bool & retry)
+{
+    bool result = false;
+    retry = false;
+    switch (rapi)
+    {
+#if defined RTL66_BUILD_PIPEWIRE
+    case rtmidi::api::pipewire:
+
+        result = detect_pipewire();
+        break;
+#endif
+#if defined RTL66_BUILD_JACK
+    case rtmidi::api::jack:
+
+        result = probe_jack(cname, c_jack_probe_timeout_ms, retry);
+        break;
+#endif
+#if defined RTL66_BUILD_ALSA
+    case rtmidi::api::alsa:
+
+        result = probe_alsa(cname);
+        break;
+#endif
+#if defined RTL66_BUILD_MACOSX_CORE
+    case rtmidi::api::macosx_core:
+
+        result = detect_core();
+        break;
+#endif
+#if defined RTL66_BUILD_WIN_MM
+    case rtmidi::api::windows_mm:
+
+        result = detect_win_mm();
+        break;
+#endif
+#if defined RTL66_BUILD_WEB_MIDI
+    case rtmidi::api::web_midi:
+
+        result = detect_web_midi();
+        break;
+#endif
+#if defined RTL66_BUILD_DUMMY
+    case rtmidi::api::dummy:
+
+        result = detect_dummy();
+        break;
+#endif
+    default:
+
+        (void) cname;
+        break;
+    }
+    return result;
+}
+
+}           // namespace (anonymous)
+
+/**
+ *  Checks cheaply whether an API is usable.  The first probe of an API does
+ *  the work; later calls return the cached answer.  The client name is
+ *  used for the client a probe opens and parks (see park_client_handle()).
+ *
+ *  The probe is not done with the probe mutex held, so that a stalled JACK
+ *  server cannot block the other APIs.  Two threads probing the same API
+ *  at once both probe it; the results agree.  A JACK probe that times out
+ *  is not cached, since the server may only be slow; the next call probes
+ *  again.
+ *
+ * \param rapi
+ *      The API to check.  Neither unspecified nor max is usable.
+ *
+ * \param clientname
+ *      The name for a client opened by the probe.  Can be empty.
+ *
+ * \return
+ *      Returns true if the API is available.
+ */
+
+bool
+probe_midi_api (rtmidi::api rapi, const std::string & clientname)
+{
+    bool result = false;
+    int index = midiapi_to_int(rapi);
+    bool valid = rapi != rtmidi::api::unspecified && is_midiapi_valid(rapi);
+    if (valid)
+    {
+        probe_cache & pc = probes();
+        int cached;
+        {
+            std::lock_guard<std::mutex> lock(pc.m_mutex);
+            cached = pc.m_results[index];
+        }
+        if (cached < 0)
+        {
+            bool retry;
+            result = run_probe(rapi, clientname, retry);
+            if (! retry)
+            {
+                std::lock_guard<std::mutex> lock(pc.m_mutex);
+                pc.m_results[index] = result ? 1 : 0 ;
+            }
+        }
+        else
+            result = cached > 0;
+    }
+    return result;
+}
+
+/**
+ *  Forgets the cached probe results, so that the next probe of each API is
+ *  done again.  Parked handles are closed.
+ */
+
+void
+reset_midi_api_probes ()
+{
+    probe_cache & pc = probes();
+    std::lock_guard<std::mutex> lock(pc.m_mutex);
+    for (auto & r : pc.m_results)
+        r = (-1);
+
+    pc.close_parked(rtmidi::api::max);
+}
+
+/**
+ *  Saves a client handle opened by a probe, replacing any other handle
+ *  parked for the same API.
+ *
+ * \param closer
+ *      The function that closes the handle if it is not adopted.
+ */
+
+void
+park_client_handle
+(
+    rtmidi::api rapi,
+    void * handle,
+    const std::string & clientname,
+    client_closer closer
+)
+{
+    if (not_nullptr(handle))
+    {
+        probe_cache & pc = probes();
+        std::lock_guard<std::mutex> lock(pc.m_mutex);
+        for (auto pi = pc.m_parked.begin(); pi != pc.m_parked.end(); ++pi)
+        {
+            if (pi->pc_api == rapi)
+            {
+                if (not_nullptr(pi->pc_closer))
+                    pi->pc_closer(pi->pc_handle);
+
+                (void) pc.m_parked.erase(pi);
+                break;
+            }
+        }
+        pc.m_parked.push_back(parked_client{rapi, handle, clientname, closer});
+    }
+}
+
+/**
+ *  Hands over the handle parked for an API.  The caller then owns it.  A
+ *  handle parked under another name, such as the one parked by the probe
+ *  in rtmidi::detected_apis(), would never be adopted, and is closed.  As
+ *  an API has now been chosen, handles parked by probes of other APIs are
+ *  closed too.
+ *
+ * \param clientname
+ *      If not empty, the parked handle must have been opened with this
+ *      name.  APIs that cannot rename a client (JACK) pass their name; the
+ *      others pass nothing and rename the client after adopting it.
+ *
+ * \return
+ *      Returns the handle, or null if there is none to adopt.
+ */
+
+void *
+adopt_client_handle (rtmidi::api rapi, const std::string & clientname)
+{
+    void * result = nullptr;
+    probe_cache & pc = probes();
+    std::lock_guard<std::mutex> lock(pc.m_mutex);
+    for (auto pi = pc.m_parked.begin(); pi != pc.m_parked.end(); ++pi)
+    {
+        if (pi->pc_api == rapi)
+        {
+            if (clientname.empty() || clientname == pi->pc_name)
+                result = pi->pc_handle;
+            else if (not_nullptr(pi->pc_closer))
+                pi->pc_closer(pi->pc_handle);
+
+            (void) pc.m_parked.erase(pi);
+            break;
+        }
+    }
+    pc.close_parked(rapi);
+
+    return result;
+}
+
+/**
+ *  Closes all parked handles.
+ */
+
+void
+release_client_handles ()
+{
+    probe_cache & pc = probes();
+    std::lock_guard<std::mutex> lock(pc.m_mutex);
+    pc.close_parked(rtmidi::api::max);
+}
+
 /*------------------------------------------------------------------------
  * rtmidi helper functions for derived classes
  *------------------------------------------------------------------------*/
 
 /**
- *  This function probes for an existing MIDI API engine.  It tries to
- *  test an output port.  Either input or output would work. Once detected,
- *  the port is deleted; we just want to find an API.
+ *  This function probes for an existing MIDI API engine.  It no longer
+ *  opens a port to do so; see probe_midi_api().  A client opened by the
+ *  probe is kept for the engine that is opened next.
  *
  *  \param desiredapi
  *      Provides the desired API.  The value rtmidi::api::unspecified means that
- *      a preferred API (or a fallback if the preferred API does not exist)
- *      will be selectied if possible. This is the default value.
+ *      the compiled APIs are probed in order of preference, and the first one
+ *      found is selected. This is the default value.
  *
  *  \param cname
- *      Provide the desired setting for the name of the client.
- *      By default this value is empty.
+ *      Provide the desired setting for the name of the client.  It should
+ *      match the name of the engine to be opened, so that the engine can
+ *      adopt the client.  By default this value is empty.
  */
 
 rtmidi::api
 find_midi_api (rtmidi::api desiredapi, std::string cname)
 {
     rtmidi::api result = rtmidi::api::unspecified;
-    midi_api * m = nullptr;
     if (desiredapi == rtmidi::api::unspecified)
-        desiredapi = rtmidi::fallback_api();
-
-    m = try_open_midi_api(desiredapi, midi::port::io::output, cname);
-    if (not_nullptr(m))
     {
-        delete m;
-        result = desiredapi;
+        rtmidi::api_list apis;
+        rtmidi::get_compiled_apis(apis);
+        for (auto a : apis)
+        {
+            if (probe_midi_api(a, cname))
+            {
+                result = a;
+                break;
+            }
+        }
     }
+    else if (probe_midi_api(desiredapi, cname))
+        result = desiredapi;
+
     return result;
 }
 
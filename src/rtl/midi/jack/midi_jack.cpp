@@ -24,7 +24,7 @@
  * \library       rtl66
  * \author        Gary P. Scavone; severe refactoring by Chris Ahlstrom
  * \date          2022-06-07
- * \updates       2025-01-30
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  Engine candidates:
@@ -39,6 +39,7 @@
  *      -   get_io_port_info()      [jack_get_ports()]
  *      -   get_port_name()       * [jack_get_ports()]
  *      -   get_port_alias()        [jack_port_by_name()]
+ *      -   get_port_latency()      [jack_port_get_latency_range()]
  *
  *  Warnings *:
  *
@@ -54,7 +55,12 @@
 #if defined RTL66_BUILD_JACK
 
 #include <stdint.h>                     /* std::uint64_t                    */
+#include <chrono>                       /* std::chrono::milliseconds        */
+#include <condition_variable>           /* std::condition_variable          */
 #include <cstring>                      /* std::strlen                      */
+#include <memory>                       /* std::shared_ptr<>                */
+#include <mutex>                        /* std::mutex, std::unique_lock     */
+#include <thread>                       /* std::thread                      */
 #include <jack/midiport.h>              /* ::jack_midi_get_event_count()    */
 #include <pthread.h>                    /* the pthreads API                 */
 
@@ -62,6 +68,7 @@
 #include "midi/event.hpp"               /* midi::event class                */
 #include "midi/eventcodes.hpp"          /* midi::status enum, functions...  */
 #include "midi/portnaming.hpp"          /* midi::extract_port_names()       */
+#include "rtl/midi/find_midi_api.hpp"   /* rtl::park_client_handle()        */
 #include "rtl/midi/jack/midi_jack_callbacks.hpp" /* rtl::jack callbacks     */
 #include "rtl/midi/rtmidi_in_data.hpp"  /* rtl::rtmidi_in_data class        */
 #include "util/msgfunctions.hpp"        /* util::error_message(), etc.      */
@@ -185,6 +192,108 @@ detect_jack (bool forcecheck)
     return result;
 }
 
+static void
+close_jack_client (void * handle)
+{
+    (void) ::jack_client_close(reinterpret_cast<jack_client_t *>(handle));
+}
+
+/**
+ *  The cheap JACK probe.  Unlike detect_jack(), it does not activate the
+ *  client or look at ports; a server that answers is enough.  The client is
+ *  opened by a helper thread, so that a stalled server costs no more than
+ *  the timeout.  If the server answers after the timeout, the helper closes
+ *  the client itself.  A client opened in time is parked (see
+ *  find_midi_api.cpp) for the engine or port of the same name.
+ *
+ *  If rtmidi::start_jack() is set, the server may be started, which can
+ *  take a while, so there is no time limit.
+ *
+ * \param clientname
+ *      The name for the client.  If empty, "rtl_jack_detector" is used.
+ *
+ * \param timeoutms
+ *      The longest wait for the server, in milliseconds.
+ *
+ * \param [out] timedout
+ *      Set to true if the server did not answer in time, in which case the
+ *      false result says nothing about whether JACK is there.
+ *
+ * \return
+ *      Returns true if a client could be opened in time.
+ */
+
+bool
+probe_jack (const std::string & clientname, int timeoutms, bool & timedout)
+{
+    struct probe_state
+    {
+        std::mutex ps_mutex;
+        std::condition_variable ps_cond;
+        jack_client_t * ps_client = nullptr;
+        bool ps_done = false;
+        bool ps_abandoned = false;
+    };
+    std::string cname = clientname.empty() ?
+        std::string("rtl_jack_detector") : clientname ;
+
+    bool startserver = rtmidi::start_jack();
+    jack_options_t jopts = startserver ? JackNullOption : JackNoStartServer ;
+    auto state = std::make_shared<probe_state>();
+    std::thread opener
+    (
+        [state, cname, jopts] ()
+        {
+            jack_client_t * c = ::jack_client_open(cname.c_str(), jopts, NULL);
+            std::lock_guard<std::mutex> lock(state->ps_mutex);
+            if (state->ps_abandoned)
+            {
+                if (not_nullptr(c))
+                    (void) ::jack_client_close(c);
+            }
+            else
+            {
+                state->ps_client = c;
+                state->ps_done = true;
+                state->ps_cond.notify_all();
+            }
+        }
+    );
+    opener.detach();
+
+    std::unique_lock<std::mutex> lock(state->ps_mutex);
+    auto done = [state] () { return state->ps_done; };
+    bool answered = true;
+    if (startserver)
+        state->ps_cond.wait(lock, done);
+    else
+        answered = state->ps_cond.wait_for
+        (
+            lock, std::chrono::milliseconds(timeoutms), done
+        );
+
+    bool result = answered && not_nullptr(state->ps_client);
+    timedout = ! answered;
+    if (result)
+    {
+        park_client_handle
+        (
+            rtmidi::api::jack, state->ps_client, cname, close_jack_client
+        );
+    }
+    else
+    {
+        if (! answered)
+        {
+            state->ps_abandoned = true;
+            warnprint("JACK server not responding");
+        }
+        else
+            warnprint("JACK not detected");
+    }
+    return result;
+}
+
 #if defined RTL66_USE_GLOBAL_CLIENTINFO
 
 void
@@ -314,7 +423,9 @@ midi_jack::~midi_jack ()
  *  if the connection does not already exist.  In Seq66v2 we will consolidate
  *  JACK transport, JACK MIDI I/O, and, Linus willing, JACK Audio I/O.
  *
- *  This function also sets up all of the JACK callbacks.
+ *  This function also sets up all of the JACK callbacks.  A client of the
+ *  same name left open by probe_jack() is adopted rather than opening
+ *  another.
  *
  *  One hidden "parameter" is the client name. Another is the port::io type.
  *  If service, that will change the process callback that is set, for use by
@@ -336,20 +447,26 @@ midi_jack::engine_connect ()
     if (ok)
     {
         const char * cname = client_name().c_str();
-
-        jack_options_t jopts = JackNoStartServer;
-        if (rtmidi::start_jack())
-            jopts = JackNullOption;
+        jack_client_t * c = reinterpret_cast<jack_client_t *>
+        (
+            adopt_client_handle(rtmidi::api::jack, client_name())
+        );
+        if (is_nullptr(c))
+        {
+            jack_options_t jopts = JackNoStartServer;
+            if (rtmidi::start_jack())
+                jopts = JackNullOption;
 
 #if defined USE_JACK_STATUS_RETURN
-        jack_status_t status;
-        jack_status_t * ps = &status;
-        jack_client_t * c = ::jack_client_open(cname, jopts, ps);
+            jack_status_t status;
+            jack_status_t * ps = &status;
+            c = ::jack_client_open(cname, jopts, ps);
 
-        // Here, can shows the bits of the status, if desired.
+            // Here, can shows the bits of the status, if desired.
 #else
-        jack_client_t * c = ::jack_client_open(cname, jopts, NULL /*ps*/);
+            c = ::jack_client_open(cname, jopts, NULL /*ps*/);
 #endif
+        }
         if (not_nullptr(c))
         {
             void * apidata = reinterpret_cast<void *>(&data);
@@ -386,6 +503,15 @@ midi_jack::engine_connect ()
 #if defined RTL66_JACK_PORT_REFRESH_CALLBACK
                 JackPortRegistrationCallback cb = jack_port_register_callback;
                 (void) jack_set_port_registration_cb(c, cb, (void *) this);
+#else
+                if (have_master_bus())
+                {
+                    JackPortRegistrationCallback cb = jack_port_watch_callback;
+                    (void) jack_set_port_registration_cb
+                    (
+                        c, cb, (void *) master_bus()
+                    );
+                }
 #endif
 #if defined RTL66_JACK_METADATA
                 std::string n = "seq_icon_name()";
@@ -1001,82 +1127,135 @@ midi_jack::set_client_name (const std::string & /*clientname*/)
 int
 midi_jack::get_io_port_info (midi::ports & ioports, bool preclear)
 {
-    int result = 0;
-    bool iswriteable = is_output();
-    midi_jack_data & data = jack_data();
     if (preclear)
         ioports.clear();
 
-    if (not_nullptr(data.jack_client()))
-    {
+    int result = is_output() ?
+        enumerate_ports(nullptr, &ioports) :
+        enumerate_ports(&ioports, nullptr) ;
+
+    return result < 0 ? 0 : result ;
+}
+
+/**
+ *  Gets both port lists from one jack_get_ports() call, splitting them by
+ *  the port flags, rather than one call (and one client) for each
+ *  direction.  The lists are not cleared.
+ *
+ * \return
+ *      Returns the total number of ports found, which can be 0, or -1 if
+ *      there is no JACK client.
+ */
+
+int
+midi_jack::get_all_io_port_info (midi::ports & inports, midi::ports & outports)
+{
+    return enumerate_ports(&inports, &outports);
+}
+
+/**
+ *  Adds the JACK MIDI ports to the given lists.  Readable ports
+ *  (JackPortIsOutput) go to inports, writable ports (JackPortIsInput) to
+ *  outports.  Either list can be null to skip that direction; if only one
+ *  is wanted, JACK does the filtering.  The port numbers count up within
+ *  each list.
+ */
+
+int
+midi_jack::enumerate_ports (midi::ports * inports, midi::ports * outports)
+{
+    int result = 0;
+    midi_jack_data & data = jack_data();
+    jack_client_t * c = data.jack_client();
+    if (is_nullptr(c))
+        return (-1);
+
+    bool both = not_nullptr(inports) && not_nullptr(outports);
 #if defined PLATFORM_DEBUG
-        infoprint(iswriteable ? "Writable ports:" : "Readable ports:");
+    if (! both)
+        infoprint(is_nullptr(inports) ? "Writable ports:" : "Readable ports:");
 #endif
-        unsigned long flag = iswriteable ?
-            JackPortIsInput : JackPortIsOutput ;
+    unsigned long flag = 0;                         /* both directions      */
+    if (! both)
+        flag = not_nullptr(outports) ? JackPortIsInput : JackPortIsOutput ;
 
-        const char ** ports = ::jack_get_ports
+    const char ** ports = ::jack_get_ports
+    (
+        c, NULL, JACK_DEFAULT_MIDI_TYPE, flag
+    );
+    if (is_nullptr(ports))
+    {
+#if defined RTL66_JACK_FALLBACK_TO_VIRTUAL_PORT
+        int clientnumber = 0;
+        int portnumber = 0;
+        std::string clientname = "";                // TODO: seq_client_name();
+        std::string portname = "midi in 0";
+        midi::ports * fallback = not_nullptr(inports) ? inports : outports ;
+        fallback->add
         (
-            data.jack_client(), NULL, JACK_DEFAULT_MIDI_TYPE, flag
+            clientnumber, clientname, portnumber, portname,
+            midi::port::io::input, midi::port::kind::manual
         );
-        if (is_nullptr(ports))
-        {
-#if defined RTL66_JACK_FALLBACK_TO_VIRTUAL_PORT
-            int clientnumber = 0;
-            int portnumber = 0;
-            std::string clientname = "";            // TODO: seq_client_name();
-            std::string portname = "midi in 0";
-            ioports.add
-            (
-                clientnumber, clientname, portnumber, portname,
-                midi::port::io::input, midi::port::kind::manual
-            );
-            ++result;
+        ++result;
 #endif
-            error_print("jack_get_ports", "found no ports");
-        }
-        else
+        error_print("jack_get_ports", "found no ports");
+    }
+    else
+    {
+        int clientnumber = 0;                       /* JACK: doesn't apply  */
+        int incount = 0;
+        int outcount = 0;
+        for (int i = 0; not_nullptr(ports[i]); ++i)
         {
-            int clientnumber = 0;                   /* JACK: doesn't apply  */
-            int count = 0;
-            while (not_nullptr(ports[count]))
+            std::string fullname = ports[i];
+            midi::ports * target = not_nullptr(inports) ? inports : outports ;
+            if (both)
             {
-                std::string fullname = ports[count];
-                std::string clientname;
-                std::string portname;
-                std::string alias = get_port_alias(fullname);
-                if (alias == fullname)
-                    alias.clear();
+                jack_port_t * p = ::jack_port_by_name(c, ports[i]);
+                int pflags = is_nullptr(p) ? 0 : ::jack_port_flags(p) ;
+                if ((pflags & JackPortIsOutput) != 0)
+                    target = inports;
+                else if ((pflags & JackPortIsInput) != 0)
+                    target = outports;
+                else
+                    continue;
+            }
 
-                /*
-                 * TODO:  somehow get the 32-bit ID of the port and add it as
-                 * a system port ID to use for lookup when detecting newly
-                 * registered or unregistered ports.
-                 */
+            std::string clientname;
+            std::string portname;
+            std::string alias = get_port_alias(fullname);
+            if (alias == fullname)
+                alias.clear();
 
-                midi::extract_port_names(fullname, clientname, portname);
+            /*
+             * TODO:  somehow get the 32-bit ID of the port and add it as
+             * a system port ID to use for lookup when detecting newly
+             * registered or unregistered ports.
+             */
 
-                /*
-                 * Retrofit this commenting out!
-                 *
-                 *  if (client == -1 || clientname != client_name_list.back())
-                 *  {
-                 *      client_name_list.push_back(clientname);
-                 *      ++client;
-                 *  }
-                 */
+            midi::extract_port_names(fullname, clientname, portname);
 
-                ioports.add
-                (
-                    clientnumber, clientname, count, portname,
-                    midi::port::io::input, midi::port::kind::normal,
-                    0, alias
-                );
-                ++count;
-            }
-            ::jack_free(ports);
-            result += count;
+            /*
+             * Retrofit this commenting out!
+             *
+             *  if (client == -1 || clientname != client_name_list.back())
+             *  {
+             *      client_name_list.push_back(clientname);
+             *      ++client;
+             *  }
+             */
+
+            int & count = target == inports ? incount : outcount ;
+            target->add
+            (
+                clientnumber, clientname, count, portname,
+                midi::port::io::input, midi::port::kind::normal,
+                0, alias
+            );
+            ++count;
         }
+        ::jack_free(ports);
+        result += incount + outcount;
     }
     return result;
 }
@@ -1183,6 +1362,35 @@ midi_jack::get_port_alias (const std::string & name)
     return result;
 }
 
+/**
+ *  Gets the playback latency of our port, that is, the worst-case time
+ *  for data written to it to reach the physical outputs it is connected to.
+ *  JACK updates the range when the graph changes, so it is best queried
+ *  after the connections are made.
+ *
+ * \return
+ *      Returns the maximum latency in microseconds, or -1 if there is no
+ *      port or client.
+ */
+
+long
+midi_jack::get_port_latency ()
+{
+    long result = -1;
+    midi_jack_data & data = jack_data();
+    jack_client_t * jc = data.jack_client();
+    jack_port_t * jp = data.jack_port();
+    if (not_nullptr_2(jc, jp))
+    {
+        jack_latency_range_t range;
+        jack_nframes_t rate = ::jack_get_sample_rate(jc);
+        ::jack_port_get_latency_range(jp, JackPlaybackLatency, &range);
+        if (rate > 0)
+            result = long(uint64_t(range.max) * 1000000 / rate);
+    }
+    return result;
+}
+
 /**
  *  Checks to see if a master client connection is available.  If so, it is
  *  logged as the client for the current port.
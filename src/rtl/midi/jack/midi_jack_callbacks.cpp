@@ -24,7 +24,7 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2022-06-07
- * \updates       2024-06-09
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  The JACK callbacks have been moved into a separate file for better
@@ -37,6 +37,7 @@
 
 #include <cstring>                      /* std::memcpy()                    */
 #include <sstream>                      /* std::ostringstream               */
+#include <vector>                       /* std::vector<> for alias buffers  */
 #include <jack/midiport.h>
 #include <jack/metadata.h>              /* JACK_METADATA_ICON names         */
 #include <jack/uuid.h>                  /* JACK_UUID_EMPTY_INITIALIZER etc. */
@@ -921,6 +922,62 @@ jack_port_register_callback (jack_port_id_t portid, int regv, void * arg)
 
 #endif      // defined RTL66_JACK_PORT_REFRESH_CALLBACK
 
+/**
+ *  Posts the MIDI ports of other clients as they are registered and
+ *  unregistered to the master bus's port watch.  JACK calls this in its
+ *  non-real-time notification thread.  The port is still there when its
+ *  unregistration is reported, so its name and alias are posted both ways.
+ *  JACK has no client and port numbers, so -1 is posted for them.
+ *
+ * \param portid
+ *      The ID of the port.
+ *
+ * \param regv
+ *      Non-zero if the port is being registered, zero if it is going.
+ *
+ * \param arg
+ *      The midi::masterbus, which holds the JACK client handle.
+ */
+
+void
+jack_port_watch_callback (jack_port_id_t portid, int regv, void * arg)
+{
+    midi::masterbus * mb = reinterpret_cast<midi::masterbus *>(arg);
+    if (is_nullptr(mb))
+        return;
+
+    jack_client_t * handle =
+        reinterpret_cast<jack_client_t *>(mb->client_handle());
+
+    jack_port_t * portptr = is_nullptr(handle) ?
+        nullptr : ::jack_port_by_id(handle, portid) ;
+
+    if (is_nullptr(portptr) || ::jack_port_is_mine(handle, portptr) != 0)
+        return;
+
+    const char * porttype = ::jack_port_type(portptr);
+    if (is_nullptr(porttype) || std::strcmp(porttype, JACK_DEFAULT_MIDI_TYPE))
+        return;
+
+    std::string name;
+    std::string alias;
+    const char * ln = ::jack_port_name(portptr);
+    if (not_nullptr(ln))
+        name = std::string(ln);
+
+    int size = ::jack_port_name_size();
+    std::vector<char> alias0(size, 0);
+    std::vector<char> alias1(size, 0);
+    char * aliases[2] = { alias0.data(), alias1.data() };
+    if (::jack_port_get_aliases(portptr, aliases) > 0)
+        alias = std::string(aliases[0]);
+
+    if (regv != 0)
+        (void) mb->port_start(-1, -1, name, alias);
+    else
+        (void) mb->port_exit(-1, -1, name, alias);
+}
+
 #if defined RTL66_JACK_PORT_CONNECT_CALLBACK
 
 /**
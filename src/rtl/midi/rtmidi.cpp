@@ -25,7 +25,7 @@
  * \library       rtl66
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2022-06-07
- * \updates       2025-01-20
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  A member function correlation and check-list can be found in
@@ -37,6 +37,7 @@
 #include "platform_macros.h"            /* operating system detection       */
 #include "c_macros.h"                   /* not_nullptr and other macros     */
 #include "midi/event.hpp"               /* midi::eventd, midi::byte         */
+#include "rtl/midi/find_midi_api.hpp"   /* rtl::probe_midi_api()            */
 #include "rtl/midi/midi_api.hpp"        /* rtl::midi_api class              */
 #include "rtl/midi/rtmidi.hpp"          /* rtl::rtmidi class, etc.          */
 
@@ -284,14 +285,14 @@ rtmidi::detected_apis () noexcept
         }
 #endif
 #if defined RTL66_BUILD_JACK
-        if (detect_jack(false))                 /* check ports, no recheck  */
+        if (probe_midi_api(rtmidi::api::jack))  /* cached, keeps the client */
         {
             s_api_list.push_back(rtmidi::api::jack);
             s_uninitialized = false;
         }
 #endif
 #if defined RTL66_BUILD_ALSA
-        if (detect_alsa(true))
+        if (probe_midi_api(rtmidi::api::alsa))
         {
             s_api_list.push_back(rtmidi::api::alsa);
             s_uninitialized = false;
@@ -709,6 +710,25 @@ rtmidi::get_io_port_info (midi::ports & ports, bool preclear)
     return result;
 }
 
+/**
+ *  Gets the input and output port lists with one enumeration, if the API
+ *  supports that.  The lists are not cleared first.
+ *
+ * \return
+ *      Returns the total number of ports found, or -1 if the API cannot do
+ *      this, in which case get_io_port_info() must be used for each list.
+ */
+
+int
+rtmidi::get_all_io_port_info (midi::ports & inports, midi::ports & outports)
+{
+    int result = (-1);
+    if (not_nullptr(rt_api_ptr()))
+        result = rt_api_ptr()->get_all_io_port_info(inports, outports);
+
+    return result;
+}
+
 #if defined RTL66_MIDI_EXTENSIONS       // defined in Linux, FIXME
 
 /**
@@ -24,12 +24,12 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2022-06-30
- * \updates       2024-06-05
+ * \updates       2026-10-18
  * \license       See above.
  *
  */
 
-#include <iostream>                     /* std::cout, std::cin              */
+#include <iostream>                     /* std::cout, std::cin, std::cerr   */
 #include <memory>                       /* std::unique_ptr<>                */
 
 #include "midi/clientinfo.hpp"          /* midi::global_client_info()       */
@@ -71,6 +71,23 @@ rt_test_sleep (int ms)
 
 #endif
 
+/**
+ *  Reports a failed check of a unit test, as in
+ *
+ *      ok = rt_test_check(count == 3, "count") && ok;
+ *
+ *  so that all of the checks run, and each failure is shown.
+ */
+
+bool
+rt_test_check (bool condition, const std::string & what)
+{
+    if (! condition)
+        std::cerr << "FAILED: " << what << std::endl;
+
+    return condition;
+}
+
 int
 rt_choose_port_number (bool isoutput)
 {
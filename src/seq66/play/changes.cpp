@@ -0,0 +1,141 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          changes.cpp
+ *
+ *  This module defines the board of change epochs for a screen-set.
+ *
+ * \library       rtl66 library
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Epochs are plain counters, bumped with fetch_add(), rather than stamps
+ *  taken from a shared clock.  With a clock there is a gap between taking
+ *  the stamp and storing it, and a consumer polling in that gap could skip
+ *  the change forever.  A counter compared for inequality cannot be
+ *  skipped.
+ */
+
+#include "play/changes.hpp"             /* seq66::changes class             */
+
+namespace seq66
+{
+
+changes::changes (int slotcount) :
+    m_slot_count    (slotcount > 0 ? slotcount : 0),
+    m_set_epoch     (0),
+    m_slot_epochs   (new std::atomic<epoch> [m_slot_count > 0 ? m_slot_count : 1])
+{
+    for (int s = 0; s < m_slot_count; ++s)
+        m_slot_epochs[s].store(0);
+}
+
+changes::epoch
+changes::slot_epoch (int slot) const
+{
+    return (slot >= 0 && slot < m_slot_count) ?
+        m_slot_epochs[slot].load(std::memory_order_acquire) : 0 ;
+}
+
+/**
+ *  Records a change to one slot.  Callable from any thread.
+ *
+ * \param slot
+ *      The slot number relative to the set, 0 to slot_count() - 1.
+ *      Out-of-range values are ignored.
+ */
+
+void
+changes::bump (int slot)
+{
+    if (slot >= 0 && slot < m_slot_count)
+    {
+        m_slot_epochs[slot].fetch_add(1, std::memory_order_release);
+        m_set_epoch.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void
+changes::bump_all ()
+{
+    for (int s = 0; s < m_slot_count; ++s)
+        bump(s);
+}
+
+/**
+ *  The cheap check.  Does not update the cursor.
+ */
+
+bool
+changes::changed (const cursor & c) const
+{
+    return set_epoch() != c.m_set_epoch;
+}
+
+/**
+ *  Reports the slots that changed since the cursor was last updated, and
+ *  updates the cursor.  If the set has not changed, this costs one
+ *  comparison and the bitmap is left alone.
+ *
+ * \param [inout] c
+ *      The consumer's cursor.
+ *
+ * \param [out] bitmap
+ *      Resized to slot_count(), and set to true for each changed slot.
+ *
+ * \return
+ *      Returns true if any slot changed.
+ */
+
+bool
+changes::changed_since (cursor & c, std::vector<bool> & bitmap) const
+{
+    epoch setepoch = set_epoch();
+    bool result = setepoch != c.m_set_epoch;
+    if (result)
+    {
+        result = false;
+        c.m_set_epoch = setepoch;
+        if (int(c.m_slot_epochs.size()) != m_slot_count)
+            c.m_slot_epochs.assign(size_t(m_slot_count), 0);
+
+        bitmap.assign(size_t(m_slot_count), false);
+        for (int s = 0; s < m_slot_count; ++s)
+        {
+            epoch e = m_slot_epochs[s].load(std::memory_order_acquire);
+            if (e != c.m_slot_epochs[s])
+            {
+                c.m_slot_epochs[s] = e;
+                bitmap[s] = true;
+                result = true;
+            }
+        }
+    }
+    return result;
+}
+
+}           // namespace seq66
+
+/*
+ * changes.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -104,6 +104,7 @@ clockslist::add
         ioitem.io_name = portname;
         ioitem.io_alias = alias;
         ioitem.io_client_number = ioitem.io_port_number = pstatus;
+        ioitem.io_latency_us = 0;
         result = portslist::add(bussno, ioitem, nickname);
     }
     return result;
@@ -121,6 +122,8 @@ clockslist::add_list_line (const std::string & line)
         midi::clocking clocktype = int_to_clock(pstatus);
         bool available = pstatus != (-2);
         result = add(pnumber, available, clocktype, pname);
+        if (result)
+            set_latency(midi::bussbyte(pnumber), parse_port_latency(line));
     }
     return result;
 }
@@ -205,7 +208,10 @@ clockslist::io_list_lines () const
     {
         const io & item = iopair.second;
         int status = clock_to_int(item.out_clock);
-        result += io_line(bussno, status, item.io_name, item.io_alias);
+        result += io_line
+        (
+            bussno, status, item.io_name, item.io_alias, item.io_latency_us
+        );
         ++bussno;
     }
     return result;
@@ -90,6 +90,7 @@ inputslist::add
         ioitem.out_clock = midi::clocking::input;
         ioitem.io_name = portname;
         ioitem.io_alias = alias;
+        ioitem.io_latency_us = 0;
         result = portslist::add(bussno, ioitem, nickname);
     }
     return result;
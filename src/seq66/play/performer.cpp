@@ -241,6 +241,7 @@
 
 #include <algorithm>                    /* std::find() for std::vector      */
 #include <cmath>                        /* std::round()                     */
+#include <chrono>                       /* std::chrono::microseconds        */
 #include <iostream>                     /* std::cout                        */
 #include <sstream>                      /* std::ostringstream               */
 
@@ -355,6 +356,7 @@ performer::performer (int ppqn, int rows, int columns) :
     m_32nds_per_quarter     (0),
     m_us_per_quarter_note   (0),
     m_master_bus            (),                 /* this is a shared pointer */
+    m_input_capture         (),
     m_record_by_buss        (false),
     m_record_by_channel     (false),
     m_buss_patterns         (),
@@ -2624,9 +2626,14 @@ performer::screenset_name
  *  ticking of the redraw timer.  Also see (for Qt 5) the qseqbase ::
  *  needs_update() function.  Most useful in seqedit or qseqedit.
  *
+ * \param [inout] c
+ *      The caller's own record of the set epochs it has seen.  Each user
+ *      interface keeps one, so that the check by one of them does not hide
+ *      the change from the others.  See setmapper::needs_update().
+ *
  * \param seq
  *      The sequence to check.  If set to seq::all(), the default, check
- *      them all, exiting when the first dirty one is found.
+ *      them all.
  *
  * \return
  *      Returns true if the performer is running or if a sequence is found
@@ -2634,7 +2641,11 @@ performer::screenset_name
  */
 
 bool
-performer::needs_update (seq::number seqno) const
+performer::needs_update
+(
+    setmapper::update_cursor & c,
+    seq::number seqno
+) const
 {
     bool result = false;
     if (m_is_busy)
@@ -2654,7 +2665,7 @@ performer::needs_update (seq::number seqno) const
             else
             {
                 if (seqno == seq::all())
-                    result = set_mapper().needs_update();   /* check all    */
+                    result = set_mapper().needs_update(c);  /* check all    */
                 else
                     result = is_dirty_main(seqno);          /* check one    */
             }
@@ -3410,6 +3421,7 @@ performer::launch (int ppqn)
                 midi::bussbyte truebus = true_output_bus(namedbus);
                 m_midi_control_out.true_buss(truebus);
             }
+            apply_output_latencies();
             m_io_active = true;                     /* set done()           */
             launch_input_thread();
             launch_output_thread();
@@ -3443,6 +3455,33 @@ performer::launch (int ppqn)
     return result;
 }
 
+/**
+ *  Gives the output busses their latencies, once they are set up and before
+ *  any output is sent.  The APIs are asked first (only JACK knows), then a
+ *  "latency=" setting in the [midi-clock] section overrides what the API
+ *  said.  A configured latency turns on compensation, which starts the
+ *  output workers; see midi::busarray::compensate_latency().
+ */
+
+void
+performer::apply_output_latencies ()
+{
+    bool configured = false;
+    (void) m_master_bus->query_output_latencies();
+    for (int b = 0; b < m_clocks.count(); ++b)
+    {
+        midi::bussbyte bus = midi::bussbyte(b);
+        long us = m_clocks.get_latency(bus);
+        if (us > 0)
+        {
+            m_master_bus->output_latency(bus, us);
+            configured = true;
+        }
+    }
+    if (configured)
+        (void) m_master_bus->compensate_latency(true);
+}
+
 /**
  *  Iterate through the current set of patterns (in the playset only!) to find
  *  those that might specify an input buss. Only one pattern can grab ahold of
@@ -4863,117 +4902,232 @@ performer::poll_cycle ()
             midi::event ev;
             if (m_master_bus->get_midi_event(&ev))
             {
+                if (m_input_capture.capturing())
+                    (void) m_input_capture.capture(ev);
+
+                if (! handle_input_event(ev))
+                    return false;                   /* e.g. sense/reset      */
+            }
+        } while (m_master_bus->is_more_input());
+    }
+    return result;
+}
+
+/**
+ *  Handles one incoming event, whether from the input ports or from a
+ *  replay of a captured input session (see replay_input()).  This is the
+ *  body of the poll_cycle() loop.
+ *
+ * \return
+ *      Returns false if input processing should stop.
+ */
+
+bool
+performer::handle_input_event (midi::event & ev)
+{
 #if defined USE_EXPERIMENTAL_CODE
 
-                /*
-                 * EXPERIMENTAL: start playing on first event. This causes
-                 * a barrage of notes!
-                 */
+    /*
+     * EXPERIMENTAL: start playing on first event. This causes
+     * a barrage of notes!
+     */
 
-                if (! is_pattern_playing())         /* ! is_running()       */
-                    inner_start();                  /* start_playing()      */
+    if (! is_pattern_playing())         /* ! is_running()       */
+        inner_start();                  /* start_playing()      */
 #endif
 
-                if (ev.below_sysex())                       /* below 0xF0   */
+    if (ev.below_sysex())                       /* below 0xF0   */
+    {
+        if (m_master_bus->is_dumping())         /* see banner   */
+        {
+            if (midi_control_event(ev, true))   /* quick check  */
+            {
+                // No code at this time
+            }
+            else
+            {
+                ev.set_timestamp(get_tick());
+                if (record_by_buss())
                 {
-                    if (m_master_bus->is_dumping())         /* see banner   */
-                    {
-                        if (midi_control_event(ev, true))   /* quick check  */
-                        {
-                            // No code at this time
-                        }
-                        else
-                        {
-                            ev.set_timestamp(get_tick());
-                            if (record_by_buss())
-                            {
-                                sequence * sp = sequence_inbus_lookup(ev);
-
-                                /*
-                                 * mastermidibase::m_seq is not ever set here.
-                                 *
-                                 * if (is_nullptr(sp))
-                                 *    sp = m_master_bus->get_sequence();
-                                 */
-
-                                if (not_nullptr(sp))
-                                    sp->stream_event(ev);
+                    sequence * sp = sequence_inbus_lookup(ev);
+
+                    /*
+                     * mastermidibase::m_seq is not ever set here.
+                     *
+                     * if (is_nullptr(sp))
+                     *    sp = m_master_bus->get_sequence();
+                     */
+
+                    if (not_nullptr(sp))
+                        sp->stream_event(ev);
 #if defined PLATFORM_DEBUG
-                                else
-                                    warn_message("no buss-recording pattern");
+                    else
+                        warn_message("no buss-recording pattern");
 #endif
-                            }
-                            else if (record_by_channel())
-                            {
+                }
+                else if (record_by_channel())
+                {
 #if defined PLATFORM_DEBUG
-                                if (! m_master_bus->dump_midi_input(ev))
-                                    warn_message("no matching channel");
+                    if (! m_master_bus->dump_midi_input(ev))
+                        warn_message("no matching channel");
 #else
-                                (void)m_master_bus->dump_midi_input(ev);
+                    (void)m_master_bus->dump_midi_input(ev);
 #endif
-                            }
-                            else
-                            {
-                                sequence * sp = m_master_bus->get_sequence();
-                                if (not_nullptr(sp))
-                                    sp->stream_event(ev);
-#if defined PLATFORM_DEBUG
-                                else
-                                    error_message("no active pattern");
-#endif
-                            }
-                        }
-                    }
-                    else
-                        (void) midi_control_event(ev);
                 }
-                else if (ev.is_midi_start())
-                {
-                    midi_start();
-                }
-                else if (ev.is_midi_continue())
-                {
-                    midi_continue();
-                }
-                else if (ev.is_midi_stop())
-                {
-                    midi_stop();
-                }
-                else if (ev.is_midi_clock())
-                {
-                    midi_clock();
-                }
-                else if (ev.is_midi_song_pos())
+                else
                 {
-                    midi_song_pos(ev);
+                    sequence * sp = m_master_bus->get_sequence();
+                    if (not_nullptr(sp))
+                        sp->stream_event(ev);
+#if defined PLATFORM_DEBUG
+                    else
+                        error_message("no active pattern");
+#endif
                 }
-                else if (ev.is_tempo())             /* added for issue #76  */
-                {
-                    /*
-                     * Should we do this only if JACK transport is not
-                     * enabled?
-                     */
+            }
+        }
+        else
+            (void) midi_control_event(ev);
+    }
+    else if (ev.is_midi_start())
+    {
+        midi_start();
+    }
+    else if (ev.is_midi_continue())
+    {
+        midi_continue();
+    }
+    else if (ev.is_midi_stop())
+    {
+        midi_stop();
+    }
+    else if (ev.is_midi_clock())
+    {
+        midi_clock();
+    }
+    else if (ev.is_midi_song_pos())
+    {
+        midi_song_pos(ev);
+    }
+    else if (ev.is_tempo())             /* added for issue #76  */
+    {
+        /*
+         * Should we do this only if JACK transport is not
+         * enabled?
+         */
 
-                    if (is_jack_master() || ! is_jack_running())
-                        (void) set_beats_per_minute(ev.tempo());
-                }
-                else if (ev.is_sysex())
-                {
-                    midi_sysex(ev);
-                }
+        if (is_jack_master() || ! is_jack_running())
+            (void) set_beats_per_minute(ev.tempo());
+    }
+    else if (ev.is_sysex())
+    {
+        midi_sysex(ev);
+    }
 #if defined USE_ACTIVE_SENSE_AND_RESET
-                else if (ev.is_sense_reset())
-                {
-                    return false;                   /* see note in banner   */
-                }
+    else if (ev.is_sense_reset())
+    {
+        return false;                   /* see note in banner   */
+    }
 #endif
-                else
-                {
-                    /* ignore the event */
-                }
+    else
+    {
+        /* ignore the event */
+    }
+    return true;
+}
+
+/**
+ *  Starts recording incoming MIDI events to a capture file.  Every event
+ *  read by poll_cycle() is written with its bus and arrival time, before it
+ *  is handled.
+ */
+
+bool
+performer::start_input_capture (const std::string & filename)
+{
+    bool result = m_input_capture.open_for_capture(filename);
+    if (! result)
+        file_error("Cannot capture input to", filename);
+
+    return result;
+}
+
+void
+performer::stop_input_capture ()
+{
+    if (m_input_capture.capturing())
+        m_input_capture.close();
+}
+
+/**
+ *  Feeds a captured input session back through handle_input_event(), the
+ *  same path the input thread uses, so that a bug seen live can be
+ *  reproduced and latency regressions can be measured without hardware.
+ *
+ * \param filename
+ *      The file written by start_input_capture().
+ *
+ * \param realtime
+ *      If true, each event is delivered at its original offset from the
+ *      start of the replay, and the lateness of each delivery is measured.
+ *      If false, events are delivered as fast as possible, which measures
+ *      throughput.
+ *
+ * \param [out] report
+ *      Receives the timing report: event count, throughput, and the
+ *      distribution of lateness and service time, in microseconds.
+ *
+ * \return
+ *      Returns true if the file could be opened and at least one event was
+ *      replayed.
+ */
+
+bool
+performer::replay_input
+(
+    const std::string & filename,
+    bool realtime,
+    std::string & report
+)
+{
+    midi::inputlog replay;
+    bool result = replay.open_for_replay(filename);
+    if (result)
+    {
+        midi::replaystats stats;
+        midi::event ev;
+        std::uint64_t offset_us;
+        stats.start();
+
+        std::uint64_t start_us = midi::inputlog::now_us();
+        while (replay.next(ev, offset_us))
+        {
+            std::uint64_t due_us = start_us + offset_us;
+            std::uint64_t now_us = midi::inputlog::now_us();
+            if (realtime && due_us > now_us)
+            {
+                std::this_thread::sleep_for
+                (
+                    std::chrono::microseconds(due_us - now_us)
+                );
+                now_us = midi::inputlog::now_us();
             }
-        } while (m_master_bus->is_more_input());
+
+            std::uint64_t late_us = realtime && now_us > due_us ?
+                now_us - due_us : 0 ;
+
+            bool ok = handle_input_event(ev);
+            stats.add(late_us, midi::inputlog::now_us() - now_us);
+            if (! ok)
+                break;
+        }
+        stats.finish();
+        report = stats.report();
+        result = stats.count() > 0;
     }
+    else
+        file_error("Cannot replay input from", filename);
+
     return result;
 }
 
@@ -5603,6 +5757,27 @@ performer::count_exportable () const
     return result;
 }
 
+/**
+ *  Totals the memory held by the whole song: every pattern in every set
+ *  (events, message payloads, undo/redo history, and triggers), plus the
+ *  shared event clipboard and the play-lists.  It does not copy anything,
+ *  and so can be polled once a second by a status display.
+ *
+ * \return
+ *      Returns the accumulated memory usage.
+ */
+
+midi::memusage
+performer::memory_usage () const
+{
+    midi::memusage result = set_mapper().memory_usage();
+    sequence::clipboard_usage(result);
+    if (m_play_list)
+        m_play_list->memory_usage(result);
+
+    return result;
+}
+
 /**
  *  Seq66 can split an SMF 0 file into multiple tracks, effectively converting
  *  it to SMF 1, via midi_splitter.  This function performers the opposite
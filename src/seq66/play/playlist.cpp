@@ -147,6 +147,32 @@ playlist::validated () const
     return result;
 }
 
+/**
+ *  Adds the storage of the play-lists and their song lists to the memory
+ *  accounting, as "other".  Map nodes are estimated by the size of their
+ *  value types; the strings are counted by capacity.
+ */
+
+void
+playlist::memory_usage (midi::memusage & mu) const
+{
+    std::size_t bytes = 0;
+    for (const auto & plpair : m_play_lists)
+    {
+        const play_list_t & pl = plpair.second;
+        bytes += sizeof(plpair) + pl.ls_list_name.capacity() +
+            pl.ls_file_directory.capacity();
+
+        for (const auto & sci : pl.ls_song_list)
+        {
+            const song_spec_t & s = sci.second;
+            bytes += sizeof(sci) + s.ss_song_directory.capacity() +
+                s.ss_filename.capacity();
+        }
+    }
+    mu.add_other(bytes);
+}
+
 /**
  *  Used (only) in the user interface to validate that usable playlist data is
  *  present and to activate the playlist.
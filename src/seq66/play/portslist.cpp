@@ -141,6 +141,7 @@ portslist::add
         ioitem.out_clock = int_to_clock(status);
         ioitem.io_name = name;
         ioitem.io_alias = alias;
+        ioitem.io_latency_us = 0;
         result = add(bussno, ioitem, nickname);
     }
     return result;
@@ -261,6 +262,26 @@ portslist::set_alias (midi::bussbyte bussno, const std::string & alias)
         it->second.io_alias = alias;
 }
 
+/**
+ *  Sets the output latency of the buss, in microseconds, for latency
+ *  compensation.  See midi::busarray::compensate_latency().
+ */
+
+void
+portslist::set_latency (midi::bussbyte bussno, long us)
+{
+    auto it = m_master_io.find(bussno);
+    if (it != m_master_io.end())
+        it->second.io_latency_us = us > 0 ? us : 0 ;
+}
+
+long
+portslist::get_latency (midi::bussbyte bussno) const
+{
+    auto it = m_master_io.find(bussno);
+    return it != m_master_io.end() ? it->second.io_latency_us : 0 ;
+}
+
 static std::string
 buss_string (const std::string & name, midi::bussbyte bussno)
 {
@@ -815,6 +836,40 @@ portslist::parse_port_line
     return result;
 }
 
+/**
+ *  Static function to get the optional latency setting from a port line.
+ *  It follows the quoted port name, and comes before any comment:
+ *
+ *      0  1   "fluidsynth:midi_00"                latency=2500
+ *
+ * \return
+ *      Returns the latency in microseconds, or 0 if not present.
+ */
+
+long
+portslist::parse_port_latency (const std::string & line)
+{
+    static const std::string s_tag = "latency=";
+    long result = 0;
+    tokenization tokens = tokenize_quoted(line);
+    for (std::size_t i = 3; i < tokens.size(); ++i)
+    {
+        const std::string & t = tokens[i];
+        if (! t.empty() && t[0] == '#')
+            break;
+
+        if (t.compare(0, s_tag.size(), s_tag) == 0)
+        {
+            result = long(string_to_int(t.substr(s_tag.size())));
+            if (result < 0)
+                result = 0;
+
+            break;
+        }
+    }
+    return result;
+}
+
 /**
  *  Static function to test an io object for validity.  To be valid it must
  *  have a non-empty io_name field.
@@ -829,8 +884,8 @@ portslist::valid (const io & item)
 /**
  *  This virtual base-class function writes a port line (for the 'rc' file)
  *  from a clockslist or inputslist.  The line consists of two integers,
- *  followed by the quoted port name, and optionally followed by the alias,
- *  shown as a comment.
+ *  followed by the quoted port name, optionally followed by a latency
+ *  setting, and optionally followed by the alias, shown as a comment.
  */
 
 std::string
@@ -839,10 +894,14 @@ portslist::io_line
     int portnumber,
     int status,
     const std::string & portname,
-    const std::string & portalias
+    const std::string & portalias,
+    long latency
 ) const
 {
     std::string name = add_quotes(portname);
+    if (latency > 0)
+        name += "  latency=" + std::to_string(latency);
+
     char tmp[128];
     if (portalias.empty())
     {
@@ -77,7 +77,8 @@ screenset::screenset (screenset::number setnum, int rows, int columns) :
     m_set_maximum       (m_set_offset + m_set_size),
     m_set_name          ("empty"),          /* usable() ? "New" : "Empty"   */
     m_is_playscreen     (false),
-    m_sequence_high     (0)
+    m_sequence_high     (0),
+    m_changes           ()
 {
     clear();
 }
@@ -104,15 +105,80 @@ screenset::change_set_number (screenset::number setno)
 
         ++seq_offset;
     }
+    m_changes->bump_all();
 }
 
 void
 screenset::clear ()
 {
     seq emptyseq;
+    for (auto & s : m_container)
+    {
+        if (s.active())
+            s.loop()->change_board(nullptr, -1);
+    }
     m_container.clear();
     for (int s = 0; s < m_set_size; ++s)
         m_container.push_back(emptyseq);
+
+    if (m_changes && m_changes->slot_count() == m_set_size)
+        m_changes->bump_all();
+    else
+        m_changes = std::make_shared<changes>(m_set_size);
+}
+
+/**
+ *  Adds the memory used by each active pattern in this set to the
+ *  accounting object.  Inactive slots hold no sequence and add nothing.
+ */
+
+void
+screenset::memory_usage (midi::memusage & mu) const
+{
+    for (const auto & s : m_container)
+    {
+        if (s.active())
+            s.loop()->memory_usage(mu);
+    }
+}
+
+/**
+ *  Moves the idle patterns of this set into cold storage.  See
+ *  sequence::make_cold().
+ *
+ * \return
+ *      Returns the number of patterns packed.
+ */
+
+int
+screenset::make_cold ()
+{
+    int result = 0;
+    for (auto & s : m_container)
+    {
+        if (s.active() && s.loop()->make_cold())
+            ++result;
+    }
+    return result;
+}
+
+/**
+ *  Brings all patterns of this set out of cold storage.
+ *
+ * \return
+ *      Returns the number of patterns unpacked.
+ */
+
+int
+screenset::make_warm ()
+{
+    int result = 0;
+    for (auto & s : m_container)
+    {
+        if (s.active() && s.loop()->make_warm())
+            ++result;
+    }
+    return result;
 }
 
 void
@@ -160,6 +226,7 @@ screenset::add (sequence * s, seq::number & seqno)
                 if (result)
                 {
                     m_container[i] = sseq;
+                    s->change_board(m_changes, i);
                     break;
                 }
             }
@@ -189,8 +256,11 @@ screenset::remove (seq::number seqno)
     if (sp && ! sp->seq_in_edit())
     {
         seq newseq;                         /* non-functional pattern       */
+        int slot = seqno - offset();
         sp->set_armed(false);               /* turns off all notes as well  */
-        m_container[seqno - offset()] = newseq;
+        sp->change_board(nullptr, -1);
+        m_container[slot] = newseq;
+        m_changes->bump(slot);              /* consumers see the removal    */
         result = true;
     }
     return result;
@@ -386,15 +456,29 @@ screenset::armed () const
     return false;
 }
 
+/**
+ *  Checks the set epoch against the one the caller saw last.  This used
+ *  to walk the slots calling is_dirty_main(), which cleared the flag that
+ *  the user-interface also polls.  Consumers that need to know which
+ *  slots changed should keep their own changes::cursor and call
+ *  changed_slots() instead.
+ *
+ * \param [inout] seen
+ *      The caller's own copy of the set epoch.  Each consumer keeps one,
+ *      so that one consumer's check never hides a change from another.
+ *      It is updated to the current epoch.
+ *
+ * \return
+ *      Returns true if the set changed since the caller's last check.
+ */
+
 bool
-screenset::needs_update () const
+screenset::needs_update (changes::epoch & seen) const
 {
-    for (auto & s : m_container)
-    {
-        if (s.active() && s.loop()->is_dirty_main())
-            return true;
-    }
-    return false;
+    changes::epoch e = m_changes->set_epoch();
+    bool result = e != seen;
+    seen = e;
+    return result;
 }
 
 /**
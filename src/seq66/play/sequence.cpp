@@ -48,6 +48,7 @@
  *      point, and add better locking coverage if necessary.
  */
 
+#include <algorithm>                    /* std::lower_bound()               */
 #include <cstring>                      /* std::memset()                    */
 #include <cmath>                        /* std::trunc()                     */
 
@@ -101,6 +102,13 @@ static const double c_measure_max   = 1000.00;
 
 int sequence::sm_fingerprint_size   = 0;
 
+/*
+ * Members for the horizon scheduler.  See setmapper::play_all_sets().
+ */
+
+std::atomic<std::uint64_t> sequence::sm_schedule_epoch { 0 };
+std::atomic<midi::pulse> sequence::sm_frame_tick { 0 };
+
 /*
  * Member for convenience.
  */
@@ -147,6 +155,7 @@ sequence::note_info::show () const
 sequence::sequence (int ppqn) :
     m_parent                    (nullptr),      /* set when seq installed   */
     m_events                    (),
+    m_dormant                   (false),
     m_triggers                  (*this),
     m_time_signatures           (),
     m_events_undo_hold          (),
@@ -166,6 +175,7 @@ sequence::sequence (int ppqn) :
     m_notes_on                  (0),
     m_master_bus                (nullptr),
     m_playing_notes             (),
+    m_output_map                (),
     m_armed                     (false),
     m_recording                 (false),
     m_draw_locked               (false),
@@ -189,6 +199,8 @@ sequence::sequence (int ppqn) :
     m_dirty_edit                (true),
     m_dirty_perf                (true),
     m_dirty_names               (true),
+    m_change_epochs             (),
+    m_change_link               (),
     m_is_modified               (false),
     m_seq_in_edit               (false),
     m_status                    (0),
@@ -221,11 +233,17 @@ sequence::sequence (int ppqn) :
 {
     sm_preserve_velocity = usr().preserve_velocity();
     sm_fingerprint_size = usr().fingerprint_size();
-    m_events.set_length(m_length);
+    events().set_length(m_length);
     m_triggers.set_ppqn(int(m_ppqn));
     m_triggers.set_length(m_length);
-    for (auto & p : m_playing_notes)            /* no notes playing now     */
-        p = 0;
+    m_playing_notes.clear();                    /* no notes playing now     */
+
+    for (auto & e : m_change_epochs)
+        e.store(0);
+
+    m_output_map.om_transpose = (-1);           /* force the first build    */
+    update_output_map();
+    update_output_transpose(0);
 }
 
 /**
@@ -382,9 +400,9 @@ sequence::partial_assign (const sequence & rhs, bool toclipboard)
         m_musical_key               = rhs.m_musical_key;
         m_musical_scale             = rhs.m_musical_scale;
         m_background_sequence       = rhs.m_background_sequence;
-        for (auto & p : m_playing_notes)            /* no notes playing now */
-            p = 0;
+        m_playing_notes.clear();                    /* no notes playing now */
 
+        update_output_map();
         m_last_tick = 0;                            /* reset to tick 0      */
         verify_and_link();                          /* NoteOn <---> NoteOff */
         if (! toclipboard)
@@ -535,8 +553,8 @@ bool
 sequence::clear_events ()
 {
     xpc::automutex locker(m_mutex);
-    bool result = ! m_events.empty();
-    m_events.clear();
+    bool result = ! events().empty();
+    events().clear();
     if (result)
         modify();                                   /* have pending changes */
 
@@ -558,14 +576,14 @@ int
 sequence::event_count () const
 {
     xpc::automutex locker(m_mutex);
-    return m_events.count();
+    return events().count();
 }
 
 int
 sequence::note_count () const
 {
     xpc::automutex locker(m_mutex);
-    return m_events.note_count();
+    return events().note_count();
 }
 
 /**
@@ -576,21 +594,21 @@ bool
 sequence::first_notes (midi::pulse & ts, int & n) const
 {
     xpc::automutex locker(m_mutex);
-    return m_events.first_notes(ts, n, m_snap_tick);
+    return events().first_notes(ts, n, m_snap_tick);
 }
 
 int
 sequence::playable_count () const
 {
     xpc::automutex locker(m_mutex);
-    return m_events.playable_count();
+    return events().playable_count();
 }
 
 bool
 sequence::is_playable () const
 {
     xpc::automutex locker(m_mutex);
-    return m_events.is_playable();
+    return events().is_playable();
 }
 
 /*-------------------------------------------------------------------------
@@ -954,7 +972,7 @@ sequence::push_undo (bool hold)
     if (hold)
         m_events_undo.push(m_events_undo_hold);     /* stazed   */
     else
-        m_events_undo.push(m_events);
+        m_events_undo.push(events());
 
     set_have_undo();                                /* stazed   */
 }
@@ -990,9 +1008,8 @@ sequence::pop_undo ()
     xpc::automutex locker(m_mutex);
     if (! m_events_undo.empty())
     {
-        m_events_redo.push(m_events);
-        m_events = m_events_undo.top();
-        m_events_undo.pop();
+        m_events_redo.push(events());
+        (void) m_events_undo.pop(events());
         verify_and_link();
         unselect();
     }
@@ -1015,9 +1032,8 @@ sequence::pop_redo ()
     xpc::automutex locker(m_mutex);
     if (! m_events_redo.empty())                // move to triggers module?
     {
-        m_events_undo.push(m_events);
-        m_events = m_events_redo.top();
-        m_events_redo.pop();
+        m_events_undo.push(events());
+        (void) m_events_redo.pop(events());
         verify_and_link();
         unselect();
     }
@@ -1025,6 +1041,95 @@ sequence::pop_redo ()
     set_have_redo();
 }
 
+/**
+ *  Adds the memory held by this pattern to the accounting object: the live
+ *  events and their payloads, the triggers with their undo history, and
+ *  the event-list copies held in the undo, redo, and undo-hold lists.
+ *  Nothing is copied, so this is cheap enough to poll from a status timer.
+ *
+ * \threadsafe
+ *
+ * \param [out] mu
+ *      The accounting object to be incremented.
+ */
+
+void
+sequence::memory_usage (midi::memusage & mu) const
+{
+    xpc::automutex locker(m_mutex);
+    m_events.memory_usage(mu);
+    m_triggers.memory_usage(mu);
+    m_events_undo.memory_usage(mu);
+    m_events_redo.memory_usage(mu);
+    if (! m_events_undo_hold.empty())
+    {
+        midi::memusage h;
+        m_events_undo_hold.memory_usage(h);
+        mu.add_as_undo(h);
+    }
+}
+
+/**
+ *  Moves the events into cold storage, if this pattern is idle.  A pattern
+ *  is idle if it is not armed, not recording, not open in an editor, and
+ *  has no triggers (song-mode playback would need its events at any time).
+ *  The events are packed and the event-list storage is released.
+ *
+ * \threadsafe
+ *
+ * \return
+ *      Returns true if the pattern was made cold.
+ */
+
+bool
+sequence::make_cold ()
+{
+    xpc::automutex locker(m_mutex);
+    bool result = ! is_cold() && ! armed() && ! recording() &&
+        ! seq_in_edit() && trigger_count() == 0;
+
+    if (result)
+        result = m_events.make_cold();
+
+    return result;
+}
+
+/**
+ *  Brings the events back from cold storage.  Usually not needed, since
+ *  events() does it on demand, but the setmapper calls it to unpack a set
+ *  ahead of time.
+ *
+ * \threadsafe
+ *
+ * \return
+ *      Returns true if the pattern was cold and was unpacked.
+ */
+
+bool
+sequence::make_warm ()
+{
+    xpc::automutex locker(m_mutex);
+    bool cold = is_cold();
+    bool result = m_events.make_warm();
+    if (cold && ! result)
+        error_message("Cold storage unpack failed", name());
+
+    return result;
+}
+
+/**
+ *  Adds the event clipboard shared by all sequences.  It is counted as
+ *  "other", and should be counted once per application, not per pattern.
+ */
+
+void
+sequence::clipboard_usage (midi::memusage & mu)
+{
+    midi::memusage c;
+    sm_clipboard.memory_usage(c);
+    mu.add_other(c.total_bytes());
+}
+
 /**
  *  Calls triggers::push_undo() with locking.
  *
@@ -1444,7 +1549,7 @@ sequence::toggle_queued ()
     printf("seq %d: queuing %s\n", int(seq_number()), m_queued ? "on" : "off");
 #endif
 
-    m_queued_tick = m_last_tick - mod_last_tick() + get_length();
+    m_queued_tick = last_tick() - mod_last_tick() + get_length();
     off_from_snap(true);
     perf()->announce_pattern(seq_number());     /* for issue #89        */
     return true;
@@ -1577,8 +1682,11 @@ sequence::play
         if (transpose == 0)
             transpose = transposable() ? perf()->get_transpose() : 0 ;
 
-        auto e = m_events.begin();
-        while (e != m_events.end())
+        update_output_transpose(transpose);         /* rarely rebuilds      */
+
+        int sent = 0;                               /* flush once, at end   */
+        auto e = events().begin();
+        while (e != events().end())
         {
 #if defined USE_NULL_EVENT_DETECTION
 
@@ -1595,37 +1703,24 @@ sequence::play
             midi::pulse stamp = ts + offset_base;
             if (stamp >= start_tick_offset && stamp <= end_tick_offset)
             {
-                if (transpose != 0 && er.is_note()) /* includes Aftertouch  */
+                if (er.is_tempo())
                 {
-                    event trans_event = er;         /* assign ALL members   */
-                    trans_event.transpose_note(transpose);
-                    put_event_on_bus(trans_event);
+                    perf()->set_beats_per_minute(er.tempo());
                 }
                 else
                 {
-                    if (er.is_tempo())
-                    {
-                        perf()->set_beats_per_minute(er.tempo());
-                    }
-                    else
-                    {
-                        if (er.is_ex_data())
-                        {
-                            if (er.is_sysex())          /* EXPERIMENTAL     */
-                                put_event_on_bus(er);   /* ca 2024-05-22    */
-                        }
-                        else
-                            put_event_on_bus(er);   /* frame still going    */
-                    }
+                    bool send = ! er.is_ex_data() || er.is_sysex();
+                    if (send && put_event_on_bus(er, true, false))
+                        ++sent;                     /* frame still going    */
                 }
             }
             else if (stamp > end_tick_offset)
                 break;                              /* frame is done        */
 
             ++e;                                    /* go to next event     */
-            if (e == m_events.end())                /* did we hit the end ? */
+            if (e == events().end())                /* did we hit the end ? */
             {
-                e = m_events.begin();               /* yes, start over      */
+                e = events().begin();               /* yes, start over      */
                 offset_base += length;              /* for another go at it */
 
                 /*
@@ -1638,6 +1733,8 @@ sequence::play
                 (void) microsleep(1);
             }
         }
+        if (sent > 0)
+            master_bus()->flush();
     }
     else
     {
@@ -1700,8 +1797,9 @@ sequence::live_play (midi::pulse tick)
             }
         }
 
-        auto e = m_events.begin();
-        while (e != m_events.end())
+        int sent = 0;
+        auto e = events().begin();
+        while (e != events().end())
         {
             event & er = eventlist::dref(e);
             midi::pulse stamp = er.timestamp() + offset_base;
@@ -1713,19 +1811,22 @@ sequence::live_play (midi::pulse tick)
                     perf()->set_beats_per_minute(er.tempo());
                 }
 #endif
-                put_event_on_bus(er);               /* frame still going    */
+                if (put_event_on_bus(er, true, false))
+                    ++sent;                         /* frame still going    */
             }
             else if (stamp > end_tick_offset)
                 break;                              /* frame is done        */
 
             ++e;                                    /* go to next event     */
-            if (e == m_events.end())                /* did we hit the end ? */
+            if (e == events().end())                /* did we hit the end ? */
             {
-                e = m_events.begin();               /* yes, start over      */
+                e = events().begin();               /* yes, start over      */
                 offset_base += length;              /* for another go at it */
                 (void) microsleep(1);
             }
         }
+        if (sent > 0)
+            master_bus()->flush();
     }
     m_last_tick = end_tick + 1;                     /* for next frame       */
 }
@@ -1745,7 +1846,7 @@ void
 sequence::verify_and_link (bool wrap)
 {
     xpc::automutex locker(m_mutex);
-    m_events.verify_and_link(get_length(), wrap);
+    events().verify_and_link(get_length(), wrap);
 }
 
 /**
@@ -1758,8 +1859,8 @@ bool
 sequence::edge_fix ()
 {
     xpc::automutex locker(m_mutex);
-    m_events_undo.push(m_events);                   /* push_undo(), no lock */
-    bool result = m_events.edge_fix(snap(), get_length());
+    m_events_undo.push(events());                   /* push_undo(), no lock */
+    bool result = events().edge_fix(snap(), get_length());
     if (result)
         modify();
 
@@ -1774,8 +1875,8 @@ bool
 sequence::remove_unlinked_notes ()
 {
     xpc::automutex locker(m_mutex);
-    m_events_undo.push(m_events);                   /* push_undo(), no lock */
-    bool result = m_events.remove_unlinked_notes();
+    m_events_undo.push(events());                   /* push_undo(), no lock */
+    bool result = events().remove_unlinked_notes();
     if (result)
         modify();
 
@@ -1790,7 +1891,7 @@ sequence::remove_unlinked_notes ()
 void
 sequence::link_new ()
 {
-    m_events.link_new();
+    events().link_new();
 }
 
 #if defined USE_SEQUENCE_REMOVE_EVENTS
@@ -1814,15 +1915,12 @@ sequence::link_new ()
 void
 sequence::remove (event::buffer::iterator evi)
 {
-    if (evi != m_events.end())
+    if (evi != events().end())
     {
         event & er = eventlist::dref(evi);
-        if (er.is_note_off() && m_playing_notes[er.get_note()] > 0)
-        {
-            master_bus()->play_and_flush(m_true_bus, &er, midi_channel(er));
-            --m_playing_notes[er.get_note()];
-        }
-        if (m_events.remove(evi))
+        if (er.is_note_off())
+            (void) put_event_on_bus(er);        /* only if it is sounding   */
+        if (events().remove(evi))
             modify();
     }
 }
@@ -1848,7 +1946,7 @@ sequence::remove (event::buffer::iterator evi)
 void
 sequence::remove (event & e)
 {
-    if (m_events.remove_event(e))
+    if (events().remove_event(e))
         modify();
 }
 
@@ -1862,7 +1960,7 @@ bool
 sequence::remove_first_match (const event & e, midi::pulse starttick)
 {
     xpc::automutex locker(m_mutex);
-    return m_events.remove_first_match(e, starttick);
+    return events().remove_first_match(e, starttick);
 }
 
 /**
@@ -1873,8 +1971,8 @@ void
 sequence::remove_all ()
 {
     xpc::automutex locker(m_mutex);
-    int count = m_events.count();
-    m_events.clear();
+    int count = events().count();
+    events().clear();
     if (count > 0)
         modify();                       /* issue #90 */
 }
@@ -1894,13 +1992,13 @@ bool
 sequence::remove_marked ()
 {
     xpc::automutex locker(m_mutex);
-    for (auto & e : m_events)
+    for (auto & e : events())
     {
         if (e.is_marked() && e.is_note_on())
             play_note_off(int(e.get_note()));
     }
 
-    bool result = m_events.remove_marked();
+    bool result = events().remove_marked();
     if (result)
         modify();
 
@@ -1920,7 +2018,7 @@ bool
 sequence::mark_selected ()
 {
     xpc::automutex locker(m_mutex);
-    return m_events.mark_selected();
+    return events().mark_selected();
 }
 
 /**
@@ -1936,9 +2034,9 @@ bool
 sequence::remove_selected ()
 {
     xpc::automutex locker(m_mutex);
-    m_events_undo.push(m_events);               /* push_undo() without lock */
+    m_events_undo.push(events());               /* push_undo() without lock */
 
-    bool result = m_events.remove_selected();
+    bool result = events().remove_selected();
     if (result)
         modify();
 
@@ -1955,7 +2053,7 @@ void
 sequence::unpaint_all ()
 {
     xpc::automutex locker(m_mutex);
-    m_events.unpaint_all();
+    events().unpaint_all();
 }
 
 /**
@@ -1990,7 +2088,7 @@ sequence::selected_box
     tick_s = m_maxbeats * m_ppqn;
     tick_f = note_h = 0;
     note_l = c_midi::byte_data_max;
-    for (auto & e : m_events)
+    for (auto & e : events())
     {
         result = true;
         if (e.is_selected())
@@ -2047,7 +2145,7 @@ sequence::onsets_selected_box
     tick_s = m_maxbeats * m_ppqn;
     tick_f = note_h = 0;
     note_l = c_midi::byte_data_max;
-    for (auto & e : m_events)
+    for (auto & e : events())
     {
         if (e.is_selected_note_on())
         {
@@ -2151,7 +2249,7 @@ int
 sequence::get_num_selected_notes () const
 {
     xpc::automutex locker(m_mutex);
-    return m_events.count_selected_notes();
+    return events().count_selected_notes();
 }
 
 /**
@@ -2175,7 +2273,7 @@ int
 sequence::get_num_selected_events (midi::byte status, midi::byte cc) const
 {
     xpc::automutex locker(m_mutex);
-    return m_events.count_selected_events(status, cc);
+    return events().count_selected_events(status, cc);
 }
 
 /**
@@ -2220,7 +2318,7 @@ sequence::select_note_events
 )
 {
     xpc::automutex locker(m_mutex);
-    return m_events.select_note_events(tick_s, note_h, tick_f, note_l, action);
+    return events().select_note_events(tick_s, note_h, tick_f, note_l, action);
 }
 
 /**
@@ -2260,7 +2358,7 @@ sequence::select_events
 )
 {
     xpc::automutex locker(m_mutex);
-    return m_events.select_events(tick_s, tick_f, status, cc, action);
+    return events().select_events(tick_s, tick_f, status, cc, action);
 }
 
 /**
@@ -2292,7 +2390,7 @@ sequence::select_events (midi::byte status, midi::byte cc, bool inverse)
 {
     xpc::automutex locker(m_mutex);
     midi::byte d0, d1;
-    for (auto & er : m_events)
+    for (auto & er : events())
     {
         er.get_data(d0, d1);
         bool match = er.match_status(status);
@@ -2326,7 +2424,7 @@ sequence::select_event_handle
 )
 {
     xpc::automutex locker(m_mutex);
-    int result = m_events.select_event_handle
+    int result = events().select_event_handle
     (
         tick_s, tick_f, astatus, cc, data
     );
@@ -2344,7 +2442,7 @@ void
 sequence::select_all ()
 {
     xpc::automutex locker(m_mutex);
-    m_events.select_all();
+    events().select_all();
 }
 
 void
@@ -2353,7 +2451,7 @@ sequence::select_by_channel (int channel)
     if (is_good_channel(midi::byte(channel)))
     {
         xpc::automutex locker(m_mutex);
-        m_events.select_by_channel(channel);
+        events().select_by_channel(channel);
     }
 }
 
@@ -2363,7 +2461,7 @@ sequence::select_notes_by_channel (int channel)
     if (is_good_channel(midi::byte(channel)))
     {
         xpc::automutex locker(m_mutex);
-        m_events.select_notes_by_channel(channel);
+        events().select_notes_by_channel(channel);
     }
 }
 
@@ -2377,7 +2475,7 @@ void
 sequence::unselect ()
 {
     xpc::automutex locker(m_mutex);
-    m_events.unselect_all();
+    events().unselect_all();
 }
 
 /**
@@ -2428,8 +2526,8 @@ bool
 sequence::move_selected_notes (midi::pulse delta_tick, int delta_note)
 {
     xpc::automutex locker(m_mutex);
-    m_events_undo.push(m_events);                  /* push_undo(), no lock */
-    bool result = m_events.move_selected_notes(delta_tick, delta_note);
+    m_events_undo.push(events());                  /* push_undo(), no lock */
+    bool result = events().move_selected_notes(delta_tick, delta_note);
     if (result)
         modify();
 
@@ -2440,8 +2538,8 @@ bool
 sequence::move_selected_events (midi::pulse delta_tick)
 {
     xpc::automutex locker(m_mutex);
-    m_events_undo.push(m_events);                  /* push_undo(), no lock */
-    bool result = m_events.move_selected_events(delta_tick);
+    m_events_undo.push(events());                  /* push_undo(), no lock */
+    bool result = events().move_selected_events(delta_tick);
     if (result)
         modify();
 
@@ -2463,8 +2561,8 @@ bool
 sequence::stretch_selected (midi::pulse delta_tick)
 {
     xpc::automutex locker(m_mutex);
-    m_events_undo.push(m_events);           /* push_undo(), no lock  */
-    bool result = m_events.stretch_selected(delta_tick);
+    m_events_undo.push(events());           /* push_undo(), no lock  */
+    bool result = events().stretch_selected(delta_tick);
     if (result)
         modify();
 
@@ -2516,9 +2614,9 @@ bool
 sequence::grow_selected (midi::pulse delta)
 {
     xpc::automutex locker(m_mutex);                  /* lock it again, dude  */
-    m_events_undo.push(m_events);               /* push_undo(), no lock */
+    m_events_undo.push(events());               /* push_undo(), no lock */
 
-    bool result = m_events.grow_selected(delta, snap());
+    bool result = events().grow_selected(delta, snap());
     if (result)
         modify();
 
@@ -2544,11 +2642,11 @@ bool
 sequence::randomize_selected (midi::byte status, int range)
 {
     xpc::automutex locker(m_mutex);
-    m_events_undo.push(m_events);               /* push_undo(), no lock  */
+    m_events_undo.push(events());               /* push_undo(), no lock  */
     if (range == (-1))
         range = usr().randomization_amount();
 
-    bool result = m_events.randomize_selected(status, range);
+    bool result = events().randomize_selected(status, range);
     if (result)
         modify();
 
@@ -2559,11 +2657,11 @@ bool
 sequence::randomize_selected_notes (int range)
 {
     xpc::automutex locker(m_mutex);
-    m_events_undo.push(m_events);               /* push_undo(), no lock  */
+    m_events_undo.push(events());               /* push_undo(), no lock  */
     if (range == (-1))
         range = usr().randomization_amount();
 
-    bool result = m_events.randomize_selected_notes(range);
+    bool result = events().randomize_selected_notes(range);
     if (result)
         modify();
 
@@ -2578,7 +2676,7 @@ bool
 sequence::jitter_notes (int jitr)
 {
     xpc::automutex locker(m_mutex);
-    bool result = m_events.jitter_notes(snap(), jitr);
+    bool result = events().jitter_notes(snap(), jitr);
     if (result)
         modify();
 
@@ -2607,7 +2705,7 @@ sequence::adjust_event_handle (midi::byte astatus, midi::byte adata)
     midi::byte datitem;
     int dataindex = event::is_two_byte_msg(astatus) ? 1 : 0 ;
     xpc::automutex locker(m_mutex);
-    for (auto & er : m_events)
+    for (auto & er : events())
     {
         if (er.is_selected_status(astatus))
         {
@@ -2665,7 +2763,7 @@ sequence::increment_selected (midi::byte astat, midi::byte /*acontrol*/)
 {
     xpc::automutex locker(m_mutex);
     bool modded = false;
-    for (auto & e : m_events)
+    for (auto & e : events())
     {
         if (e.is_selected_status(astat))   /* && er.get_control == acontrol */
         {
@@ -2713,7 +2811,7 @@ sequence::decrement_selected (midi::byte astat, midi::byte /*acontrol*/)
 {
     xpc::automutex locker(m_mutex);
     bool modded = false;
-    for (auto & e : m_events)
+    for (auto & e : events())
     {
         if (e.is_selected_status(astat))   /* && er.get_control == acontrol */
         {
@@ -2743,7 +2841,7 @@ sequence::repitch (const notemapper & nmap, bool all)
     xpc::automutex locker(m_mutex);
     bool result = false;
     push_undo();
-    for (auto & e : m_events)
+    for (auto & e : events())
     {
         if (e.is_note() && (all || e.is_selected()))
         {
@@ -2793,7 +2891,7 @@ sequence::copy_selected ()
 {
     xpc::automutex locker(m_mutex);
     eventlist clipbd;
-    bool result = m_events.copy_selected(clipbd);
+    bool result = events().copy_selected(clipbd);
     if (result)
         sm_clipboard = clipbd;
 
@@ -2884,7 +2982,7 @@ sequence::paste_selected (midi::pulse tick, int note)
     xpc::automutex locker(m_mutex);
     eventlist clipbd = sm_clipboard;            /* copy the clipboard   */
     push_undo();                                /* push undo, no lock   */
-    bool result = m_events.paste_selected(clipbd, tick, note);
+    bool result = events().paste_selected(clipbd, tick, note);
     if (result)
         modify();
 
@@ -2915,7 +3013,7 @@ sequence::merge_events (const sequence & source)
     if (result)
     {
         push_undo();                                /* push undo, no lock   */
-        result = m_events.merge(clipbd);
+        result = events().merge(clipbd);
         if (result)
             modify();
     }
@@ -2985,7 +3083,7 @@ sequence::change_event_data_range
     xpc::automutex locker(m_mutex);
     bool result = false;
     bool haveselection = any_selected_events(status, cc);
-    for (auto & er : m_events)
+    for (auto & er : events())
     {
         bool match = false;
         if (haveselection && ! er.is_selected())
@@ -3071,7 +3169,7 @@ sequence::change_event_data_relative
     xpc::automutex locker(m_mutex);
     bool result = false;
     bool haveselection = any_selected_events(status, cc);
-    for (auto & er : m_events)
+    for (auto & er : events())
     {
         bool match = false;
         if (haveselection && ! er.is_selected())
@@ -3175,8 +3273,8 @@ sequence::change_event_data_lfo
     if (usemeasure)
         dlength = double(measures_to_ticks());
 
-    m_events_undo.push(m_events);           /* experimental, seems to work  */
-    for (auto & er : m_events)
+    m_events_undo.push(events());           /* experimental, seems to work  */
+    for (auto & er : events())
     {
         bool match = false;
         if (noselection || er.is_selected())
@@ -3309,7 +3407,7 @@ sequence::fix_pattern (fixparameters & params)
         push_undo();
         if (params.fp_align_left)
         {
-            params.fp_align_left = m_events.align_left();       /* realigned?   */
+            params.fp_align_left = events().align_left();       /* realigned?   */
             if (params.fp_align_left)
                 tempefx = bit_set(tempefx, fixeffect::shifted);
             else
@@ -3317,7 +3415,7 @@ sequence::fix_pattern (fixparameters & params)
         }
         if (params.fp_reverse || params.fp_reverse_in_place)
         {
-            result = m_events.reverse_events(params.fp_reverse_in_place);
+            result = events().reverse_events(params.fp_reverse_in_place);
         }
         if (result)
         {
@@ -3330,7 +3428,7 @@ sequence::fix_pattern (fixparameters & params)
                 {
                     newscalefactor = newmeasures / double(currentbars);
                     newmeasures = trunc_measures(newmeasures);
-                    newlength = m_events.apply_time_factor
+                    newlength = events().apply_time_factor
                     (
                         newscalefactor, params.fp_save_note_length
                     );
@@ -3338,7 +3436,7 @@ sequence::fix_pattern (fixparameters & params)
             }
             else if (fixscale)
             {
-                newlength = m_events.apply_time_factor
+                newlength = events().apply_time_factor
                 (
                     newscalefactor, params.fp_save_note_length
                 );
@@ -3372,20 +3470,20 @@ sequence::fix_pattern (fixparameters & params)
 
             if (params.fp_quan_type == alteration::tighten)
             {
-                result = m_events.quantize_all_events(snap(), 2);
+                result = events().quantize_all_events(snap(), 2);
             }
             else if (params.fp_quan_type == alteration::quantize)
             {
-                result = m_events.quantize_all_events(snap(), 1);
+                result = events().quantize_all_events(snap(), 1);
             }
             if (params.fp_quan_type == alteration::jitter)
             {
-                result = m_events.jitter_notes(snap(), params.fp_jitter);
+                result = events().jitter_notes(snap(), params.fp_jitter);
             }
 #if defined SEQ66_USE_ADDED_ALTERATIONS
             if (params.fp_quan_type == alteration::random)
             {
-                m_events.select_all();                      // TODO
+                events().select_all();                      // TODO
                 result = m_events_randomize_selected_notes
                 (
                     params.fp_jitter, params.fp_jitter      // FIXME
@@ -3393,7 +3491,7 @@ sequence::fix_pattern (fixparameters & params)
             }
             if (params.fp_quan_type == alteration::notemap)
             {
-                result = m_events.jitter_notes(params.fp_jitter);   // TODO
+                result = events().jitter_notes(params.fp_jitter);   // TODO
             }
 #endif
             if (result)
@@ -3579,7 +3677,7 @@ sequence::push_add_note
     bool repaint, int velocity
 )
 {
-    m_events_undo.push(m_events);                   /* push_undo(), no lock */
+    m_events_undo.push(events());                   /* push_undo(), no lock */
     return add_painted_note(tick, len, note, repaint, velocity);
 }
 
@@ -3590,7 +3688,7 @@ sequence::push_add_chord
     int note, int velocity
 )
 {
-    m_events_undo.push(m_events);                   /* push_undo(), no lock */
+    m_events_undo.push(events());                   /* push_undo(), no lock */
     return add_chord(chord, tick, len, note, velocity);
 }
 
@@ -3752,7 +3850,7 @@ sequence::add_time_signature (midi::pulse tick, int beats, int bw)
     bool result = beats > 0 && is_power_of_2(bw);
     if (result)
     {
-        m_events_undo.push(m_events);               /* push_undo(), no lock */
+        m_events_undo.push(events());               /* push_undo(), no lock */
         event e (tick, EVENT_MIDI_META);
         midi::byte bt[4];
         bw = beat_log2(bw);                                 /* log2(bw)     */
@@ -3890,7 +3988,7 @@ bool
 sequence::add_event (const event & er)
 {
     xpc::automutex locker(m_mutex);
-    bool result = m_events.append(er);  /* no-sort insertion of event       */
+    bool result = events().append(er);  /* no-sort insertion of event       */
     if (result)
     {
         if (er.is_note_off())
@@ -3920,14 +4018,14 @@ bool
 sequence::append_event (const event & er)
 {
     xpc::automutex locker(m_mutex);
-    return m_events.append(er);     /* does *not* sort, too time-consuming  */
+    return events().append(er);     /* does *not* sort, too time-consuming  */
 }
 
 void
 sequence::sort_events ()
 {
     xpc::automutex locker(m_mutex);
-    m_events.sort();
+    events().sort();
 }
 
 event
@@ -3936,9 +4034,9 @@ sequence::find_event (const event & e, bool nextmatch)
     xpc::automutex locker(m_mutex);
     static event s_null_result{0, 0, 0};
     event::iterator evi = nextmatch ?
-        m_events.find_next_match(e) : m_events.find_first_match(e) ;
+        events().find_next_match(e) : events().find_first_match(e) ;
 
-    return evi != m_events.end() ?  *evi : s_null_result ;
+    return evi != events().end() ?  *evi : s_null_result ;
 }
 
 bool
@@ -3946,7 +4044,7 @@ sequence::remove_duplicate_events (midi::pulse tick, int note)
 {
     xpc::automutex locker(m_mutex);                  /* ca 2023-04-29    */
     bool ignore = false;
-    for (auto & er : m_events)
+    for (auto & er : events())
     {
         if (er.is_painted() && er.timestamp() == tick)
         {
@@ -4012,7 +4110,7 @@ sequence::add_event
         if (repaint)
             e.paint();
 
-        result = m_events.append(e);    /* (add_event(e) locks & verifies)  */
+        result = events().append(e);    /* (add_event(e) locks & verifies)  */
         if (result)
         {
             verify_and_link();
@@ -4099,6 +4197,7 @@ bool
 sequence::stream_event (event & ev)
 {
     xpc::automutex locker(m_mutex);
+    wake();                                     /* m_last_tick is used      */
     bool result = channels_match(ev);           /* set if channel matches   */
     if (result)
     {
@@ -4215,7 +4314,7 @@ sequence::stream_event (event & ev)
 
                         bool ok = add_note
                         (
-                            snap() - m_events.note_off_margin(), ev
+                            snap() - events().note_off_margin(), ev
                         );
                         if (ok)
                             ++m_notes_on;
@@ -4229,7 +4328,7 @@ sequence::stream_event (event & ev)
             }
         }
         if (m_thru)
-            put_event_on_bus(ev);
+            put_event_on_bus(ev, false);            /* thru not transposed  */
 
         /*
          * We don't need to link note events until a note-off comes in.
@@ -4257,20 +4356,55 @@ void
 sequence::set_dirty_mp ()
 {
     m_dirty_names = m_dirty_main = m_dirty_perf = true;
+    reschedule();
+    m_change_epochs[int(changes::kind::main)].fetch_add(1);
+    m_change_epochs[int(changes::kind::perf)].fetch_add(1);
+    m_change_epochs[int(changes::kind::names)].fetch_add(1);
+
+    std::shared_ptr<const changes::link> lk = std::atomic_load(&m_change_link);
+    if (lk)
+        lk->l_board->bump(lk->l_slot);
 }
 
 /**
  *  Call set_dirty_mp() and then sets the dirty flag for editing. Note that it
- *  does not call performer::modify().
+ *  does not call performer::modify().  The edit epoch is bumped first, so
+ *  that a consumer woken by the set epoch sees it.
  */
 
 void
 sequence::set_dirty ()
 {
+    m_change_epochs[int(changes::kind::edit)].fetch_add(1);
     set_dirty_mp();
     m_dirty_edit = true;
 }
 
+/**
+ *  Attaches this pattern to the change board of its screen-set, and bumps
+ *  the slot so that consumers see the new occupant.  The board and slot
+ *  are published with one store, so a concurrent set_dirty_mp() sees
+ *  either the old pair or the new one.
+ *
+ * \param board
+ *      The board, or a null pointer to detach the pattern.
+ *
+ * \param slot
+ *      The slot number within the set.
+ */
+
+void
+sequence::change_board (const std::shared_ptr<changes> & board, int slot)
+{
+    std::shared_ptr<const changes::link> lk;
+    if (board)
+        lk = std::make_shared<changes::link>(board, slot);
+
+    std::atomic_store(&m_change_link, lk);
+    if (board)
+        board->bump(slot);
+}
+
 /**
  *  Returns the value of the dirty names (heh heh) flag, and sets that
  *  flag to false.  Not sure that we need to lock a boolean on modern
@@ -4532,9 +4666,9 @@ sequence::intersect_notes
 )
 {
     xpc::automutex locker(m_mutex);
-    auto on = m_events.begin();
-    auto off = m_events.begin();
-    while (on != m_events.end())
+    auto on = events().begin();
+    auto off = events().begin();
+    while (on != events().end())
     {
         event & eon = eventlist::dref(on);
         if (position_note == eon.get_note() && eon.is_note_on())
@@ -4548,7 +4682,7 @@ sequence::intersect_notes
              */
 
             bool notematch = false;
-            for ( ; off != m_events.end(); ++off)
+            for ( ; off != events().end(); ++off)
             {
                 event & eoff = eventlist::dref(off);
                 if (eon.get_note() == eoff.get_note() && eoff.is_note_off())
@@ -4611,7 +4745,7 @@ sequence::intersect_events
 {
     xpc::automutex locker(m_mutex);
     midi::pulse poslength = posend - posstart;
-    for (auto & eon : m_events)
+    for (auto & eon : events())
     {
         if (eon.match_status(status))
         {
@@ -4947,7 +5081,7 @@ midi::pulse
 sequence::get_max_timestamp () const
 {
     xpc::automutex locker(m_mutex);
-    return m_events.get_max_timestamp();
+    return events().get_max_timestamp();
 }
 
 bool
@@ -5191,7 +5325,7 @@ sequence::minmax_notes (int & lowest, int & highest) // const
     bool result = false;
     int low = int(max_midi_value());
     int high = -1;
-    for (auto & er : m_events)
+    for (auto & er : events())
     {
         if (er.is_strict_note())
         {
@@ -5254,9 +5388,9 @@ sequence::get_next_note
 ) const
 {
     xpc::automutex locker(m_mutex);
-    while (evi != m_events.cend())
+    while (evi != events().cend())
     {
-        if (m_events.action_in_progress())      /* atomic boolean check     */
+        if (events().action_in_progress())      /* atomic boolean check     */
             return draw::finish;                /* bug out immediately      */
 
         draw status = get_note_info(niout, evi);
@@ -5357,8 +5491,8 @@ sequence::reset_interval
 {
     bool result = false;
     bool got_beginning = false;
-    it0 = m_events.cbegin();
-    it1 = m_events.cend();
+    it0 = events().cbegin();
+    it1 = events().cend();
     for (auto iter = cbegin(); ! cend(iter); ++iter)
     {
         midi::pulse t = iter->timestamp();
@@ -5419,10 +5553,10 @@ sequence::get_next_event
 )
 {
     xpc::automutex locker(m_mutex);
-    bool result = evi != m_events.end();
+    bool result = evi != events().end();
     if (result)
     {
-        if (m_events.action_in_progress())      /* atomic boolean check     */
+        if (events().action_in_progress())      /* atomic boolean check     */
             return false;
 
         midi::byte d1;                            /* will be ignored          */
@@ -5477,9 +5611,9 @@ sequence::get_next_event_match
 {
     xpc::automutex locker(m_mutex);
     bool ismeta = event::is_meta_msg(status);
-    while (evi != m_events.end())
+    while (evi != events().end())
     {
-        if (m_events.action_in_progress())      /* atomic boolean check     */
+        if (events().action_in_progress())      /* atomic boolean check     */
             return false;                       /* bug out immediately      */
 
         const event & drawevent = eventlist::cdref(evi);
@@ -5555,9 +5689,9 @@ sequence::get_next_meta_match
     if (range != c_null_midi::pulse)
         range += start;
 
-    while (evi != m_events.end())
+    while (evi != events().end())
     {
-        if (m_events.action_in_progress())      /* atomic boolean check     */
+        if (events().action_in_progress())      /* atomic boolean check     */
             return false;                       /* bug out immediately      */
 
         const event & drawevent = eventlist::cdref(evi);
@@ -5609,7 +5743,9 @@ sequence::set_last_tick (midi::pulse tick)
     if (is_null_midi::pulse(tick))
         tick = m_length;
 
+    m_dormant = false;
     m_last_tick = tick;
+    reschedule();
 }
 
 /**
@@ -5638,9 +5774,10 @@ sequence::get_tick () const
 midi::pulse
 sequence::get_last_tick () const
 {
+    midi::pulse lt = last_tick();
     return get_length() > 0 ?
-        (m_last_tick + get_length() - m_trigger_offset) % get_length() :
-        m_last_tick - m_trigger_offset
+        (lt + get_length() - m_trigger_offset) % get_length() :
+        lt - m_trigger_offset
         ;
 }
 
@@ -5677,6 +5814,7 @@ sequence::set_midi_bus (midi::bussbyte nominalbus, bool user_change)
         if (is_nullptr(perf()))                 /* "parent" is not yet set  */
         {
             m_true_bus = null_buss();           /* an invalid value         */
+            update_output_map();
         }
         else
         {
@@ -5685,6 +5823,8 @@ sequence::set_midi_bus (midi::bussbyte nominalbus, bool user_change)
             if (is_null_buss(m_true_bus))
                 m_true_bus = nominalbus;        /* buss no longer exists    */
 
+            update_output_map();
+
             if (user_change)
                 modify();                       /* no easy way to undo this */
 
@@ -5809,7 +5949,7 @@ sequence::set_length (midi::pulse len, bool adjust_triggers, bool verify)
         else
             len = get_length();
 
-        m_events.set_length(len);
+        events().set_length(len);
         m_triggers.set_length(len);             /* must precede adjustment  */
         if (adjust_triggers)
             m_triggers.adjust_offsets_to_length(len);
@@ -5918,7 +6058,7 @@ bool
 sequence::extend_length ()
 {
     xpc::automutex locker(m_mutex);
-    midi::pulse len = m_events.get_max_timestamp();
+    midi::pulse len = events().get_max_timestamp();
     bool result = len > get_length();
     if (len > get_length())
     {
@@ -6007,6 +6147,9 @@ sequence::set_armed (bool p)
     bool result = p != armed();
     if (result)
     {
+        if (p && is_cold())
+            (void) make_warm();
+
         armed(p);
         if (p)
             set_song_mute(false);                   /* see banner notes     */
@@ -6321,6 +6464,7 @@ sequence::set_midi_channel (midi::byte ch, bool user_change)
         off_playing_notes();
         m_free_channel = is_null_channel(ch);
         m_midi_channel = ch;                /* if (! m_free_channel)        */
+        update_output_map();
         if (user_change)
             modify();                       /* no easy way to undo this     */
 
@@ -6352,11 +6496,12 @@ sequence::set_channels (int channel)
     bool result = channel != c_midichannel_null;
     if (result)
     {
-        result = m_events.set_channels(channel);
+        result = events().set_channels(channel);
         if (result)
         {
             m_midi_channel = c_midichannel_null;
             m_free_channel = true;
+            update_output_map();
         }
     }
     return result;
@@ -6390,7 +6535,7 @@ sequence::to_string () const
     result += "\n Length (ticks): ";
     result += std::to_string(get_length());
     result += "Events:\n";
-    result += m_events.to_string();
+    result += events().to_string();
     return result;
 }
 
@@ -6399,41 +6544,103 @@ sequence::to_string () const
  *  buss.  This function does not bother checking if m_master_bus is a null
  *  pointer.
  *
- *  Note that the call to midi_channel() yields the event channel if
- *  free_channel() is true.  Otherwise the global pattern channel is true.
+ *  The bus, channel, and transposition come from m_output_map, which is
+ *  kept up-to-date by the setters and by play(), so no configuration is
+ *  checked here.  The channel map yields the event channel if
+ *  free_channel() is true.  Otherwise it yields the pattern channel.
+ *  Sounding notes are counted per output channel, so that a Note Off is
+ *  only sent (and only matches) a Note On on the same channel.
  *
  * \param ev
  *      The event to put on the buss.
  *
+ * \param transpose
+ *      If true (the default), note events (including Aftertouch) are mapped
+ *      through the transposition note map.  MIDI thru does not use it.
+ *
+ * \param flush
+ *      If true (the default), the bus is flushed.  The play() functions pass
+ *      false, and flush once after the whole frame has been queued.
+ *
+ * \return
+ *      Returns false if the event was a Note Off for a note that is not
+ *      sounding, and so was not sent.
+ *
  * \threadsafe
  */
 
-void
-sequence::put_event_on_bus (const event & ev)
+bool
+sequence::put_event_on_bus (const event & ev, bool transpose, bool flush)
 {
-    midi::byte note = ev.get_note();
-    bool skip = false;
+    const outputmap & om = m_output_map;
+    event evout;
+    evout.prep_for_send(perf()->get_tick(), ev);          /* issue #100   */
+    if (transpose && ev.is_note())
+        evout.set_note(om.om_notes[ev.get_note() & 0x7F]);
+
+    midi::byte note = evout.get_note();
+    midi::byte channel = om.om_channels[ev.channel()];
+    bool result = true;
     if (ev.is_note_on())
-    {
-        ++m_playing_notes[note];
-    }
+        m_playing_notes.note_on(channel, note);
     else if (ev.is_note_off())
+        result = m_playing_notes.note_off(channel, note);
+
+    if (result)
     {
-        if (m_playing_notes[note] == 0)
-            skip = true;
+        if (flush)
+            master_bus()->play_and_flush(om.om_bus, &evout, channel);
         else
-            --m_playing_notes[note];
+            master_bus()->play(om.om_bus, &evout, channel);
     }
-    if (! skip)
+    return result;
+}
+
+/**
+ *  Rebuilds the bus and channel part of m_output_map from m_true_bus,
+ *  m_free_channel, and m_midi_channel.  Called by the setters of those
+ *  values; the caller holds the mutex if needed.
+ */
+
+void
+sequence::update_output_map ()
+{
+    m_output_map.om_bus = m_true_bus;
+    for (int c = 0; c < 256; ++c)
     {
-        event evout;
-        evout.prep_for_send(perf()->get_tick(), ev);      /* issue #100   */
-        master_bus()->play_and_flush(m_true_bus, &evout, midi_channel(ev));
+        m_output_map.om_channels[c] = m_free_channel ?
+            midi::byte(c) : m_midi_channel ;
     }
 }
 
 /**
- *  Sends a note-off event for all active notes.  This function does not
+ *  Rebuilds the note map of m_output_map if the transposition has changed.
+ *  This is called once per play() frame, so the check is cheap and the
+ *  rebuild (128 entries) happens only when the transposition actually
+ *  changes.
+ *
+ * \param transpose
+ *      The transposition, in semitones, for the current frame.
+ */
+
+void
+sequence::update_output_transpose (int transpose)
+{
+    if (transpose != m_output_map.om_transpose)
+    {
+        m_output_map.om_transpose = transpose;
+        for (int n = 0; n < c_notes_count; ++n)
+        {
+            int note = n + transpose;
+            m_output_map.om_notes[n] = (note >= 0 && note < c_notes_count) ?
+                midi::byte(note) : midi::byte(n) ;
+        }
+    }
+}
+
+/**
+ *  Sends a note-off event for all active notes, on the channel each was
+ *  played on, as one batch with a single flush.  This function does not
  *  bother checking if m_master_bus is a null pointer.
  *
  * \threadsafe
@@ -6443,19 +6650,16 @@ void
 sequence::off_playing_notes ()
 {
     xpc::automutex locker(m_mutex);
-    int channel = free_channel() ? 0 : seq_midi_channel() ;
-    event e(0, EVENT_NOTE_OFF, channel, 0, 0);
-    for (int x = 0; x < c_notes_count; ++x)
+    if (m_playing_notes.any())
     {
-        while (m_playing_notes[x] > 0)
-        {
-            e.set_data(x);
-            master_bus()->play(m_true_bus, &e, channel);
-            --m_playing_notes[x];
-        }
+        std::vector<event> offs;
+        (void) m_playing_notes.release(offs);
+        for (auto & e : offs)
+            master_bus()->play(m_output_map.om_bus, &e, e.channel());
+
+        if (not_nullptr(master_bus()))
+            master_bus()->flush();
     }
-    if (not_nullptr(master_bus()))
-        master_bus()->flush();
 }
 
 /**
@@ -6489,7 +6693,7 @@ sequence::transpose_notes (int steps, int scale, int key)
     xpc::automutex locker(m_mutex);
     const int * transposetable;
     bool result = false;
-    m_events_undo.push(m_events);                   /* push_undo(), no lock */
+    m_events_undo.push(events());                   /* push_undo(), no lock */
     if (steps < 0)
     {
         transposetable = scales_down(scale, key);   /* 0 = chromatic scale  */
@@ -6498,7 +6702,7 @@ sequence::transpose_notes (int steps, int scale, int key)
     else
         transposetable = scales_up(scale, key);     /* 0 = chromatic scale  */
 
-    for (auto & er : m_events)
+    for (auto & er : events())
     {
         if (er.is_selected_note())                  /* transposable event?  */
         {
@@ -6537,8 +6741,8 @@ sequence::shift_notes (midi::pulse ticks)
     xpc::automutex locker(m_mutex);
     if (get_length() > 0)
     {
-        m_events_undo.push(m_events);               /* push_undo(), no lock */
-        for (auto & er : m_events)
+        m_events_undo.push(events());               /* push_undo(), no lock */
+        for (auto & er : events())
         {
             if (er.is_selected_note())              /* shiftable event?     */
             {
@@ -6554,7 +6758,7 @@ sequence::shift_notes (midi::pulse ticks)
         }
         if (result)
         {
-            m_events.sort();
+            events().sort();
             set_dirty();                            /* seqedit to update    */
         }
     }
@@ -6574,8 +6778,8 @@ sequence::apply_song_transpose ()
     if (transpose != 0)
     {
         xpc::automutex locker(m_mutex);
-        m_events_undo.push(m_events);               /* push_undo(), no lock */
-        for (auto & er : m_events)
+        m_events_undo.push(events());               /* push_undo(), no lock */
+        for (auto & er : events())
         {
             if (er.is_note())                       /* also aftertouch      */
                 er.transpose_note(transpose);
@@ -6645,7 +6849,7 @@ sequence::quantize_events (midi::byte status, midi::byte cc, int divide)
     if (divide == 0)
         return false;
 
-    bool result = m_events.quantize_events(status, cc, snap(), divide);
+    bool result = events().quantize_events(status, cc, snap(), divide);
     if (result)
         set_dirty();
 
@@ -6659,7 +6863,7 @@ sequence::quantize_notes (int divide)
     if (divide == 0)
         return false;
 
-    bool result = m_events.quantize_notes(snap(), divide);
+    bool result = events().quantize_notes(snap(), divide);
     if (result)
         set_dirty();
 
@@ -6680,7 +6884,7 @@ sequence::change_ppqn (int p)
 
     if (result)
     {
-        result = m_events.rescale(p, m_ppqn);           /* new & old PPQNs  */
+        result = events().rescale(p, m_ppqn);           /* new & old PPQNs  */
         if (result)
         {
             m_length = rescale_tick(m_length, p, m_ppqn);
@@ -6719,7 +6923,7 @@ bool
 sequence::push_quantize (midi::byte status, midi::byte cc, int divide)
 {
     xpc::automutex locker(m_mutex);
-    m_events_undo.push(m_events);
+    m_events_undo.push(events());
     return quantize_events(status, cc, divide);
 }
 
@@ -6727,7 +6931,7 @@ bool
 sequence::push_quantize_notes (int divide)
 {
     xpc::automutex locker(m_mutex);
-    m_events_undo.push(m_events);
+    m_events_undo.push(events());
     return quantize_notes(divide);
 }
 
@@ -6735,7 +6939,7 @@ bool
 sequence::push_jitter_notes (int range)
 {
     xpc::automutex locker(m_mutex);
-    m_events_undo.push(m_events);
+    m_events_undo.push(events());
     if (range == (-1))
         range = usr().jitter_range(snap());
 
@@ -6795,11 +6999,11 @@ sequence::copy_events (const eventlist & newevents)
 {
     xpc::automutex locker(m_mutex);
     bool result = false;
-    m_events.clear();
-    m_events = newevents;
-    if (m_events.empty())
+    events().clear();
+    events() = newevents;
+    if (events().empty())
     {
-        m_events.unmodify();
+        events().unmodify();
 
         /*
          * ca 2021-02-03 Not sure we want to change the length at all, let
@@ -6810,7 +7014,7 @@ sequence::copy_events (const eventlist & newevents)
     }
     else
     {
-        midi::pulse len = m_events.get_max_timestamp();
+        midi::pulse len = events().get_max_timestamp();
         bool change_length = false;
         if (len < get_ppqn())
         {
@@ -6910,6 +7114,7 @@ sequence::set_parent (performer * p)
 void
 sequence::play_queue (midi::pulse tick, bool playbackmode, bool resumenoteons)
 {
+    wake();
     if (check_queued_tick(tick))
     {
         play(get_queued_tick() - 1, playbackmode, resumenoteons);
@@ -6937,6 +7142,118 @@ sequence::play_queue (midi::pulse tick, bool playbackmode, bool resumenoteons)
         play(tick, playbackmode, resumenoteons);
 }
 
+/**
+ *  Brings m_last_tick up to date after the horizon scheduler has skipped
+ *  this pattern.  Each skipped play() would only have set m_last_tick to
+ *  the frame tick plus one, so setting it to sm_frame_tick leaves the
+ *  pattern as if it had been played on every frame.
+ *
+ * \threadsafe
+ */
+
+void
+sequence::wake ()
+{
+    if (m_dormant)
+    {
+        xpc::automutex locker(m_mutex);
+        if (m_dormant)
+        {
+            m_last_tick = sm_frame_tick.load();
+            m_dormant = false;
+        }
+    }
+}
+
+/**
+ *  Calculates the next frame tick at which playing this pattern can do
+ *  more than advance m_last_tick.  Called by the horizon scheduler right
+ *  after play_queue().  When in doubt, the answer is the next frame, so
+ *  the scheduler plays the pattern as often as before.
+ *
+ *  -   Queued, one-shot, recording, metronome, and loop-counted patterns
+ *      have state that changes with the tick, so they play every frame.
+ *  -   Live mode.  An unarmed pattern never needs to play (arming it
+ *      bumps the schedule epoch).  An armed pattern is due at the next
+ *      repeat of its next event.
+ *  -   Song mode.  An armed pattern plays every frame.  An unarmed one is
+ *      due at the next trigger boundary.
+ *
+ * \threadsafe
+ *
+ * \param tick
+ *      The tick of the frame just played.
+ *
+ * \param songmode
+ *      True if playing in Song mode.
+ *
+ * \return
+ *      Returns the tick, or never_due().
+ */
+
+midi::pulse
+sequence::next_due (midi::pulse tick, bool songmode)
+{
+    xpc::automutex locker(m_mutex);
+    midi::pulse result = tick + 1;
+    bool busy = get_queued() || one_shot() || recording() ||
+        song_recording() || is_metro_seq() || loop_count_max() > 0;
+
+    if (busy)
+        return result;
+
+    if (m_song_mute)
+        return armed() ? result : never_due() ;
+
+    if (songmode)
+    {
+        if (! armed())
+        {
+            result = never_due();
+            for (const auto & t : m_triggers.triggerlist())
+            {
+                if (t.tick_start() > tick && t.tick_start() < result)
+                    result = t.tick_start();
+
+                if (t.tick_end() > tick && t.tick_end() < result)
+                    result = t.tick_end();
+            }
+        }
+    }
+    else if (! armed())
+    {
+        result = never_due();
+    }
+    else if (events().empty())
+    {
+        result = never_due();
+    }
+    else
+    {
+        midi::pulse length = get_length() > 0 ? get_length() : m_ppqn ;
+        const event & first = eventlist::cdref(events().cbegin());
+        const event & last = eventlist::cdref(std::prev(events().cend()));
+        if (first.timestamp() >= 0 && last.timestamp() < length)
+        {
+            midi::pulse next = tick + 1;
+            midi::pulse base = next - next % length;
+            midi::pulse position = next % length;
+            auto e = std::lower_bound
+            (
+                events().cbegin(), events().cend(), position,
+                [] (const event & ev, midi::pulse p)
+                {
+                    return ev.timestamp() < p;
+                }
+            );
+            result = e != events().cend() ?
+                base + eventlist::cdref(e).timestamp() :
+                base + length + first.timestamp() ;
+        }
+    }
+    return result;
+}
+
 /**
  *  Actually, useful mainly for the user-interface, this function calculates
  *  the size of the left and right handles of a note.
@@ -6974,7 +7291,7 @@ sequence::toggle_one_shot ()
     xpc::automutex locker(m_mutex);
     set_dirty_mp();
     m_one_shot = ! m_one_shot;
-    m_one_shot_tick = m_last_tick - mod_last_tick() + get_length();
+    m_one_shot_tick = last_tick() - mod_last_tick() + get_length();
     perf()->announce_pattern(seq_number());     /* for issue #89        */
     off_from_snap(true);
     return m_one_shot;
@@ -7119,7 +7436,7 @@ sequence::resume_note_ons (midi::pulse tick)
     xpc::automutex locker(m_mutex);                     /* better here?     */
     if (get_length() > 0)
     {
-        for (auto & ei : m_events)
+        for (auto & ei : events())
         {
             if (ei.is_note_on_linked())                 /* note on linked   */
             {
@@ -7149,7 +7466,7 @@ sequence::expand_recording () const
     bool result = false;
     if (expanding())
     {
-        midi::pulse tstamp = m_last_tick;
+        midi::pulse tstamp = last_tick();
         if (tstamp >= expand_threshold())
         {
 #if defined PLATFORM_DEBUG_TMI
@@ -7209,7 +7526,7 @@ sequence::update_recording (int index)
         case recordstyle::oneshot_reset:
 
             clear_events();
-            m_last_tick = 0;
+            set_last_tick(0);
             set_recording(toggler::on);
             break;
 
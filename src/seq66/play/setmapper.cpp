@@ -73,6 +73,8 @@
  *      -#  TO BE CONTINUED...
  */
 
+#include <algorithm>                    /* std::push_heap(), std::sort()    */
+#include <cstdlib>                      /* std::abs()                       */
 #include <iostream>                     /* std::cout                        */
 
 #include "cfg/settings.hpp"             /* seq66::rc()                      */
@@ -122,7 +124,14 @@ setmapper::setmapper
     m_set_clipboard         (seq::unassigned(), rows, columns),
     m_playscreen            (seq::unassigned()),
     m_playscreen_pointer    (nullptr),
-    m_tracks_mute_state     (m_set_size, false)
+    m_tracks_mute_state     (m_set_size, false),
+    m_cold_storage          (coldstorage::off),
+    m_horizon_enabled       (false),
+    m_horizon               (),
+    m_horizon_epoch         (0),
+    m_horizon_tick          (0),
+    m_horizon_songmode      (false),
+    m_horizon_valid         (false)
 {
     (void) reset();
 }
@@ -143,6 +152,27 @@ setmapper::reset ()
     return result;
 }
 
+/**
+ *  Totals the memory used by the patterns in all of the screensets.  The
+ *  patterns in the set clipboard are copies, and are counted as "other".
+ *
+ * \return
+ *      Returns the accumulated memory usage.
+ */
+
+midi::memusage
+setmapper::memory_usage () const
+{
+    midi::memusage result;
+    for (const auto & sset : sets())
+        sset.second.memory_usage(result);
+
+    midi::memusage clip;
+    m_set_clipboard.memory_usage(clip);
+    result.add_other(clip.total_bytes());
+    return result;
+}
+
 /**
  *  Given the raw sequence number, returns the calculated set number and the
  *  offset of the sequence in the set.
@@ -357,6 +387,7 @@ setmapper::add_sequence (sequence * s, seq::number & seqno)
         if (result)
         {
             seq::number n = seqno + 1;
+            sequence::reschedule();
             ++m_sequence_count;
             if (n > m_sequence_high)
                 m_sequence_high = n;            /* no way to back out, tho  */
@@ -508,6 +539,19 @@ setmapper::toggle_song_mute (seq::number seqno)
  *  This plays all sets at once.  Could be a useful feature, but the very
  *  large b4uacuse-stress MIDI file reveals a lot of crackling in Yoshimi
  *  playback.  Compare it to the plain play() function.
+ *
+ *  Most patterns have nothing to play in most frames, so, if enabled by
+ *  horizon_scheduling(true), only the patterns whose next-due tick (see
+ *  sequence::next_due()) has been reached are played.  They are taken from
+ *  a midi::duequeue, and played in the same order as a full sweep, so the
+ *  output is the same.  A skipped pattern is left dormant, and catches up
+ *  its last tick when next played (see sequence::wake()).
+ *
+ *  The queue is rebuilt, and every pattern played, when the schedule epoch
+ *  changes (edits, arming, queuing, triggers, repositioning, adding or
+ *  removing patterns), when the tick moves back, or when the playback mode
+ *  changes.  With the horizon off, the full sweep is left as it always was,
+ *  and the horizon_stats() are not counted.
  */
 
 void
@@ -518,8 +562,59 @@ setmapper::play_all_sets
     bool resumenoteons
 )
 {
+    if (! m_horizon_enabled)
+    {
+        for (auto & sset : sets())
+            sset.second.play(tick, mode, resumenoteons);
+
+        return;
+    }
+
+    bool songmode = mode == sequence::playback::song;
+    std::uint64_t epoch = sequence::schedule_epoch();
+    bool rebuild = ! m_horizon_valid || epoch != m_horizon_epoch ||
+        tick <= m_horizon_tick || songmode != m_horizon_songmode;
+
+    if (rebuild)
+    {
+        rebuild_horizon(tick);
+        m_horizon_epoch = epoch;
+        m_horizon_songmode = songmode;
+        m_horizon_valid = true;
+    }
+    (void) m_horizon.play
+    (
+        tick, [songmode, resumenoteons] (sequence & s, midi::pulse t)
+        {
+            s.play_queue(t, songmode, resumenoteons);
+
+            midi::pulse due = s.next_due(t, songmode);
+            s.doze();
+            return due == sequence::never_due() ?
+                midi::duequeue<sequence>::never() : due ;
+        }
+    );
+    m_horizon_tick = tick;
+    sequence::frame_done(tick);
+}
+
+/**
+ *  Puts every active pattern in the queue, due now, in the order of a full
+ *  sweep of the sets.
+ */
+
+void
+setmapper::rebuild_horizon (midi::pulse tick)
+{
+    m_horizon.clear();
     for (auto & sset : sets())
-        sset.second.play(tick, mode, resumenoteons);
+    {
+        for (auto & s : sset.second.seq_container())
+        {
+            if (s.active())
+                m_horizon.add(*s.loop(), tick);
+        }
+    }
 }
 
 /**
@@ -581,6 +676,7 @@ setmapper::remove_sequence (seq::number seqno)
         result = sset.remove(seqno);        /* it exists, remove it!        */
         if (result)
         {
+            sequence::reschedule();         /* drop it from the horizon     */
             if (m_sequence_count > 1)       /* allow for the dummy sequence */
                 --m_sequence_count;
         }
@@ -945,10 +1041,67 @@ setmapper::set_playing_screenset (screenset::number setno)
         result = play_screen()->learn_bits(m_tracks_mute_state);
         if (result && rc().is_setsmode_normal())
             mute_group_tracks();
+
+        if (result && m_cold_storage != coldstorage::off)
+            update_cold_storage();
     }
     return result;
 }
 
+/**
+ *  Unpacks the patterns of a set ahead of time, for example when the set is
+ *  queued to be the next play-screen.
+ *
+ * \return
+ *      Returns the number of patterns that were unpacked.
+ */
+
+int
+setmapper::prepare_screenset (screenset::number setno)
+{
+    auto sit = sets().find(setno);
+    return sit != sets().end() ? sit->second.make_warm() : 0 ;
+}
+
+/**
+ *  Changes the cold-storage policy.  Turning it off unpacks every pattern.
+ */
+
+void
+setmapper::cold_storage (coldstorage cs)
+{
+    m_cold_storage = cs;
+    update_cold_storage();
+}
+
+/**
+ *  Applies the cold-storage policy after a play-screen change.  The
+ *  play-screen (and, when eager, its neighbours) is unpacked first, then
+ *  the idle patterns of the other sets are packed.  Patterns that are
+ *  armed, in an editor, or used in the song are left alone by
+ *  sequence::make_cold().
+ */
+
+void
+setmapper::update_cold_storage ()
+{
+    bool enabled = m_cold_storage != coldstorage::off;
+    int reach = m_cold_storage == coldstorage::eager ? 1 : 0 ;
+    for (int pass = 0; pass < 2; ++pass)        /* unpack first, then pack  */
+    {
+        for (auto & sset : sets())
+        {
+            int distance = std::abs(sset.first - m_playscreen);
+            bool warm = ! enabled || distance <= reach;
+
+            if (pass == 0 && warm)
+                (void) sset.second.make_warm();
+            else if (pass == 1 && ! warm)
+                (void) sset.second.make_cold();
+        }
+    }
+}
+
 /*
  * -------------------------------------------------------------------------
  * Mutes
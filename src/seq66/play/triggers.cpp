@@ -240,6 +240,25 @@ triggers::any_transposed () const
     return result;
 }
 
+/**
+ *  Adds the live trigger list, and the undo and redo copies of it, to the
+ *  memory accounting.  The copied-trigger clipboard is a single trigger, and
+ *  is counted as "other".
+ */
+
+void
+triggers::memory_usage (midi::memusage & mu) const
+{
+    mu.add_triggers(m_triggers.size(), m_triggers.capacity() * sizeof(trigger));
+    for (const auto & c : m_undo_stack)
+        mu.add_undo(1, c.capacity() * sizeof(trigger));
+
+    for (const auto & c : m_redo_stack)
+        mu.add_undo(1, c.capacity() * sizeof(trigger));
+
+    mu.add_other(sizeof(m_clipboard));
+}
+
 bool
 triggers::change_ppqn (int p)
 {
@@ -255,14 +274,18 @@ triggers::change_ppqn (int p)
 
 /**
  *  Pushes the list-trigger into the trigger undo-list, then flags each
- *  item in the undo-list as unselected.
+ *  item in the undo-list as unselected.  If the undo-list is full, the
+ *  oldest entry is dropped.
  */
 
 void
 triggers::push_undo ()
 {
-    m_undo_stack.push(m_triggers);
-    for (auto & t : m_undo_stack.top())
+    if (int(m_undo_stack.size()) >= c_undo_depth)
+        m_undo_stack.pop_front();
+
+    m_undo_stack.push_back(m_triggers);
+    for (auto & t : m_undo_stack.back())
         unselect(t, false);             /* do not count this unselection    */
 }
 
@@ -277,9 +300,12 @@ triggers::pop_undo ()
 {
     if (m_undo_stack.size() > 0)
     {
-        m_redo_stack.push(m_triggers);
-        m_triggers = m_undo_stack.top();
-        m_undo_stack.pop();
+        if (int(m_redo_stack.size()) >= c_undo_depth)
+            m_redo_stack.pop_front();
+
+        m_redo_stack.push_back(m_triggers);
+        m_triggers = std::move(m_undo_stack.back());
+        m_undo_stack.pop_back();
     }
 }
 
@@ -294,9 +320,12 @@ triggers::pop_redo ()
 {
     if (m_redo_stack.size() > 0)
     {
-        m_undo_stack.push(m_triggers);
-        m_triggers = m_redo_stack.top();
-        m_redo_stack.pop();
+        if (int(m_undo_stack.size()) >= c_undo_depth)
+            m_undo_stack.pop_front();
+
+        m_undo_stack.push_back(m_triggers);
+        m_triggers = std::move(m_redo_stack.back());
+        m_redo_stack.pop_back();
     }
 }
 
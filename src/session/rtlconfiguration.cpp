@@ -25,13 +25,14 @@
  * \library       rtl66 application
  * \author        Chris Ahlstrom
  * \date          2020-03-22
- * \updates       2023-01-01
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  */
 
 #include <cstring>                      /* std::strlen()                    */
 
+#include "midi/undostack.hpp"           /* midi::undostack defaults         */
 #include "session/rtlconfiguration.hpp" /* sessions::rtlconfiguration()     */
 #include "util/msgfunctions.hpp"        /* util::msgprintf()                */
 #include "util/filefunctions.hpp"       /* util::file_readable() etc.       */
@@ -50,7 +51,10 @@ rtlconfiguration::rtlconfiguration (const std::string & caps) :
     m_capabilities      (caps),
     m_midi_filepath     (),
     m_midi_filename     (),
-    m_load_midi_file    (false)
+    m_load_midi_file    (false),
+    m_undo_budget       (midi::undostack::c_budget_default),
+    m_undo_depth        (midi::undostack::c_depth_default),
+    m_event_feed        ()
 {
     // set_rtlconfiguration_defaults();
 }
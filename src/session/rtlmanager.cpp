@@ -25,7 +25,7 @@
  * \library       rtl66 application
  * \author        Chris Ahlstrom
  * \date          2020-03-22
- * \updates       2024-01-16
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This module provides functionality that is useful even if session support
@@ -50,6 +50,7 @@
 #include "cfg/appinfo.hpp"              /* cfg::set_app_name()              */
 #include "midi/file.hpp"                /* midi::write_midi_file()          */
 #include "midi/player.hpp"              /* midi::player class               */
+#include "midi/undostack.hpp"           /* midi::undostack budget, depth    */
 #include "rtl/test_helpers.hpp"         /* rt_simple_cli()                  */
 #include "session/rtlmanager.hpp"       /* session::rtlmanager()            */
 #include "util/msgfunctions.hpp"        /* util::file_message() etc.        */
@@ -225,6 +226,23 @@ rtlmanager::parse_option_file (std::string & errmessage)
     return result;
 }
 
+/**
+ *  Reloads the MIDI clock and input settings while the player runs.  The
+ *  file is read in the background; see player::reload_configuration().
+ *  Unlike parse_option_file(), this can be called at any time after
+ *  create_player().
+ */
+
+bool
+rtlmanager::reload_configuration (const std::string & filename)
+{
+    bool result = bool(player_ptr());
+    if (result)
+        result = player_ptr()->reload_configuration(filename);
+
+    return result;
+}
+
 bool
 rtlmanager::parse_command_line
 (
@@ -306,6 +324,15 @@ rtlmanager::create_player ()
     if (result)
     {
 //      (void) p->get_settings(rc(), usr());
+        if (not_nullptr(config_ptr()))
+        {
+            midi::undostack::budget(config_ptr()->undo_budget());
+            midi::undostack::default_depth(config_ptr()->undo_depth());
+
+            const std::string & feedname = config_ptr()->event_feed();
+            if (! feedname.empty())
+                (void) p->open_event_feed(feedname);
+        }
         m_player_ptr = std::move(p);              /* change the ownership */
         result = player_ptr()->launch();
         if (! result)
@@ -0,0 +1,159 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          transport/clock/frameclock.cpp
+ *
+ *    A clock that counts audio frames, shared by audio and MIDI.
+ *
+ * \library       rtl66 library
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ */
+
+#include <cmath>                        /* std::ceil()                      */
+
+#include "transport/clock/frameclock.hpp" /* transport::clock::frameclock   */
+
+namespace transport
+{
+
+namespace clock
+{
+
+/**
+ *  The tempo until one is set: 120 BPM at 192 PPQN.
+ */
+
+static const midi::bpm c_frameclock_bpm = 120.0;
+static const midi::ppqn c_frameclock_ppqn = 192;
+
+/**
+ * \ctor frameclock
+ */
+
+frameclock::frameclock (unsigned samplerate) :
+    m_frames        (0),
+    m_sample_rate   (samplerate),
+    m_active        (false),
+    m_tempo_mutex   (),
+    m_bpm           (c_frameclock_bpm),
+    m_ppqn          (c_frameclock_ppqn),
+    m_anchor_frame  (0),
+    m_anchor_tick   (0.0)
+{
+    // no code
+}
+
+/**
+ *  Sets the frame count, and restarts the ticks from 0 at that frame.
+ *  Not to be called while the audio side is advancing the clock.
+ */
+
+void
+frameclock::reset (frame f)
+{
+    std::lock_guard<std::mutex> lock(m_tempo_mutex);
+    m_frames = f;
+    m_anchor_frame = f;
+    m_anchor_tick = 0.0;
+}
+
+/**
+ *  Sets the tempo from the current frame on.  The tick reached so far
+ *  becomes the new anchor, so there is no jump.
+ */
+
+void
+frameclock::tempo (midi::bpm bp, midi::ppqn ppq)
+{
+    if (bp > 0.0 && ppq > 0)
+    {
+        frame now = frames();
+        double tick = ticks_at(now);
+        std::lock_guard<std::mutex> lock(m_tempo_mutex);
+        m_anchor_tick = tick;
+        m_anchor_frame = now;
+        m_bpm = bp;
+        m_ppqn = ppq;
+    }
+}
+
+double
+frameclock::seconds_at (frame f) const
+{
+    unsigned sr = m_sample_rate;
+    return sr > 0 ? double(f) / sr : 0.0 ;
+}
+
+/**
+ *  The tick at a frame, with the fraction.  Frames before the current
+ *  tempo's anchor are converted at that tempo too.
+ */
+
+double
+frameclock::ticks_at (frame f) const
+{
+    double result = 0.0;
+    unsigned sr = m_sample_rate;
+    if (sr > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_tempo_mutex);
+        double df = f >= m_anchor_frame ?
+            double(f - m_anchor_frame) : -double(m_anchor_frame - f) ;
+
+        result = m_anchor_tick + df * m_bpm * m_ppqn / (60.0 * sr);
+    }
+    return result;
+}
+
+/**
+ *  The first frame at or after the given tick.  This is the frame at
+ *  which an event at that tick is due.
+ */
+
+frameclock::frame
+frameclock::frame_of (midi::pulse tick) const
+{
+    frame result = 0;
+    unsigned sr = m_sample_rate;
+    if (sr > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_tempo_mutex);
+        double dt = double(tick) - m_anchor_tick;
+        double df = std::ceil(dt * 60.0 * sr / (m_bpm * m_ppqn) - 1.0e-9);
+        if (df >= 0.0)
+            result = m_anchor_frame + frame(df);
+        else if (frame(-df) <= m_anchor_frame)
+            result = m_anchor_frame - frame(-df);
+    }
+    return result;
+}
+
+}           // namespace clock
+
+}           // namespace transport
+
+/*
+ * transport/clock/frameclock.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
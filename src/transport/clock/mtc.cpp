@@ -0,0 +1,411 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          transport/clock/mtc.cpp
+ *
+ *    MIDI Time Code: a quarter-frame generator and a follower.
+ *
+ * \library       rtl66 library
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ */
+
+#include <cmath>                        /* std::ceil(), std::fabs()         */
+
+#include "transport/clock/mtc.hpp"      /* transport::clock::mtc_generator  */
+
+namespace transport
+{
+
+namespace clock
+{
+
+/*
+ * Drop-frame constants: real frames in ten minutes, and in a minute that
+ * drops two frame numbers.
+ */
+
+static const long c_df_ten_minutes = 17982;
+static const long c_df_minute = 1798;
+
+static int
+nominal_fps (mtc_rate r)
+{
+    switch (r)
+    {
+        case mtc_rate::fps_24:          return 24;
+        case mtc_rate::fps_25:          return 25;
+        default:                        return 30;
+    }
+}
+
+static double
+frames_to_seconds (double frames, mtc_rate r)
+{
+    return frames / mtc_fps(r);
+}
+
+/**
+ *  The true frame rate.  29.97 is 30000/1001.
+ */
+
+double
+mtc_fps (mtc_rate r)
+{
+    return r == mtc_rate::fps_29_97_df ?
+        30000.0 / 1001.0 : double(nominal_fps(r)) ;
+}
+
+/**
+ *  The number of real frames from 00:00:00:00 to the given timecode.
+ */
+
+long
+timecode_to_frames (const timecode & tc, mtc_rate r)
+{
+    long fps = nominal_fps(r);
+    long seconds = (tc.tc_hours * 60L + tc.tc_minutes) * 60L + tc.tc_seconds;
+    long result = seconds * fps + tc.tc_frames;
+    if (r == mtc_rate::fps_29_97_df)
+    {
+        long minutes = tc.tc_hours * 60L + tc.tc_minutes;
+        result -= 2 * (minutes - minutes / 10);
+    }
+    return result;
+}
+
+/**
+ *  The inverse of timecode_to_frames().  The hours wrap at 24.
+ */
+
+timecode
+frames_to_timecode (long count, mtc_rate r)
+{
+    long fps = nominal_fps(r);
+    if (count < 0)
+        count = 0;
+
+    if (r == mtc_rate::fps_29_97_df)
+    {
+        long d = count / c_df_ten_minutes;
+        long m = count % c_df_ten_minutes;
+        count += 18 * d;
+        if (m >= 2)
+            count += 2 * ((m - 2) / c_df_minute);
+    }
+
+    timecode result;
+    result.tc_frames = int(count % fps);
+    result.tc_seconds = int((count / fps) % 60);
+    result.tc_minutes = int((count / (fps * 60)) % 60);
+    result.tc_hours = int((count / (fps * 3600)) % 24);
+    return result;
+}
+
+/**
+ *  The full-frame SysEx message for a timecode, sent to all devices.
+ */
+
+midi::bytes
+mtc_full_frame (const timecode & tc, mtc_rate r)
+{
+    midi::byte hr = midi::byte((int(r) << 5) | (tc.tc_hours & 0x1F));
+    return midi::bytes
+    {
+        0xF0, 0x7F, 0x7F, 0x01, 0x01, hr,
+        midi::byte(tc.tc_minutes), midi::byte(tc.tc_seconds),
+        midi::byte(tc.tc_frames), 0xF7
+    };
+}
+
+/*------------------------------------------------------------------------
+ * mtc_generator
+ *------------------------------------------------------------------------*/
+
+mtc_generator::mtc_generator (mtc_rate r) :
+    m_rate      (r),
+    m_next_qf   (0)
+{
+    // no code
+}
+
+/**
+ *  Moves to the first even frame at or after the given position, so that
+ *  the next quarter frame is piece 0 of a set.
+ *
+ * \return
+ *      Returns the full-frame message for that frame, to be sent before
+ *      the quarter frames resume.
+ */
+
+midi::bytes
+mtc_generator::locate (double seconds)
+{
+    long frame = 0;
+    if (seconds > 0.0)
+        frame = long(std::ceil(seconds * mtc_fps(m_rate) - 1.0e-9));
+
+    if ((frame & 1) != 0)
+        ++frame;
+
+    m_next_qf = frame * 4;
+    return mtc_full_frame(frames_to_timecode(frame, m_rate), m_rate);
+}
+
+double
+mtc_generator::next_seconds () const
+{
+    return frames_to_seconds(m_next_qf / 4.0, m_rate);
+}
+
+/**
+ *  The data byte of the next quarter frame: the piece number and a nibble
+ *  of the timecode of the first frame of its set.
+ */
+
+midi::byte
+mtc_generator::next_data () const
+{
+    int piece = int(m_next_qf % 8);
+    timecode tc = frames_to_timecode((m_next_qf / 8) * 2, m_rate);
+    int nibble;
+    switch (piece)
+    {
+        case 0:     nibble = tc.tc_frames & 0x0F;               break;
+        case 1:     nibble = (tc.tc_frames >> 4) & 0x01;        break;
+        case 2:     nibble = tc.tc_seconds & 0x0F;              break;
+        case 3:     nibble = (tc.tc_seconds >> 4) & 0x03;       break;
+        case 4:     nibble = tc.tc_minutes & 0x0F;              break;
+        case 5:     nibble = (tc.tc_minutes >> 4) & 0x03;       break;
+        case 6:     nibble = tc.tc_hours & 0x0F;                break;
+        default:
+
+            nibble = ((tc.tc_hours >> 4) & 0x01) | (int(m_rate) << 1);
+            break;
+    }
+    return midi::byte((piece << 4) | nibble);
+}
+
+/**
+ *  Appends the quarter frames due before the given time, with their exact
+ *  times, and moves past them.
+ *
+ * \return
+ *      Returns the number appended.
+ */
+
+std::size_t
+mtc_generator::quarter_frames (double until, std::vector<quarter_frame> & qf)
+{
+    std::size_t result = 0;
+    for (double t = next_seconds(); t < until; t = next_seconds())
+    {
+        qf.push_back(quarter_frame{t, next_data()});
+        ++m_next_qf;
+        ++result;
+    }
+    return result;
+}
+
+/*------------------------------------------------------------------------
+ * mtc_follower
+ *------------------------------------------------------------------------*/
+
+mtc_follower::mtc_follower (double smoothing) :
+    m_smoothing         (smoothing),
+    m_nibbles           (),
+    m_last_piece        (-1),
+    m_run               (0),
+    m_direction         (0),
+    m_rate              (mtc_rate::fps_25),
+    m_locked            (false),
+    m_frame_position    (0.0),
+    m_estimate          (0.0),
+    m_estimate_time     (0.0)
+{
+    // no code
+}
+
+void
+mtc_follower::reset ()
+{
+    for (auto & n : m_nibbles)
+        n = 0;
+
+    m_last_piece = -1;
+    m_run = 0;
+    m_direction = 0;
+    m_locked = false;
+    m_frame_position = m_estimate = m_estimate_time = 0.0;
+}
+
+/**
+ *  Takes one quarter frame.
+ *
+ * \param data
+ *      The data byte (not the F1 status).
+ *
+ * \param seconds
+ *      The arrival time, on any steady clock.
+ *
+ * \return
+ *      Returns true if the position was updated.
+ */
+
+bool
+mtc_follower::receive_quarter_frame (midi::byte data, double seconds)
+{
+    int piece = (data >> 4) & 0x07;
+    int dir = 0;
+    if (m_last_piece >= 0)
+    {
+        if (piece == (m_last_piece + 1) % 8)
+            dir = 1;
+        else if (piece == (m_last_piece + 7) % 8)
+            dir = -1;
+    }
+
+    bool wasmoving = m_direction != 0;
+    if (dir == 0)
+    {
+        m_run = 1;                      /* first piece, or some were lost   */
+    }
+    else if (dir != m_direction)
+    {
+        m_direction = dir;              /* starting, or turning around      */
+        m_run = 2;
+    }
+    else
+        ++m_run;
+
+    m_nibbles[piece] = data & 0x0F;
+    m_last_piece = piece;
+
+    bool result = m_locked && dir != 0;
+    if (result)
+        m_frame_position += 0.25 * dir;
+
+    bool complete = m_run >= 8 &&
+        ((m_direction > 0 && piece == 7) || (m_direction < 0 && piece == 0));
+
+    if (complete)
+    {
+        timecode tc;
+        tc.tc_frames = m_nibbles[0] | ((m_nibbles[1] & 0x01) << 4);
+        tc.tc_seconds = m_nibbles[2] | ((m_nibbles[3] & 0x03) << 4);
+        tc.tc_minutes = m_nibbles[4] | ((m_nibbles[5] & 0x03) << 4);
+        tc.tc_hours = m_nibbles[6] | ((m_nibbles[7] & 0x01) << 4);
+        m_rate = static_cast<mtc_rate>((m_nibbles[7] >> 1) & 0x03);
+        m_frame_position = timecode_to_frames(tc, m_rate) + piece / 4.0;
+        m_locked = result = true;
+    }
+    if (result)
+    {
+        /*
+         * Move the smoothed line toward this arrival, or snap to it if it
+         * is off by more than two frames (a locate or a restart).
+         */
+
+        double raw = frames_to_seconds(m_frame_position, m_rate);
+        double predicted = m_estimate +
+            m_direction * (seconds - m_estimate_time);
+
+        double error = raw - predicted;
+        if (! wasmoving || std::fabs(error) > 2.0 / mtc_fps(m_rate))
+            m_estimate = raw;
+        else
+            m_estimate = predicted + m_smoothing * error;
+
+        m_estimate_time = seconds;
+    }
+    return result;
+}
+
+/**
+ *  Takes a full-frame SysEx message, F0 7F dd 01 01 hh mm ss ff F7, which
+ *  sets the position and stops the motion until quarter frames resume.
+ *
+ * \return
+ *      Returns true if the message is a full-frame message.
+ */
+
+bool
+mtc_follower::receive_full_frame (const midi::bytes & msg)
+{
+    bool result = msg.size() == 10 && msg[0] == 0xF0 && msg[1] == 0x7F &&
+        msg[3] == 0x01 && msg[4] == 0x01 && msg[9] == 0xF7;
+
+    if (result)
+    {
+        timecode tc;
+        tc.tc_hours = msg[5] & 0x1F;
+        tc.tc_minutes = msg[6];
+        tc.tc_seconds = msg[7];
+        tc.tc_frames = msg[8];
+        m_rate = static_cast<mtc_rate>((msg[5] >> 5) & 0x03);
+        m_frame_position = double(timecode_to_frames(tc, m_rate));
+        m_estimate = frames_to_seconds(m_frame_position, m_rate);
+        m_last_piece = -1;
+        m_run = 0;
+        m_direction = 0;
+        m_locked = true;
+    }
+    return result;
+}
+
+/**
+ *  True if quarter frames are still arriving, that is, the last one came
+ *  less than two frames ago.
+ */
+
+bool
+mtc_follower::running (double seconds) const
+{
+    return m_locked && m_direction != 0 &&
+        seconds - m_estimate_time < 2.0 / mtc_fps(m_rate);
+}
+
+/**
+ *  The position, in seconds, at the given time on the arrival clock.
+ *  While running it is extrapolated from the smoothed line; otherwise it
+ *  stays where the motion stopped.
+ */
+
+double
+mtc_follower::position (double seconds) const
+{
+    double result = m_estimate;
+    if (running(seconds))
+        result += m_direction * (seconds - m_estimate_time);
+
+    return result;
+}
+
+}           // namespace clock
+
+}           // namespace transport
+
+/*
+ * transport/clock/mtc.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -24,12 +24,14 @@
  * \library       rtl66 library
  * \author        Chris Ahlstrom
  * \date          2022-11-10
- * \updates       2022-12-01
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  GitHub issue #165: enabled a build and run with no JACK support.
  */
 
+#include <cmath>                        /* std::fmod()                      */
+
 #include "midi/calculations.hpp"        /* ticks_to_delta_time_us() etc.    */
 #include "transport/info.hpp"           /* transport::info class            */
 
@@ -126,6 +128,37 @@ info::resolution_change_management
     }
 }
 
+/**
+ *  Folds a play position that has reached the right (R) marker back into
+ *  the L/R loop, keeping the part of the frame that ran past R, so that
+ *  the head of the loop starts exactly where the tail left off.
+ *
+ * \param [inout] tick
+ *      Provides the position, and returns the folded position, which is
+ *      L plus the overshoot modulo the loop length.  Unchanged if there is
+ *      no wrap.
+ *
+ * \return
+ *      Returns the number of times R was crossed, 0 if not looping, if the
+ *      loop is empty, or if the position has not reached R.  More than 1
+ *      means whole passes of the loop were skipped (e.g. after a stall).
+ */
+
+int
+info::loop_wrap (double & tick) const
+{
+    int result = 0;
+    double right = double(m_right_tick);
+    double span = double(m_right_tick - m_left_tick);
+    if (m_looping && span > 0.0 && tick >= right)
+    {
+        double over = tick - right;
+        result = 1 + int(over / span);
+        tick = double(m_left_tick) + std::fmod(over, span);
+    }
+    return result;
+}
+
 /**
  *  Set the left marker at the given tick.  We let the caller determine if
  *  this setting is a modification.  If the left tick is later than the right
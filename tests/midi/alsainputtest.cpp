@@ -0,0 +1,244 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          alsainputtest.cpp
+ *
+ *      A test-file for the shared ALSA input thread.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Opens two virtual input ports and a sender on the ALSA sequencer, and
+ *  checks that a callback can remove its own port (which needs the thread
+ *  to call it without holding its lock), that removing the last port from
+ *  a callback leaves a thread that the next add() joins and replaces, and
+ *  that remove() from another thread waits for a callback in progress.
+ *  Skips if there is no ALSA sequencer.
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <chrono>                       /* std::chrono::milliseconds        */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <functional>                   /* std::function<>                  */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <thread>                       /* std::this_thread::sleep_for()    */
+
+#include "rtl/midi/alsa/midi_alsa_input.hpp"  /* rtl::midi_alsa_input      */
+#include "rtl/midi/rtmidi_in_data.hpp"  /* rtl::rtmidi_in_data             */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+#if defined RTL66_BUILD_ALSA
+
+static snd_seq_t * s_in = nullptr;
+static snd_seq_t * s_out = nullptr;
+static int s_sender = -1;
+
+/**
+ *  What a port's callback has seen, and what it does on a given note.
+ */
+
+class port_state
+{
+public:
+
+    int p_port = -1;
+    std::atomic<int> p_count{0};
+    std::atomic<bool> p_busy{false};
+    int p_trigger = -1;
+    std::function<void ()> p_action;
+};
+
+static void
+callback (double /*ts*/, midi::message * msg, void * userdata)
+{
+    port_state * ps = static_cast<port_state *>(userdata);
+    ++ps->p_count;
+    if (msg->size() >= 2 && int((*msg)[1]) == ps->p_trigger && ps->p_action)
+    {
+        ps->p_busy = true;
+        ps->p_action();
+        ps->p_busy = false;
+    }
+}
+
+static int
+make_port (const char * name)
+{
+    return ::snd_seq_create_simple_port
+    (
+        s_in, name, SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_SUBS_WRITE,
+        SND_SEQ_PORT_TYPE_MIDI_GENERIC | SND_SEQ_PORT_TYPE_APPLICATION
+    );
+}
+
+static void
+send_note (int port, int note)
+{
+    snd_seq_event_t ev;
+    snd_seq_ev_clear(&ev);
+    snd_seq_ev_set_source(&ev, s_sender);
+    snd_seq_ev_set_dest(&ev, ::snd_seq_client_id(s_in), port);
+    snd_seq_ev_set_direct(&ev);
+    snd_seq_ev_set_noteon(&ev, 0, note, 100);
+    (void) ::snd_seq_event_output_direct(s_out, &ev);
+}
+
+static bool
+wait_for (std::function<bool ()> done)
+{
+    for (int ms = 0; ms < 2000; ++ms)
+    {
+        if (done())
+            return true;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return done();
+}
+
+static bool
+open_sequencer ()
+{
+    bool result = ::snd_seq_open
+    (
+        &s_in, "default", SND_SEQ_OPEN_DUPLEX, SND_SEQ_NONBLOCK
+    ) == 0;
+    if (result)
+    {
+        result = ::snd_seq_open
+        (
+            &s_out, "default", SND_SEQ_OPEN_OUTPUT, 0
+        ) == 0;
+        if (result)
+        {
+            s_sender = ::snd_seq_create_simple_port
+            (
+                s_out, "sender", SND_SEQ_PORT_CAP_READ,
+                SND_SEQ_PORT_TYPE_MIDI_GENERIC | SND_SEQ_PORT_TYPE_APPLICATION
+            );
+            result = s_sender >= 0;
+        }
+    }
+    return result;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    if (! open_sequencer())
+    {
+        std::cout << "No ALSA sequencer, skipping." << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    bool ok = true;
+    rtl::midi_alsa_input & service = rtl::midi_alsa_input::instance();
+    rtl::rtmidi_in_data da, db;
+    port_state a, b;
+    a.p_port = make_port("a");
+    b.p_port = make_port("b");
+    da.user_callback(callback, &a);
+    db.user_callback(callback, &b);
+    bool added = service.add(s_in, a.p_port, &da, nullptr) &&
+        service.add(s_in, b.p_port, &db, nullptr);
+
+    ok = rt_test_check(added, "add ports") && ok;
+
+    /*
+     * Port a removes itself on note 64.
+     */
+
+    a.p_trigger = 64;
+    a.p_action = [&] () { (void) service.remove(s_in, a.p_port); };
+    for (int n = 60; n < 70; ++n)
+    {
+        send_note(a.p_port, n);
+        send_note(b.p_port, n);
+    }
+    ok = rt_test_check
+    (
+        wait_for([&] () { return b.p_count == 10; }), "other port served"
+    ) && ok;
+    ok = rt_test_check(a.p_count == 5, "removed from its own callback") && ok;
+
+    /*
+     * Port b, now the last, removes itself; the thread stops from within.
+     */
+
+    b.p_trigger = 70;
+    b.p_action = [&] () { (void) service.remove(s_in, b.p_port); };
+    send_note(b.p_port, 70);
+    ok = rt_test_check
+    (
+        wait_for([&] () { return ! service.running(); }),
+        "stopped from callback"
+    ) && ok;
+
+    a.p_count = 0;
+    a.p_trigger = 72;
+    a.p_action = [] ()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    };
+    added = service.add(s_in, a.p_port, &da, nullptr);
+    ok = rt_test_check(added, "re-add") && ok;
+    send_note(a.p_port, 71);
+    ok = rt_test_check
+    (
+        wait_for([&] () { return a.p_count == 1; }), "new thread serves"
+    ) && ok;
+
+    /*
+     * A remove() from this thread waits for the callback in progress.
+     */
+
+    send_note(a.p_port, 72);
+    ok = rt_test_check
+    (
+        wait_for([&] () { return a.p_busy.load(); }), "callback started"
+    ) && ok;
+    (void) service.remove(s_in, a.p_port);
+    ok = rt_test_check(! a.p_busy, "remove waits for callback") && ok;
+    ok = rt_test_check(! service.running(), "stopped") && ok;
+
+    ::snd_seq_close(s_out);
+    ::snd_seq_close(s_in);
+    std::cout << "ALSA input test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+#else
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    std::cout << "ALSA not built, skipping." << std::endl;
+    return EXIT_SUCCESS;
+}
+
+#endif      // defined RTL66_BUILD_ALSA
+
+/*
+ * alsainputtest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,201 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          audiopush.cpp
+ *
+ *      A test-file for the push-mode (blocking) audio stream.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Opens a 16-bit duplex push stream on the headless dummy device, which
+ *  records what it played one buffer earlier.  A sine wave is written with
+ *  blocking writes and read back with blocking reads, and the result must
+ *  match it to within the 16-bit rounding.  The writer goes on for a ring's
+ *  worth of silence, so that the output never runs dry while the reader
+ *  finishes.  Then the writer stops, and the callback must count underruns;
+ *  the reader stops, and it must count overruns.  A non-blocking write to a
+ *  full ring must return at once.
+ */
+
+#include <chrono>                       /* std::chrono::steady_clock        */
+#include <cmath>                        /* std::sin(), std::fabs()          */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <string>                       /* std::string                      */
+#include <thread>                       /* std::this_thread::sleep_for()    */
+#include <vector>                       /* std::vector<>                    */
+
+#include "rtl/audio/audio_dummy.hpp"    /* rtl::audio_dummy class           */
+#include "rtl/audio/rtaudio.hpp"        /* rtl::rtaudio class               */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+static const unsigned s_channels = 2;
+static const unsigned s_rate = 48000;
+static const unsigned s_buffer = 256;
+static const unsigned s_ring = 2048;
+static const std::size_t s_frames = 9600;     /* 200 ms                     */
+
+/**
+ *  An rtaudio that always uses the dummy device.
+ */
+
+class dummy_audio : public rtl::rtaudio
+{
+
+public:
+
+    dummy_audio ()
+    {
+        (void) open_audio_api(api::dummy);
+    }
+
+protected:
+
+    virtual bool open_audio_api
+    (
+        api /*rapi*/                        = api::dummy,
+        const std::string & /*clientname*/  = "",
+        unsigned /*queuesize*/              = 0
+    ) override
+    {
+        delete_rt_api_ptr();
+        rt_api_ptr(new rtl::audio_dummy());
+        return true;
+    }
+
+};
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = true;
+    dummy_audio audio;
+    rtl::stream_parameters out(0, s_channels);
+    rtl::stream_parameters in(0, s_channels);
+    ok = rt_test_check
+    (
+        audio.open_push_stream
+        (
+            &out, &in, rtl::stream_format::sint16, s_rate, s_buffer, s_ring,
+            nullptr, nullptr
+        ), "open push stream"
+    );
+    if (! ok)
+        return EXIT_FAILURE;
+
+    std::vector<float> sine((s_frames + s_ring) * s_channels, 0.0f);
+    for (std::size_t f = 0; f < s_frames; ++f)
+    {
+        double phase = 2.0 * 3.14159265 * 440.0 * f / s_rate;
+        float v = 0.5f * float(std::sin(phase));
+        sine[f * s_channels] = v;
+        sine[f * s_channels + 1] = -v;
+    }
+
+    /*
+     * Prefill part of the ring, then stream the rest with a writer thread
+     * while this thread reads.
+     */
+
+    std::size_t prefill = audio.write(sine.data(), 4 * s_buffer);
+    ok = rt_test_check(prefill == 4 * s_buffer, "prefill") && ok;
+    ok = rt_test_check(audio.start_stream(), "start stream") && ok;
+
+    const std::size_t total = s_frames + s_ring;
+    std::size_t written = prefill;
+    std::thread writer
+    (
+        [&audio, &sine, &written, total] ()
+        {
+            written += audio.write
+            (
+                sine.data() + written * s_channels, total - written, 1000
+            );
+        }
+    );
+
+    /*
+     * The first recorded buffer is the loopback's initial silence; skip it.
+     */
+
+    std::vector<float> heard(s_frames * s_channels);
+    std::size_t got = audio.read(heard.data(), s_buffer, 1000);
+    ok = rt_test_check(got == s_buffer, "initial read") && ok;
+    got = audio.read(heard.data(), s_frames, 1000);
+    ok = rt_test_check(got == s_frames, "blocking read") && ok;
+    ok = rt_test_check(audio.underruns() == 0, "no underruns while fed") && ok;
+    writer.join();
+    ok = rt_test_check(written == total, "blocking write") && ok;
+
+    float worst = 0.0f;
+    for (std::size_t i = 0; i < got * s_channels; ++i)
+    {
+        float d = std::fabs(heard[i] - sine[i]);
+        if (d > worst)
+            worst = d;
+    }
+    ok = rt_test_check(worst < 1.0f / 16384.0f, "loopback matches") && ok;
+
+    /*
+     * Starve the output, and stop reading the input.
+     */
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    ok = rt_test_check(audio.underruns() > 0, "underruns counted") && ok;
+    ok = rt_test_check(audio.overruns() > 0, "overruns counted") && ok;
+    (void) audio.stop_stream();
+
+    /*
+     * With the stream stopped, fill the ring; a non-blocking write then
+     * returns at once, and a timed one after the timeout.
+     */
+
+    (void) audio.write(sine.data(), s_ring);
+    ok = rt_test_check(audio.push_writable() == 0, "ring full") && ok;
+    ok = rt_test_check
+    (
+        audio.write(sine.data(), 1) == 0, "non-blocking write"
+    ) && ok;
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t late = audio.write(sine.data(), 1, 50);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>
+    (
+        std::chrono::steady_clock::now() - start
+    ).count();
+    ok = rt_test_check(late == 0 && ms >= 45, "timed write") && ok;
+    (void) audio.close_stream();
+
+    std::cout
+        << "Worst loopback error " << worst << "; " << audio.underruns()
+        << " underruns, " << audio.overruns() << " overruns" << std::endl
+        ;
+    std::cout << "Audio push test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * audiopush.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
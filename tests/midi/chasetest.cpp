@@ -0,0 +1,271 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          chasetest.cpp
+ *
+ *      A test-file for the controller-chase index.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Checks that the channel mode messages are not chased, that a Reset All
+ *  Controllers forgets what it resets, that a parameter select is sent
+ *  before its data entry (and an NRPN select replaces an RPN select), and
+ *  that a removal or an edit in place, made directly on the event-list
+ *  without telling the index, is seen by the next chase.
+ */
+
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/chaseindex.hpp"          /* midi::chaseindex, chasestate     */
+#include "midi/eventlist.hpp"           /* midi::eventlist class            */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+static const midi::pulse s_interval = 1000;
+
+static midi::event
+control (midi::pulse t, int channel, int cc, int value)
+{
+    return midi::event
+    (
+        t, midi::status::control_change, midi::byte(channel),
+        midi::byte(cc), midi::byte(value)
+    );
+}
+
+/**
+ *  Chases to the tick and returns the events that would be sent, as the
+ *  controller numbers in order (the program change is -1).
+ */
+
+static std::vector<int>
+chased
+(
+    midi::chaseindex & ci, const midi::eventlist & evl, midi::pulse tick,
+    std::vector<int> * values = nullptr
+)
+{
+    std::vector<int> result;
+    midi::chasestate state;
+    std::vector<midi::event> out;
+    (void) ci.chase(evl, tick, state);
+    (void) state.fill_events(out, tick);
+    for (const auto & ev : out)
+    {
+        result.push_back(ev.is_controller() ? int(ev.d0()) : -1);
+        if (values != nullptr)
+            values->push_back(int(ev.d1()));
+    }
+    return result;
+}
+
+static int
+position (const std::vector<int> & ccs, int cc)
+{
+    for (std::size_t i = 0; i < ccs.size(); ++i)
+    {
+        if (ccs[i] == cc)
+            return int(i);
+    }
+    return -1;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = true;
+
+    /*
+     * Channel mode messages, and Reset All Controllers.
+     */
+
+    {
+        midi::eventlist evl;
+        midi::chaseindex ci(s_interval);
+        (void) evl.append(control(0, 0, 1, 50));        /* modulation       */
+        (void) evl.append(control(0, 0, 7, 100));       /* volume           */
+        (void) evl.append(control(0, 0, 64, 127));      /* sustain          */
+        (void) evl.append(control(10, 0, 123, 0));      /* all notes off    */
+        (void) evl.append(control(20, 0, 120, 0));      /* all sound off    */
+        (void) evl.append(control(2500, 0, 121, 0));    /* reset all        */
+        (void) evl.append(control(2600, 0, 11, 90));    /* expression       */
+        evl.sort();
+
+        std::vector<int> ccs = chased(ci, evl, 100);
+        ok = rt_test_check
+        (
+            position(ccs, 123) < 0 && position(ccs, 120) < 0,
+            "mode messages not chased"
+        ) && ok;
+        ok = rt_test_check(position(ccs, 64) >= 0, "sustain chased") && ok;
+
+        ccs = chased(ci, evl, 3000);
+        ok = rt_test_check
+        (
+            position(ccs, 121) == 0, "reset sent first"
+        ) && ok;
+        ok = rt_test_check
+        (
+            position(ccs, 1) < 0 && position(ccs, 64) < 0,
+            "reset forgets controllers"
+        ) && ok;
+        ok = rt_test_check
+        (
+            position(ccs, 7) > 0 && position(ccs, 11) > 0,
+            "volume kept, later controller chased"
+        ) && ok;
+    }
+
+    /*
+     * RPN and NRPN.
+     */
+
+    {
+        midi::eventlist evl;
+        midi::chaseindex ci(s_interval);
+        (void) evl.append(control(0, 1, 101, 0));       /* RPN 0, bend range */
+        (void) evl.append(control(1, 1, 100, 0));
+        (void) evl.append(control(2, 1, 6, 12));        /* data entry MSB   */
+        (void) evl.append(control(3, 1, 38, 0));        /* data entry LSB   */
+        (void) evl.append(control(4, 1, 7, 80));
+        evl.sort();
+
+        std::vector<int> ccs = chased(ci, evl, 100);
+        int sel = position(ccs, 100);
+        ok = rt_test_check
+        (
+            position(ccs, 101) >= 0 && position(ccs, 101) < sel &&
+                sel < position(ccs, 6) && position(ccs, 6) < position(ccs, 38),
+            "select before data entry"
+        ) && ok;
+
+        (void) evl.append(control(2000, 1, 99, 1));     /* NRPN 1/8         */
+        (void) evl.append(control(2001, 1, 98, 8));
+        (void) evl.append(control(2002, 1, 6, 64));
+        evl.sort();
+        std::vector<int> values;
+        ccs = chased(ci, evl, 3000, &values);
+        int data = position(ccs, 6);
+        ok = rt_test_check
+        (
+            position(ccs, 101) < 0 && position(ccs, 100) < 0,
+            "NRPN replaces RPN"
+        ) && ok;
+        ok = rt_test_check
+        (
+            position(ccs, 99) < position(ccs, 98) &&
+                position(ccs, 98) < data && data >= 0 && values[data] == 64,
+            "NRPN select before data entry"
+        ) && ok;
+    }
+
+    /*
+     * Changes made directly on the event-list.
+     */
+
+    {
+        midi::eventlist evl;
+        midi::chaseindex ci(s_interval);
+        (void) evl.append(control(10, 2, 7, 100));
+        (void) evl.append(control(5000, 2, 7, 50));
+        evl.sort();
+
+        std::vector<int> values;
+        std::vector<int> ccs = chased(ci, evl, 6000, &values);
+        ok = rt_test_check
+        (
+            ccs.size() == 1 && values[0] == 50, "chase to last value"
+        ) && ok;
+
+        (void) evl.remove(evl.begin() + 1);             /* no invalidate()  */
+        values.clear();
+        ccs = chased(ci, evl, 6000, &values);
+        ok = rt_test_check
+        (
+            ccs.size() == 1 && values[0] == 100, "removal seen"
+        ) && ok;
+
+        (void) evl.append(control(5000, 2, 7, 50));
+        evl.sort();
+        (void) chased(ci, evl, 6000);
+        for (auto e = evl.begin(); e != evl.end(); ++e)
+            e->set_channel(3);                          /* edit in place    */
+
+        evl.invalidate_match_index();                   /* as documented    */
+        midi::chasestate state;
+        (void) ci.chase(evl, 6000, state);
+        ok = rt_test_check
+        (
+            state.value(3, 7) == 50 && state.value(2, 7) < 0,
+            "edit in place seen"
+        ) && ok;
+    }
+
+    /*
+     * An edit noted by invalidate(), then another that is not.  The second
+     * removes events, leaving checkpoints that index past the end.
+     */
+
+    {
+        midi::eventlist evl;
+        midi::chaseindex ci(s_interval);
+        for (int i = 0; i < 31; ++i)
+            (void) evl.append(control(10 + 100 * i, 4, 7, i));
+
+        evl.sort();
+        (void) chased(ci, evl, 6000);
+        (void) evl.append(control(5500, 4, 7, 99));
+        evl.sort();
+        ci.invalidate(evl, 5500);
+        for (int i = 0; i < 11; ++i)
+            (void) evl.remove(evl.begin() + 20);        /* no invalidate()  */
+
+        midi::chasestate state;
+        (void) ci.chase(evl, 5400, state);
+        ok = rt_test_check
+        (
+            state.value(4, 7) == 19, "unnoted edit after a noted one"
+        ) && ok;
+
+        (void) chased(ci, evl, 6000);
+        for (int i = 0; i < 10; ++i)
+            (void) evl.remove(evl.begin() + 10);
+
+        ci.invalidate(evl, 5500);                       /* the wrong tick   */
+        state.clear();
+        (void) ci.chase(evl, 5400, state);
+        ok = rt_test_check
+        (
+            state.value(4, 7) == 9, "no index past the end"
+        ) && ok;
+    }
+    std::cout << "Chase test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * chasetest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
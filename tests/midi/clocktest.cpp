@@ -0,0 +1,195 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          clocktest.cpp
+ *
+ *      A test-file for the audio frame clock.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Runs 24 hours of buffer ticks through an (unstarted) dummy audio stream
+ *  and checks that the stream time is exact, showing the drift of the old
+ *  running sum for comparison.  Then, offline, it steps a frame clock one
+ *  buffer at a time the way the player's output loop does, and checks that
+ *  the ticks reached match the clock and that each tick is due in the
+ *  buffer holding its frame, across a tempo change.
+ */
+
+#include <cmath>                        /* std::fabs()                      */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <string>                       /* std::string                      */
+
+#include "rtl/audio/audio_dummy.hpp"    /* rtl::audio_dummy class           */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+using frameclock = transport::clock::frameclock;
+
+static const unsigned s_rate = 48000;
+static const unsigned s_buffer = 256;
+
+/**
+ *  Exposes the stream-time functions that backends call.
+ */
+
+class ticking_audio : public rtl::audio_dummy
+{
+
+public:
+
+    using audio_dummy::open_stream;
+    using audio_dummy::close_stream;
+    using audio_dummy::tick_stream_time;
+    using audio_dummy::get_stream_time;
+    using audio_dummy::frame_clock;
+
+};
+
+static int
+no_callback
+(
+    void *, void *, int, double, rtl::stream_status, void *
+)
+{
+    return 0;
+}
+
+/**
+ *  Steps the clock through the given number of buffers at the given tempo,
+ *  carrying the tick remainder as the player does, and checks each buffer.
+ */
+
+static bool
+step_buffers
+(
+    frameclock & fc, midi::bpm bp, midi::ppqn ppq,
+    long buffers, long & tick, long long & frac
+)
+{
+    bool result = true;
+    long long bpm_times_ppqn = (long long)(bp * ppq);
+    long long den = 60LL * fc.sample_rate();
+    for (long b = 0; b < buffers && result; ++b)
+    {
+        frameclock::frame f0 = fc.frames();
+        fc.advance(s_buffer);
+
+        frameclock::frame f1 = fc.frames();
+        long long num = bpm_times_ppqn * (long long)(f1 - f0) + frac;
+        long first = tick + 1;
+        tick += long(num / den);
+        frac = num % den;
+        if (tick != long(std::floor(fc.ticks() + 1.0e-9)))
+            result = false;
+
+        for (long t = first; t <= tick; ++t)    /* ticks due this buffer    */
+        {
+            frameclock::frame due = fc.frame_of(t);
+            if (due <= f0 || due > f1)
+                result = false;
+        }
+    }
+    return result;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = true;
+
+    /*
+     * 24 hours of buffers.
+     */
+
+    ticking_audio audio;
+    rtl::stream_parameters out(0, 2);
+    ok = rt_test_check
+    (
+        audio.open_stream
+        (
+            &out, nullptr, rtl::stream_format::float32, s_rate, s_buffer,
+            no_callback, nullptr, nullptr, nullptr
+        ), "open stream"
+    );
+
+    const long day = 24L * 3600L * s_rate / s_buffer;
+    double summed = 0.0;
+    for (long b = 0; b < day; ++b)
+    {
+        audio.tick_stream_time();
+        summed += s_buffer * 1.0 / s_rate;
+    }
+    double t = audio.get_stream_time();
+    ok = rt_test_check
+    (
+        audio.frame_clock().frames() == 86400ULL * s_rate, "frames"
+    ) && ok;
+    ok = rt_test_check(t == 86400.0, "stream time after 24 hours") && ok;
+    std::cout
+        << "After 24 hours: frame clock " << t << " s, running sum off by "
+        << std::fabs(summed - 86400.0) * 1.0e6 << " us" << std::endl
+        ;
+    (void) audio.close_stream();
+    ok = rt_test_check
+    (
+        ! audio.frame_clock().active(), "inactive when closed"
+    ) && ok;
+
+    /*
+     * Offline scheduling: an awkward tempo, then a change.
+     */
+
+    frameclock fc(s_rate);
+    fc.tempo(133.0, 192);
+    long tick = 0;
+    long long frac = 0;
+    ok = rt_test_check
+    (
+        step_buffers(fc, 133.0, 192, 10000, tick, frac), "ticks at 133 BPM"
+    ) && ok;
+
+    double before = fc.ticks();
+    fc.tempo(97.0, 192);
+    ok = rt_test_check
+    (
+        std::fabs(fc.ticks() - before) < 1.0e-9, "tempo anchor"
+    ) && ok;
+    ok = rt_test_check
+    (
+        step_buffers(fc, 97.0, 192, 10000, tick, frac), "ticks at 97 BPM"
+    ) && ok;
+    std::cout
+        << "Offline: " << tick << " ticks in " << fc.frames() << " frames"
+        << std::endl
+        ;
+    std::cout
+        << "Frame clock test " << (ok ? "passed" : "failed") << std::endl
+        ;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * clocktest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
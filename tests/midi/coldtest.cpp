@@ -0,0 +1,152 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          coldtest.cpp
+ *
+ *      A test-file for the cold storage of idle pattern events.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Packs a pattern's events, edits them while cold (an append, a removal,
+ *  and a const query), and checks that each edit survives another trip
+ *  through cold storage, with the note links rebuilt.
+ */
+
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+
+#include "midi/coldlist.hpp"            /* midi::coldlist class             */
+#include "midi/memusage.hpp"            /* midi::memusage class             */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+static const int s_note_count = 64;
+
+static midi::event
+note (bool on, midi::pulse t, int key)
+{
+    return midi::event
+    (
+        t, on ? midi::status::note_on : midi::status::note_off,
+        0, key, on ? 100 : 0
+    );
+}
+
+static bool
+has_note (const midi::eventlist & evl, midi::pulse t, int key)
+{
+    for (auto e = evl.cbegin(); e != evl.cend(); ++e)
+    {
+        if (e->timestamp() == t && e->is_note_on() && e->get_note() == key)
+            return true;
+    }
+    return false;
+}
+
+static bool
+all_linked (const midi::eventlist & evl)
+{
+    for (auto e = evl.cbegin(); e != evl.cend(); ++e)
+    {
+        if (e->is_note_on() && ! e->is_linked())
+            return false;
+    }
+    return true;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = true;
+    midi::coldlist cl;
+    midi::eventlist raw;
+    for (int i = 0; i < s_note_count; ++i)
+    {
+        (void) raw.append(note(true, i * 96, 40 + i % 40));
+        (void) raw.append(note(false, i * 96 + 90, 40 + i % 40));
+    }
+    (void) cl.events().merge(raw);                  /* sorts, does not link */
+    int count = cl.events().count();
+    ok = rt_test_check(cl.make_cold() && cl.is_cold(), "made cold") && ok;
+    ok = rt_test_check(! cl.make_cold(), "already cold") && ok;
+
+    midi::memusage mu;
+    cl.memory_usage(mu);
+    ok = rt_test_check
+    (
+        mu.cold_bytes() > 0 && mu.event_bytes() == 0, "cold accounting"
+    ) && ok;
+
+    /*
+     * An edit of a cold list must land in the real events.
+     */
+
+    midi::eventlist added;
+    (void) added.append(note(true, 7000, 90));
+    (void) added.append(note(false, 7050, 90));
+    (void) cl.events().merge(added);
+    ok = rt_test_check(! cl.is_cold(), "edit warms") && ok;
+    ok = rt_test_check(cl.make_cold(), "cold again") && ok;
+    ok = rt_test_check
+    (
+        cl.events().count() == count + 2 && has_note(cl.events(), 7000, 90),
+        "append survives"
+    ) && ok;
+
+    (void) cl.make_cold();
+    (void) cl.events().remove(cl.events().begin());
+    (void) cl.make_cold();
+    ok = rt_test_check
+    (
+        cl.events().count() == count + 1 && ! has_note(cl.events(), 0, 40),
+        "removal survives"
+    ) && ok;
+
+    /*
+     * A const query warms too, and the links are rebuilt.
+     */
+
+    (void) cl.make_cold();
+    const midi::coldlist & ccl = cl;
+    ok = rt_test_check
+    (
+        ccl.events().count() == count + 1 && ! ccl.is_cold(), "const query"
+    ) && ok;
+    ok = rt_test_check(all_linked(ccl.events()), "links rebuilt") && ok;
+
+    (void) cl.make_cold();
+    midi::coldlist copy(cl);
+    ok = rt_test_check
+    (
+        copy.events().count() == count + 1 && ! copy.is_cold(), "copy"
+    ) && ok;
+    std::cout << "Cold storage test " << (ok ? "passed" : "failed")
+        << std::endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * coldtest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,474 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          configtest.cpp
+ *
+ *      A test-file for reloading the bus configuration while playing.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Uses the dummy API and busses that count what they send and how often
+ *  they are connected or set.  A thread plays frames, applying the staged
+ *  changes at the top of each, while a series of configurations is
+ *  reloaded.  The busses that a configuration does not change must get
+ *  every event and never be touched, and bad files must change nothing.
+ */
+
+#include <atomic>                       /* std::atomic<bool>                */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <sstream>                      /* std::istringstream               */
+#include <string>                       /* std::string                      */
+#include <thread>                       /* std::thread, std::this_thread    */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/busarray.hpp"            /* midi::busarray class             */
+#include "midi/busconfig.hpp"           /* midi::busconfig class            */
+#include "midi/event.hpp"               /* midi::event class                */
+#include "midi/masterbus.hpp"           /* midi::masterbus class            */
+#include "midi/portwatch.hpp"           /* midi::portwatch class            */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+/**
+ *  A bus that counts its events, the times it is set, and the times it is
+ *  connected.  As an input it enables itself as bus_in does.
+ */
+
+class countingbus : public midi::bus
+{
+
+public:
+
+    std::atomic<int> m_sent;
+    std::atomic<int> m_sets;
+    int m_connects;
+
+    countingbus
+    (
+        midi::masterbus & master, int index, midi::port::io io,
+        const std::string & client, const std::string & port,
+        int clientid
+    ) :
+        midi::bus   (master, index, io),
+        m_sent      (0),
+        m_sets      (0),
+        m_connects  (0)
+    {
+        bus_name(client);
+        port_name(port);
+        set_bus_id(clientid);
+        set_port_id(0);
+    }
+
+    virtual bool send_event (const midi::event *, midi::byte) override
+    {
+        ++m_sent;
+        return true;
+    }
+
+    virtual bool init_input (bool inputing) override
+    {
+        ++m_sets;
+        if (inputing)
+            activate();
+        else
+            deactivate();
+
+        clock_type(inputing ? midi::clocking::none : midi::clocking::disabled);
+        return true;
+    }
+
+    virtual bool connect () override
+    {
+        ++m_connects;
+        return true;
+    }
+
+};
+
+static bool
+parsed (midi::busconfig & cfg, const std::string & text, std::string & msg)
+{
+    std::istringstream in(text);
+    msg.clear();
+    return cfg.parse(in, msg);
+}
+
+static const std::string s_good =
+    "[midi-clock]\n"
+    "3      # number of output ports\n"
+    " 0  0  \"[0] 20:0 Synth:Synth MIDI 1\"\n"
+    " 1  1  \"[1] 24:0 Launchpad Mini:Launchpad Mini MIDI 1\"\n"
+    " 2  0  \"[2] 28:0 Drum Box:Drum Box In\"\n"
+    "\n"
+    "[midi-input]\n"
+    " 0  1  \"[0] 32:0 Keys:Keys Out\"\n"
+    " 1  0  \"[1] 36:0 Pads:Pads Out\"\n"
+    ;
+
+static bool
+test_parse ()
+{
+    bool ok = true;
+    std::string msg;
+    midi::busconfig cfg;
+    ok = rt_test_check(parsed(cfg, s_good, msg), "good file: " + msg) && ok;
+    ok = rt_test_check
+    (
+        cfg.clocks().size() == 3 && cfg.inputs().size() == 2 &&
+            cfg.clocks()[1].bc_clock == midi::clocking::pos &&
+            cfg.inputs()[1].bc_clock == midi::clocking::disabled,
+        "good file contents"
+    ) && ok;
+
+    const std::vector<std::string> bad
+    {
+        "[midi-clock]\n 0  0  Synth\n",
+        "[midi-clock]\n 0  5  \"Synth:Synth MIDI 1\"\n",
+        "[midi-input]\n 0  2  \"Keys:Keys Out\"\n",
+        "[midi-clock]\n 0  0  \"A:A\"\n 0  1  \"B:B\"\n",
+        "[midi-clock]\n 99  0  \"A:A\"\n",
+        "[midi-clock]\n2\n 0  0  \"A:A\"\n",
+        "[midi-clock]\n zero  0  \"A:A\"\n",
+        "[midi-clock]\n 0  0  \"A:A\"\n[midi-clock]\n 1  0  \"B:B\"\n",
+        "[midi-meta-events]\n",
+    };
+    for (const auto & text : bad)
+    {
+        bool rejected = ! parsed(cfg, text, msg);
+        ok = rt_test_check
+        (
+            rejected && ! msg.empty(), "bad file: " + text
+        ) && ok;
+        std::cout << "Rejected: " << msg << std::endl;
+    }
+    ok = rt_test_check
+    (
+        cfg.clocks().size() == 3 && cfg.inputs().size() == 2,
+        "bad files change nothing"
+    ) && ok;
+    ok = rt_test_check
+    (
+        ! cfg.parse_file("/nonexistent/rtl66.rc", msg) &&
+            msg.find("cannot open") != std::string::npos,
+        "missing file"
+    ) && ok;
+    return ok;
+}
+
+/**
+ *  Each step reloads a configuration.  The Synth output and the Keys input
+ *  are the same in all of them.  The Drum Box line is marked as not present
+ *  in one step, which must leave it alone, and a port that is not on the
+ *  system is ignored.
+ */
+
+static const std::vector<std::string> s_steps
+{
+    "[midi-clock]\n"                                /* Launchpad disabled   */
+    " 0  0  \"[0] 20:0 Synth:Synth MIDI 1\"\n"
+    " 1 -1  \"[1] 24:0 Launchpad Mini:Launchpad Mini MIDI 1\"\n"
+    " 2  0  \"[2] 28:0 Drum Box:Drum Box In\"\n"
+    "[midi-input]\n"
+    " 0  1  \"[0] 32:0 Keys:Keys Out\"\n"
+    " 1  0  \"[1] 36:0 Pads:Pads Out\"\n"
+    ,
+    "[midi-clock]\n"                                /* a stranger, -2       */
+    " 0  0  \"[0] 20:0 Synth:Synth MIDI 1\"\n"
+    " 1 -1  \"[1] 24:0 Launchpad Mini:Launchpad Mini MIDI 1\"\n"
+    " 2 -2  \"[2] 28:0 Drum Box:Drum Box In\"\n"
+    " 3  1  \"[3] 40:0 Stranger:Stranger In\"\n"
+    ,
+    "[midi-clock]\n"                                /* both come back       */
+    " 1  2  \"[1] 24:0 Launchpad Mini:Launchpad Mini MIDI 1\"\n"
+    " 2  1  \"[2] 28:0 Drum Box:Drum Box In\"\n"
+    "[midi-input]\n"
+    " 1  1  \"[1] 36:0 Pads:Pads Out\"\n"
+    ,
+};
+
+static bool
+test_reload ()
+{
+    bool ok = true;
+    midi::masterbus mb(rtl::rtmidi::api::dummy);
+    midi::busarray outs;
+    midi::busarray ins;
+    auto output = midi::port::io::output;
+    auto input = midi::port::io::input;
+    countingbus * synth = new countingbus
+    (
+        mb, 0, output, "Synth", "Synth MIDI 1", 20
+    );
+    countingbus * pad = new countingbus
+    (
+        mb, 1, output, "Launchpad Mini", "Launchpad Mini MIDI 1", 24
+    );
+    countingbus * drums = new countingbus
+    (
+        mb, 2, output, "Drum Box", "Drum Box In", 28
+    );
+    countingbus * keys = new countingbus(mb, 0, input, "Keys", "Keys Out", 32);
+    countingbus * pads = new countingbus(mb, 1, input, "Pads", "Pads Out", 36);
+    (void) outs.add(synth, midi::clocking::none);
+    (void) outs.add(pad, midi::clocking::none);
+    (void) outs.add(drums, midi::clocking::none);
+    (void) ins.add(keys, midi::clocking::input);
+    (void) ins.add(pads, midi::clocking::input);
+    (void) outs.initialize();
+    (void) ins.initialize();
+    (void) synth->set_clock(midi::clocking::none);
+    (void) pad->set_clock(midi::clocking::none);
+    (void) drums->set_clock(midi::clocking::none);
+    keys->activate();
+    pads->deactivate();
+    pads->clock_type(midi::clocking::disabled);
+
+    /*
+     * The output thread.  It notes, at the top of each frame, which busses
+     * are enabled, then sends one event to each bus.
+     */
+
+    midi::busconfig::stage stage;
+    std::atomic<bool> playing(true);
+    std::atomic<int> frames(0);
+    int padframes = 0;
+    int drumframes = 0;
+    int applied = 0;
+    std::thread player
+    (
+        [&] ()
+        {
+            midi::event ev(0, midi::status::note_on, midi::byte(0), 60, 100);
+            while (playing)
+            {
+                applied += stage.apply(outs, ins);
+                if (pad->port_enabled())
+                    ++padframes;
+
+                if (drums->port_enabled())
+                    ++drumframes;
+
+                for (midi::bussbyte b = 0; b < 3; ++b)
+                    outs.send_event(b, &ev, 0);
+
+                ++frames;
+                std::this_thread::yield();
+            }
+        }
+    );
+
+    /*
+     * The reloading thread, this one.
+     */
+
+    int staged = 0;
+    std::string msg;
+    std::vector<midi::busconfig::change> changes;
+    for (const auto & text : s_steps)
+    {
+        midi::busconfig cfg;
+        ok = rt_test_check(parsed(cfg, text, msg), "step: " + msg) && ok;
+        staged += cfg.changes(outs, ins, changes);
+        stage.post(changes);
+
+        int start = frames;
+        while (stage.pending() || frames < start + 50)
+            std::this_thread::yield();
+
+        if (staged == 1)
+        {
+            ok = rt_test_check
+            (
+                ! pad->port_enabled(), "Launchpad disabled"
+            ) && ok;
+            ok = rt_test_check(! stage.pending(), "staged and applied") && ok;
+        }
+    }
+
+    midi::busconfig bad;
+    ok = rt_test_check
+    (
+        ! parsed(bad, "[midi-clock]\n 0 9 \"x\"\n", msg), "bad"
+    ) && ok;
+    ok = rt_test_check
+    (
+        bad.changes(outs, ins, changes) == 0, "bad is empty"
+    ) && ok;
+
+    int start = frames;
+    while (frames < start + 50)
+        std::this_thread::yield();
+
+    playing = false;
+    player.join();
+
+    int total = frames;
+    std::cout
+        << "Frames: " << total << ", changes: " << applied << std::endl;
+
+    ok = rt_test_check
+    (
+        staged == 4 && applied == 4, "changes staged, applied"
+    ) && ok;
+    ok = rt_test_check
+    (
+        synth->m_sent == total, "Synth heard every frame"
+    ) && ok;
+    ok = rt_test_check(pad->m_sent == padframes, "Launchpad per frame") && ok;
+    ok = rt_test_check
+    (
+        drums->m_sent == drumframes, "Drum Box per frame"
+    ) && ok;
+    ok = rt_test_check
+    (
+        padframes > 0 && padframes < total && drumframes == total,
+        "Launchpad off for a while, Drum Box always on"
+    ) && ok;
+    ok = rt_test_check
+    (
+        synth->clock_type() == midi::clocking::none, "Synth clock"
+    ) && ok;
+    ok = rt_test_check
+    (
+        pad->clock_type() == midi::clocking::mod, "Launchpad"
+    ) && ok;
+    ok = rt_test_check
+    (
+        drums->clock_type() == midi::clocking::pos, "Drum Box"
+    ) && ok;
+    ok = rt_test_check
+    (
+        keys->m_sets == 0 && keys->port_enabled(), "Keys alone"
+    ) && ok;
+    ok = rt_test_check
+    (
+        pads->m_sets == 1 && pads->port_enabled(), "Pads on"
+    ) && ok;
+
+    int connects = synth->m_connects + pad->m_connects + drums->m_connects +
+        keys->m_connects + pads->m_connects;
+
+    ok = rt_test_check(connects == 0, "no port re-connected") && ok;
+    return ok;
+}
+
+/**
+ *  The changes are made while all the ports are there, then the Launchpad
+ *  and the Pads go before the output thread applies them.  Neither may be
+ *  set or re-activated.  The Drum Box was never opened; it gets its new
+ *  clock, but stays inactive.
+ */
+
+static bool
+test_unplugged_apply ()
+{
+    bool ok = true;
+    midi::masterbus mb(rtl::rtmidi::api::dummy);
+    midi::busarray outs;
+    midi::busarray ins;
+    auto output = midi::port::io::output;
+    auto input = midi::port::io::input;
+    countingbus * pad = new countingbus
+    (
+        mb, 0, output, "Launchpad Mini", "Launchpad Mini MIDI 1", 24
+    );
+    countingbus * drums = new countingbus
+    (
+        mb, 1, output, "Drum Box", "Drum Box In", 28
+    );
+    countingbus * pads = new countingbus(mb, 0, input, "Pads", "Pads Out", 36);
+    (void) outs.add(pad, midi::clocking::none);
+    (void) outs.add(drums, midi::clocking::none);
+    (void) ins.add(pads, midi::clocking::input);
+    (void) outs.initialize();
+    (void) ins.initialize();
+    (void) pad->set_clock(midi::clocking::none);
+    drums->deactivate();
+    pads->activate();
+    pads->clock_type(midi::clocking::none);
+
+    std::string msg;
+    midi::busconfig cfg;
+    ok = rt_test_check
+    (
+        parsed
+        (
+            cfg,
+            "[midi-clock]\n"
+            " 0  1  \"[0] 24:0 Launchpad Mini:Launchpad Mini MIDI 1\"\n"
+            " 1  2  \"[1] 28:0 Drum Box:Drum Box In\"\n"
+            "[midi-input]\n"
+            " 0  0  \"[0] 36:0 Pads:Pads Out\"\n",
+            msg
+        ),
+        "unplug file: " + msg
+    ) && ok;
+
+    std::vector<midi::busconfig::change> changes;
+    midi::busconfig::stage stage;
+    ok = rt_test_check(cfg.changes(outs, ins, changes) == 3, "3 made") && ok;
+    stage.post(changes);
+
+    midi::portwatch::change gone;
+    gone.pw_action = midi::portwatch::action::vanished;
+    gone.pw_client = 24;
+    gone.pw_port = 0;
+    ok = rt_test_check(outs.port_vanished(gone), "Launchpad gone") && ok;
+    gone.pw_client = 36;
+    ok = rt_test_check(ins.port_vanished(gone), "Pads gone") && ok;
+
+    ok = rt_test_check(stage.apply(outs, ins) == 1, "1 applied") && ok;
+    ok = rt_test_check
+    (
+        ! pad->port_enabled() && pad->clock_type() == midi::clocking::none,
+        "Launchpad untouched"
+    ) && ok;
+    ok = rt_test_check
+    (
+        pads->m_sets == 0 && ! pads->port_enabled(), "Pads untouched"
+    ) && ok;
+    ok = rt_test_check
+    (
+        ! drums->port_enabled() && drums->clock_type() == midi::clocking::mod,
+        "Drum Box clock only"
+    ) && ok;
+    return ok;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = test_parse();
+    ok = test_reload() && ok;
+    ok = test_unplugged_apply() && ok;
+    std::cout << "Config reload test " << (ok ? "passed" : "failed") <<
+        std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * configtest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
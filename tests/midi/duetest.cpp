@@ -0,0 +1,259 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          duetest.cpp
+ *
+ *      A test-file for the queue of patterns by next-due tick.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Plays a set of looping patterns, some sparse, some busy, and some with
+ *  nothing to play, over frames of uneven length, once with a full sweep
+ *  (as horizon_scheduling(false) does) and once through a midi::duequeue.
+ *  The events sent, and their order, must be the same, while the queue
+ *  visits far fewer patterns.  A move back in time refills the queue.
+ */
+
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/duequeue.hpp"            /* midi::duequeue<> template        */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+/**
+ *  An event sent: its tick and the pattern that sent it.
+ */
+
+class sent
+{
+public:
+
+    midi::pulse s_tick;
+    int s_pattern;
+
+    bool operator == (const sent & rhs) const
+    {
+        return s_tick == rhs.s_tick && s_pattern == rhs.s_pattern;
+    }
+};
+
+/**
+ *  A looping pattern with events at fixed offsets.  Like a sequence, it
+ *  plays everything since the last tick it was played to, so a pattern
+ *  that is skipped catches up when next played.
+ */
+
+class pattern
+{
+public:
+
+    int p_number;
+    midi::pulse p_length;
+    std::vector<midi::pulse> p_offsets;
+    midi::pulse p_last;
+
+    pattern (int number, midi::pulse length) :
+        p_number    (number),
+        p_length    (length),
+        p_offsets   (),
+        p_last      (-1)
+    {
+        // no code
+    }
+
+    bool has_event (midi::pulse t) const
+    {
+        for (auto offset : p_offsets)
+        {
+            if (t % p_length == offset)
+                return true;
+        }
+        return false;
+    }
+
+    void play (midi::pulse tick, std::vector<sent> & out)
+    {
+        for (midi::pulse t = p_last + 1; t <= tick; ++t)
+        {
+            if (has_event(t))
+                out.push_back(sent{t, p_number});
+        }
+        p_last = tick;
+    }
+
+    midi::pulse next_due (midi::pulse tick) const
+    {
+        if (! p_offsets.empty())
+        {
+            for (midi::pulse t = tick + 1; t <= tick + p_length; ++t)
+            {
+                if (has_event(t))
+                    return t;
+            }
+        }
+        return midi::duequeue<pattern>::never();
+    }
+};
+
+static std::vector<pattern>
+make_patterns ()
+{
+    std::vector<pattern> result;
+    for (int n = 0; n < 24; ++n)
+    {
+        pattern p(n, midi::pulse(192 * (1 + n % 4)));
+        if (n % 6 == 5)
+        {
+            /* nothing to play, e.g. an empty or muted pattern */
+        }
+        else if (n % 3 == 0)
+        {
+            for (midi::pulse t = 0; t < p.p_length; t += 24)
+                p.p_offsets.push_back(t);           /* busy             */
+        }
+        else
+            p.p_offsets.push_back(midi::pulse(7 * n)); /* sparse         */
+
+        result.push_back(p);
+    }
+    return result;
+}
+
+/**
+ *  The frame ticks: uneven steps, then a move back, then more steps.
+ */
+
+static std::vector<midi::pulse>
+make_frames ()
+{
+    std::vector<midi::pulse> result;
+    midi::pulse tick = 0;
+    for (int f = 0; f < 400; ++f)
+    {
+        result.push_back(tick);
+        tick += 1 + (f * 7) % 13;
+        if (f == 250)
+            tick = 100;
+    }
+    return result;
+}
+
+static void
+rewind (std::vector<pattern> & patterns, midi::pulse tick)
+{
+    for (auto & p : patterns)
+        p.p_last = tick - 1;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = true;
+    std::vector<midi::pulse> frames = make_frames();
+    std::vector<sent> swept, queued;
+    midi::duequeue<pattern> sweeper;                /* only for the stats */
+    midi::duequeue<pattern> dq;
+    {
+        std::vector<pattern> patterns = make_patterns();
+        midi::pulse prev = -1;
+        for (auto tick : frames)
+        {
+            if (tick <= prev)
+                rewind(patterns, tick);
+
+            for (auto & p : patterns)
+                p.play(tick, swept);
+
+            sweeper.swept(int(patterns.size()));
+            prev = tick;
+        }
+    }
+    {
+        std::vector<pattern> patterns = make_patterns();
+        midi::pulse prev = -1;
+        for (auto tick : frames)
+        {
+            if (prev < 0 || tick <= prev)
+            {
+                rewind(patterns, tick);
+                dq.clear();
+                for (auto & p : patterns)
+                    dq.add(p, tick);
+            }
+            (void) dq.play
+            (
+                tick, [&queued] (pattern & p, midi::pulse t)
+                {
+                    p.play(t, queued);
+                    return p.next_due(t);
+                }
+            );
+            prev = tick;
+        }
+    }
+    ok = rt_test_check(! swept.empty(), "events sent") && ok;
+    ok = rt_test_check(swept == queued, "same events, same order") && ok;
+    if (swept != queued)
+    {
+        std::cerr
+            << "Swept " << swept.size() << ", queued " << queued.size()
+            << std::endl;
+    }
+
+    const midi::duestats & ss = sweeper.stats();
+    const midi::duestats & qs = dq.stats();
+    ok = rt_test_check
+    (
+        ss.ds_frames == long(frames.size()) &&
+            qs.ds_frames == ss.ds_frames, "frames counted"
+    ) && ok;
+    ok = rt_test_check
+    (
+        ss.ds_visits == ss.ds_items && qs.ds_items == ss.ds_items,
+        "sweep visits every pattern"
+    ) && ok;
+    ok = rt_test_check
+    (
+        qs.ds_visits * 2 < ss.ds_visits, "queue visits fewer patterns"
+    ) && ok;
+    ok = rt_test_check(qs.ds_rebuilds == 2, "rebuilt on move back") && ok;
+    ok = rt_test_check
+    (
+        dq.pending() < dq.population(), "patterns never due dropped"
+    ) && ok;
+    std::cout
+        << "Visits: sweep " << ss.ds_visits << ", queue " << qs.ds_visits
+        << std::endl;
+
+    dq.reset_stats();
+    ok = rt_test_check(dq.stats().ds_frames == 0, "stats reset") && ok;
+    std::cout << "Due queue test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * duetest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
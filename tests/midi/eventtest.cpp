@@ -0,0 +1,305 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          eventtest.cpp
+ *
+ *      A test-file for event-list searching and bulk removal.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Builds a 100000-event list of linked notes, and checks that lookups
+ *  through the match index find the same events as the scan, also after
+ *  many removals (which leave tombstones in the index), and that
+ *  removing a 10% selection in one pass leaves the right events with
+ *  consistent note links.  The times of both ways are shown.
+ */
+
+#include <chrono>                       /* std::chrono::steady_clock        */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/eventlist.hpp"           /* midi::eventlist class            */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+static const int s_note_count = 50000;  /* 100000 events                    */
+
+static long
+elapsed_us (std::chrono::steady_clock::time_point start)
+{
+    using namespace std::chrono;
+    auto us = duration_cast<microseconds>(steady_clock::now() - start);
+    return long(us.count());
+}
+
+static midi::event
+note (bool on, int i)
+{
+    return midi::event
+    (
+        midi::pulse(i * 4 + (on ? 0 : 3)),
+        on ? midi::status::note_on : midi::status::note_off,
+        midi::byte(i % 16), 36 + i % 48, on ? 100 : 0
+    );
+}
+
+/**
+ *  Builds the list, sorted and linked (merge() does the linking).
+ */
+
+static void
+build (midi::eventlist & evl, int notes = s_note_count)
+{
+    midi::eventlist raw;
+    for (int i = 0; i < notes; ++i)
+    {
+        (void) raw.append(note(true, i));
+        (void) raw.append(note(false, i));
+    }
+    (void) evl.merge(raw);
+}
+
+/**
+ *  Removes, appends, and looks up the same notes in both lists, and checks
+ *  that the index finds what the scan finds.  The notes removed are spread
+ *  over the list, so that most removals leave tombstones before the
+ *  positions looked up later.
+ */
+
+static bool
+churn
+(
+    midi::eventlist & scanned, midi::eventlist & indexed,
+    int notes, int rounds
+)
+{
+    bool result = true;
+    for (int r = 0; r < rounds; ++r)
+    {
+        int i = int((long(r) * 7919) % notes);
+        midi::event target = note(r % 2 == 0, i);
+        bool a = scanned.remove_first_match(target);
+        bool b = indexed.remove_first_match(target);
+        if (a != b)
+            result = false;
+
+        if (r % 7 == 0)
+        {
+            (void) scanned.append(note(true, notes + r));
+            (void) indexed.append(note(true, notes + r));
+        }
+        if (r % 5 == 0)
+        {
+            midi::event probe = note(r % 3 == 0, (i + 1) % notes);
+            auto se = scanned.find_first_match(probe);
+            auto ie = indexed.find_first_match(probe);
+            int spos = se == scanned.end() ? -1 : int(se - scanned.begin());
+            int ipos = ie == indexed.end() ? -1 : int(ie - indexed.begin());
+            if (spos != ipos)
+                result = false;
+        }
+    }
+    return result && scanned.count() == indexed.count();
+}
+
+/**
+ *  Every linked event must point at an event that points back, and each
+ *  Note On at a Note Off of the same note.
+ */
+
+static bool
+links_consistent (midi::eventlist & evl)
+{
+    for (auto i = evl.begin(); i != evl.end(); ++i)
+    {
+        if (i->is_linked())
+        {
+            auto p = i->link();
+            if (p < evl.begin() || p >= evl.end() || ! p->is_linked())
+                return false;
+
+            if (p->link() != i || p->get_note() != i->get_note())
+                return false;
+
+            if (i->is_note_on() && ! p->is_note_off())
+                return false;
+        }
+    }
+    return true;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    using namespace std::chrono;
+    bool ok = true;
+    midi::eventlist scanned;
+    midi::eventlist indexed;
+    build(scanned);
+    build(indexed);
+    indexed.match_indexing(true);
+    ok = rt_test_check(scanned.count() == 2 * s_note_count, "list size") && ok;
+    ok = rt_test_check(links_consistent(scanned), "initial links") && ok;
+
+    /*
+     * Lookups: the same positions either way.
+     */
+
+    std::vector<midi::event> targets;
+    for (int i = 0; i < s_note_count; i += s_note_count / 1000)
+        targets.push_back(note(i % 2 == 0, i));
+
+    auto start = steady_clock::now();
+    std::vector<int> found;
+    for (const auto & t : targets)
+    {
+        auto ei = scanned.find_first_match(t);
+        int pos = ei == scanned.end() ? -1 : int(ei - scanned.begin());
+        found.push_back(pos);
+    }
+    long scan_us = elapsed_us(start);
+
+    start = steady_clock::now();
+    bool same = true;
+    for (std::size_t k = 0; k < targets.size(); ++k)
+    {
+        auto ei = indexed.find_first_match(targets[k]);
+        int pos = ei == indexed.end() ? -1 : int(ei - indexed.begin());
+        if (pos != found[k] || pos < 0)
+            same = false;
+    }
+    long index_us = elapsed_us(start);
+    ok = rt_test_check(same, "indexed lookups") && ok;
+    std::cout
+        << targets.size() << " lookups: " << scan_us << " us scanned, "
+        << index_us << " us indexed (including the index build)"
+        << std::endl
+        ;
+
+    /*
+     * Removal of matches keeps the index in step with the list.
+     */
+
+    midi::event gone = note(true, 123);
+    ok = rt_test_check(indexed.remove_first_match(gone), "remove match") && ok;
+    ok = rt_test_check
+    (
+        indexed.find_first_match(gone) == indexed.end(), "match removed"
+    ) && ok;
+    auto ei = indexed.find_first_match(note(false, 124));
+    ok = rt_test_check
+    (
+        ei != indexed.end() && ei->timestamp() == 124 * 4 + 3,
+        "index after removal"
+    ) && ok;
+
+    /*
+     * Many removals, with appends and lookups between them.  A removal
+     * leaves a tombstone rather than renumbering the index, so it costs
+     * about what a lookup does; the small list has enough removals to drop
+     * and rebuild its index several times.
+     */
+
+    (void) scanned.remove_first_match(gone);
+    same = churn(scanned, indexed, s_note_count, 2000);
+    ok = rt_test_check(same, "removals through the index") && ok;
+
+    midi::eventlist smallscanned;
+    midi::eventlist smallindexed;
+    build(smallscanned, 500);
+    build(smallindexed, 500);
+    smallindexed.match_indexing(true);
+    ok = rt_test_check
+    (
+        churn(smallscanned, smallindexed, 500, 600), "index rebuilt"
+    ) && ok;
+
+    /*
+     * Delete a 10% selection: every tenth event, which leaves some notes
+     * without their partners.  Erasing one event at a time is quadratic, so
+     * it is timed on a list a tenth the size.
+     */
+
+    const int small = s_note_count / 10;
+    midi::eventlist onepass;
+    midi::eventlist erased;
+    build(onepass);
+    build(erased, small);
+    std::vector<midi::pulse> expected;
+    int index = 0;
+    for (auto & e : onepass)
+    {
+        if (index++ % 10 == 0)
+            e.select();
+        else
+            expected.push_back(e.timestamp());
+    }
+    index = 0;
+    for (auto & e : erased)
+    {
+        if (index++ % 10 == 0)
+            e.select();
+    }
+
+    start = steady_clock::now();
+    for (auto i = erased.begin(); i != erased.end(); /* ++i */)
+    {
+        if (i->is_selected())
+            i = erased.remove(i);           /* one erase per event, as was  */
+        else
+            ++i;
+    }
+    long erase_us = elapsed_us(start);
+
+    start = steady_clock::now();
+    ok = rt_test_check(onepass.remove_selected(), "remove selected") && ok;
+    long onepass_us = elapsed_us(start);
+    ok = rt_test_check
+    (
+        onepass.count() == int(expected.size()), "kept count"
+    ) && ok;
+
+    bool order = true;
+    index = 0;
+    for (const auto & e : onepass)
+    {
+        if (e.is_selected() || e.timestamp() != expected[index++])
+            order = false;
+    }
+    ok = rt_test_check(order, "kept events") && ok;
+    ok = rt_test_check(links_consistent(onepass), "links after removal") && ok;
+    std::cout
+        << "Removing 10%: " << erase_us << " us erasing one by one from "
+        << 2 * small << " events (before relinking), " << onepass_us
+        << " us in one pass from " << 2 * s_note_count << std::endl
+        ;
+    std::cout << "Event list test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * eventtest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
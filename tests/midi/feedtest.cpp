@@ -0,0 +1,268 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          feedtest.cpp
+ *
+ *      A test-file and example reader for the shared-memory event feed.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  With no arguments, this program publishes events and transport
+ *  snapshots to a private feed, reads them back, and checks them, including
+ *  the lapping of a slow reader, a second writer of the same name, a close
+ *  while output threads are publishing, and the feed a player opens at
+ *  start-up.
+ *
+ *  With "--follow name" it attaches to a running application's feed and
+ *  prints each record, as a lighting or logging observer would.
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <chrono>                       /* std::chrono::milliseconds        */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <string>                       /* std::string, std::to_string()    */
+#include <thread>                       /* std::thread, sleep_for()         */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/event.hpp"               /* midi::event class                */
+#include "midi/eventfeed.hpp"           /* midi::eventfeed writer           */
+#include "midi/feedreader.hpp"          /* midi::feedreader reader          */
+#include "midi/player.hpp"              /* midi::player class               */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+static void
+show_record (const midi::feedrecord & r)
+{
+    std::cout << "#" << r.number << " t=" << r.time_ns << " tick=" << r.tick;
+    if (r.is_transport())
+    {
+        std::cout
+            << " transport bpm=" << r.bpm << " ppqn=" << r.ppqn
+            << (r.flags & midi::feed::c_flag_running ? " running" : " stopped")
+            ;
+    }
+    else
+    {
+        std::cout << " bus=" << int(r.bus) << " ch=" << int(r.channel) << " [";
+        for (int i = 0; i < int(r.length); ++i)
+            std::cout << " " << std::hex << int(r.data[i]) << std::dec;
+
+        std::cout << " ]";
+        if (r.size > r.length)
+            std::cout << " (" << r.size << " bytes)";
+    }
+    std::cout << std::endl;
+}
+
+static int
+follow (const std::string & name)
+{
+    midi::feedreader reader;
+    if (! reader.open(name))
+    {
+        std::cerr << "Cannot open feed " << name << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Following feed " << name << " of process "
+        << reader.writer_pid() << std::endl
+        ;
+    for (;;)
+    {
+        midi::feedrecord rec;
+        midi::feedreader::status s = reader.next(rec);
+        if (s == midi::feedreader::status::ok)
+            show_record(rec);
+        else if (s == midi::feedreader::status::empty)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        else
+            break;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ *  Output threads publish through pins while the feed is closed under
+ *  them.  Each publish must either land in the mapping or see no feed.
+ */
+
+static bool
+close_while_publishing (const std::string & name)
+{
+    midi::eventfeed writer;
+    bool ok = rt_test_check(writer.open(name, 64), "re-open after close");
+    std::atomic<bool> running(true);
+    std::atomic<long> published(0);
+    std::vector<std::thread> outputs;
+    for (int t = 0; t < 4; ++t)
+    {
+        outputs.emplace_back
+        (
+            [&running, &published] ()
+            {
+                midi::event e(0, 0x90, 60, 100);
+                while (running)
+                {
+                    midi::eventfeed::pin pinned;
+                    midi::eventfeed * ef = pinned.feed();
+                    if (ef != nullptr)
+                    {
+                        ef->publish_event(0, 0, e);
+                        ++published;
+                    }
+                }
+            }
+        );
+    }
+    while (published < 10000)
+        std::this_thread::yield();
+
+    writer.close();                             /* waits for the pins       */
+    long after = published;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    running = false;
+    for (auto & t : outputs)
+        t.join();
+
+    ok = rt_test_check(published == after, "nothing after close") && ok;
+    return ok;
+}
+
+/**
+ *  The player opens the feed that the configuration names, as
+ *  rtlmanager::create_player() does, and closes it.
+ */
+
+static bool
+player_feed (const std::string & name)
+{
+    midi::player p;
+    bool ok = rt_test_check
+    (
+        p.open_event_feed(name) && p.event_feed_open() &&
+            midi::eventfeed::active() != nullptr,
+        "player feed open"
+    );
+    midi::feedreader reader;
+    ok = rt_test_check(reader.open(name), "player feed readable") && ok;
+    p.close_event_feed();
+    ok = rt_test_check
+    (
+        ! p.event_feed_open() && midi::eventfeed::active() == nullptr,
+        "player feed closed"
+    ) && ok;
+    return ok;
+}
+
+static int
+self_test ()
+{
+    std::string name = "/rtl66-feedtest-" +
+        std::to_string(midi::feed::steady_ns() % 1000000);
+    midi::eventfeed writer;
+    if (! writer.open(name, 64))
+    {
+        std::cout << "Event feed not supported here, skipping." << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    bool ok = rt_test_check
+    (
+        midi::eventfeed::active() == &writer, "active feed"
+    );
+    midi::eventfeed intruder;
+    ok = rt_test_check
+    (
+        ! intruder.open(name, 64) && midi::eventfeed::active() == &writer,
+        "live feed not taken over"
+    ) && ok;
+    midi::feedreader reader;
+    ok = rt_test_check(reader.open(name), "reader open") && ok;
+
+    midi::feedrecord rec;
+    ok = rt_test_check
+    (
+        reader.next(rec) == midi::feedreader::status::empty, "empty feed"
+    ) && ok;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        midi::event e(i * 48, 0x90, midi::byte(60 + i), 100);
+        writer.publish_event(1, 0, e);
+    }
+    writer.publish_transport(480, 120.0, 192, true, false);
+    for (int i = 0; i < 10; ++i)
+    {
+        ok = rt_test_check
+        (
+            reader.next(rec) == midi::feedreader::status::ok &&
+                rec.is_event() && rec.bus == 1 && rec.tick == i * 48 &&
+                rec.length == 3 && rec.data[1] == 60 + i,
+            "event record " + std::to_string(i)
+        ) && ok;
+    }
+    ok = rt_test_check
+    (
+        reader.next(rec) == midi::feedreader::status::ok &&
+            rec.is_transport() && rec.bpm == 120.0 && rec.ppqn == 192 &&
+            (rec.flags & midi::feed::c_flag_running) != 0,
+        "transport record"
+    ) && ok;
+
+    for (int i = 0; i < 100; ++i)               /* lap the reader           */
+    {
+        midi::event e(i, 0x80, 60, 0);
+        writer.publish_event(0, 0, e);
+    }
+
+    int count = 0;
+    while (reader.next(rec) == midi::feedreader::status::ok)
+        ++count;
+
+    ok = rt_test_check(count == 64, "records after lapping") && ok;
+    ok = rt_test_check(reader.dropped() == 36, "dropped record count") && ok;
+    writer.close();
+    ok = rt_test_check
+    (
+        midi::eventfeed::active() == nullptr, "feed closed"
+    ) && ok;
+    ok = close_while_publishing(name) && ok;
+    ok = player_feed(name) && ok;
+    std::cout << "Event feed test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+int
+main (int argc, char * argv [])
+{
+    if (argc > 2 && std::string(argv[1]) == "--follow")
+        return follow(argv[2]);
+
+    return self_test();
+}
+
+/*
+ * feedtest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
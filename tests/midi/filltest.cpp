@@ -0,0 +1,199 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          filltest.cpp
+ *
+ *      A test-file for the concurrent track fill of the MIDI file writer.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Writes the same song serially and with several fill jobs, and checks
+ *  that the files are byte for byte the same.  The tracks differ in size,
+ *  so that the workers finish them out of order.
+ */
+
+#include <cstdio>                       /* std::remove()                    */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <fstream>                      /* std::ifstream                    */
+#include <iostream>                     /* std::cout                        */
+#include <iterator>                     /* std::istreambuf_iterator<>       */
+#include <string>                       /* std::string, std::to_string()    */
+
+#include "midi/file.hpp"                /* midi::file class                 */
+#include "midi/player.hpp"              /* midi::player class               */
+#include "midi/track.hpp"               /* midi::track class                */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+static const int s_tracks = 16;
+static const midi::pulse s_spacing = 48;
+
+static midi::event
+channel_event (midi::pulse ts, int st, int d0, int d1 = 0)
+{
+    return midi::event(ts, midi::byte(st), midi::byte(d0), midi::byte(d1));
+}
+
+/**
+ *  Fills each track with notes, controllers, and pitch bends on its own
+ *  channel.  Track t gets a different number of notes, the odd ones many
+ *  more than the even ones.
+ */
+
+static bool
+build_song (midi::player & p)
+{
+    bool result = true;
+    for (int t = 0; t < s_tracks && result; ++t)
+    {
+        midi::track::number final;
+        result = p.new_track(final, midi::track::number(t));
+        if (result)
+        {
+            midi::track::pointer trk = p.get_track(final);
+            int ch = t % 16;
+            int notes = (t % 2 == 1 ? 2000 : 50) + 37 * t;
+            for (int i = 0; i < notes; ++i)
+            {
+                midi::pulse ts = midi::pulse(i) * s_spacing;
+                int n = 36 + (i * 7 + t) % 60;
+                midi::eventlist & evl = trk->events();
+                (void) evl.append(channel_event(ts, 0x90 | ch, n, 100));
+                (void) evl.append
+                (
+                    channel_event(ts + s_spacing / 2, 0x80 | ch, n, 64)
+                );
+                if (i % 16 == 0)
+                {
+                    (void) evl.append
+                    (
+                        channel_event(ts, 0xB0 | ch, 7, (i / 16) % 128)
+                    );
+                }
+                if (i % 24 == 0)
+                {
+                    (void) evl.append
+                    (
+                        channel_event(ts + 1, 0xE0 | ch, i % 128, 64)
+                    );
+                }
+            }
+            trk->track_name("Track " + std::to_string(t));
+            trk->events().sort();
+            (void) trk->set_length(midi::pulse(notes) * s_spacing);
+        }
+    }
+    return result;
+}
+
+/**
+ *  Writes the song with the given number of fill jobs, and reads the file
+ *  back as bytes.
+ */
+
+static bool
+write_song
+(
+    midi::player & p, int jobs, const std::string & fname, midi::bytes & out
+)
+{
+    bool result;
+    {
+        midi::file f(fname, p);
+        f.fill_jobs(jobs);
+        result = f.write();
+    }
+    out.clear();
+    if (result)
+    {
+        std::ifstream in(fname, std::ios::binary);
+        result = in.good();
+        if (result)
+        {
+            out.assign
+            (
+                std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>()
+            );
+        }
+    }
+    (void) std::remove(fname.c_str());
+    return result;
+}
+
+static int
+chunks (const midi::bytes & data)
+{
+    int result = 0;
+    for (std::size_t i = 0; i + 4 <= data.size(); ++i)
+    {
+        if
+        (
+            data[i] == 'M' && data[i + 1] == 'T' &&
+            data[i + 2] == 'r' && data[i + 3] == 'k'
+        )
+        {
+            ++result;
+        }
+    }
+    return result;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = true;
+    std::string fname = "/tmp/rtl66-filltest.mid";
+    midi::player p;
+    ok = rt_test_check(build_song(p), "song built");
+
+    midi::bytes serial;
+    ok = rt_test_check(write_song(p, 1, fname, serial), "serial write") && ok;
+    ok = rt_test_check
+    (
+        chunks(serial) == s_tracks && serial.size() > 100000,
+        "all tracks written"
+    ) && ok;
+
+    const int jobs[] = { 2, 4, 8, 0 };
+    for (int j : jobs)
+    {
+        std::string tag = std::to_string(j) + " jobs";
+        midi::bytes parallel;
+        ok = rt_test_check
+        (
+            write_song(p, j, fname, parallel), "write with " + tag
+        ) && ok;
+        ok = rt_test_check(parallel == serial, "same bytes with " + tag) && ok;
+    }
+    std::cout << "Wrote " << serial.size() << " bytes in " << s_tracks
+        << " tracks" << std::endl;
+
+    std::cout << "Fill test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * filltest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
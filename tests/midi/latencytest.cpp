@@ -0,0 +1,229 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          latencytest.cpp
+ *
+ *      A test-file for output latency compensation.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  A loopback of three dummy busses that note when each event is handed to
+ *  them.  Their latencies come from a [midi-clock] section, applied through
+ *  a busconfig::stage as the output thread would, and compensation runs the
+ *  events through the output workers.  An event sent to every bus at once
+ *  must reach each one after its compensation (the largest latency less its
+ *  own), and not much later.
+ */
+
+#include <algorithm>                    /* std::min()                       */
+#include <atomic>                       /* std::atomic<>                    */
+#include <chrono>                       /* std::chrono::steady_clock        */
+#include <cstdint>                      /* std::int64_t                     */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <sstream>                      /* std::istringstream               */
+#include <string>                       /* std::string                      */
+#include <thread>                       /* std::this_thread::sleep_for()    */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/busarray.hpp"            /* midi::busarray class             */
+#include "midi/busconfig.hpp"           /* midi::busconfig class            */
+#include "midi/event.hpp"               /* midi::event class                */
+#include "midi/masterbus.hpp"           /* midi::masterbus class            */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+static const int s_bus_count = 3;
+static const int s_rounds = 5;
+static const long s_slack_us = 15000;           /* a loaded machine     */
+
+static std::int64_t
+now_us ()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>
+    (
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+/**
+ *  A bus that notes the time of the last event handed to it.
+ */
+
+class stampingbus : public midi::bus
+{
+
+public:
+
+    std::atomic<std::int64_t> m_stamp_us;
+    std::atomic<int> m_sent;
+
+    stampingbus
+    (
+        midi::masterbus & master, int index,
+        const std::string & client, const std::string & port,
+        int clientid
+    ) :
+        midi::bus   (master, index, midi::port::io::output),
+        m_stamp_us  (0),
+        m_sent      (0)
+    {
+        bus_name(client);
+        port_name(port);
+        set_bus_id(clientid);
+        set_port_id(0);
+    }
+
+    virtual bool send_event (const midi::event *, midi::byte) override
+    {
+        m_stamp_us = now_us();
+        ++m_sent;
+        return true;
+    }
+
+};
+
+static const std::string s_config =
+    "[midi-clock]\n"
+    " 0  0  \"[0] 20:0 Near:Near MIDI 1\"\n"
+    " 1  0  \"[1] 24:0 Mid:Mid MIDI 1\"     latency=15000\n"
+    " 2  0  \"[2] 28:0 Far:Far MIDI 1\"     latency=40000   # slow synth\n"
+    ;
+
+static const long s_compensation[s_bus_count] = { 40000, 25000, 0 };
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = true;
+    midi::masterbus mb(rtl::rtmidi::api::dummy);
+    midi::busarray outs;
+    midi::busarray ins;
+    stampingbus * busses[s_bus_count] =
+    {
+        new stampingbus(mb, 0, "Near", "Near MIDI 1", 20),
+        new stampingbus(mb, 1, "Mid", "Mid MIDI 1", 24),
+        new stampingbus(mb, 2, "Far", "Far MIDI 1", 28)
+    };
+    for (auto b : busses)
+        (void) outs.add(b, midi::clocking::none);
+
+    (void) outs.initialize();
+    for (auto b : busses)
+        (void) b->set_clock(midi::clocking::none);
+
+    /*
+     * The latencies come in as the configuration does.
+     */
+
+    std::string msg;
+    midi::busconfig cfg;
+    std::istringstream in(s_config);
+    ok = rt_test_check(cfg.parse(in, msg), "parse: " + msg) && ok;
+    ok = rt_test_check
+    (
+        cfg.clocks()[0].bc_latency_us == -1 &&
+            cfg.clocks()[2].bc_latency_us == 40000,
+        "latency parsed"
+    ) && ok;
+
+    std::istringstream bad("[midi-clock]\n 0 0 \"A:A\" latency=fast\n");
+    midi::busconfig badcfg;
+    ok = rt_test_check(! badcfg.parse(bad, msg), "bad latency") && ok;
+
+    midi::busconfig::stage stage;
+    std::vector<midi::busconfig::change> changes;
+    int count = cfg.changes(outs, ins, changes);
+    stage.post(changes);
+    ok = rt_test_check(count == 2, "two latencies changed") && ok;
+    ok = rt_test_check(stage.apply(outs, ins) == 2, "applied") && ok;
+    ok = rt_test_check
+    (
+        outs.latency(0) == 0 && outs.latency(1) == 15000 &&
+            outs.latency(2) == 40000, "latencies set"
+    ) && ok;
+
+    ok = rt_test_check(outs.compensate_latency(true), "compensating") && ok;
+    ok = rt_test_check(outs.async_output(), "workers started") && ok;
+    for (int b = 0; b < s_bus_count; ++b)
+    {
+        ok = rt_test_check
+        (
+            outs.compensation(midi::bussbyte(b)) == s_compensation[b],
+            "compensation " + std::to_string(b)
+        ) && ok;
+    }
+
+    /*
+     * The loopback.  Each offset must be at least the compensation, and
+     * the best of the rounds close to it.
+     */
+
+    midi::event ev(0, midi::status::note_on, midi::byte(0), 60, 100);
+    long best[s_bus_count] = { s_slack_us, s_slack_us, s_slack_us };
+    bool early = false;
+    for (int round = 0; round < s_rounds; ++round)
+    {
+        std::int64_t posted[s_bus_count];
+        for (int b = 0; b < s_bus_count; ++b)
+        {
+            posted[b] = now_us();
+            outs.send_event(midi::bussbyte(b), &ev, 0);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        for (int b = 0; b < s_bus_count; ++b)
+        {
+            long offset = long(busses[b]->m_stamp_us - posted[b]);
+            long late = offset - s_compensation[b];
+            if (late < 0)
+            {
+                std::cerr
+                    << "Bus " << b << " early by " << -late << " us"
+                    << std::endl;
+
+                early = true;
+            }
+            best[b] = std::min(best[b], late);
+        }
+    }
+    ok = rt_test_check(! early, "no bus early") && ok;
+    for (int b = 0; b < s_bus_count; ++b)
+    {
+        std::cout
+            << "Bus " << b << ": compensation " << s_compensation[b]
+            << " us, best lateness " << best[b] << " us" << std::endl;
+
+        ok = rt_test_check
+        (
+            busses[b]->m_sent == s_rounds && best[b] < s_slack_us,
+            "offset matches compensation " + std::to_string(b)
+        ) && ok;
+    }
+    std::cout << "Latency test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * latencytest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,313 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          looptest.cpp
+ *
+ *      A test-file for the L/R loop wrap.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Plays a real track through a one-bar loop 1000 times, with frames of
+ *  uneven size, splitting each frame at R the way player::output_func()
+ *  does: the tail up to R, track::loop_wrap() as player::loop_wrap() calls
+ *  it, then the head from L in the same frame.  The track's sixteenth
+ *  notes, each on its own note number, are placed on an unrolled timeline,
+ *  where the spacing must be constant across every seam, with none lost or
+ *  doubled.  The pattern is two bars long, and a note held past R has its
+ *  Note Off in the second bar, which the loop never reaches; it must be
+ *  closed at the seam (wrapnotes::close) or sent once, in the frame where
+ *  it falls due after L (wrapnotes::carry).
+ */
+
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/player.hpp"              /* midi::player class               */
+#include "midi/track.hpp"               /* midi::track class                */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+#include "transport/info.hpp"           /* transport::info class            */
+
+static const midi::pulse s_ppqn = 192;
+static const midi::pulse s_bar = 4 * s_ppqn;
+static const midi::pulse s_length = 2 * s_bar;          /* the pattern      */
+static const midi::pulse s_left = 2 * s_length;         /* bar 5            */
+static const midi::pulse s_right = s_left + s_bar;      /* one bar          */
+static const midi::pulse s_spacing = s_ppqn / 4;        /* every 16th note  */
+static const int s_first_note = 36;
+static const int s_held_note = 100;
+static const midi::pulse s_held_on = s_bar - 68;        /* sounds at R      */
+static const midi::pulse s_held_off = s_bar + 132;      /* in bar 2         */
+static const midi::pulse s_held_due = s_left + 132;     /* if carried       */
+static const int s_loops = 1000;
+
+/**
+ *  A small deterministic generator, so that failures can be repeated.
+ */
+
+static unsigned
+next_random (unsigned & state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static midi::event
+note (bool on, midi::pulse ts, int n)
+{
+    return midi::event
+    (
+        ts, on ? midi::status::note_on : midi::status::note_off,
+        midi::byte(0), n, on ? 100 : 0
+    );
+}
+
+/**
+ *  A track that records what it would send, instead of sending.  The
+ *  sixteenth-note onsets go on the unrolled timeline, using the pass and
+ *  the note number; the Note Offs of the held note are kept with the frame
+ *  they were sent in.
+ */
+
+class looping_track : public midi::track
+{
+
+public:
+
+    struct held_off
+    {
+        int h_pass;
+        midi::pulse h_first;
+        midi::pulse h_last;
+        bool h_seam;
+    };
+
+    int l_pass;                         /* wraps so far                     */
+    midi::pulse l_first;                /* the frame being played           */
+    midi::pulse l_last;
+    bool l_seam;                        /* inside loop_wrap()               */
+    std::vector<midi::pulse> l_onsets;
+    std::vector<held_off> l_held_offs;
+    int l_held_ons;
+
+    looping_track () :
+        midi::track (),
+        l_pass      (0),
+        l_first     (0),
+        l_last      (0),
+        l_seam      (false),
+        l_onsets    (),
+        l_held_offs (),
+        l_held_ons  (0)
+    {
+        free_channel(true);
+    }
+
+protected:
+
+    virtual void send_on_bus
+    (
+        const midi::event & evout, midi::byte /*channel*/, bool /*flush*/
+    ) override
+    {
+        int n = int(evout.get_note());
+        if (n == s_held_note)
+        {
+            if (evout.is_note_on())
+                ++l_held_ons;
+            else if (evout.is_note_off())
+                l_held_offs.push_back({l_pass, l_first, l_last, l_seam});
+        }
+        else if (evout.is_note_on())
+        {
+            l_onsets.push_back
+            (
+                l_pass * (s_right - s_left) + (n - s_first_note) * s_spacing
+            );
+        }
+    }
+
+    virtual void flush_bus () override
+    {
+        // no code
+    }
+
+};
+
+/**
+ *  Loops the track with the given policy, and checks the onsets and the
+ *  Note Offs of the held note.
+ */
+
+static bool
+run_loops (midi::track::wrapnotes policy, const std::string & tag)
+{
+    bool ok = true;
+    midi::player p;
+    looping_track t;
+    for (midi::pulse ts = 0; ts < s_bar; ts += s_spacing)
+    {
+        int n = s_first_note + int(ts / s_spacing);
+        (void) t.events().append(note(true, ts, n));
+        (void) t.events().append(note(false, ts + s_spacing / 2, n));
+    }
+    (void) t.events().append(note(true, s_held_on, s_held_note));
+    (void) t.events().append(note(false, s_held_off, s_held_note));
+    t.events().sort();
+    t.set_parent(&p, lib66::toggler::on);
+    (void) t.set_length(s_length);
+    (void) t.set_armed(true);
+
+    transport::info ti(4, 4, 120.0, int(s_ppqn));
+    ti.right_tick(s_right);
+    ti.left_tick(s_left);
+    ti.looping(true);
+    t.loop_wrap(s_right, s_left, policy);           /* nothing sounding     */
+
+    const midi::notetracker & nt = t.playing_notes();
+    unsigned seed = 12345;
+    double current = double(s_left);
+    midi::pulse first = s_left;
+    bool held = true;
+    while (t.l_pass < s_loops)
+    {
+        double delta = 0.25 + (next_random(seed) % 3000) * 0.25;
+        double looptick = current + delta;          /* under a bar a frame  */
+        if (ti.loop_wrap(looptick) > 0)
+        {
+            t.l_first = first;                      /* the tail             */
+            t.l_last = s_right - 1;
+            t.play(s_right - 1);
+            t.l_seam = true;
+            t.loop_wrap(s_right, s_left, policy);   /* player::loop_wrap()  */
+            t.l_seam = false;
+            first = s_left;
+            ++t.l_pass;
+            bool sounding = nt.sounding(0, s_held_note);
+            if (sounding != (policy == midi::track::wrapnotes::carry))
+                held = false;
+
+            if (t.l_pass == s_loops)
+                break;
+        }
+        current = looptick;
+        midi::pulse now = midi::pulse(current);
+        t.l_first = first;                          /* head, or whole frame */
+        t.l_last = now;
+        t.play(now);
+        first = now + 1;
+    }
+
+    std::size_t expected = std::size_t(s_loops) *
+        std::size_t((s_right - s_left) / s_spacing);
+
+    const std::vector<midi::pulse> & onsets = t.l_onsets;
+    ok = rt_test_check(onsets.size() == expected, tag + " onset count") && ok;
+    bool even = ! onsets.empty() && onsets.front() == 0;
+    for (std::size_t i = 1; i < onsets.size(); ++i)
+    {
+        if (onsets[i] - onsets[i - 1] != s_spacing)
+        {
+            even = false;
+            std::cerr
+                << "Spacing " << (onsets[i] - onsets[i - 1])
+                << " at onset " << i << std::endl
+                ;
+            break;
+        }
+    }
+    ok = rt_test_check(even, tag + " constant spacing") && ok;
+    ok = rt_test_check(t.l_held_ons == s_loops, tag + " held note") && ok;
+    ok = rt_test_check(held, tag + " sounding across the seam") && ok;
+
+    /*
+     * Closed: one Note Off at each seam.  Carried: one in the frame that
+     * covers its due tick in the next pass, none at the seams; the last
+     * pass ends at a seam, so its Note Off is still pending.
+     */
+
+    bool carry = policy == midi::track::wrapnotes::carry;
+    bool placed = true;
+    int pass = 0;
+    for (const auto & h : t.l_held_offs)
+    {
+        ++pass;
+        if (carry)
+        {
+            if (h.h_seam || h.h_pass != pass)
+                placed = false;
+
+            if (h.h_first > s_held_due || h.h_last < s_held_due)
+                placed = false;
+        }
+        else if (! h.h_seam || h.h_pass != pass - 1)
+            placed = false;
+    }
+    int offs = carry ? s_loops - 1 : s_loops ;
+    ok = rt_test_check
+    (
+        int(t.l_held_offs.size()) == offs && placed, tag + " held Note Offs"
+    ) && ok;
+    std::cout
+        << tag << ": " << onsets.size() << " onsets over " << t.l_pass
+        << " loops, " << t.l_held_offs.size() << " held Note Offs"
+        << std::endl
+        ;
+    return ok;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = true;
+    transport::info ti(4, 4, 120.0, int(s_ppqn));
+    ti.right_tick(s_right);
+    ti.left_tick(s_left);
+
+    double tick = double(s_right) + 10.0;
+    ok = rt_test_check
+    (
+        ti.loop_wrap(tick) == 0, "no wrap unless looping"
+    ) && ok;
+    ti.looping(true);
+    tick = double(s_right) - 0.5;
+    ok = rt_test_check(ti.loop_wrap(tick) == 0, "no wrap before R") && ok;
+    tick = double(s_right) + 2.5 * (s_right - s_left);
+    ok = rt_test_check(ti.loop_wrap(tick) == 3, "wraps counted") && ok;
+    ok = rt_test_check
+    (
+        tick == s_left + 0.5 * (s_right - s_left), "overshoot"
+    ) && ok;
+
+    ok = run_loops(midi::track::wrapnotes::close, "close") && ok;
+    ok = run_loops(midi::track::wrapnotes::carry, "carry") && ok;
+    std::cout << "Loop wrap test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * looptest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -24,16 +24,18 @@
  * \library       rtl66
  * \author        Gary Scavone; refactoring by Chris Ahlstrom
  * \date          2022-06-30
- * \updates       2024-01-29
+ * \updates       2026-10-18
  * \license       See above.
  *
  *      By Gary Scavone, 2003-2012.
  */
 
+#include <chrono>                       /* std::chrono::steady_clock        */
 #include <iostream>                     /* std::cout, std::cerr             */
 #include <map>                          /* std::map<>                       */
 #include <memory>                       /* std::unique_ptr<>                */
 
+#include "rtl/midi/find_midi_api.hpp"   /* rtl::find_midi_api()             */
 #include "rtl/midi/rtmidi.hpp"          /* rtl::rtmidi class, etc.          */
 #include "rtl/midi/rtmidi_in.hpp"       /* rtl::rtmidi_in class             */
 #include "rtl/midi/rtmidi_out.hpp"      /* rtl::rtmidi_out class            */
@@ -52,9 +54,33 @@ show_help ()
     );
 }
 
+/**
+ *  Times the search for an API, which is what an application does first
+ *  at startup.  The second search should come from the probe cache.
+ */
+
+static void
+time_api_search ()
+{
+    using namespace std::chrono;
+    auto start = steady_clock::now();
+    rtl::rtmidi::api first = rtl::find_midi_api();
+    auto middle = steady_clock::now();
+    rtl::rtmidi::api second = rtl::find_midi_api();
+    auto end = steady_clock::now();
+    long firstus = long(duration_cast<microseconds>(middle - start).count());
+    long secondus = long(duration_cast<microseconds>(end - middle).count());
+    std::cout
+        << "API search: '" << rtl::rtmidi::api_name(first) << "' in "
+        << firstus << " us, cached '" << rtl::rtmidi::api_name(second)
+        << "' in " << secondus << " us\n" << std::endl
+        ;
+}
+
 /**
  *  Main routine. Steps:
  *
+ *  -   Time the API search.
  *  -   Create an rtl::rtmidi::api map.
  */
 
@@ -73,6 +99,8 @@ main (int argc, char * argv [])
     }
     if (can_run)
     {
+        time_api_search();
+
         rtl::rtmidi::api_list apis;
         rtl::rtmidi::get_detected_apis(apis);
 
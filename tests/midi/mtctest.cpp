@@ -0,0 +1,207 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          mtctest.cpp
+ *
+ *      A test-file for the MIDI Time Code generator and follower.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Entirely offline.  Checks the drop-frame conversions over a day, then,
+ *  for each frame rate, feeds two minutes of generated quarter frames
+ *  (across an hour boundary) to the follower with arrival jitter, forward
+ *  and in reverse, and checks the position error.  Also checks the
+ *  full-frame locate.
+ */
+
+#include <cmath>                        /* std::fabs()                      */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+#include "transport/clock/mtc.hpp"      /* transport::clock::mtc_generator  */
+
+using namespace transport::clock;
+
+static const double s_jitter = 0.0004;      /* +/- 0.4 ms arrival jitter    */
+static const double s_bound = 0.001;        /* allowed position error       */
+
+/**
+ *  A repeatable jitter in [-s_jitter, s_jitter].
+ */
+
+static double
+jitter ()
+{
+    static unsigned long s_seed = 12345;
+    s_seed = s_seed * 1103515245UL + 12345UL;
+    double unit = double((s_seed >> 16) & 0x7FFF) / 32767.0;
+    return (2.0 * unit - 1.0) * s_jitter;
+}
+
+/**
+ *  Feeds the quarter frames, in the given order, one every quarter frame,
+ *  and returns the largest position error once locked.  The true position
+ *  at each arrival is the time at which that quarter frame was due.
+ */
+
+static double
+follow
+(
+    mtc_follower & f, const std::vector<quarter_frame> & qfs,
+    bool reverse, double period, int & dir
+)
+{
+    double worst = 0.0;
+    std::size_t n = qfs.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const quarter_frame & q = qfs[reverse ? n - 1 - i : i];
+        double now = 1000.0 + i * period;       /* the follower's own clock */
+        (void) f.receive_quarter_frame(q.qf_data, now + jitter());
+        if (f.locked() && i > 16)
+        {
+            double error = std::fabs(f.position(now) - q.qf_seconds);
+            if (error > worst)
+                worst = error;
+        }
+    }
+    dir = f.direction();
+    return worst;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = true;
+
+    /*
+     * Drop frame: every real frame of a day converts and back, and no
+     * minute but every tenth shows frames 0 and 1.
+     */
+
+    const mtc_rate df = mtc_rate::fps_29_97_df;
+    const long day = timecode_to_frames(timecode{24, 0, 0, 0}, df);
+    bool roundtrip = true;
+    bool dropped = true;
+    for (long n = 0; n < day; ++n)
+    {
+        timecode tc = frames_to_timecode(n, df);
+        if (timecode_to_frames(tc, df) != n)
+            roundtrip = false;
+
+        if (tc.tc_seconds == 0 && tc.tc_frames < 2 && tc.tc_minutes % 10 != 0)
+            dropped = false;
+    }
+    ok = rt_test_check(roundtrip, "drop-frame round trip") && ok;
+    ok = rt_test_check(dropped, "drop-frame numbering") && ok;
+    ok = rt_test_check(day == 2589408, "drop-frame day length") && ok;
+
+    const mtc_rate rates [] =
+    {
+        mtc_rate::fps_24, mtc_rate::fps_25,
+        mtc_rate::fps_29_97_df, mtc_rate::fps_30
+    };
+    const char * names [] = { "24", "25", "29.97df", "30" };
+    for (int r = 0; r < 4; ++r)
+    {
+        std::string name = names[r];
+        mtc_generator gen(rates[r]);
+        std::vector<quarter_frame> qfs;
+        (void) gen.locate(3595.3);
+        (void) gen.quarter_frames(3715.3, qfs);
+
+        double period = 0.25 / mtc_fps(rates[r]);
+        bool even = true;
+        for (std::size_t i = 1; i < qfs.size(); ++i)
+        {
+            double gap = qfs[i].qf_seconds - qfs[i - 1].qf_seconds;
+            if (std::fabs(gap - period) > 1.0e-6)
+                even = false;
+        }
+        ok = rt_test_check(even, name + " quarter-frame spacing") && ok;
+        ok = rt_test_check
+        (
+            (qfs[0].qf_data >> 4) == 0, name + " starts at piece 0"
+        ) && ok;
+
+        int dir = 0;
+        mtc_follower forward;
+        double fwd = follow(forward, qfs, false, period, dir);
+        ok = rt_test_check
+        (
+            forward.locked() && dir == 1, name + " forward lock"
+        ) && ok;
+        ok = rt_test_check(forward.rate() == rates[r], name + " rate") && ok;
+        ok = rt_test_check(fwd < s_bound, name + " forward error") && ok;
+
+        mtc_follower backward;
+        double bwd = follow(backward, qfs, true, period, dir);
+        ok = rt_test_check
+        (
+            backward.locked() && dir == -1, name + " reverse lock"
+        ) && ok;
+        ok = rt_test_check(bwd < s_bound, name + " reverse error") && ok;
+        std::cout
+            << names[r] << " fps: " << qfs.size() << " quarter frames, "
+            << "worst error " << fwd * 1000.0 << " ms forward, "
+            << bwd * 1000.0 << " ms reverse" << std::endl
+            ;
+
+        /*
+         * A locate: the full frame sets the position, and it holds until
+         * quarter frames resume from there.
+         */
+
+        mtc_follower located;
+        midi::bytes ff = gen.locate(100.0);
+        double at = gen.next_seconds();
+        ok = rt_test_check
+        (
+            located.receive_full_frame(ff), name + " full frame"
+        ) && ok;
+        ok = rt_test_check
+        (
+            std::fabs(located.position(5.0) - at) < 1.0e-9 &&
+                ! located.running(5.0), name + " located"
+        ) && ok;
+        qfs.clear();
+        (void) gen.quarter_frames(101.0, qfs);
+        (void) follow(located, qfs, false, period, dir);
+        ok = rt_test_check
+        (
+            std::fabs(located.position(1000.0) - at) < s_bound,
+            name + " resume after locate"
+        ) && ok;
+    }
+    std::cout << "MTC test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * mtctest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
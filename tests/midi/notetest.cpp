@@ -0,0 +1,210 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          notetest.cpp
+ *
+ *      A test-file for the per-channel sounding-note table.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Plays a few frames of a multi-channel pattern through a real track, and
+ *  checks that Note Offs pair with the Note Ons of their own channel, and
+ *  that releasing the notes yields exactly the (channel, note) pairs still
+ *  sounding.  The track's bus output is counted, to check that each frame
+ *  is flushed once, not once per event.
+ */
+
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <string>                       /* std::string, std::to_string()    */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/event.hpp"               /* midi::event class                */
+#include "midi/notetracker.hpp"         /* midi::notetracker                */
+#include "midi/player.hpp"              /* midi::player class               */
+#include "midi/track.hpp"               /* midi::track class                */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+static midi::event
+note (bool on, midi::pulse ts, int channel, int n)
+{
+    return midi::event
+    (
+        ts, on ? midi::status::note_on : midi::status::note_off,
+        midi::byte(channel), n, on ? 100 : 0
+    );
+}
+
+/**
+ *  A track that counts what it sends to the bus, and the flushes, instead
+ *  of sending.  The channels of the events are used as is.
+ */
+
+class counting_track : public midi::track
+{
+
+public:
+
+    int c_sent;
+    int c_flushes;
+
+    counting_track () : midi::track (), c_sent (0), c_flushes (0)
+    {
+        free_channel(true);
+    }
+
+    void reset_counts ()
+    {
+        c_sent = c_flushes = 0;
+    }
+
+protected:
+
+    virtual void send_on_bus
+    (
+        const midi::event & /*evout*/, midi::byte /*channel*/, bool flush
+    ) override
+    {
+        ++c_sent;
+        if (flush)
+            ++c_flushes;
+    }
+
+    virtual void flush_bus () override
+    {
+        ++c_flushes;
+    }
+
+};
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    midi::player p;
+    counting_track t;
+    const midi::notetracker & nt = t.playing_notes();
+    bool ok = rt_test_check(! nt.any() && nt.sounding() == 0, "empty tracker");
+
+    /*
+     * Frame 1 (tick 0): the same note on three channels, plus a chord on
+     * channel 9.  Frame 2 (tick 100): a Note Off on channel 3 must not
+     * release channel 0 or 15, and a stray Note Off on channel 1 must be
+     * skipped.  Frame 3 (up to tick 200) is empty.
+     */
+
+    std::vector<midi::event> events
+    {
+        note(true, 0, 0, 60), note(true, 0, 3, 60), note(true, 0, 15, 60),
+        note(true, 0, 9, 36), note(true, 0, 9, 38), note(true, 0, 9, 42),
+        note(true, 0, 9, 127), note(true, 0, 9, 64),
+        note(false, 100, 3, 60), note(false, 100, 1, 60),
+        note(false, 100, 9, 36),
+        note(true, 100, 0, 60)                  /* stacked on channel 0     */
+    };
+    for (const auto & ev : events)
+        (void) t.events().append(ev);
+
+    t.set_parent(&p, lib66::toggler::on);
+    (void) t.set_length(768);
+    (void) t.set_armed(true);
+
+    t.play(10);
+    ok = rt_test_check
+    (
+        t.c_sent == 8 && t.c_flushes == 1, "frame 1 flushes"
+    ) && ok;
+    ok = rt_test_check(nt.sounding() == 8, "frame 1 sounding") && ok;
+    std::cout
+        << "Frame 1: " << t.c_sent << " events, " << t.c_flushes
+        << " flush" << std::endl
+        ;
+
+    t.reset_counts();
+    t.play(110);
+    ok = rt_test_check
+    (
+        t.c_sent == 3 && t.c_flushes == 1, "frame 2 flushes"
+    ) && ok;
+    ok = rt_test_check(! nt.sounding(3, 60), "channel 3 released") && ok;
+    ok = rt_test_check(nt.sounding(15, 60), "channel 15 still sounding") && ok;
+    ok = rt_test_check(nt.count(0, 60) == 2, "channel 0 stacked") && ok;
+    ok = rt_test_check(! nt.sounding(1, 60), "stray Note Off") && ok;
+    ok = rt_test_check(nt.sounding() == 7, "frame 2 sounding") && ok;
+
+    /*
+     * An empty frame flushes nothing.
+     */
+
+    t.reset_counts();
+    t.play(200);
+    ok = rt_test_check
+    (
+        t.c_sent == 0 && t.c_flushes == 0, "empty frame"
+    ) && ok;
+
+    /*
+     * Panic: one Note Off per unmatched Note On, on its own channel, in
+     * channel and note order.
+     */
+
+    midi::notetracker held = nt;
+    std::vector<midi::event> offs;
+    int count = held.release(offs);
+    ok = rt_test_check
+    (
+        count == 7 && int(offs.size()) == 7, "release count"
+    ) && ok;
+
+    const int expected [][2] =
+    {
+        { 0, 60 }, { 0, 60 }, { 9, 38 }, { 9, 42 },
+        { 9, 64 }, { 9, 127 }, { 15, 60 }
+    };
+    for (int i = 0; i < count && i < 7; ++i)
+    {
+        ok = rt_test_check
+        (
+            offs[i].is_note_off() &&
+                offs[i].channel() == expected[i][0] &&
+                offs[i].get_note() == expected[i][1],
+            "release event " + std::to_string(i)
+        ) && ok;
+    }
+    ok = rt_test_check
+    (
+        ! held.any() && held.sounding() == 0, "released all"
+    ) && ok;
+    offs.clear();
+    ok = rt_test_check
+    (
+        held.release(offs) == 0 && offs.empty(), "release empty"
+    ) && ok;
+    std::cout << "Note tracker test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * notetest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,528 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          porttest.cpp
+ *
+ *      A test-file for port hot-plugging.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Uses the dummy API and busses that count what they send.  One device is
+ *  unplugged, so that its events go nowhere, then plugged back in with new
+ *  ALSA numbers, as a USB device is.  Its events must resume on its own bus,
+ *  and a bus the user had disabled must stay disabled.  With asynchronous
+ *  output, the port must not be re-opened while the bus's output worker is
+ *  still sending what was queued before the unplug.  A slow re-bind must
+ *  not hold up masterbus::play() on the other busses, and turning
+ *  asynchronous output on and off must not disturb the output thread.
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <chrono>                       /* std::chrono::microseconds        */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <string>                       /* std::string                      */
+#include <thread>                       /* std::thread                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/busarray.hpp"            /* midi::busarray class             */
+#include "midi/event.hpp"               /* midi::event class                */
+#include "midi/masterbus.hpp"           /* midi::masterbus class            */
+#include "midi/portwatch.hpp"           /* midi::portwatch class            */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+/**
+ *  An output bus that only counts its events.
+ */
+
+class countingbus : public midi::bus
+{
+
+public:
+
+    int m_sent;
+
+    countingbus
+    (
+        midi::masterbus & master, int index,
+        const std::string & client, const std::string & port,
+        int clientid
+    ) :
+        midi::bus   (master, index, midi::port::io::output),
+        m_sent      (0)
+    {
+        bus_name(client);
+        port_name(port);
+        set_bus_id(clientid);
+        set_port_id(0);
+    }
+
+    virtual bool send_event (const midi::event *, midi::byte) override
+    {
+        ++m_sent;
+        return true;
+    }
+
+};
+
+/**
+ *  An output bus whose sends are slow, and which notes whether a send was
+ *  in progress, or made, while it was being re-bound.
+ */
+
+class slowbus : public midi::bus
+{
+
+public:
+
+    std::atomic<int> m_sent;
+    std::atomic<bool> m_sending;
+    bool m_overlap;
+
+    slowbus
+    (
+        midi::masterbus & master, int index,
+        const std::string & client, const std::string & port,
+        int clientid
+    ) :
+        midi::bus   (master, index, midi::port::io::output),
+        m_sent      (0),
+        m_sending   (false),
+        m_overlap   (false)
+    {
+        bus_name(client);
+        port_name(port);
+        set_bus_id(clientid);
+        set_port_id(0);
+    }
+
+    virtual bool send_event (const midi::event *, midi::byte) override
+    {
+        m_sending = true;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        ++m_sent;
+        m_sending = false;
+        return true;
+    }
+
+    virtual bool rebind (int busid, int portid) override
+    {
+        int sent = m_sent;
+        if (m_sending)
+            m_overlap = true;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        if (m_sending || m_sent != sent)
+            m_overlap = true;
+
+        return midi::bus::rebind(busid, portid);
+    }
+
+};
+
+/**
+ *  A bus whose port takes a long time to re-open.
+ */
+
+class sleepybus : public countingbus
+{
+
+public:
+
+    std::atomic<bool> m_rebinding;
+
+    sleepybus
+    (
+        midi::masterbus & master, int index,
+        const std::string & client, const std::string & port,
+        int clientid
+    ) :
+        countingbus (master, index, client, port, clientid),
+        m_rebinding (false)
+    {
+        // no code
+    }
+
+    virtual bool rebind (int busid, int portid) override
+    {
+        m_rebinding = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        bool result = midi::bus::rebind(busid, portid);
+        m_rebinding = false;
+        return result;
+    }
+
+};
+
+/**
+ *  A master bus whose busses the test supplies, and whose play() the test
+ *  can call, as the output thread does.
+ */
+
+class testmaster : public midi::masterbus
+{
+
+public:
+
+    testmaster () : midi::masterbus (rtl::rtmidi::api::dummy)
+    {
+        // no code
+    }
+
+    midi::busarray & outs ()
+    {
+        return output_busses();
+    }
+
+    void send (midi::bussbyte b, midi::event * ev)
+    {
+        play(b, ev, 0);
+    }
+
+};
+
+/**
+ *  Does what masterbus::process_port_changes() does for one array.
+ */
+
+static int
+apply (midi::portwatch & watch, midi::busarray & busses)
+{
+    int result = 0;
+    std::vector<midi::portwatch::change> changes;
+    if (watch.take(changes))
+    {
+        for (const auto & pc : changes)
+        {
+            if (busses.port_change(pc))
+                ++result;
+        }
+    }
+    return result;
+}
+
+static bool
+test_identity ()
+{
+    bool ok = true;
+    ok = rt_test_check
+    (
+        midi::portwatch::identity("LAUNCHPAD MINI:Launchpad  Mini MIDI 1") ==
+        midi::portwatch::identity("Launchpad Mini:Launchpad Mini MIDI 1"),
+        "case and spacing"
+    ) && ok;
+    ok = rt_test_check
+    (
+        midi::portwatch::identity("fluidsynth:Synth input port (1234:0)") ==
+        midi::portwatch::identity("fluidsynth:Synth input port (5678:0)"),
+        "numbers dropped"
+    ) && ok;
+    ok = rt_test_check
+    (
+        midi::portwatch::identity("Launchpad Mini:Launchpad Mini MIDI 1") !=
+        midi::portwatch::identity("Launchpad Mini:Launchpad Mini MIDI 2"),
+        "ports differ"
+    ) && ok;
+    return ok;
+}
+
+static bool
+test_replug ()
+{
+    bool ok = true;
+    midi::masterbus mb(rtl::rtmidi::api::dummy);
+    midi::busarray busses;
+    countingbus * synth = new countingbus(mb, 0, "Synth", "Synth MIDI 1", 20);
+    countingbus * pad = new countingbus
+    (
+        mb, 1, "Launchpad Mini", "Launchpad Mini MIDI 1", 24
+    );
+    countingbus * off = new countingbus(mb, 2, "Drum Box", "Drum Box In", 28);
+    (void) busses.add(synth, midi::clocking::none);
+    (void) busses.add(pad, midi::clocking::none);
+    (void) busses.add(off, midi::clocking::none);
+    (void) busses.initialize();
+    synth->activate();
+    pad->activate();                                /* off stays disabled   */
+
+    ok = rt_test_check
+    (
+        busses.bus_from_name("Launchpad Mini:Launchpad Mini MIDI 1") == 1,
+        "lookup by name"
+    ) && ok;
+    ok = rt_test_check
+    (
+        busses.bus_from_name("Nothing:Here") == -1, "no bus"
+    ) && ok;
+
+    midi::event ev(0, midi::status::note_on, midi::byte(0), 60, 100);
+    busses.send_event(1, &ev, 0);
+    ok = rt_test_check(pad->m_sent == 1, "sent before unplug") && ok;
+
+    midi::portwatch watch;
+    watch.post(midi::portwatch::action::vanished, 24, 0);
+    watch.post(midi::portwatch::action::vanished, 28, 0);
+    ok = rt_test_check(apply(watch, busses) == 1, "one bus unplugged") && ok;
+    ok = rt_test_check
+    (
+        busses.unplugged(1) && ! busses.unplugged(2), "flags"
+    ) && ok;
+    busses.send_event(1, &ev, 0);
+    ok = rt_test_check(pad->m_sent == 1, "nothing sent while gone") && ok;
+
+    watch.post                                      /* new ALSA numbers     */
+    (
+        midi::portwatch::action::appeared, 32, 0,
+        "Launchpad Mini:Launchpad Mini MIDI 1"
+    );
+    watch.post
+    (
+        midi::portwatch::action::appeared, 33, 0, "Drum Box:Drum Box In"
+    );
+    watch.post
+    (
+        midi::portwatch::action::appeared, 34, 0, "Stranger:Stranger Out"
+    );
+    ok = rt_test_check(apply(watch, busses) == 1, "one bus re-bound") && ok;
+    ok = rt_test_check
+    (
+        pad->port_enabled() && pad->bus_id() == 32, "re-bound"
+    ) && ok;
+    ok = rt_test_check(! off->port_enabled(), "disabled bus left alone") && ok;
+
+    busses.send_event(1, &ev, 0);
+    busses.send_event(1, &ev, 0);
+    ok = rt_test_check(pad->m_sent == 3, "events resume") && ok;
+    ok = rt_test_check
+    (
+        synth->m_sent == 0 && off->m_sent == 0, "right bus"
+    ) && ok;
+    return ok;
+}
+
+/**
+ *  A replug while the output worker has a backlog.  The worker is paused
+ *  for the re-bind, and sends the rest afterwards.
+ */
+
+static bool
+test_async_replug ()
+{
+    const int count = 200;
+    bool ok = true;
+    midi::masterbus mb(rtl::rtmidi::api::dummy);
+    midi::busarray busses;
+    slowbus * pad = new slowbus
+    (
+        mb, 0, "Launchpad Mini", "Launchpad Mini MIDI 1", 24
+    );
+    (void) busses.add(pad, midi::clocking::none);
+    (void) busses.initialize();
+    pad->activate();
+    ok = rt_test_check(busses.async_output(true), "async output") && ok;
+
+    midi::event ev(0, midi::status::note_on, midi::byte(0), 60, 100);
+    for (int i = 0; i < count; ++i)
+        busses.send_event(0, &ev, 0);
+
+    midi::portwatch watch;
+    watch.post(midi::portwatch::action::vanished, 24, 0);
+    watch.post
+    (
+        midi::portwatch::action::appeared, 32, 0,
+        "Launchpad Mini:Launchpad Mini MIDI 1"
+    );
+    ok = rt_test_check(apply(watch, busses) == 2, "async replug") && ok;
+    ok = rt_test_check(pad->m_sent < count, "backlog at replug") && ok;
+    ok = rt_test_check(! pad->m_overlap, "worker paused for re-bind") && ok;
+
+    for (int ms = 0; ms < 2000 && pad->m_sent < count; ++ms)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    ok = rt_test_check(pad->m_sent == count, "worker resumed") && ok;
+    (void) busses.async_output(false);
+    return ok;
+}
+
+/**
+ *  masterbus::process_port_changes() re-opens the port without its lock,
+ *  so play() on another bus goes on during a slow re-bind.
+ */
+
+static bool
+test_unlocked_rebind ()
+{
+    bool ok = true;
+    testmaster tm;
+    countingbus * synth = new countingbus(tm, 0, "Synth", "Synth MIDI 1", 20);
+    sleepybus * pad = new sleepybus
+    (
+        tm, 1, "Launchpad Mini", "Launchpad Mini MIDI 1", 24
+    );
+    (void) tm.outs().add(synth, midi::clocking::none);
+    (void) tm.outs().add(pad, midi::clocking::none);
+    (void) tm.outs().initialize();
+    synth->activate();
+    pad->activate();
+
+    tm.port_watch().post(midi::portwatch::action::vanished, 24, 0);
+    ok = rt_test_check(tm.process_port_changes() == 1, "unplugged") && ok;
+    tm.port_watch().post
+    (
+        midi::portwatch::action::appeared, 32, 0,
+        "Launchpad Mini:Launchpad Mini MIDI 1"
+    );
+    int rebound = 0;
+    std::thread poller
+    (
+        [&tm, &rebound] () { rebound = tm.process_port_changes(); }
+    );
+    for (int ms = 0; ms < 1000 && ! pad->m_rebinding; ++ms)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    midi::event ev(0, midi::status::note_on, midi::byte(0), 60, 100);
+    auto start = std::chrono::steady_clock::now();
+    tm.send(0, &ev);
+    auto took = std::chrono::duration_cast<std::chrono::milliseconds>
+    (
+        std::chrono::steady_clock::now() - start
+    ).count();
+    bool during = pad->m_rebinding;
+    poller.join();
+    ok = rt_test_check(during && took < 100, "play() during re-bind") && ok;
+    ok = rt_test_check(synth->m_sent == 1, "sent during re-bind") && ok;
+    ok = rt_test_check
+    (
+        rebound == 1 && pad->port_enabled() && pad->bus_id() == 32,
+        "re-bound unlocked"
+    ) && ok;
+    std::cout << "play() during a re-bind took " << took << " ms" << std::endl;
+    return ok;
+}
+
+/**
+ *  An output thread plays to two busses while asynchronous output is
+ *  turned on and off under it.  Every event must arrive, once.
+ */
+
+static bool
+test_async_toggle ()
+{
+    const int toggles = 20;
+    testmaster tm;
+    countingbus * synth = new countingbus(tm, 0, "Synth", "Synth MIDI 1", 20);
+    countingbus * pad = new countingbus
+    (
+        tm, 1, "Launchpad Mini", "Launchpad Mini MIDI 1", 24
+    );
+    (void) tm.outs().add(synth, midi::clocking::none);
+    (void) tm.outs().add(pad, midi::clocking::none);
+    (void) tm.outs().initialize();
+    synth->activate();
+    pad->activate();
+
+    std::atomic<bool> playing(true);
+    int played = 0;
+    std::thread player
+    (
+        [&tm, &playing, &played] ()
+        {
+            midi::event ev(0, midi::status::note_on, midi::byte(0), 60, 100);
+            while (playing)
+            {
+                tm.send(midi::bussbyte(played++ % 2), &ev);
+                std::this_thread::yield();      /* the queues never fill    */
+            }
+        }
+    );
+    for (int t = 0; t < toggles; ++t)
+    {
+        (void) tm.async_output(t % 2 == 0, 65536);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    playing = false;
+    player.join();
+    (void) tm.async_output(false);
+    std::cout << "Played " << played << " events with async output toggled"
+        << std::endl;
+
+    return rt_test_check
+    (
+        played > 0 && synth->m_sent + pad->m_sent == played,
+        "every event sent once"
+    );
+}
+
+/**
+ *  The API threads post while the poller takes.  Nothing may be lost.
+ */
+
+static bool
+test_queue ()
+{
+    const int count = 10000;
+    midi::portwatch watch;
+    std::thread poster
+    (
+        [&watch, count] ()
+        {
+            for (int i = 0; i < count; ++i)
+                watch.post(midi::portwatch::action::appeared, i, 0);
+        }
+    );
+    int taken = 0;
+    bool ordered = true;
+    std::vector<midi::portwatch::change> changes;
+    while (taken < count)
+    {
+        if (watch.take(changes))
+        {
+            for (const auto & pc : changes)
+            {
+                if (pc.pw_client != taken++)
+                    ordered = false;
+            }
+        }
+    }
+    poster.join();
+    return rt_test_check(ordered && ! watch.pending(), "queue in order") ;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = test_identity();
+    ok = test_replug() && ok;
+    ok = test_async_replug() && ok;
+    ok = test_unlocked_rebind() && ok;
+    ok = test_async_toggle() && ok;
+    ok = test_queue() && ok;
+    std::cout << "Port test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * porttest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
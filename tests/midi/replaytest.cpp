@@ -0,0 +1,181 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          replaytest.cpp
+ *
+ *      A test-file for the capture and replay of MIDI input sessions.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Captures a short session (Start, clocks, a Song Position, a SysEx, and a
+ *  few notes) to a file, reads it back and compares every event and its
+ *  bus, then replays it through midi::player::replay_input(), the same
+ *  path the input thread uses, and checks the clock state it leaves.
+ */
+
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <cstdio>                       /* std::remove()                    */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/calculations.hpp"        /* midi::combine_bytes()            */
+#include "midi/event.hpp"               /* midi::event class                */
+#include "midi/inputlog.hpp"            /* midi::inputlog class             */
+#include "midi/player.hpp"              /* midi::player class               */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+static const int s_clocks = 24;
+static const int s_song_position = 0x123;                /* 16th notes   */
+static const midi::byte s_spp_lsb = midi::byte(s_song_position & 0x7F);
+static const midi::byte s_spp_msb = midi::byte(s_song_position >> 7);
+
+static midi::event
+realtime (midi::byte status)
+{
+    midi::event ev;
+    ev.set_status(status);
+    return ev;
+}
+
+/**
+ *  The session, in the order the input thread would read it.
+ */
+
+static std::vector<midi::event>
+session ()
+{
+    std::vector<midi::event> result;
+    result.push_back(realtime(0xFA));                       /* Start        */
+    for (int c = 0; c < s_clocks; ++c)
+        result.push_back(realtime(0xF8));                   /* Clock        */
+
+    for (int n = 0; n < 4; ++n)
+    {
+        midi::event on(0, midi::status::note_on, 0, 60 + n, 100);
+        midi::event off(0, midi::status::note_off, 0, 60 + n, 0);
+        on.set_input_bus(midi::bussbyte(n % 2));
+        off.set_input_bus(midi::bussbyte(n % 2));
+        result.push_back(on);
+        result.push_back(off);
+    }
+
+    midi::event sx;
+    midi::bytes data = { 0x7E, 0x7F, 0x06, 0x01, 0xF7 };   /* after F0 */
+    (void) sx.set_sysex(data);
+    result.push_back(sx);
+
+    midi::event spp = realtime(0xF2);                       /* Song Pos     */
+    spp.set_data(s_spp_lsb, s_spp_msb);
+    result.push_back(spp);
+    return result;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = true;
+    std::string filename = "/tmp/rtl66-replaytest.r66i";
+    std::vector<midi::event> events = session();
+    {
+        midi::inputlog capture;
+        ok = rt_test_check
+        (
+            capture.open_for_capture(filename), "open for capture"
+        ) && ok;
+        for (const auto & ev : events)
+            ok = rt_test_check(capture.capture(ev), "capture") && ok;
+
+        capture.close();
+    }
+    {
+        midi::inputlog replay;
+        ok = rt_test_check
+        (
+            replay.open_for_replay(filename), "open for replay"
+        ) && ok;
+
+        std::size_t count = 0;
+        std::uint64_t prev_us = 0;
+        std::uint64_t time_us;
+        midi::event ev;
+        bool same = true;
+        bool ordered = true;
+        while (replay.next(ev, time_us))
+        {
+            if (count < events.size())
+            {
+                const midi::event & orig = events[count];
+                if
+                (
+                    ev.get_message().event_bytes() !=
+                        orig.get_message().event_bytes() ||
+                    ev.input_bus() != orig.input_bus()
+                )
+                {
+                    same = false;
+                }
+            }
+            if (time_us < prev_us)
+                ordered = false;
+
+            prev_us = time_us;
+            ++count;
+        }
+        ok = rt_test_check(count == events.size(), "replayed count") && ok;
+        ok = rt_test_check(same, "round trip of bytes and bus") && ok;
+        ok = rt_test_check(ordered, "times ascend") && ok;
+    }
+    {
+        midi::player p;
+        std::string report;
+        ok = rt_test_check
+        (
+            p.replay_input(filename, false, report), "player replay"
+        ) && ok;
+
+        const transport::clock::info & ci = p.clockinfo();
+        ok = rt_test_check(ci.midiclockrunning(), "Start replayed") && ok;
+        ok = rt_test_check
+        (
+            ci.midiclocktick() == s_clocks * ci.midiclockincrement(),
+            "clocks replayed"
+        ) && ok;
+        ok = rt_test_check
+        (
+            ci.midiclockpos() == midi::combine_bytes(s_spp_lsb, s_spp_msb),
+            "Song Position replayed"
+        ) && ok;
+        ok = rt_test_check(! report.empty(), "timing report") && ok;
+        std::cout << report << std::endl;
+    }
+    (void) std::remove(filename.c_str());
+    std::cout << "Replay test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * replaytest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
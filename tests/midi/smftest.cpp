@@ -0,0 +1,450 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          smftest.cpp
+ *
+ *      A test-file for the size-optimizing SMF writer.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Checks the bytes of a small track written plainly and packed, then
+ *  writes a corpus of generated tracks both ways, reads them back, and
+ *  checks that a receiver would hear the same thing from each.  The size
+ *  reduction is reported.
+ */
+
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <map>                          /* std::map<>                       */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/track.hpp"               /* midi::track class                */
+#include "midi/trackdata.hpp"           /* midi::trackdata, smfpacking      */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+#include "util/bytevector.hpp"          /* util::bytevector big-endian data */
+
+/**
+ *  Gets at the protected parser, the inverse of put_track_events().
+ */
+
+class reader : public midi::trackdata
+{
+
+public:
+
+    bool read (midi::track & trk, const midi::bytes & raw)
+    {
+        util::bytevector data;
+        data.assign(raw, 0, raw.size());
+        return parse_track(trk, data, 0, raw.size()) > 0;
+    }
+
+    const midi::eventlist & list () const
+    {
+        return events();
+    }
+
+};
+
+static midi::event
+channel_event (midi::pulse ts, int st, int d0, int d1 = 0)
+{
+    return midi::event(ts, midi::byte(st), midi::byte(d0), midi::byte(d1));
+}
+
+static midi::event
+meta_event (midi::pulse ts, midi::meta type, const midi::bytes & data)
+{
+    midi::event e;
+    e.set_timestamp(ts);
+    (void) e.append_meta_data(type, data);
+    return e;
+}
+
+static midi::bytes
+written (midi::track & trk, const midi::smfpacking & packing)
+{
+    (void) trk.data().put_track_events(trk, packing);
+    return trk.data().byte_list();
+}
+
+/**
+ *  A small receiver.  It logs each note, program, and action, and the
+ *  controller, pitch-wheel, and tempo state at the end of each tick at
+ *  which the state changed.  Two tracks that give the same log sound the
+ *  same.  A Note On of velocity 0 is a Note Off, and release velocities
+ *  are not heard.  A data entry is logged with the parameter it goes to:
+ *  the last RPN or NRPN selected, and that kind's select values.
+ */
+
+class receiver
+{
+
+private:
+
+    std::vector<std::string> m_log;
+    std::map<int, int> m_state;         /* (ch << 8 | cc) or tempo key      */
+    std::map<int, int> m_heard;         /* state as of the last log         */
+    std::map<int, bool> m_nrpn;         /* per channel, NRPN last selected  */
+    midi::pulse m_tick;
+
+public:
+
+    receiver () :
+        m_log   (),
+        m_state (),
+        m_heard (),
+        m_nrpn  (),
+        m_tick  (-1)
+    {
+        // no code
+    }
+
+    const std::vector<std::string> & log () const
+    {
+        return m_log;
+    }
+
+    void hear (const midi::eventlist & evl)
+    {
+        for (auto ei = evl.cbegin(); ei != evl.cend(); ++ei)
+            hear(*ei);
+
+        flush();
+    }
+
+private:
+
+    void flush ()
+    {
+        if (m_state != m_heard)
+        {
+            std::string s = std::to_string(m_tick) + " state";
+            for (const auto & kv : m_state)
+            {
+                s += " " + std::to_string(kv.first);
+                s += "=" + std::to_string(kv.second);
+            }
+            m_log.push_back(s);
+            m_heard = m_state;
+        }
+    }
+
+    std::string parameter (int ch)
+    {
+        auto m = m_nrpn.find(ch);
+        std::string result = "none";
+        if (m != m_nrpn.end())
+        {
+            int msb = m->second ? 99 : 101;
+            auto hi = m_state.find(ch << 8 | msb);
+            auto lo = m_state.find(ch << 8 | (msb - 1));
+            result = m->second ? "nrpn " : "rpn " ;
+            result += std::to_string(hi == m_state.end() ? -1 : hi->second);
+            result += "/";
+            result += std::to_string(lo == m_state.end() ? -1 : lo->second);
+        }
+        return result;
+    }
+
+    void hear (const midi::event & e)
+    {
+        if (e.timestamp() != m_tick)
+        {
+            flush();
+            m_tick = e.timestamp();
+        }
+
+        std::string t = std::to_string(m_tick) + " ";
+        int ch = int(midi::mask_channel(e.status()));
+        int st = int(midi::mask_status(e.status()));
+        if (e.is_tempo())
+        {
+            m_state[0x10000] = int(e.get_message(3)) << 16 |
+                int(e.get_message(4)) << 8 | int(e.get_message(5));
+        }
+        else if (e.is_time_signature())
+        {
+            m_state[0x10001] = int(e.get_message(3)) << 8 |
+                int(e.get_message(4));
+        }
+        else if (! e.has_channel())
+        {
+            m_log.push_back(t + "meta " + std::to_string(int(e.channel())));
+        }
+        else if (st == 0x80 || (st == 0x90 && e.d1() == 0))
+        {
+            m_log.push_back(t + "off " + std::to_string(ch << 8 | e.d0()));
+        }
+        else if
+        (
+            st == 0xB0 && (e.d0() == 6 || e.d0() == 38 || e.d0() == 96 ||
+                e.d0() == 97 || e.d0() >= 120)
+        )
+        {
+            std::string act = t + "act " + std::to_string(ch << 8 | e.d0()) +
+                " " + std::to_string(e.d1());
+
+            if (e.d0() < 120)
+                act += " " + parameter(ch);
+
+            m_log.push_back(act);
+            if (e.d0() == 121)
+            {
+                for (int cc = 0; cc < 128; ++cc)
+                    m_state.erase(ch << 8 | cc);
+
+                m_state.erase(ch << 8 | 0xFF);
+                m_nrpn.erase(ch);
+            }
+        }
+        else if (st == 0xB0)
+        {
+            m_state[ch << 8 | e.d0()] = e.d1();
+            if (e.d0() >= 98 && e.d0() <= 101)
+                m_nrpn[ch] = e.d0() < 100;
+        }
+        else if (st == 0xE0)
+            m_state[ch << 8 | 0xFF] = e.d0() | e.d1() << 7;
+        else
+        {
+            m_log.push_back
+            (
+                t + std::to_string(e.status()) + " " +
+                std::to_string(e.d0()) + " " + std::to_string(e.d1())
+            );
+        }
+    }
+
+};
+
+static bool
+test_bytes ()
+{
+    bool ok = true;
+    midi::track trk;
+    midi::eventlist & evl = trk.events();
+    (void) evl.append(channel_event(0, 0x90, 60, 100));
+    (void) evl.append(channel_event(96, 0x80, 60, 64));
+    (void) evl.append(channel_event(96, 0xB0, 7, 100));
+    (void) evl.append(channel_event(120, 0xB0, 7, 100));
+    (void) evl.append(channel_event(200, 0x90, 62, 100));
+
+    midi::bytes plain = written(trk, midi::smfpacking());
+    midi::bytes plainbytes
+    {
+        0x00, 0x90, 0x3C, 0x64,
+        0x60, 0x80, 0x3C, 0x40,
+        0x00, 0xB0, 0x07, 0x64,
+        0x18, 0xB0, 0x07, 0x64,
+        0x50, 0x90, 0x3E, 0x64
+    };
+    ok = rt_test_check(plain == plainbytes, "default is byte-exact") && ok;
+
+    midi::bytes packed = written(trk, midi::smfpacking(true));
+    midi::bytes packedbytes
+    {
+        0x00, 0x90, 0x3C, 0x64,
+        0x60, 0x3C, 0x00,                           /* running, velocity 0  */
+        0x00, 0xB0, 0x07, 0x64,                     /* repeat dropped       */
+        0x68, 0x90, 0x3E, 0x64                      /* 104 ticks carried    */
+    };
+    ok = rt_test_check(packed == packedbytes, "packed bytes") && ok;
+    return ok;
+}
+
+/**
+ *  A simple generator, so that the corpus is the same on every run.
+ */
+
+static unsigned s_seed = 66;
+
+static int
+roll (int range)
+{
+    s_seed = s_seed * 1103515245u + 12345u;
+    return int((s_seed >> 16) % unsigned(range));
+}
+
+/**
+ *  Fills a track the way a recording or a quantized LFO would: chords with
+ *  release velocities, controllers and the pitch wheel that sit on a value,
+ *  an RPN data entry sent twice, a controller reset, an RPN and an NRPN
+ *  interleaved (the second RPN select repeats the first, but is needed),
+ *  and tempo changes stored twice at the same tick.
+ */
+
+static void
+generate (midi::track & trk, int channels)
+{
+    midi::eventlist & evl = trk.events();
+    midi::pulse ts = 0;
+    for (int bar = 0; bar < 16; ++bar)
+    {
+        if (bar % 4 == 0)
+        {
+            midi::byte t = midi::byte(bar / 4);
+            midi::bytes tempo{0x07, 0xA1, t};
+            midi::bytes timesig{4, 2, 24, 8};
+            (void) evl.append(meta_event(ts, midi::meta::set_tempo, tempo));
+            (void) evl.append(meta_event(ts, midi::meta::set_tempo, tempo));
+            (void) evl.append
+            (
+                meta_event(ts, midi::meta::time_signature, timesig)
+            );
+            (void) evl.append
+            (
+                meta_event(ts, midi::meta::time_signature, timesig)
+            );
+        }
+        for (int ch = 0; ch < channels; ++ch)
+        {
+            int root = 48 + roll(24);
+            for (int n = 0; n < 3; ++n)
+            {
+                int note = root + n * 4;
+                (void) evl.append(channel_event(ts, 0x90 | ch, note, 100));
+                (void) evl.append
+                (
+                    channel_event(ts + 180, 0x80 | ch, note, roll(128))
+                );
+            }
+            for (int step = 0; step < 8; ++step)
+            {
+                midi::pulse at = ts + step * 24;
+                int level = 64 + (step / 3) * 8;
+                int bend = step < 4 ? 0x2000 : 0x2000 + roll(2) * 512;
+                (void) evl.append(channel_event(at, 0xB0 | ch, 1, level));
+                (void) evl.append(channel_event(at, 0xB0 | ch, 7, 100));
+                (void) evl.append
+                (
+                    channel_event(at, 0xE0 | ch, bend & 0x7F, bend >> 7)
+                );
+            }
+            if (bar % 8 == 0)
+            {
+                (void) evl.append(channel_event(ts, 0xB0 | ch, 101, 0));
+                (void) evl.append(channel_event(ts, 0xB0 | ch, 100, 0));
+                (void) evl.append(channel_event(ts, 0xB0 | ch, 6, 2));
+                (void) evl.append(channel_event(ts + 1, 0xB0 | ch, 6, 2));
+                (void) evl.append(channel_event(ts + 2, 0xB0 | ch, 121, 0));
+                (void) evl.append(channel_event(ts + 3, 0xB0 | ch, 7, 100));
+            }
+            else if (bar % 8 == 4)
+            {
+                const int selects[][2] =
+                {
+                    { 101, 0 }, { 100, 0 }, { 6, 2 },               /* RPN  */
+                    { 99, 1 }, { 98, 8 }, { 6, 64 },                /* NRPN */
+                    { 101, 0 }, { 100, 0 }, { 6, 12 }               /* RPN  */
+                };
+                midi::pulse at = ts + 1;
+                for (const auto & s : selects)
+                {
+                    (void) evl.append
+                    (
+                        channel_event(at++, 0xB0 | ch, s[0], s[1])
+                    );
+                }
+            }
+        }
+        ts += 192;
+    }
+    evl.sort();
+}
+
+static bool
+test_corpus ()
+{
+    bool ok = true;
+    std::size_t plaintotal = 0;
+    std::size_t packedtotal = 0;
+    for (int f = 0; f < 8; ++f)
+    {
+        midi::track trk(f);
+        generate(trk, 1 + f % 4);
+
+        receiver original;
+        original.hear(trk.events());
+
+        midi::bytes plain = written(trk, midi::smfpacking());
+        midi::bytes packed = written(trk, midi::smfpacking(true));
+        midi::track plaintrk(f);
+        midi::track packedtrk(f);
+        reader plainreader;
+        reader packedreader;
+        ok = rt_test_check
+        (
+            plainreader.read(plaintrk, plain) &&
+                packedreader.read(packedtrk, packed),
+            "read back"
+        ) && ok;
+
+        receiver fromplain;
+        receiver frompacked;
+        fromplain.hear(plainreader.list());
+        frompacked.hear(packedreader.list());
+        ok = rt_test_check
+        (
+            fromplain.log() == original.log(), "plain round trip"
+        ) && ok;
+        ok = rt_test_check
+        (
+            frompacked.log() == original.log(), "packed sounds same"
+        ) && ok;
+        ok = rt_test_check
+        (
+            packed.size() < plain.size(), "packed is smaller"
+        ) && ok;
+
+        plaintotal += plain.size();
+        packedtotal += packed.size();
+        std::cout
+            << "Track " << f << ": " << plain.size() << " -> "
+            << packed.size() << " bytes" << std::endl
+            ;
+    }
+    std::cout
+        << "Corpus: " << plaintotal << " -> " << packedtotal << " bytes, "
+        << (100 * (plaintotal - packedtotal) / plaintotal) << "% smaller"
+        << std::endl
+        ;
+    return ok;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = test_bytes();
+    ok = test_corpus() && ok;
+    std::cout << "SMF packing test " << (ok ? "passed" : "failed") <<
+        std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * smftest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
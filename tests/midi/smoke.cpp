@@ -24,7 +24,7 @@
  * \library       rtl66
  * \author        Chris Ahlstrom
  * \date          2022-11-25
- * \updates       2024-06-05
+ * \updates       2026-10-18
  * \license       See above.
  *
  *      Provides a smoke test for reading and writing a short MIDI file and
@@ -36,6 +36,9 @@
  *          -   midi::track
  *          -   midi::player
  *          -   midi::bus
+ *          -   midi::memusage (dumped after each file is read)
+ *          -   Deferred (lazy) track decoding, whose output must match the
+ *              ordinary load byte for byte
  *
  *      and their dependencies.
  *
@@ -45,7 +48,11 @@
  *  It assume it is run from the top-level directory of the rtl66 project.
  */
 
+#include <chrono>                       /* std::chrono::steady_clock        */
+#include <cstdio>                       /* std::remove()                    */
+#include <fstream>                      /* std::ifstream                    */
 #include <iostream>
+#include <iterator>                     /* std::istreambuf_iterator         */
 
 #include "cfg/appinfo.hpp"              /* cfg::set_client_name()           */
 #include "rtl/midi/rtmidi.hpp"          /* rtl::rtmidi class, etc.          */
@@ -68,17 +75,81 @@ static const std::vector<std::string> s_test_files
     "simpleblast-ch1-8th-notes-960.midi"
 };
 
+static std::string
+file_bytes (const std::string & filename)
+{
+    std::ifstream f(filename, std::ios::binary);
+    return std::string
+    (
+        std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()
+    );
+}
+
+/**
+ *  Loads the file with deferred decoding, writes it out, and checks that
+ *  the result is the same as that of the ordinary load.  The load times of
+ *  both are shown.
+ */
+
+static bool
+lazy_test
+(
+    midi::player & p,
+    const std::string & testfile,
+    const std::string & eagerfile,
+    long eager_us
+)
+{
+    using namespace std::chrono;
+    std::string errmsg;
+    std::string lazyfile = eagerfile + ".lazy";
+    p.lazy_decode(true);
+
+    auto start = steady_clock::now();
+    bool result = p.read_midi_file(testfile, errmsg, false);
+    long lazy_us = long
+    (
+        duration_cast<microseconds>(steady_clock::now() - start).count()
+    );
+    if (result)
+        result = p.write_midi_file(lazyfile, errmsg, true);
+
+    p.lazy_decode(false);
+    if (result)
+    {
+        result = file_bytes(lazyfile) == file_bytes(eagerfile);
+        std::cout
+            << "Load time: " << eager_us << " us eager, "
+            << lazy_us << " us lazy; output "
+            << (result ? "identical" : "DIFFERS") << std::endl
+            ;
+        (void) std::remove(lazyfile.c_str());
+    }
+    else
+        std::cerr << "Lazy load/write failed: " << errmsg << std::endl;
+
+    return result;
+}
+
 static
 bool file_test (midi::player & p, const std::string & file)
 {
+    using namespace std::chrono;
     std::string errmsg;
     std::string testfile{s_base_directory};
     testfile += "/";
     testfile += file;
 
+    auto start = steady_clock::now();
     bool result = p.read_midi_file(testfile, errmsg, false);
+    long eager_us = long
+    (
+        duration_cast<microseconds>(steady_clock::now() - start).count()
+    );
     if (result)
     {
+        std::cout << p.memory_usage().to_string(file);
+
         std::string outfile = testfile;
         auto ppos = outfile.find_first_of(".");
         outfile.insert(ppos, "-out");
@@ -96,6 +167,7 @@ bool file_test (midi::player & p, const std::string & file)
                 << file << " and its -out version should be identical."
                 << std::endl
                 ;
+            result = lazy_test(p, testfile, outfile, eager_us);
         }
         else
         {
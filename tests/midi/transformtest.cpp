@@ -0,0 +1,161 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          transformtest.cpp
+ *
+ *      A test-file for the play-time transform.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Checks the transform tables, then plays a track with a transpose that
+ *  changes while a note is held.  The Note Off must release the note that
+ *  actually sounded, nothing may be left sounding, and the stored events
+ *  must be as they were.
+ */
+
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <memory>                       /* std::make_shared<>()             */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midi/player.hpp"              /* midi::player class               */
+#include "midi/track.hpp"               /* midi::track class                */
+#include "midi/transform.hpp"           /* midi::transform class            */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+static midi::event
+note (bool on, midi::pulse ts, int n)
+{
+    return midi::event
+    (
+        ts, on ? midi::status::note_on : midi::status::note_off,
+        midi::byte(0), n, on ? 100 : 0
+    );
+}
+
+static bool
+test_tables ()
+{
+    bool ok = true;
+    midi::transform plain;
+    ok = rt_test_check(plain.identity(), "default is identity") && ok;
+
+    midi::transform tr(7, 0.5, 10);
+    ok = rt_test_check(! tr.identity(), "not identity") && ok;
+    ok = rt_test_check(tr.note(60) == 67, "transpose") && ok;
+    ok = rt_test_check(tr.note(125) == 120, "fold down an octave") && ok;
+    ok = rt_test_check(tr.velocity(0) == 0, "velocity 0 kept") && ok;
+    ok = rt_test_check(tr.velocity(100) == 60, "velocity scale, offset") && ok;
+    tr.velocity_map(0.0);
+    ok = rt_test_check(tr.velocity(100) == 1, "velocity never 0") && ok;
+
+    tr.channel_map(0, 9);
+    ok = rt_test_check
+    (
+        tr.channel(0) == 9 && tr.channel(1) == 1, "channel map"
+    ) && ok;
+
+    tr.note_range(48, 59);
+    ok = rt_test_check
+    (
+        tr.note(60) == 55, "fold into range"
+    ) && ok;     /* 67 - 12  */ tr.note_range(60, 64);
+    ok = rt_test_check(tr.note(30) == 60, "pin to narrow range") && ok;
+
+    midi::transform soft(0, 1.0, 0, midi::transform::curve::soft);
+    midi::transform hard(0, 1.0, 0, midi::transform::curve::hard);
+    ok = rt_test_check
+    (
+        soft.velocity(32) > 32 && hard.velocity(32) < 32, "curves"
+    ) && ok;
+    ok = rt_test_check(soft.velocity(127) == 127, "curve end") && ok;
+    return ok;
+}
+
+static bool
+test_held_change ()
+{
+    bool ok = true;
+    midi::player p;
+    midi::track t;
+    (void) t.events().append(note(true, 0, 60));
+    (void) t.events().append(note(false, 384, 60));
+    (void) t.events().append(note(true, 384, 64));
+    (void) t.events().append(note(false, 700, 64));
+    t.set_parent(&p, lib66::toggler::on);
+    (void) t.set_armed(true);
+
+    std::vector<midi::event> stored;
+    for (const auto & e : t.events())
+        stored.push_back(e);
+
+    const midi::notetracker & nt = t.playing_notes();
+    t.play_transform(std::make_shared<midi::transform>(5));
+    t.play(10);
+    ok = rt_test_check
+    (
+        nt.sounding(0, 65) && ! nt.sounding(0, 60), "up 5"
+    ) && ok;
+
+    t.play_transform(std::make_shared<midi::transform>(-3));    /* held     */
+    t.play(400);
+    ok = rt_test_check(! nt.sounding(0, 65), "held note released") && ok;
+    ok = rt_test_check
+    (
+        nt.sounding(0, 61) && nt.sounding() == 1, "down 3"
+    ) && ok;
+
+    t.play_transform(nullptr);
+    t.play(767);
+    ok = rt_test_check(! nt.any(), "nothing left sounding") && ok;
+
+    bool same = stored.size() == std::size_t(t.events().count());
+    std::size_t i = 0;
+    for (const auto & e : t.events())
+    {
+        if (! same)
+            break;
+
+        const midi::event & s = stored[i++];
+        same = e.timestamp() == s.timestamp() && e.status() == s.status() &&
+            e.get_note() == s.get_note() && e.d1() == s.d1();
+    }
+    ok = rt_test_check(same, "stored events untouched") && ok;
+    return ok;
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = test_tables();
+    ok = test_held_change() && ok;
+    std::cout << "Transform test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * transformtest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
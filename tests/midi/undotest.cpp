@@ -0,0 +1,270 @@
+/*
+ *  This file is part of rtl66.
+ *
+ *  rtl66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  rtl66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with rtl66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          undotest.cpp
+ *
+ *      A test-file for the bounded undo stack.
+ *
+ * \library       rtl66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       See above.
+ *
+ *  Checks that eventlist::pack() and unpack() round-trip notes, controls,
+ *  a tempo event, and a SysEx with their flags; that a stack over a small
+ *  budget spills its oldest snapshots and pops every one back intact; that
+ *  the spill space of snapshots dropped by a depth limit is reused; and
+ *  that the background trim packs and spills without push() doing it.
+ */
+
+#include <chrono>                       /* std::chrono::milliseconds        */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <iostream>                     /* std::cout, std::cerr             */
+#include <thread>                       /* std::this_thread::sleep_for()    */
+
+#include "midi/eventlist.hpp"           /* midi::eventlist class            */
+#include "midi/undostack.hpp"           /* midi::undostack class            */
+#include "rtl/test_helpers.hpp"         /* rt_test_check()                  */
+
+static const int s_snapshots = 40;
+
+/**
+ *  Builds a pattern that differs for each version number, so that a
+ *  snapshot popped in the wrong order is caught.
+ */
+
+static void
+build (midi::eventlist & evl, int version)
+{
+    for (int i = 0; i < 32 + version; ++i)
+    {
+        midi::pulse t = midi::pulse(i * 48);
+        midi::byte ch = midi::byte(i % 16);
+        (void) evl.append
+        (
+            midi::event(t, midi::status::note_on, ch, 36 + i % 48, 100)
+        );
+        (void) evl.append
+        (
+            midi::event(t + 40, midi::status::note_off, ch, 36 + i % 48, 0)
+        );
+    }
+    (void) evl.append
+    (
+        midi::event(7, midi::status::control_change, 3, 7, version % 128)
+    );
+    (void) evl.append(midi::create_tempo_event(0, 100.0 + version));
+
+    midi::event sx;
+    midi::bytes data = { 0xF0, 0x7E, 0x7F, 0x09, 0x01, 0xF7 };
+    sx.set_timestamp(5);
+    (void) sx.set_sysex(data);
+    (void) evl.append(sx);
+    evl.sort();
+    auto e = evl.begin();
+    e->select();
+}
+
+static bool
+same (const midi::eventlist & a, const midi::eventlist & b)
+{
+    bool result = a.count() == b.count() && a.length() == b.length();
+    if (result)
+    {
+        auto eb = b.cbegin();
+        for (auto ea = a.cbegin(); ea != a.cend(); ++ea, ++eb)
+        {
+            if
+            (
+                ea->timestamp() != eb->timestamp() ||
+                ea->is_selected() != eb->is_selected() ||
+                ea->get_message().event_bytes() !=
+                    eb->get_message().event_bytes()
+            )
+            {
+                result = false;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ *  Pushes the versions, then pops them all back, newest first.
+ */
+
+static bool
+push_and_pop (midi::undostack & stack)
+{
+    bool result = true;
+    for (int v = 0; v < s_snapshots; ++v)
+    {
+        midi::eventlist evl;
+        build(evl, v);
+        stack.push(evl);
+    }
+    for (int v = s_snapshots - 1; v >= 0; --v)
+    {
+        midi::eventlist expected, popped;
+        build(expected, v);
+        if (! stack.pop(popped) || ! same(expected, popped))
+        {
+            std::cerr << "Snapshot " << v << " differs" << std::endl;
+            result = false;
+            break;
+        }
+    }
+    return result && stack.empty();
+}
+
+int
+main (int /*argc*/, char * /*argv*/ [])
+{
+    bool ok = true;
+    midi::eventlist original;
+    midi::eventlist restored;
+    midi::bytes packed;
+    build(original, 3);
+    original.pack(packed);
+    ok = rt_test_check(restored.unpack(packed), "unpack") && ok;
+    ok = rt_test_check(same(original, restored), "pack round trip") && ok;
+    midi::bytes truncated(packed.begin(), packed.begin() + packed.size() / 2);
+    ok = rt_test_check
+    (
+        ! restored.unpack(truncated) && restored.count() == 0,
+        "truncated data rejected"
+    ) && ok;
+
+    /*
+     * Synchronous trim, with a budget of a few snapshots.
+     */
+
+    midi::undostack::background_trim(false);
+    midi::undostack::budget(packed.size() * 4);
+    {
+        midi::undostack stack;
+        for (int v = 0; v < s_snapshots; ++v)
+        {
+            midi::eventlist evl;
+            build(evl, v);
+            stack.push(evl);
+        }
+        ok = rt_test_check(stack.spilled() > 0, "spilled") && ok;
+        ok = rt_test_check
+        (
+            midi::undostack::total_bytes() <= midi::undostack::budget(),
+            "within budget"
+        ) && ok;
+        stack.clear();
+        ok = rt_test_check
+        (
+            midi::undostack::total_bytes() == 0, "clear releases"
+        ) && ok;
+    }
+    {
+        midi::undostack stack;
+        ok = rt_test_check(push_and_pop(stack), "spilled pops") && ok;
+    }
+
+    /*
+     * The default depth applies to stacks that do not give one.
+     */
+
+    midi::undostack::default_depth(10);
+    {
+        midi::undostack stack;
+        midi::eventlist evl;
+        build(evl, 0);
+        for (int v = 0; v < 25; ++v)
+            stack.push(evl);
+
+        ok = rt_test_check(stack.size() == 10, "default depth") && ok;
+    }
+    midi::undostack::default_depth(0);
+
+    /*
+     * A depth limit with spilling: the snapshots it drops leave holes at
+     * the start of the spill file, which must be reused.
+     */
+
+    {
+        midi::undostack stack(4, 10);
+        midi::bytes biggest;
+        midi::eventlist evl;
+        build(evl, s_snapshots);
+        evl.pack(biggest);
+        for (int v = 0; v < 200; ++v)
+        {
+            evl.clear();
+            build(evl, v % s_snapshots);
+            stack.push(evl);
+        }
+        ok = rt_test_check(stack.spilled() > 0, "depth spilled") && ok;
+        ok = rt_test_check
+        (
+            stack.spill_file_size() <= 3 * 10 * biggest.size(),
+            "dropped spill space reused"
+        ) && ok;
+
+        bool popped = true;
+        for (int v = 199; v >= 190; --v)
+        {
+            midi::eventlist expected, restored;
+            build(expected, v % s_snapshots);
+            if (! stack.pop(restored) || ! same(expected, restored))
+            {
+                std::cerr << "Snapshot " << v << " differs" << std::endl;
+                popped = false;
+                break;
+            }
+        }
+        ok = rt_test_check(popped && stack.empty(), "depth pops") && ok;
+    }
+
+    /*
+     * Background trim: push() only marks the stack.
+     */
+
+    midi::undostack::background_trim(true);
+    {
+        midi::undostack stack;
+        for (int v = 0; v < s_snapshots; ++v)
+        {
+            midi::eventlist evl;
+            build(evl, v);
+            stack.push(evl);
+        }
+        for (int ms = 0; ms < 2000 && stack.spilled() == 0; ++ms)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        ok = rt_test_check(stack.spilled() > 0, "background spill") && ok;
+        stack.clear();
+        ok = rt_test_check(push_and_pop(stack), "background pops") && ok;
+    }
+    std::cout << "Undo stack test " << (ok ? "passed" : "failed") << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * undotest.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */